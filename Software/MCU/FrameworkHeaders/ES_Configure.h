@@ -39,233 +39,106 @@
 // Define if we want to log data for RL Motor control
 //#define RL_MOTOR_LOGGING
 
-// Set the distance between the wheels
-//#define WHEEL_BASE 0.258572 // Distance between wheels on the robot (m) (Centered Wheels)
-#define WHEEL_BASE 0.2713 // 122 RPM Car Setup
-
-/****************************************************************************/
-// The maximum number of services sets an upper bound on the number of
-// services that the framework will handle. Reasonable values are 8 and 16
-// corresponding to an 8-bit(uint8_t) and 16-bit(uint16_t) Ready variable size
-#define MAX_NUM_SERVICES 16
-
-/****************************************************************************/
-// This macro determines that nuber of services that are *actually* used in
-// a particular application. It will vary in value from 1 to MAX_NUM_SERVICES
-#define NUM_SERVICES 10
-
-/****************************************************************************/
-// These are the definitions for Service 0, the lowest priority service.
-// Every Events and Services application must have a Service 0. Further
-// services are added in numeric sequence (1,2,3,...) with increasing
-// priorities
-// the header file with the public function prototypes
-#define SERV_0_HEADER "UsbService.h"
-// the name of the Init function
-#define SERV_0_INIT InitUsbService
-// the name of the run function
-#define SERV_0_RUN RunUsbService
-// How big should this services Queue be?
-#define SERV_0_QUEUE_SIZE 5
-
-/****************************************************************************/
-// The following sections are used to define the parameters for each of the
-// services. You only need to fill out as many as the number of services
-// defined by NUM_SERVICES
-/****************************************************************************/
-// These are the definitions for Service 1
-#if NUM_SERVICES > 1
-// the header file with the public function prototypes
-#define SERV_1_HEADER "LEDService.h"
-// the name of the Init function
-#define SERV_1_INIT InitLEDService
-// the name of the run function
-#define SERV_1_RUN RunLEDService
-// How big should this services Queue be?
-#define SERV_1_QUEUE_SIZE 3
-#endif
-
-/****************************************************************************/
-// These are the definitions for Service 2
-#if NUM_SERVICES > 2
-// the header file with the public function prototypes
-#define SERV_2_HEADER "IMU_SM.h"
-// the name of the Init function
-#define SERV_2_INIT InitImuSM
-// the name of the run function
-#define SERV_2_RUN RunImuSM
-// How big should this services Queue be?
-#define SERV_2_QUEUE_SIZE 3
-#endif
-
-/****************************************************************************/
-// These are the definitions for Service 3
-#if NUM_SERVICES > 3
-// the header file with the public function prototypes
-#define SERV_3_HEADER "JetsonSM.h"
-// the name of the Init function
-#define SERV_3_INIT InitJetsonSM
-// the name of the run function
-#define SERV_3_RUN RunJetsonSM
-// How big should this services Queue be?
-#define SERV_3_QUEUE_SIZE 3
-#endif
-
-/****************************************************************************/
-// These are the definitions for Service 4
-#if NUM_SERVICES > 4
-// the header file with the public function prototypes
-#define SERV_4_HEADER "Button1DebouncerSM.h"
-// the name of the Init function
-#define SERV_4_INIT InitButton1DebouncerSM
-// the name of the run function
-#define SERV_4_RUN RunButton1DebouncerSM
-// How big should this services Queue be?
-#define SERV_4_QUEUE_SIZE 3
+// Define as false to run the float PID law in the motor ISR instead of the
+// integer one, see MotorControl.c
+#ifndef MOTOR_PID_FIXED
+#define MOTOR_PID_FIXED true
 #endif
 
-/****************************************************************************/
-// These are the definitions for Service 5
-#if NUM_SERVICES > 5
-// the header file with the public function prototypes
-#define SERV_5_HEADER "Button2DebouncerSM.h"
-// the name of the Init function
-#define SERV_5_INIT InitButton2DebouncerSM
-// the name of the run function
-#define SERV_5_RUN RunButton2DebouncerSM
-// How big should this services Queue be?
-#define SERV_5_QUEUE_SIZE 3
+// Define as true for the PID gains retuned on the host plant for a crawl,
+// not yet checked on the robot, see MotorControl.c
+#ifndef MOTOR_PID_CRAWL_GAINS
+#define MOTOR_PID_CRAWL_GAINS false
 #endif
 
-/****************************************************************************/
-// These are the definitions for Service 6
-#if NUM_SERVICES > 6
-// the header file with the public function prototypes
-#define SERV_6_HEADER "Button3DebouncerSM.h"
-// the name of the Init function
-#define SERV_6_INIT InitButton3DebouncerSM
-// the name of the run function
-#define SERV_6_RUN RunButton3DebouncerSM
-// How big should this services Queue be?
-#define SERV_6_QUEUE_SIZE 3
+// Motor PWM frequency in Hz, 763 to 100000, see MotorPWM.c. 20000 and up
+// is past hearing, at the cost of duty resolution (2500 steps at 20 kHz)
+#ifndef MOTOR_PWM_HZ
+#define MOTOR_PWM_HZ 10000
 #endif
 
-/****************************************************************************/
-// These are the definitions for Service 7
-#if NUM_SERVICES > 7
-// the header file with the public function prototypes
-#define SERV_7_HEADER "MotorSM.h"
-// the name of the Init function
-#define SERV_7_INIT InitMotorSM
-// the name of the run function
-#define SERV_7_RUN RunMotorSM
-// How big should this services Queue be?
-#define SERV_7_QUEUE_SIZE 3
-#endif
+// Set the distance between the wheels
+//#define WHEEL_BASE 0.258572 // Distance between wheels on the robot (m) (Centered Wheels)
+#define WHEEL_BASE 0.2713 // 122 RPM Car Setup
+#define WHEEL_RADIUS 0.04 // Radius of wheels (m)
 
 /****************************************************************************/
-// These are the definitions for Service 8
-#if NUM_SERVICES > 8
-// the header file with the public function prototypes
-#define SERV_8_HEADER "EEPROMSM.h"
-// the name of the Init function
-#define SERV_8_INIT InitEEPROMSM
-// the name of the run function
-#define SERV_8_RUN RunEEPROMSM
-// How big should this services Queue be?
-#define SERV_8_QUEUE_SIZE 3
-#endif
+// The maximum number of services sets an upper bound on the number of
+// services that the framework will handle. Legal values are 32 and 64.
+// The Ready mask is one 32 bit word per 32 services, since the MIPS32 core
+// can only update 32 bits atomically
+#define MAX_NUM_SERVICES 32
 
 /****************************************************************************/
-// These are the definitions for Service 9
-#if NUM_SERVICES > 9
-// the header file with the public function prototypes
-#define SERV_9_HEADER "ReflectService.h"
-// the name of the Init function
-#define SERV_9_INIT InitReflectService
-// the name of the run function
-#define SERV_9_RUN RunReflectService
-// How big should this services Queue be?
-#define SERV_9_QUEUE_SIZE 3
-#endif
+// Set to true to have ES_Run keep per-service dispatch counts, run function
+// times, queue high water marks and failed posts, along with the fraction
+// of time spent in the idle loop. It costs two core timer reads and a few
+// compares per event, see ES_GetServiceStats
+#define ES_PROFILING true
 
 /****************************************************************************/
-// These are the definitions for Service 10
-#if NUM_SERVICES > 10
-// the header file with the public function prototypes
-#define SERV_10_HEADER "TestHarnessService10.h"
-// the name of the Init function
-#define SERV_10_INIT InitTestHarnessService10
-// the name of the run function
-#define SERV_10_RUN RunTestHarnessService10
-// How big should this services Queue be?
-#define SERV_10_QUEUE_SIZE 3
+// Set to true to record every post, dispatch and timer expiry in a RAM ring
+// (ES_Trace.c) that the 'r' key sends out over the terminal. Records are
+// 12 bytes each, ES_TRACE_DEPTH must be a power of 2
+#ifndef ES_TRACE
+#define ES_TRACE true
 #endif
+#define ES_TRACE_DEPTH 512
 
 /****************************************************************************/
-// These are the definitions for Service 11
-#if NUM_SERVICES > 11
-// the header file with the public function prototypes
-#define SERV_11_HEADER "TestHarnessService11.h"
-// the name of the Init function
-#define SERV_11_INIT InitTestHarnessService11
-// the name of the run function
-#define SERV_11_RUN RunTestHarnessService11
-// How big should this services Queue be?
-#define SERV_11_QUEUE_SIZE 3
+// Set to true for ES_LOG (ES_Log.c) to put its format string and arguments
+// in a RAM ring that drains to the terminal in binary, for
+// HostTools/es_log.py to format. False makes ES_LOG a plain DB_printf.
+// Records are 24 bytes each, ES_LOG_DEPTH must be a power of 2
+#ifndef ES_LOGGING
+#define ES_LOGGING true
 #endif
+#define ES_LOG_DEPTH 64
 
 /****************************************************************************/
-// These are the definitions for Service 12
-#if NUM_SERVICES > 12
-// the header file with the public function prototypes
-#define SERV_12_HEADER "TestHarnessService12.h"
-// the name of the Init function
-#define SERV_12_INIT InitTestHarnessService12
-// the name of the run function
-#define SERV_12_RUN RunTestHarnessService12
-// How big should this services Queue be?
-#define SERV_12_QUEUE_SIZE 3
+// Set to true to run the services whose Level (below) is above 0 from the
+// core software interrupts rather than from the ES_Run loop. A post to such
+// a service then preempts whatever lower level service is running, instead
+// of waiting for it to return. Data shared across levels must be touched
+// inside ES_EnterCeiling/ES_ExitCeiling, see ES_Framework.c. With false the
+// Level column is ignored and every service runs from ES_Run as before.
+// Left overridable so the host build can run both for comparison
+#ifndef ES_PREEMPTIVE
+#define ES_PREEMPTIVE false
 #endif
 
-/****************************************************************************/
-// These are the definitions for Service 13
-#if NUM_SERVICES > 13
-// the header file with the public function prototypes
-#define SERV_13_HEADER "TestHarnessService13.h"
-// the name of the Init function
-#define SERV_13_INIT InitTestHarnessService13
-// the name of the run function
-#define SERV_13_RUN RunTestHarnessService13
-// How big should this services Queue be?
-#define SERV_13_QUEUE_SIZE 3
-#endif
+// JetsonSM's level, named so the data it shares can use it as a ceiling
+#define JETSON_LEVEL 1
 
 /****************************************************************************/
-// These are the definitions for Service 14
-#if NUM_SERVICES > 14
-// the header file with the public function prototypes
-#define SERV_14_HEADER "TestHarnessService14.h"
-// the name of the Init function
-#define SERV_14_INIT InitTestHarnessService14
-// the name of the run function
-#define SERV_14_RUN RunTestHarnessService14
-// How big should this services Queue be?
-#define SERV_14_QUEUE_SIZE 3
-#endif
-
-/****************************************************************************/
-// These are the definitions for Service 15
-#if NUM_SERVICES > 15
-// the header file with the public function prototypes
-#define SERV_15_HEADER "TestHarnessService15.h"
-// the name of the Init function
-#define SERV_15_INIT InitTestHarnessService15
-// the name of the run function
-#define SERV_15_RUN RunTestHarnessService15
-// How big should this services Queue be?
-#define SERV_15_QUEUE_SIZE 3
-#endif
+// The services, one entry per line. The first line is Service 0, the lowest
+// priority service, and every Events and Services application must have
+// one. Further services are added on the following lines with increasing
+// priorities. The header with each service's public function prototypes
+// goes in ES_ServiceHeaders.h. The columns of each entry are:
+//   Name, used for the queue and in diagnostics
+//   the name of the Init function
+//   the name of the Run function
+//   How big should this services Queue be?
+//   Use the lock-free (ISR safe, power of 2 size) queue for this service?
+//   Level, 0 to ES_MAX_LEVEL: with ES_PREEMPTIVE a higher level always
+//   preempts a lower one, priority only orders services of the same level
+#define SERVICE_LIST(SERVICE) \
+  SERVICE(Usb,     InitUsbService,         RunUsbService,         5, false, 0) \
+  SERVICE(LED,     InitLEDService,         RunLEDService,         4, true,  0) \
+  SERVICE(Imu,     InitImuSM,              RunImuSM,              3, false, 0) \
+  SERVICE(Jetson,  InitJetsonSM,           RunJetsonSM,           4, true,  JETSON_LEVEL) \
+  SERVICE(Button1, InitButton1DebouncerSM, RunButton1DebouncerSM, 3, false, 0) \
+  SERVICE(Button2, InitButton2DebouncerSM, RunButton2DebouncerSM, 3, false, 0) \
+  SERVICE(Button3, InitButton3DebouncerSM, RunButton3DebouncerSM, 3, false, 0) \
+  SERVICE(Motor,   InitMotorSM,            RunMotorSM,            3, false, 0) \
+  SERVICE(EEPROM,  InitEEPROMSM,           RunEEPROMSM,           4, true,  0) \
+  SERVICE(Reflect, InitReflectService,     RunReflectService,     3, false, 0)
+
+// The number of services that are *actually* used, counted from the list.
+// It is an expression, so it can not be used in #if
+#define ES_COUNT_SERVICE(Name, Init, Run, QueueSize, LockFree, Level) + 1
+#define NUM_SERVICES (0 SERVICE_LIST(ES_COUNT_SERVICE))
 
 /****************************************************************************/
 // Name/define the events of interest
@@ -308,6 +181,26 @@ typedef enum
   EV_PRINT_RL_DATA
 }ES_EventType_t;
 
+/****************************************************************************/
+// The payload pool (ES_Pool.c) holds fixed size blocks for events that need
+// more than the 16 bit EventParam. Events with a type in this list carry a
+// block handle in EventParam, every queue they sit in holds a reference and
+// ES_Run drops it once the run function returns. At most 32 blocks.
+#define ES_POOL_NUM_BLOCKS 8
+#define ES_POOL_BLOCK_SIZE 32
+#define PAYLOAD_EVENT_LIST(EVENT) \
+  EVENT(EV_JETSON_MESSAGE_RECEIVED) \
+  EVENT(EV_JETSON_VELOCITY_RECEIVED)
+
+/****************************************************************************/
+// Events with a type in this list are coalesced, for sources where only the
+// newest value matters. While one is waiting for a service, another post of
+// the same type to that service replaces its EventParam (and payload block)
+// rather than taking a second queue entry. It is dispatched in the place of
+// the first post, with the value of the last one.
+#define COALESCED_EVENT_LIST(EVENT) \
+  EVENT(EV_JETSON_VELOCITY_RECEIVED)
+
 /****************************************************************************/
 // These are the definitions for the Distribution lists. Each definition
 // should be a comma separated list of post functions to indicate which
@@ -342,10 +235,25 @@ typedef enum
 // This is the list of event checking functions
 #define EVENT_CHECK_LIST Check4Keystroke, CheckButton1, CheckButton2, CheckButton3
 
+/****************************************************************************/
+// The number of framework timers. Legal values are 16, 32, 48 and 64, the
+// tick cost is the same for all of them so only RAM is spent on unused ones
+#define NUM_TIMERS 32
+
+/****************************************************************************/
+// With tickless timers the core timer compare is only programmed for the
+// next timer expiry, and the elapsed ticks are applied in one step, rather
+// than taking an interrupt every tick. ES_Timer_GetTime reads the same either
+// way. Left overridable so the host build can run both for comparison
+#ifndef TICKLESS_TIMERS
+#define TICKLESS_TIMERS true
+#endif
+
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
-// corresponding timer expires. All 16 must be defined. If you are not using
-// a timer, then you should use TIMER_UNUSED
+// corresponding timer expires. All NUM_TIMERS must be defined (for 48 or 64
+// timers, add TIMER32_RESP_FUNC and up). If you are not using a timer,
+// then you should use TIMER_UNUSED
 // Unlike services, any combination of timers may be used and there is no
 // priority in servicing them
 #define TIMER_UNUSED ((pPostFunc)0)
@@ -365,6 +273,22 @@ typedef enum
 #define TIMER13_RESP_FUNC PostButton1DebouncerSM
 #define TIMER14_RESP_FUNC PostMotorSM
 #define TIMER15_RESP_FUNC PostJetsonSM
+#define TIMER16_RESP_FUNC TIMER_UNUSED
+#define TIMER17_RESP_FUNC TIMER_UNUSED
+#define TIMER18_RESP_FUNC TIMER_UNUSED
+#define TIMER19_RESP_FUNC TIMER_UNUSED
+#define TIMER20_RESP_FUNC TIMER_UNUSED
+#define TIMER21_RESP_FUNC TIMER_UNUSED
+#define TIMER22_RESP_FUNC TIMER_UNUSED
+#define TIMER23_RESP_FUNC TIMER_UNUSED
+#define TIMER24_RESP_FUNC TIMER_UNUSED
+#define TIMER25_RESP_FUNC TIMER_UNUSED
+#define TIMER26_RESP_FUNC TIMER_UNUSED
+#define TIMER27_RESP_FUNC TIMER_UNUSED
+#define TIMER28_RESP_FUNC TIMER_UNUSED
+#define TIMER29_RESP_FUNC TIMER_UNUSED
+#define TIMER30_RESP_FUNC TIMER_UNUSED
+#define TIMER31_RESP_FUNC TIMER_UNUSED
 
 /****************************************************************************/
 // Give the timer numbers symbol names to make it easier to move them
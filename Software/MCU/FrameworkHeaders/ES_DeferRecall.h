@@ -26,17 +26,17 @@
 
 /****************************************************************************
  Function
-   ES_DeferEvent  (wrapper for ES_EnQueueLIFO)
-   this is a straight re-naming to aid readability
+   ES_DeferEvent
  Parameters
    ES_Event * pBlock : pointer to the block of memory in use as the Queue
    ES_Event Event2Add : event to be added to the Queue
  Returns
    bool : true if the add was successful, false if not
  Description
-   if it will fit, adds Event2Add to the Queue
+   if it will fit, adds Event2Add to the Queue, LIFO. A payload event keeps
+   its block while it is deferred.
  ***************************************************************************/
-#define ES_DeferEvent(a, b) ES_EnQueueLIFO(a, b)
+bool ES_DeferEvent(ES_Event_t *pBlock, ES_Event_t Event2Add);
 
 /****************************************************************************
  Function
@@ -40,10 +40,48 @@ typedef enum
   FailedOther
 }ES_Return_t;
 
+// what ES_PROFILING has collected on one service since the last reset. Times
+// are in core timer counts (10ns)
+typedef struct
+{
+  uint32_t Dispatches;      // events handed to the run function
+  uint32_t MinCounts;       // shortest run function call
+  uint32_t AvgCounts;
+  uint32_t MaxCounts;       // longest run function call
+  uint32_t AvgLatency;      // post to run function call, for events posted
+  uint32_t MaxLatency;      // to an empty queue
+  uint32_t FailedPosts;     // posts refused because the queue was full
+  uint32_t Coalesced;       // posts that replaced an event still waiting
+  uint8_t  QueueHighWater;  // most events ever waiting in the queue
+  uint8_t  QueueSize;       // from SERVICE_LIST, for comparison
+}ES_ServiceStats_t;
+
+// ES_GetIdlePermille when there is nothing to go on: ES_PROFILING is off, or
+// no time has passed since the last reset
+#define ES_IDLE_UNKNOWN 0xFFFFu
+
+// priority ceilings for data shared by services of different levels. Enter
+// with the highest level of any service that touches the data, nothing at or
+// below it can run until the matching exit. Enter/exit pairs nest, and they
+// compile away without ES_PREEMPTIVE
+typedef uint32_t ES_Ceiling_t;
+#if ES_PREEMPTIVE
+#define ES_EnterCeiling(Level) _HW_RaiseLevel(Level)
+#define ES_ExitCeiling(Saved) _HW_RestoreLevel(Saved)
+#else
+#define ES_EnterCeiling(Level) 0u
+#define ES_ExitCeiling(Saved) ((void)(Saved))
+#endif
+
 ES_Return_t ES_Initialize(TimerRate_t NewRate);
 ES_Return_t ES_Run(void);
+void ES_RunLevel(uint8_t Level);
 bool ES_PostAll(ES_Event_t ThisEvent);
 bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent);
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent);
+const char *ES_GetServiceName(uint8_t WhichService);
+bool ES_GetServiceStats(uint8_t WhichService, ES_ServiceStats_t *pStats);
+uint16_t ES_GetIdlePermille(void);
+void ES_ResetServiceStats(void);
 
 #endif   // ES_Framework_H
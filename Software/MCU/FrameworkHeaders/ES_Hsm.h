@@ -0,0 +1,80 @@
+/****************************************************************************
+ Module
+     ES_Hsm.h
+ Description
+     header file for the table driven hierarchical state machine engine of
+     the Events & Services Framework
+ Notes
+     A machine is const data: one ES_HsmState_t per state, indexed by the
+     state's enum value, each pointing at the table of transitions that
+     leave it. See ES_Hsm.c for how a dispatch walks them.
+
+*****************************************************************************/
+#ifndef ES_Hsm_H
+#define ES_Hsm_H
+
+#include <stddef.h>   // the tables use NULL for "none"
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+// Parent of a top level state, InitialChild of a leaf state
+#define ES_HSM_NO_STATE 0xFF
+// Target of a transition that runs its action without leaving the state
+#define ES_HSM_INTERNAL 0xFE
+// deepest nesting the engine handles, top level states are depth 1
+#define ES_HSM_MAX_DEPTH 8
+
+// true lets the transition be taken
+typedef bool (*ES_HsmGuard_t)(ES_Event_t ThisEvent);
+// transition actions and state entry/exit functions
+typedef void (*ES_HsmAction_t)(ES_Event_t ThisEvent);
+// called after every transition taken, with the leaf states before and after
+typedef void (*ES_HsmTraceHook_t)(uint8_t From, uint8_t To,
+    ES_Event_t ThisEvent);
+
+typedef struct
+{
+  uint8_t        EventType;   // ES_EventType_t that triggers it
+  uint8_t        Target;      // state index or ES_HSM_INTERNAL
+  ES_HsmGuard_t  Guard;       // NULL for always
+  ES_HsmAction_t Action;      // NULL for none
+}ES_HsmTransition_t;
+
+typedef struct
+{
+  const ES_HsmTransition_t *pTransitions; // tried in order, first match wins
+  ES_HsmAction_t Entry;         // NULL for none
+  ES_HsmAction_t Exit;          // NULL for none
+  uint8_t        Parent;        // ES_HSM_NO_STATE at the top level
+  uint8_t        InitialChild;  // entered next, ES_HSM_NO_STATE for a leaf
+  uint8_t        NumTransitions;
+}ES_HsmState_t;
+
+typedef struct
+{
+  const ES_HsmState_t *pStates;  // indexed by state
+  uint8_t              NumStates;
+  ES_HsmTraceHook_t    Trace;    // NULL for none
+}ES_HsmMachine_t;
+
+// the only RAM a machine needs
+typedef struct
+{
+  const ES_HsmMachine_t *pMachine;
+  uint8_t                CurrentState;  // always a leaf once started
+}ES_Hsm_t;
+
+// one entry of a machine's state table, Transitions must be an array
+#define ES_HSM_STATE(Parent, InitialChild, Entry, Exit, Transitions) \
+  { (Transitions), (Entry), (Exit), (Parent), (InitialChild), \
+    (uint8_t)(sizeof(Transitions) / sizeof((Transitions)[0])) }
+
+/* prototypes for public functions */
+
+void ES_HsmInit(ES_Hsm_t *pMe, const ES_HsmMachine_t *pMachine,
+    uint8_t InitialState);
+bool ES_HsmDispatch(ES_Hsm_t *pMe, ES_Event_t ThisEvent);
+uint8_t ES_HsmGetState(const ES_Hsm_t *pMe);
+bool ES_HsmIsIn(const ES_Hsm_t *pMe, uint8_t State);
+
+#endif /* ES_Hsm_H */
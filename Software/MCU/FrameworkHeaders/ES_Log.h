@@ -0,0 +1,60 @@
+/****************************************************************************
+ Module
+     ES_Log.h
+ Description
+     header file for the deferred binary log of the Events & Services
+     Framework
+ Notes
+     ES_LOG takes the same arguments as DB_printf, a literal format string
+     and up to 3 %d %x %u %c values, but only copies them into a RAM ring.
+     The formatting is done later, on the host, by HostTools/es_log.py.
+     %s can not be logged, the string may be gone by the time it is read.
+
+*****************************************************************************/
+#ifndef ES_Log_H
+#define ES_Log_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+
+// one entry of the ring
+typedef struct
+{
+  uint32_t          Time;     // core timer count (10ns)
+  int32_t           Format;   // format string address - ES_LogAnchor
+  uint32_t          Args[3];
+  uint8_t           NumArgs;
+  volatile uint16_t Seq;      // record number + 1 skipping 0, 0 while being
+                              // written
+}ES_LogRecord_t;
+
+#if ES_LOGGING
+// picks ES_Log0..ES_Log3 by the number of arguments after the format, more
+// than 3 fails to compile
+#define ES_LOG_PICK(_0, _1, _2, _3, Name, ...) Name
+#define ES_LOG(...) \
+  ES_LOG_PICK(__VA_ARGS__, ES_Log3, ES_Log2, ES_Log1, ES_Log0, )(__VA_ARGS__)
+// the "" only lets a string literal through, the host has to find it in the
+// image
+#define ES_Log0(Format) ES_LogWrite("" Format, 0, 0, 0, 0)
+#define ES_Log1(Format, A) ES_LogWrite("" Format, 1, (uint32_t)(A), 0, 0)
+#define ES_Log2(Format, A, B) \
+  ES_LogWrite("" Format, 2, (uint32_t)(A), (uint32_t)(B), 0)
+#define ES_Log3(Format, A, B, C) \
+  ES_LogWrite("" Format, 3, (uint32_t)(A), (uint32_t)(B), (uint32_t)(C))
+#else
+#include "dbprintf.h"
+// formatted on the spot, as before
+#define ES_LOG(...) DB_printf(__VA_ARGS__)
+#endif
+
+// the format strings are found relative to this in the image
+extern const char ES_LogAnchor[];
+
+/* prototypes for public functions */
+
+void ES_LogWrite(const char *pFormat, uint8_t NumArgs, uint32_t Arg0,
+    uint32_t Arg1, uint32_t Arg2);
+bool ES_LogMoveToTerminal(void);
+
+#endif /* ES_Log_H */
@@ -61,3 +61,16 @@ extern uint8_t const Nybble2MSBitNum[15];
    J. Edward Carryer, 10/20/13, 17:03
 ****************************************************************************/
 uint8_t ES_GetMSBitSet(uint16_t Val2Check);
+
+/****************************************************************************
+ Function
+   ES_GetMSBitSet32
+ Parameters
+   uint32_t  Val2Check The number to find the MSB in
+ Returns
+   bit number of the MSB that is set in Val2Check, 128 if Val2Check = 0
+ Description
+   32 bit version of ES_GetMSBitSet, the fallback for ES_GetMSBit32 on
+   compilers without a count leading zeros builtin
+****************************************************************************/
+uint8_t ES_GetMSBitSet32(uint32_t Val2Check);
@@ -0,0 +1,39 @@
+/****************************************************************************
+ Module
+     ES_Pool.h
+ Description
+     header file for the event payload pool of the Events & Services
+     Framework
+ Notes
+
+*****************************************************************************/
+#ifndef ES_Pool_H
+#define ES_Pool_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+// what ES_PoolAlloc returns when every block is in use
+#define ES_POOL_NO_BLOCK 0xFFFF
+
+typedef struct
+{
+  uint8_t  NumBlocks;       // ES_POOL_NUM_BLOCKS
+  uint8_t  BlockSize;       // ES_POOL_BLOCK_SIZE, in bytes
+  uint8_t  InUse;           // blocks allocated right now
+  uint8_t  HighWater;       // most blocks ever allocated at once
+  uint32_t AllocFailures;   // ES_PoolAlloc calls that found the pool empty
+}ES_PoolStats_t;
+
+/* prototypes for public functions */
+
+void ES_PoolInit(void);
+uint16_t ES_PoolAlloc(void);
+void *ES_PoolGetPtr(uint16_t Handle);
+void ES_PoolAddRef(uint16_t Handle);
+void ES_PoolRelease(uint16_t Handle);
+bool ES_EventHasPayload(ES_EventType_t EventType);
+void ES_PoolGetStats(ES_PoolStats_t *pStats);
+void ES_PoolResetStats(void);
+
+#endif /* ES_Pool_H */
@@ -24,6 +24,9 @@
 
 // pull in the hardware header files that we need
 #include <xc.h>
+#ifdef ES_PORT_HOST
+#include <time.h>
+#endif
 
 #include <stdio.h>
 #include <stdint.h>
@@ -83,6 +86,72 @@ extern  uint8_t _INTCON_temp;
 #define ExitCritical()
 #endif
 
+// lock-free primitives for the queues and the Ready mask. XC32, like gcc on
+// the host, expands the __sync builtins into ll/sc retry loops on the MIPS32
+// core, so they are atomic with respect to ISRs without turning ints off.
+// Both set & clear act as full barriers.
+#define ES_AtomicSetBits(pVar, Mask) ((void)__sync_fetch_and_or((pVar), (Mask)))
+#define ES_AtomicClrBits(pVar, Mask) \
+  ((void)__sync_fetch_and_and((pVar), ~(Mask)))
+// evaluates to the value before the bits were set
+#define ES_AtomicFetchSetBits(pVar, Mask) __sync_fetch_and_or((pVar), (Mask))
+#define ES_CompareAndSwap(pVar, OldVal, NewVal) \
+  __sync_bool_compare_and_swap((pVar), (OldVal), (NewVal))
+#define ES_AtomicInc(pVar) ((void)__sync_fetch_and_add((pVar), 1))
+// evaluates to the value after the decrement
+#define ES_AtomicDec(pVar) __sync_sub_and_fetch((pVar), 1)
+// evaluates to the value before the increment
+#define ES_AtomicFetchInc(pVar) __sync_fetch_and_add((pVar), 1)
+// keeps the compiler and the core from moving memory accesses across it
+#define ES_MemoryBarrier() __sync_synchronize()
+
+// marks a window between two steps of a lock-free operation that an
+// interrupt has to be able to split. Nothing on the PIC, on the host it lets
+// a test take an interrupt there (_HW_Host_SetPointHook)
+#ifdef ES_PORT_HOST
+#define ES_InterruptPoint() \
+  do { if (HostSFR_InterruptPoint != NULL) { HostSFR_InterruptPoint(); } } \
+  while (0)
+#else
+#define ES_InterruptPoint()
+#endif
+
+// the preemption levels of ES_PREEMPTIVE. Level n services run from a core
+// software interrupt at IPLn, the two the core has give levels 1 and 2, and
+// level 0 is the ES_Run loop. Every hardware ISR is above IPL2
+#define ES_MAX_LEVEL 2
+
+// true while running an ISR. The interrupt priority in Status is raised by
+// the interrupt entry code, and to at most ES_MAX_LEVEL by the software
+// interrupt levels and ceilings, which are not ISRs
+#define ES_InISR() ((_CP0_GET_STATUS() & _CP0_STATUS_IPL_MASK) > \
+  (ES_MAX_LEVEL << _CP0_STATUS_IPL_POSITION))
+
+// bit number of the most significant 1 in a non-zero 32 bit value, this is
+// how ES_Run picks the highest priority Ready service. XC32 (and gcc on the
+// host) turn __builtin_clz into a single clz instruction, other compilers get
+// the table driven version from ES_LookupTables.c
+#ifdef __GNUC__
+#define ES_GetMSBit32(Val) ((uint8_t)(31 - __builtin_clz(Val)))
+#else
+#define ES_GetMSBit32(Val) ES_GetMSBitSet32(Val)
+#endif
+
+// free running count used to time the service run functions (ES_PROFILING),
+// the core timer ticks at SYSCLK/2 = 100MHz
+#define ES_GetProfileCount() _CP0_GET_COUNT()
+
+// free running count for the benches in the module test harnesses, and
+// the units to print it in. On the host the core timer is the port's
+// virtual clock, so the benches take the host's own time
+#ifdef ES_PORT_HOST
+#define ES_GetBenchCount() ((uint32_t)_HW_Host_GetNanos())
+#define ES_BENCH_COUNT_UNITS "ns"
+#else
+#define ES_GetBenchCount() _CP0_GET_COUNT()
+#define ES_BENCH_COUNT_UNITS "core timer counts"
+#endif
+
 /* Rate constants for programming the SysTick Period to generate tick interrupts.
    These assume that we are using the M4K core timer running at 20MHz. Even
    thought the processor clock is 40MHz the core timer increments every other 
@@ -120,8 +189,34 @@ bool _HW_Process_Pending_Ints(void);
 uint16_t _HW_GetTickCount(void);
 void _HW_ConsoleInit(void);
 void _HW_SysTickIntHandler(void);
+void _HW_LevelsInit(void);
+void _HW_PendLevel(uint8_t Level);
+uint32_t _HW_RaiseLevel(uint8_t Level);
+void _HW_RestoreLevel(uint32_t Saved);
 
 // and the one Framework function that we define here
 uint16_t ES_Timer_GetTime(void);
 
+#ifdef ES_PORT_HOST
+// extra controls provided by the host port (ES_Port_Host.c)
+typedef void (*pHostIdleHook_t)(void);
+typedef void (*pHostIsrHook_t)(void);
+
+void _HW_Host_SetTimeScale(uint32_t Scale);
+void _HW_Host_AdvanceTime(uint32_t Counts);
+void _HW_Host_SetIdleHook(pHostIdleHook_t pHook);
+void _HW_Host_SetIsrHook(pHostIsrHook_t pHook);
+void _HW_Host_SetPointHook(pHostIsrHook_t pHook);
+
+// host monotonic time in ns, independent of the time scale. Inline so the
+// module harnesses that are built without the host port can use it too
+static inline uint64_t _HW_Host_GetNanos(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return ((uint64_t)Now.tv_sec * 1000000000u) + (uint64_t)Now.tv_nsec;
+}
+#endif
+
 #endif
@@ -23,6 +23,7 @@
 /* prototypes for public functions */
 
 uint8_t ES_InitQueue(ES_Event_t *pBlock, uint8_t BlockSize);
+uint8_t ES_InitLockFreeQueue(ES_Event_t *pBlock, uint8_t BlockSize);
 bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
 bool ES_EnQueueLIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
 uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent);
@@ -0,0 +1,59 @@
+/****************************************************************************
+ Module
+     ES_Ring.h
+ Description
+     header file for the single producer, single consumer ring buffers of
+     the Events & Services Framework
+ Notes
+     The caller owns the storage, Capacity elements of ElemSize bytes with
+     Capacity a power of 2, and the ES_Ring_t. ES_RING_DEFINE makes both.
+
+*****************************************************************************/
+#ifndef ES_Ring_H
+#define ES_Ring_H
+
+#include "ES_Types.h"
+
+typedef struct
+{
+  uint8_t           *pStorage;
+  uint32_t          Mask;       // Capacity - 1
+  uint16_t          ElemSize;   // bytes
+  volatile uint32_t Head;       // elements ever put, producer only
+  volatile uint32_t Tail;       // elements ever taken, consumer only
+}ES_Ring_t;
+
+// a ring of Capacity elements of Type with static storage. The ES_Ring_t
+// still has to go through ES_RingInit
+#define ES_RING_DEFINE(Name, Type, Capacity) \
+  static Type Name##Storage[Capacity]; \
+  static ES_Ring_t Name
+
+#define ES_RingInitStatic(Name) \
+  ES_RingInit(&(Name), Name##Storage, sizeof(Name##Storage[0]), \
+      sizeof(Name##Storage) / sizeof(Name##Storage[0]))
+
+/* prototypes for public functions */
+
+bool ES_RingInit(ES_Ring_t *pRing, void *pStorage, uint16_t ElemSize,
+    uint32_t Capacity);
+void ES_RingReset(ES_Ring_t *pRing);
+uint32_t ES_RingCount(const ES_Ring_t *pRing);
+uint32_t ES_RingSpace(const ES_Ring_t *pRing);
+uint32_t ES_RingCapacity(const ES_Ring_t *pRing);
+
+// producer side
+bool ES_RingPut(ES_Ring_t *pRing, const void *pElem);
+uint32_t ES_RingPutN(ES_Ring_t *pRing, const void *pElems, uint32_t N);
+void *ES_RingWriteSpan(ES_Ring_t *pRing, uint32_t *pLength);
+void ES_RingCommit(ES_Ring_t *pRing, uint32_t N);
+
+// consumer side
+bool ES_RingGet(ES_Ring_t *pRing, void *pElem);
+uint32_t ES_RingGetN(ES_Ring_t *pRing, void *pElems, uint32_t N);
+uint32_t ES_RingPeekN(const ES_Ring_t *pRing, void *pElems, uint32_t N);
+void *ES_RingPeekSpan(const ES_Ring_t *pRing, uint32_t Offset,
+    uint32_t *pLength);
+void ES_RingSkip(ES_Ring_t *pRing, uint32_t N);
+
+#endif /* ES_Ring_H */
@@ -0,0 +1,36 @@
+/****************************************************************************
+ Module
+     ES_Snapshot.h
+ Description
+     header file for the snapshots of the Events & Services Framework, a
+     value one context publishes and any other reads whole, without a
+     critical region
+ Notes
+     The caller owns the two buffers and the ES_Snapshot_t,
+     ES_SNAPSHOT_DEFINE makes both.
+
+*****************************************************************************/
+#ifndef ES_Snapshot_H
+#define ES_Snapshot_H
+
+#include "ES_Types.h"
+
+typedef struct
+{
+  uint8_t           *pBuffers;  // two values, side by side
+  uint16_t          Size;       // bytes in one value
+  volatile uint32_t Seq;        // values ever published, writer only
+}ES_Snapshot_t;
+
+// a snapshot of a Type with static buffers, both zero, as if a zero value
+// had been published
+#define ES_SNAPSHOT_DEFINE(Name, Type) \
+  static Type Name##Buffers[2]; \
+  static ES_Snapshot_t Name = { (uint8_t *)Name##Buffers, sizeof(Type), 0 }
+
+/* prototypes for public functions */
+
+void ES_SnapshotPublish(ES_Snapshot_t *pSnapshot, const void *pValue);
+uint32_t ES_SnapshotRead(const ES_Snapshot_t *pSnapshot, void *pValue);
+
+#endif /* ES_Snapshot_H */
@@ -44,6 +44,8 @@ typedef enum
 
 void ES_Timer_Init(TimerRate_t Rate);
 void ES_Timer_Tick_Resp(void);
+void ES_Timer_Advance(uint16_t Ticks);
+uint16_t ES_Timer_GetTicksToNext(void);
 ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime);
 ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime);
 ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num);
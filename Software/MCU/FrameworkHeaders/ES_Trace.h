@@ -0,0 +1,59 @@
+/****************************************************************************
+ Module
+     ES_Trace.h
+ Description
+     header file for the event trace recorder of the Events & Services
+     Framework
+ Notes
+
+*****************************************************************************/
+#ifndef ES_Trace_H
+#define ES_Trace_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+typedef enum
+{
+  ES_TRACE_POST = 0,        // event went into a service queue
+  ES_TRACE_POST_FAILED,     // queue was full
+  ES_TRACE_DEQUEUE,         // ES_Run took it out, Depth is what is left
+  ES_TRACE_RUN_START,       // run function called
+  ES_TRACE_RUN_END,         // run function returned
+  ES_TRACE_TIMER_EXPIRED,   // Which is the timer number
+  ES_TRACE_POST_COALESCED   // replaced the waiting one of its type
+}ES_TraceKind_t;
+
+// or'd into Kind when the record was made from an ISR
+#define ES_TRACE_FROM_ISR 0x80
+
+// one entry of the ring, this is also what the dump sends (little endian)
+typedef struct
+{
+  uint32_t Time;    // core timer count (10ns)
+  uint16_t Param;   // EventParam
+  uint8_t  Type;    // EventType
+  uint8_t  Kind;    // ES_TraceKind_t | ES_TRACE_FROM_ISR
+  uint8_t  Which;   // service (or timer) number
+  uint8_t  Depth;   // queue entries left, ES_TRACE_DEQUEUE only
+  uint16_t Seq;     // low bits of the record number, shows gaps
+}ES_TraceRecord_t;
+
+// the hooks in the framework go through this so they vanish with ES_TRACE
+#if ES_TRACE
+#define ES_TRACE_EVENT(Kind, Which, Event, Depth) \
+  ES_TraceRecord((Kind), (Which), (Event), (Depth))
+#else
+#define ES_TRACE_EVENT(Kind, Which, Event, Depth)
+#endif
+
+/* prototypes for public functions */
+
+void ES_TraceRecord(ES_TraceKind_t Kind, uint8_t Which, ES_Event_t ThisEvent,
+    uint8_t Depth);
+void ES_TraceClear(void);
+void ES_TraceStartDump(void);
+bool ES_TraceMoveToTerminal(void);
+
+#endif /* ES_Trace_H */
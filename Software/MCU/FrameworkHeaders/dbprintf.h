@@ -1,5 +1,7 @@
 #include "ES_Port.h"
+#include "terminal.h"
 void DB_printf(const char *Format, ...);
+void DB_printfPolicy(Terminal_TxPolicy_t Policy, const char *Format, ...);
 
 // Note: these definitions are for a little Endian processor
 //#define LOWORD(l) (*((unsigned int *)(&l)))
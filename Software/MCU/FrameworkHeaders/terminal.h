@@ -19,7 +19,24 @@ extern "C" {
 #define goHome() printf("\x1b[1,1H")
 #define clrLine() printf("\x1b[K")
     
+// must be a power of 2
 #define XMIT_BUFFER_SIZE 1024
+
+// the USB bridge has to be set to match, U1BRG is worked out from PBCLK2
+#ifndef TERMINAL_BAUD
+#define TERMINAL_BAUD 115200
+#endif
+
+// what a write does when the transmit buffer can not take all of it
+typedef enum
+{
+  TERMINAL_TX_BLOCK,    // wait for the DMA to make room, a drop in an ISR
+  TERMINAL_TX_PARTIAL,  // take what fits, the rest is dropped
+  TERMINAL_TX_DROP      // all or nothing, so lines are never cut
+}Terminal_TxPolicy_t;
+
+// used by Terminal_WriteByte, printf and DB_printf
+#define TERMINAL_TX_DEFAULT TERMINAL_TX_DROP
     
 // map the generic functions for testing the serial port to actual functions
 // for this platform.
@@ -31,7 +48,12 @@ extern "C" {
 void Terminal_HWInit(void);
 uint8_t Terminal_ReadByte(void);
 void Terminal_WriteByte(uint8_t txByte);
+uint16_t Terminal_Write(const uint8_t *pData, uint16_t Length,
+    Terminal_TxPolicy_t Policy);
+uint32_t Terminal_GetTxDropped(void);
+void Terminal_SetBaud(uint32_t Baud);
 bool Terminal_IsRxData(void);
+uint16_t Terminal_GetTxSpace(void);
 void Terminal_MoveBuffer2UART( void );
 
 #ifdef __XC16__  // DEPRICATED, USE FOR xc16 of xc32 v1.34 or lower
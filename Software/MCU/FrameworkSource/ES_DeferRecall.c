@@ -23,6 +23,7 @@
 #include "ES_General.h"
 #include "ES_Events.h"
 #include "ES_DeferRecall.h"
+#include "ES_Pool.h"
 
 /*--------------------------- External Variables --------------------------*/
 
@@ -35,6 +36,33 @@
 /*---------------------------- Module Variables ---------------------------*/
 
 /*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_DeferEvent
+ Parameters
+      ES_Event * pBlock, pointer to the block of memory that implements the
+        Defer/Recall queue
+      ES_Event Event2Add, event to be deferred
+ Returns
+     bool true if the event fit in the queue
+ Description
+     adds the event to the deferral queue LIFO fashion. ES_Run drops the
+     reference the service queue held on a payload event when the run
+     function returns, so the deferral queue takes one of its own.
+****************************************************************************/
+bool ES_DeferEvent(ES_Event_t *pBlock, ES_Event_t Event2Add)
+{
+  if (ES_EnQueueLIFO(pBlock, Event2Add) != true)
+  {
+    return false;
+  }
+  if (ES_EventHasPayload(Event2Add.EventType))
+  {
+    ES_PoolAddRef(Event2Add.EventParam);
+  }
+  return true;
+}
+
 /****************************************************************************
  Function
      ES_RecallEvents
@@ -64,6 +92,11 @@ bool ES_RecallEvents(uint8_t WhichService, ES_Event_t *pBlock)
     if (RecalledEvent.EventType != ES_NO_EVENT)
     {
       ES_PostToServiceLIFO(WhichService, RecalledEvent);
+      if (ES_EventHasPayload(RecalledEvent.EventType))
+      {
+        // the service queue has its own reference now
+        ES_PoolRelease(RecalledEvent.EventParam);
+      }
       WereEventsPulled = true;
     }
   } while (RecalledEvent.EventType != ES_NO_EVENT);
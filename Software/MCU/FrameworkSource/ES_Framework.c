@@ -4,6 +4,30 @@
  Description
      source file for the core functions of the Events & Services framework
  Notes
+   The service tables are generated from SERVICE_LIST in ES_Configure.h.
+   Ready holds one bit per service in 32 bit words, ES_Run takes the
+   highest set bit with a count leading zeros.
+   Events with a payload (ES_Pool.c) hold one block reference per queue
+   they are posted to, ES_Run drops it after the run function returns.
+   With ES_TRACE the posts and dispatches are recorded by ES_Trace.c.
+   With ES_PREEMPTIVE the services with a Level above 0 are not run by
+   ES_Run, which only takes the level 0 ones, but by ES_RunLevel from the
+   core software interrupt of their level. A post to one pends that
+   interrupt, so the service runs as soon as the post is made (or the
+   ceiling around it is left), preempting a lower level service part way
+   through its run function. Every level still runs its services to
+   completion, one event at a time, so only data shared across levels
+   needs protecting, with ES_EnterCeiling/ES_ExitCeiling. Posts are made
+   at the level of the service posted to, so it never finds a queue slot
+   that a post it preempted has claimed but not yet filled.
+   With ES_PROFILING a post to an empty queue is time stamped, so the wait
+   from the post to the run function call is measured as well.
+   An event in COALESCED_EVENT_LIST goes into a mailbox, one per service
+   for each such type, holding its EventParam. Only the post that finds the
+   mailbox empty puts the event in the queue, as a place holder. Later ones
+   swap their EventParam into the mailbox, and ES_Run swaps the newest one
+   out when it takes the place holder off the queue. The swaps are atomic,
+   so ISRs can post them too.
 
  History
  When           Who     What/Why
@@ -30,6 +54,9 @@
 #include "../FrameworkHeaders/ES_Configure.h"
 #include "../FrameworkHeaders/ES_Framework.h"
 #include "../FrameworkHeaders/ES_Queue.h"
+#include "../FrameworkHeaders/ES_Pool.h"
+#include "../FrameworkHeaders/ES_Trace.h"
+#include "../FrameworkHeaders/ES_Log.h"
 #include "../FrameworkHeaders/ES_LookupTables.h"
 #include "../FrameworkHeaders/ES_Timers.h"
 #include "../FrameworkHeaders/ES_General.h"
@@ -57,185 +84,160 @@ typedef InitFunc_t  *pInitFunc;
 typedef RunFunc_t   *pRunFunc;
 
 #define NULL_INIT_FUNC ((pInitFunc)0)
+#define NO_SERVICE_READY 0xFF
 
 typedef struct
 {
   InitFunc_t *InitFunc;       // Service Initialization function
   RunFunc_t *RunFunc;         // Service Run function
+  const char *Name;           // for the diagnostics
+  uint8_t Level;              // with ES_PREEMPTIVE, where it is run from
 }ES_ServDesc_t;
 
+#if (MAX_NUM_SERVICES != 32) && (MAX_NUM_SERVICES != 64)
+#error "MAX_NUM_SERVICES must be 32 or 64"
+#endif
+
+// one word of Ready per 32 services
+#define READY_WORDS (MAX_NUM_SERVICES / 32)
+#define READY_WORD(Service) ((Service) >> 5)
+#define READY_MASK(Service) (1u << ((Service) & 31))
+
+// NUM_SERVICES comes from counting the list, so this is a compile time check
+typedef char ES_TooManyServices_t[(NUM_SERVICES <= MAX_NUM_SERVICES) ? 1 : -1];
+
+// mailbox numbers for the COALESCED_EVENT_LIST types, in list order
+#define ES_MAILBOX_NUMBER(Event) Event##_MAILBOX,
+enum
+{
+  COALESCED_EVENT_LIST(ES_MAILBOX_NUMBER)
+  NUM_MAILBOXES
+};
+#define NO_MAILBOX 0xFF
+// set in a mailbox with an event waiting, the low 16 bits are its EventParam
+#define MAILBOX_FULL 0x10000u
+
 typedef struct
 {
   ES_Event_t *pMem;       // pointer to the memory
   uint8_t Size;         // how big is it
+  bool LockFree;        // set up with ES_InitLockFreeQueue?
 }ES_QueueDesc_t;
 
+#if ES_PROFILING
+// what is kept per service, ES_GetServiceStats turns it into ES_ServiceStats_t.
+// TotalCounts is 64 bits since a 32 bit sum of 100MHz counts wraps in 42s
+typedef struct
+{
+  uint32_t Dispatches;
+  uint32_t MinCounts;
+  uint32_t MaxCounts;
+  uint64_t TotalCounts;
+  volatile uint32_t FailedPosts;  // ISRs post too
+  volatile uint32_t Coalesced;    // counted by ISR posts too
+  uint8_t  QueueHighWater;
+  uint32_t Latencies;             // dispatches timed from their post
+  uint32_t MaxLatency;
+  uint64_t TotalLatency;
+  // stamped by the post that finds the queue empty, the event it put at
+  // the head is the next one dispatched
+  volatile uint32_t PostedAt;
+  volatile bool     Waiting;
+}ES_ServProfile_t;
+#endif
+
 /*---------------------------- Module Functions ---------------------------*/
 //static bool CheckSystemEvents( void );
+#if ES_PROFILING
+static void RecordRun(uint8_t WhichService, uint32_t RunCounts,
+    uint8_t QueueDepth);
+static void RecordLatency(uint8_t WhichService, uint32_t Latency);
+static void RecordIdle(uint32_t IdleStart, uint32_t PreemptStart);
+static void RecordFailedPost(uint8_t WhichService);
+static void RecordCoalesced(uint8_t WhichService);
+#endif
+static bool RunService(uint8_t WhichService);
+static bool EnQueue(uint8_t WhichService, ES_Event_t TheEvent, bool LIFO);
+static void MarkReady(uint8_t WhichService);
+static uint8_t GetHighestReady(uint8_t Level);
+static uint8_t GetMailbox(ES_EventType_t EventType);
+static uint32_t SwapMailbox(volatile uint32_t *pMailbox, uint32_t NewValue);
+static bool PostCoalesced(uint8_t WhichService, uint8_t WhichMailbox,
+    ES_Event_t TheEvent, bool LIFO);
 
 /*---------------------------- Module Variables ---------------------------*/
 /****************************************************************************/
-// You fill in this array with the names of the service init & run functions
-// for each service that you use.
-// The order is: InitFunction, RunFunction
-// The first entry, at index 0, is the lowest priority, with increasing
-// priority with higher indices
+// The service list in ES_Configure.h fills in everything below, one entry
+// per service. The first entry, at index 0, is the lowest priority, with
+// increasing priority with higher indices
+
+#define ES_DECLARE_SERVICE(Name, Init, Run, QueueSize, LockFree, Level) \
+  InitFunc_t Init;                                                      \
+  RunFunc_t Run;                                                        \
+  typedef char Name##LevelInRange_t[((Level) <= ES_MAX_LEVEL) ? 1 : -1];
+SERVICE_LIST(ES_DECLARE_SERVICE)
 
+#define ES_SERVICE_DESC(Name, Init, Run, QueueSize, LockFree, Level) \
+  { Init, Run, #Name, Level },
 static ES_ServDesc_t const ServDescList[] =
-{ { SERV_0_INIT, SERV_0_RUN } /* lowest priority  always present */
-#if NUM_SERVICES > 1
-  , { SERV_1_INIT, SERV_1_RUN }
-#endif
-#if NUM_SERVICES > 2
-  , { SERV_2_INIT, SERV_2_RUN }
-#endif
-#if NUM_SERVICES > 3
-  , { SERV_3_INIT, SERV_3_RUN }
-#endif
-#if NUM_SERVICES > 4
-  , { SERV_4_INIT, SERV_4_RUN }
-#endif
-#if NUM_SERVICES > 5
-  , { SERV_5_INIT, SERV_5_RUN }
-#endif
-#if NUM_SERVICES > 6
-  , { SERV_6_INIT, SERV_6_RUN }
-#endif
-#if NUM_SERVICES > 7
-  , { SERV_7_INIT, SERV_7_RUN }
-#endif
-#if NUM_SERVICES > 8
-  , { SERV_8_INIT, SERV_8_RUN }
-#endif
-#if NUM_SERVICES > 9
-  , { SERV_9_INIT, SERV_9_RUN }
-#endif
-#if NUM_SERVICES > 10
-  , { SERV_10_INIT, SERV_10_RUN }
-#endif
-#if NUM_SERVICES > 11
-  , { SERV_11_INIT, SERV_11_RUN }
-#endif
-#if NUM_SERVICES > 12
-  , { SERV_12_INIT, SERV_12_RUN }
-#endif
-#if NUM_SERVICES > 13
-  , { SERV_13_INIT, SERV_13_RUN }
-#endif
-#if NUM_SERVICES > 14
-  , { SERV_14_INIT, SERV_14_RUN }
-#endif
-#if NUM_SERVICES > 15
-  , { SERV_15_INIT, SERV_15_RUN }
-#endif
+{
+  SERVICE_LIST(ES_SERVICE_DESC)
 };
 
 /****************************************************************************/
 // The queues for the services
 
-static ES_Event_t Queue0[SERV_0_QUEUE_SIZE + 1];
-#if NUM_SERVICES > 1
-static ES_Event_t Queue1[SERV_1_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 2
-static ES_Event_t Queue2[SERV_2_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 3
-static ES_Event_t Queue3[SERV_3_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 4
-static ES_Event_t Queue4[SERV_4_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 5
-static ES_Event_t Queue5[SERV_5_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 6
-static ES_Event_t Queue6[SERV_6_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 7
-static ES_Event_t Queue7[SERV_7_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 8
-static ES_Event_t Queue8[SERV_8_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 9
-static ES_Event_t Queue9[SERV_9_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 10
-static ES_Event_t Queue10[SERV_10_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 11
-static ES_Event_t Queue11[SERV_11_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 12
-static ES_Event_t Queue12[SERV_12_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 13
-static ES_Event_t Queue13[SERV_13_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 14
-static ES_Event_t Queue14[SERV_14_QUEUE_SIZE + 1];
-#endif
-#if NUM_SERVICES > 15
-static ES_Event_t Queue15[SERV_15_QUEUE_SIZE + 1];
-#endif
+#define ES_SERVICE_QUEUE(Name, Init, Run, QueueSize, LockFree, Level) \
+  static ES_Event_t Name##Queue[QueueSize + 1];
+SERVICE_LIST(ES_SERVICE_QUEUE)
 
 /****************************************************************************/
 // array of queue descriptors for posting by priority level
 
-static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
-  { Queue0, ARRAY_SIZE(Queue0) }
-#if NUM_SERVICES > 1
-  , { Queue1, ARRAY_SIZE(Queue1) }
-#endif
-#if NUM_SERVICES > 2
-  , { Queue2, ARRAY_SIZE(Queue2) }
-#endif
-#if NUM_SERVICES > 3
-  , { Queue3, ARRAY_SIZE(Queue3) }
-#endif
-#if NUM_SERVICES > 4
-  , { Queue4, ARRAY_SIZE(Queue4) }
-#endif
-#if NUM_SERVICES > 5
-  , { Queue5, ARRAY_SIZE(Queue5) }
-#endif
-#if NUM_SERVICES > 6
-  , { Queue6, ARRAY_SIZE(Queue6) }
-#endif
-#if NUM_SERVICES > 7
-  , { Queue7, ARRAY_SIZE(Queue7) }
-#endif
-#if NUM_SERVICES > 8
-  , { Queue8, ARRAY_SIZE(Queue8) }
-#endif
-#if NUM_SERVICES > 9
-  , { Queue9, ARRAY_SIZE(Queue9) }
-#endif
-#if NUM_SERVICES > 10
-  , { Queue10, ARRAY_SIZE(Queue10) }
-#endif
-#if NUM_SERVICES > 11
-  , { Queue11, ARRAY_SIZE(Queue11) }
-#endif
-#if NUM_SERVICES > 12
-  , { Queue12, ARRAY_SIZE(Queue12) }
-#endif
-#if NUM_SERVICES > 13
-  , { Queue13, ARRAY_SIZE(Queue13) }
-#endif
-#if NUM_SERVICES > 14
-  , { Queue14, ARRAY_SIZE(Queue14) }
-#endif
-#if NUM_SERVICES > 15
-  , { Queue15, ARRAY_SIZE(Queue15) }
-#endif
+#define ES_QUEUE_DESC(Name, Init, Run, QueueSize, LockFree, Level) \
+  { Name##Queue, ARRAY_SIZE(Name##Queue), LockFree },
+static ES_QueueDesc_t const EventQueues[NUM_SERVICES] =
+{
+  SERVICE_LIST(ES_QUEUE_DESC)
 };
 
 /****************************************************************************/
-// Variable used to keep track of which queues have events in them
+// Variable used to keep track of which queues have events in them, bit n of
+// word n/32 for service n.
+// ISRs post too, so only change it with ES_AtomicSetBits/ES_AtomicClrBits
+
+volatile uint32_t Ready[READY_WORDS];
+
+/****************************************************************************/
+// The coalesced events waiting for each service, MAILBOX_FULL | EventParam
+// or 0. Only changed with SwapMailbox
+static volatile uint32_t Mailbox[NUM_SERVICES][NUM_MAILBOXES];
+
+#if ES_PREEMPTIVE
+/****************************************************************************/
+// The services of each level, laid out like Ready. Filled in by
+// ES_Initialize from the Level column of SERVICE_LIST
+static uint32_t LevelMask[ES_MAX_LEVEL + 1][READY_WORDS];
+
+// set when a run function called from ES_RunLevel fails, ES_Run returns
+// FailedRun once it sees it
+static volatile bool LevelRunFailed = false;
+#endif
 
-uint16_t Ready;
+#if ES_PROFILING
+/****************************************************************************/
+// Profiling data, all written from ES_Run except FailedPosts
+static ES_ServProfile_t ServProfile[NUM_SERVICES];
+static uint64_t IdleCounts;    // time spent in the idle part of ES_Run
+static uint64_t WindowCounts;  // time since the last reset
+static uint32_t LastIdleEnd;   // count at the end of the previous idle pass
+// time the software interrupt levels have taken from ES_Run, which is not
+// idle time. Stays 0 without ES_PREEMPTIVE
+static volatile uint32_t PreemptCounts;
+#if ES_PREEMPTIVE
+static volatile uint8_t CurrentLevel = 0;  // the one running, 0 in ES_Run
+#endif
+#endif
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -257,6 +259,7 @@ ES_Return_t ES_Initialize(TimerRate_t NewRate)
 {
   uint8_t i;
   ES_Timer_Init(NewRate);  // start up the timer subsystem
+  ES_PoolInit();           // and the payload blocks
   // loop through the list testing for NULL pointers and
   for (i = 0; i < ARRAY_SIZE(ServDescList); i++)
   {
@@ -265,8 +268,21 @@ ES_Return_t ES_Initialize(TimerRate_t NewRate)
     {
       return FailedPointer; // protect against NULL pointers
     }
+#if ES_PREEMPTIVE
+    LevelMask[ServDescList[i].Level][READY_WORD(i)] |= READY_MASK(i);
+#endif
     // and initializing the event queues (must happen before running inits)
-    ES_InitQueue(EventQueues[i].pMem, EventQueues[i].Size);
+    if (EventQueues[i].LockFree)
+    {
+      if (ES_InitLockFreeQueue(EventQueues[i].pMem, EventQueues[i].Size) == 0)
+      {
+        return FailedInit; // lock-free queues need a power of 2 size
+      }
+    }
+    else
+    {
+      ES_InitQueue(EventQueues[i].pMem, EventQueues[i].Size);
+    }
     // executing the init functions
     if (ServDescList[i].InitFunc(i) != true)
     {
@@ -275,6 +291,12 @@ ES_Return_t ES_Initialize(TimerRate_t NewRate)
   }
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
   _HW_DebugLines_Init();
+#endif
+  ES_ResetServiceStats();
+#if ES_PREEMPTIVE
+  // the ES_INIT events posted above are waiting for this, so the services
+  // above level 0 start off now, once every queue is ready
+  _HW_LevelsInit();
 #endif
   return Success;
 }
@@ -299,48 +321,106 @@ ES_Return_t ES_Initialize(TimerRate_t NewRate)
 ****************************************************************************/
 ES_Return_t ES_Run(void)
 {
-  // make these static to improve speed
   uint8_t         HighestPrior;
-  static ES_Event_t ThisEvent;
+#if ES_PROFILING
+  uint32_t        StartCount;
+  uint32_t        PreemptStart;
+#endif
 
   while (1)  // stay here unless we detect an error condition
-  { // loop through the list executing the run functions for services
+  {
+#if ES_PREEMPTIVE
+    if (LevelRunFailed)
+    {
+      return FailedRun;
+    }
+#endif
+    // loop through the list executing the run functions for services
     // with a non-empty queue. Process any pending ints before testing
     // Ready
-    while ((_HW_Process_Pending_Ints()) && (Ready != 0))
+    while ((_HW_Process_Pending_Ints()) &&
+        ((HighestPrior = GetHighestReady(0)) != NO_SERVICE_READY))
     {
-      HighestPrior = ES_GetMSBitSet(Ready);
-      if (ES_DeQueue(EventQueues[HighestPrior].pMem, &ThisEvent) == 0)
-      {
-        Ready &= BitNum2ClrMask[HighestPrior]; // mark queue as now empty
-      }
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-      _HW_DebugSetLine1();
-#endif
-      if (ServDescList[HighestPrior].RunFunc(ThisEvent).EventType !=
-          ES_NO_EVENT)
+      if (RunService(HighestPrior) != true)
       {
         return FailedRun;
       }
-#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-      _HW_DebugClearLine1();
-#endif
     }
 
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
     _HW_DebugSetLine2();
+#endif
+#if ES_PROFILING
+    StartCount = ES_GetProfileCount();
+    PreemptStart = PreemptCounts;
 #endif
     // all the queues are empty, so look for new user detected events
     if (!ES_CheckUserEvents()) // no new user events
     {
+#if ES_TRACE
+      ES_TraceMoveToTerminal(); // a trace dump goes out as the buffer drains
+#endif
+#if ES_LOGGING
+      ES_LogMoveToTerminal(); // ES_LOG records go out as the buffer drains
+#endif
       Terminal_MoveBuffer2UART(); // try moving bytes, if available, to UART
     }
+#if ES_PROFILING
+    RecordIdle(StartCount, PreemptStart);
+#endif
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
     _HW_DebugClearLine2();
 #endif
   }
 }
 
+/****************************************************************************
+ Function
+   ES_RunLevel
+ Parameters
+   uint8_t : the level, 1 to ES_MAX_LEVEL
+ Returns
+   None
+ Description
+   Runs the ready services of one level, highest priority first, until
+   their queues are empty. Called by the port from the core software
+   interrupt of the level, which _HW_PendLevel raises when one of them is
+   posted to.
+ Notes
+   Only does anything with ES_PREEMPTIVE. A failed run function stops the
+   level and makes ES_Run return FailedRun.
+****************************************************************************/
+void ES_RunLevel(uint8_t Level)
+{
+#if ES_PREEMPTIVE
+  uint8_t   WhichService;
+#if ES_PROFILING
+  uint8_t   Preempted = CurrentLevel;
+  uint32_t  StartCount = ES_GetProfileCount();
+
+  CurrentLevel = Level;
+#endif
+  while (!LevelRunFailed &&
+      ((WhichService = GetHighestReady(Level)) != NO_SERVICE_READY))
+  {
+    if (RunService(WhichService) != true)
+    {
+      LevelRunFailed = true;
+    }
+  }
+#if ES_PROFILING
+  CurrentLevel = Preempted;
+  if (Preempted == 0)
+  {
+    // a level nested inside another is already in the outer one's time
+    PreemptCounts += ES_GetProfileCount() - StartCount;
+  }
+#endif
+#else
+  (void)Level;
+#endif
+}
+
 /****************************************************************************
  Function
    ES_PostAll
@@ -358,16 +438,34 @@ ES_Return_t ES_Run(void)
 bool ES_PostAll(ES_Event_t ThisEvent)
 {
   uint8_t i;
+  bool    HasPayload = ES_EventHasPayload(ThisEvent.EventType);
+  uint8_t WhichMailbox = GetMailbox(ThisEvent.EventType);
   // loop through the list executing the post functions
   for (i = 0; i < ARRAY_SIZE(EventQueues); i++)
   {
-    if (ES_EnQueueFIFO(EventQueues[i].pMem, ThisEvent) != true)
+    if (WhichMailbox != NO_MAILBOX)
     {
-      break; // this is a failed post
+      if (PostCoalesced(i, WhichMailbox, ThisEvent, false) != true)
+      {
+        break; // this is a failed post
+      }
+      continue;
     }
-    else
+    if (HasPayload)
+    {
+      ES_PoolAddRef(ThisEvent.EventParam); // one reference per queue
+    }
+    if (EnQueue(i, ThisEvent, false) != true)
     {
-      Ready |= BitNum2SetMask[i]; // show queue as non-empty
+      if (HasPayload)
+      {
+        ES_PoolRelease(ThisEvent.EventParam);
+      }
+      ES_TRACE_EVENT(ES_TRACE_POST_FAILED, i, ThisEvent, 0);
+#if ES_PROFILING
+      RecordFailedPost(i);
+#endif
+      break; // this is a failed post
     }
   }
   if (i == ARRAY_SIZE(EventQueues))    // if no failures
@@ -391,21 +489,43 @@ bool ES_PostAll(ES_Event_t ThisEvent)
  Description
    posts to one of the services' queues
  Notes
-   used by the timer library to associate a timer with a state machine
+   used by the timer library to associate a timer with a state machine.
+   An event in COALESCED_EVENT_LIST replaces one of its type already
+   waiting for the service, see PostCoalesced
  Author
    J. Edward Carryer, 01/16/12,
 ****************************************************************************/
 bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
 {
+  bool    HasPayload = ES_EventHasPayload(TheEvent.EventType);
+  uint8_t WhichMailbox = GetMailbox(TheEvent.EventType);
+
+  if ((WhichMailbox != NO_MAILBOX) &&
+      (WhichService < ARRAY_SIZE(EventQueues)))
+  {
+    return PostCoalesced(WhichService, WhichMailbox, TheEvent, false);
+  }
+  // take the queue's reference first, ES_Run may drop it as soon as the
+  // event is in
+  if (HasPayload)
+  {
+    ES_PoolAddRef(TheEvent.EventParam);
+  }
   if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueFIFO(EventQueues[WhichService].pMem, TheEvent) ==
-        true))
+      (EnQueue(WhichService, TheEvent, false) == true))
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
     return true;
   }
   else
   {
+    if (HasPayload)
+    {
+      ES_PoolRelease(TheEvent.EventParam);
+    }
+    ES_TRACE_EVENT(ES_TRACE_POST_FAILED, WhichService, TheEvent, 0);
+#if ES_PROFILING
+    RecordFailedPost(WhichService);
+#endif
     return false;
   }
 }
@@ -427,22 +547,479 @@ bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
 ****************************************************************************/
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent)
 {
+  bool    HasPayload = ES_EventHasPayload(TheEvent.EventType);
+  uint8_t WhichMailbox = GetMailbox(TheEvent.EventType);
+
+  if ((WhichMailbox != NO_MAILBOX) &&
+      (WhichService < ARRAY_SIZE(EventQueues)))
+  {
+    return PostCoalesced(WhichService, WhichMailbox, TheEvent, true);
+  }
+  // take the queue's reference first, ES_Run may drop it as soon as the
+  // event is in
+  if (HasPayload)
+  {
+    ES_PoolAddRef(TheEvent.EventParam);
+  }
   if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueLIFO(EventQueues[WhichService].pMem, TheEvent) ==
-        true))
+      (EnQueue(WhichService, TheEvent, true) == true))
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
     return true;
   }
   else
   {
+    if (HasPayload)
+    {
+      ES_PoolRelease(TheEvent.EventParam);
+    }
+    ES_TRACE_EVENT(ES_TRACE_POST_FAILED, WhichService, TheEvent, 0);
+#if ES_PROFILING
+    RecordFailedPost(WhichService);
+#endif
     return false;
   }
 }
 
+/****************************************************************************
+ Function
+   ES_GetServiceName
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+ Returns
+   const char * : the name the service was given in SERVICE_LIST, "?" if
+                  there is no such service
+ Description
+   lets the diagnostics print services by name rather than priority
+****************************************************************************/
+const char *ES_GetServiceName(uint8_t WhichService)
+{
+  if (WhichService >= ARRAY_SIZE(ServDescList))
+  {
+    return "?";
+  }
+  return ServDescList[WhichService].Name;
+}
+
+/****************************************************************************
+ Function
+   ES_GetServiceStats
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+   ES_ServiceStats_t * : where to put the numbers
+ Returns
+   boolean : False if the service does not exist or ES_PROFILING is off
+ Description
+   Reports what ES_Run has measured for one service since the last call to
+   ES_ResetServiceStats
+ Notes
+   Times include any ISRs, and with ES_PREEMPTIVE any higher level
+   services, that ran during the run function. A high water mark equal to
+   QueueSize means the queue has been full, FailedPosts counts the events
+   that were lost when it was. Coalesced counts the posts of
+   COALESCED_EVENT_LIST events that replaced one already waiting. Latency
+   is only timed for events posted to an empty queue, the wait of the ones
+   behind them is mostly the run time of the ones in front.
+****************************************************************************/
+bool ES_GetServiceStats(uint8_t WhichService, ES_ServiceStats_t *pStats)
+{
+#if ES_PROFILING
+  ES_ServProfile_t *pProfile;
+
+  if (WhichService >= ARRAY_SIZE(ServProfile))
+  {
+    return false;
+  }
+  pProfile = &ServProfile[WhichService];
+  pStats->Dispatches = pProfile->Dispatches;
+  pStats->MaxCounts = pProfile->MaxCounts;
+  pStats->MaxLatency = pProfile->MaxLatency;
+  pStats->FailedPosts = pProfile->FailedPosts;
+  pStats->Coalesced = pProfile->Coalesced;
+  pStats->QueueHighWater = pProfile->QueueHighWater;
+  // the block holds the queue header in its first entry
+  pStats->QueueSize = EventQueues[WhichService].Size - 1;
+  if (pProfile->Dispatches == 0)
+  {
+    pStats->MinCounts = 0;
+    pStats->AvgCounts = 0;
+  }
+  else
+  {
+    pStats->MinCounts = pProfile->MinCounts;
+    pStats->AvgCounts = (uint32_t)(pProfile->TotalCounts /
+        pProfile->Dispatches);
+  }
+  if (pProfile->Latencies == 0)
+  {
+    pStats->AvgLatency = 0;
+  }
+  else
+  {
+    pStats->AvgLatency = (uint32_t)(pProfile->TotalLatency /
+        pProfile->Latencies);
+  }
+  return true;
+#else
+  (void)WhichService;
+  (void)pStats;
+  return false;
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_GetIdlePermille
+ Parameters
+   None
+ Returns
+   uint16_t : thousandths of the time since the last reset that ES_Run spent
+              in its idle loop (event checkers and moving bytes to the UART)
+ Description
+   1000 minus this is the CPU load from the services. ES_IDLE_UNKNOWN if
+   ES_PROFILING is off or the window is empty, which is not the same as no
+   idle time at all.
+****************************************************************************/
+uint16_t ES_GetIdlePermille(void)
+{
+#if ES_PROFILING
+  if (WindowCounts == 0)
+  {
+    return ES_IDLE_UNKNOWN;
+  }
+  return (uint16_t)((IdleCounts * 1000u) / WindowCounts);
+#else
+  return ES_IDLE_UNKNOWN;
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_ResetServiceStats
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Starts a new measurement window for ES_GetServiceStats and
+   ES_GetIdlePermille
+****************************************************************************/
+void ES_ResetServiceStats(void)
+{
+#if ES_PROFILING
+  uint8_t i;
+
+  for (i = 0; i < ARRAY_SIZE(ServProfile); i++)
+  {
+    ServProfile[i].Dispatches = 0;
+    ServProfile[i].MinCounts = UINT32_MAX;
+    ServProfile[i].MaxCounts = 0;
+    ServProfile[i].TotalCounts = 0;
+    ServProfile[i].FailedPosts = 0;
+    ServProfile[i].Coalesced = 0;
+    ServProfile[i].QueueHighWater = 0;
+    ServProfile[i].Latencies = 0;
+    ServProfile[i].MaxLatency = 0;
+    ServProfile[i].TotalLatency = 0;
+  }
+  IdleCounts = 0;
+  WindowCounts = 0;
+  LastIdleEnd = ES_GetProfileCount();
+#endif
+}
+
 //*********************************
 // private functions
 //*********************************
+// takes the next event off a service's queue and calls its run function
+// with it, false if the run function failed
+static bool RunService(uint8_t WhichService)
+{
+  ES_Event_t  ThisEvent;  // not static, a higher level may be preempting
+  uint8_t     Remaining;
+  uint8_t     WhichMailbox;
+#if ES_PROFILING
+  ES_ServProfile_t *pProfile = &ServProfile[WhichService];
+  bool        Timed;
+  uint32_t    PostedAt;
+  uint32_t    StartCount;
+#endif
+
+  Remaining = ES_DeQueue(EventQueues[WhichService].pMem, &ThisEvent);
+  WhichMailbox = GetMailbox(ThisEvent.EventType);
+  if (WhichMailbox != NO_MAILBOX)
+  {
+    // only a place holder, the newest post is in the mailbox. Emptying it
+    // lets the next post queue another one
+    ThisEvent.EventParam =
+        (uint16_t)SwapMailbox(&Mailbox[WhichService][WhichMailbox], 0);
+  }
+  ES_TRACE_EVENT(ES_TRACE_DEQUEUE, WhichService, ThisEvent, Remaining);
+#if ES_PROFILING
+  // taken before Ready is cleared, after that a post stamps the next event
+  Timed = pProfile->Waiting;
+  PostedAt = pProfile->PostedAt;
+  pProfile->Waiting = false;
+#endif
+  if (Remaining == 0)
+  {
+    // mark queue as now empty
+    ES_AtomicClrBits(&Ready[READY_WORD(WhichService)],
+        READY_MASK(WhichService));
+    // an ISR may have posted between the DeQueue and the clear
+    if (!ES_IsQueueEmpty(EventQueues[WhichService].pMem))
+    {
+      ES_AtomicSetBits(&Ready[READY_WORD(WhichService)],
+          READY_MASK(WhichService));
+    }
+  }
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+  _HW_DebugSetLine1();
+#endif
+  ES_TRACE_EVENT(ES_TRACE_RUN_START, WhichService, ThisEvent, 0);
+#if ES_PROFILING
+  StartCount = ES_GetProfileCount();
+  if (Timed)
+  {
+    RecordLatency(WhichService, StartCount - PostedAt);
+  }
+#endif
+  if (ServDescList[WhichService].RunFunc(ThisEvent).EventType !=
+      ES_NO_EVENT)
+  {
+    return false;
+  }
+  ES_TRACE_EVENT(ES_TRACE_RUN_END, WhichService, ThisEvent, 0);
+  if (ES_EventHasPayload(ThisEvent.EventType))
+  {
+    ES_PoolRelease(ThisEvent.EventParam); // the queue's reference
+  }
+#if ES_PROFILING
+  // the queue only grows between dispatches, so its depth just before
+  // this DeQueue is the most it held since the last one
+  RecordRun(WhichService, ES_GetProfileCount() - StartCount, Remaining + 1);
+#endif
+#ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
+  _HW_DebugClearLine1();
+#endif
+  return true;
+}
+
+// puts an event in a service's queue and shows it as non-empty, false if
+// the queue was full. With ES_PREEMPTIVE it is done at the service's level,
+// so the service can not run between the claim of a lock-free slot and its
+// publish (see DeQueueLockFree). A post from a lower level would otherwise
+// be preempted there by an ISR posting the next slot, and the level would
+// find an unpublished event at the head and never go idle
+static bool EnQueue(uint8_t WhichService, ES_Event_t TheEvent, bool LIFO)
+{
+  ES_Ceiling_t Saved = ES_EnterCeiling(ServDescList[WhichService].Level);
+  bool         Queued;
+
+  if (LIFO)
+  {
+    Queued = ES_EnQueueLIFO(EventQueues[WhichService].pMem, TheEvent);
+  }
+  else
+  {
+    Queued = ES_EnQueueFIFO(EventQueues[WhichService].pMem, TheEvent);
+  }
+  if (Queued)
+  {
+    ES_TRACE_EVENT(ES_TRACE_POST, WhichService, TheEvent, 0);
+    MarkReady(WhichService); // show queue as non-empty
+  }
+  ES_ExitCeiling(Saved);
+  return Queued;
+}
+
+// shows a service's queue as non-empty after a post to it, and with
+// ES_PREEMPTIVE pends its level if it is not run from ES_Run
+static void MarkReady(uint8_t WhichService)
+{
+#if ES_PROFILING
+  if ((ES_AtomicFetchSetBits(&Ready[READY_WORD(WhichService)],
+      READY_MASK(WhichService)) & READY_MASK(WhichService)) == 0)
+  {
+    // the queue was empty, so this event is the next one dispatched
+    ServProfile[WhichService].PostedAt = ES_GetProfileCount();
+    ServProfile[WhichService].Waiting = true;
+  }
+#else
+  ES_AtomicSetBits(&Ready[READY_WORD(WhichService)], READY_MASK(WhichService));
+#endif
+#if ES_PREEMPTIVE
+  if (ServDescList[WhichService].Level > 0)
+  {
+    _HW_PendLevel(ServDescList[WhichService].Level);
+  }
+#endif
+}
+
+// the highest priority service of a level with a non-empty queue,
+// NO_SERVICE_READY if there is none. Without ES_PREEMPTIVE every service is
+// in level 0. One clz per word, so at most two for 64 services
+static uint8_t GetHighestReady(uint8_t Level)
+{
+  int8_t    Word;
+  uint32_t  Bits;
+
+#if !ES_PREEMPTIVE
+  (void)Level;
+#endif
+  for (Word = READY_WORDS - 1; Word >= 0; Word--)
+  {
+#if ES_PREEMPTIVE
+    Bits = Ready[Word] & LevelMask[Level][Word];
+#else
+    Bits = Ready[Word];
+#endif
+    if (Bits != 0)
+    {
+      return (uint8_t)((Word << 5) + ES_GetMSBit32(Bits));
+    }
+  }
+  return NO_SERVICE_READY;
+}
+
+// the mailbox of an event type in COALESCED_EVENT_LIST, NO_MAILBOX for the
+// rest
+static uint8_t GetMailbox(ES_EventType_t EventType)
+{
+#define ES_MAILBOX_CASE(Event) case Event: return Event##_MAILBOX;
+  switch (EventType)
+  {
+    COALESCED_EVENT_LIST(ES_MAILBOX_CASE)
+
+    default:
+      return NO_MAILBOX;
+  }
+#undef ES_MAILBOX_CASE
+}
+
+// puts NewValue in the mailbox and returns what was there, in one step as
+// far as ISRs and the other levels can tell
+static uint32_t SwapMailbox(volatile uint32_t *pMailbox, uint32_t NewValue)
+{
+  uint32_t OldValue;
+
+  do
+  {
+    OldValue = *pMailbox;
+  } while (!ES_CompareAndSwap(pMailbox, OldValue, NewValue));
+  return OldValue;
+}
+
+// posts an event in COALESCED_EVENT_LIST. If the mailbox was full the event
+// already queued will be dispatched with this one's EventParam, else this
+// one goes in the queue to hold its place. The mailbox holds the payload
+// block reference, not the queue
+static bool PostCoalesced(uint8_t WhichService, uint8_t WhichMailbox,
+    ES_Event_t TheEvent, bool LIFO)
+{
+  volatile uint32_t *pMailbox = &Mailbox[WhichService][WhichMailbox];
+  bool     HasPayload = ES_EventHasPayload(TheEvent.EventType);
+  uint32_t Replaced;
+
+  if (HasPayload)
+  {
+    ES_PoolAddRef(TheEvent.EventParam);
+  }
+  Replaced = SwapMailbox(pMailbox, MAILBOX_FULL | TheEvent.EventParam);
+  if (Replaced & MAILBOX_FULL)
+  {
+    if (HasPayload)
+    {
+      ES_PoolRelease((uint16_t)Replaced);
+    }
+    ES_TRACE_EVENT(ES_TRACE_POST_COALESCED, WhichService, TheEvent, 0);
+#if ES_PROFILING
+    RecordCoalesced(WhichService);
+#endif
+    return true;
+  }
+  if (EnQueue(WhichService, TheEvent, LIFO))
+  {
+    return true;
+  }
+  // no room for the place holder, so empty the mailbox again. An ISR may
+  // have replaced this event in the meantime, it is lost with it
+  Replaced = SwapMailbox(pMailbox, 0);
+  if (HasPayload)
+  {
+    ES_PoolRelease((uint16_t)Replaced);
+  }
+  ES_TRACE_EVENT(ES_TRACE_POST_FAILED, WhichService, TheEvent, 0);
+#if ES_PROFILING
+  RecordFailedPost(WhichService);
+#endif
+  return false;
+}
+
+#if ES_PROFILING
+// adds one run function call to the service's numbers
+static void RecordRun(uint8_t WhichService, uint32_t RunCounts,
+    uint8_t QueueDepth)
+{
+  ES_ServProfile_t *pProfile = &ServProfile[WhichService];
+
+  pProfile->Dispatches++;
+  pProfile->TotalCounts += RunCounts;
+  if (RunCounts < pProfile->MinCounts)
+  {
+    pProfile->MinCounts = RunCounts;
+  }
+  if (RunCounts > pProfile->MaxCounts)
+  {
+    pProfile->MaxCounts = RunCounts;
+  }
+  if (QueueDepth > pProfile->QueueHighWater)
+  {
+    pProfile->QueueHighWater = QueueDepth;
+  }
+}
+
+// adds the wait from the post to the run function call of an event that was
+// posted to an empty queue
+static void RecordLatency(uint8_t WhichService, uint32_t Latency)
+{
+  ES_ServProfile_t *pProfile = &ServProfile[WhichService];
+
+  pProfile->Latencies++;
+  pProfile->TotalLatency += Latency;
+  if (Latency > pProfile->MaxLatency)
+  {
+    pProfile->MaxLatency = Latency;
+  }
+}
+
+// adds one pass through the idle part of ES_Run, less any time the software
+// interrupt levels took from it, and the time since the previous one to the
+// window
+static void RecordIdle(uint32_t IdleStart, uint32_t PreemptStart)
+{
+  uint32_t Now = ES_GetProfileCount();
+
+  IdleCounts += (Now - IdleStart) - (PreemptCounts - PreemptStart);
+  WindowCounts += Now - LastIdleEnd;
+  LastIdleEnd = Now;
+}
+
+// may be called from an ISR
+static void RecordFailedPost(uint8_t WhichService)
+{
+  if (WhichService < ARRAY_SIZE(ServProfile))
+  {
+    ES_AtomicInc(&ServProfile[WhichService].FailedPosts);
+  }
+}
+
+// may be called from an ISR, only for services that exist
+static void RecordCoalesced(uint8_t WhichService)
+{
+  ES_AtomicInc(&ServProfile[WhichService].Coalesced);
+}
+#endif
+
 #if 0
 /****************************************************************************
  Function
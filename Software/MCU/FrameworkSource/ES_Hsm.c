@@ -0,0 +1,866 @@
+/****************************************************************************
+ Module
+     ES_Hsm.c
+ Description
+     Runs hierarchical state machines that are declared as const tables
+     instead of nested switch statements
+ Notes
+     A dispatch looks for a transition on the event in the current state's
+     table, then in its parent's and so on up, and takes the first one whose
+     guard passes. An internal transition (Target ES_HSM_INTERNAL) only runs
+     its action. Any other transition leaves every state up to, but not
+     including, the lowest state containing both the source and the target,
+     runs its action, enters every state down to the target, then follows
+     InitialChild down to a leaf. A transition to the source itself or to a
+     state that contains it leaves and enters that state again, the same as
+     a self transition in HSMTemplate.c.
+     Exit functions run innermost first, entry functions outermost first,
+     and each gets the event that caused the transition.
+     The initial state given to ES_HsmInit is normally a pseudostate with a
+     single ES_INIT transition, so the usual Init/Post/Run service shape is
+     unchanged: the init function posts ES_INIT and the run function hands
+     every event to ES_HsmDispatch.
+
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_Hsm.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+static const ES_HsmTransition_t *FindTransition(const ES_HsmState_t *pState,
+    ES_Event_t ThisEvent);
+static uint8_t FindTop(const ES_HsmState_t *pStates, uint8_t Source,
+    uint8_t Target);
+static uint8_t GetDepth(const ES_HsmState_t *pStates, uint8_t State);
+static void ExitTo(ES_Hsm_t *pMe, uint8_t Top, ES_Event_t ThisEvent);
+static void EnterFrom(ES_Hsm_t *pMe, uint8_t Top, uint8_t Target,
+    ES_Event_t ThisEvent);
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_HsmInit
+ Parameters
+   ES_Hsm_t * : the machine instance to set up
+   const ES_HsmMachine_t * : its tables
+   uint8_t : the state to start in, usually the initial pseudostate
+ Returns
+   None
+ Description
+   Puts the machine in InitialState without running any entry functions
+****************************************************************************/
+void ES_HsmInit(ES_Hsm_t *pMe, const ES_HsmMachine_t *pMachine,
+    uint8_t InitialState)
+{
+  pMe->pMachine = pMachine;
+  pMe->CurrentState = InitialState;
+}
+
+/****************************************************************************
+ Function
+   ES_HsmDispatch
+ Parameters
+   ES_Hsm_t * : the machine
+   ES_Event_t : the event to process
+ Returns
+   bool : true if a transition was taken, false if no state wanted the event
+ Description
+   Takes the first transition on the event from the current state or one
+   of the states containing it, see the module Notes
+****************************************************************************/
+bool ES_HsmDispatch(ES_Hsm_t *pMe, ES_Event_t ThisEvent)
+{
+  const ES_HsmState_t      *pStates = pMe->pMachine->pStates;
+  const ES_HsmTransition_t *pTransition = NULL;
+  uint8_t                  From = pMe->CurrentState;
+  uint8_t                  Source;
+  uint8_t                  Top;
+
+  for (Source = From; Source != ES_HSM_NO_STATE;
+      Source = pStates[Source].Parent)
+  {
+    pTransition = FindTransition(&pStates[Source], ThisEvent);
+    if (pTransition != NULL)
+    {
+      break;
+    }
+  }
+  if (pTransition == NULL)
+  {
+    return false;
+  }
+
+  if (pTransition->Target == ES_HSM_INTERNAL)
+  {
+    if (pTransition->Action != NULL)
+    {
+      pTransition->Action(ThisEvent);
+    }
+  }
+  else
+  {
+    Top = FindTop(pStates, Source, pTransition->Target);
+    ExitTo(pMe, Top, ThisEvent);
+    if (pTransition->Action != NULL)
+    {
+      pTransition->Action(ThisEvent);
+    }
+    EnterFrom(pMe, Top, pTransition->Target, ThisEvent);
+  }
+
+  if (pMe->pMachine->Trace != NULL)
+  {
+    pMe->pMachine->Trace(From, pMe->CurrentState, ThisEvent);
+  }
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_HsmGetState
+ Parameters
+   const ES_Hsm_t * : the machine
+ Returns
+   uint8_t : the current (leaf) state
+ Description
+   For the Query functions of the services
+****************************************************************************/
+uint8_t ES_HsmGetState(const ES_Hsm_t *pMe)
+{
+  return pMe->CurrentState;
+}
+
+/****************************************************************************
+ Function
+   ES_HsmIsIn
+ Parameters
+   const ES_Hsm_t * : the machine
+   uint8_t : a state
+ Returns
+   bool : true if State is the current state or contains it
+ Description
+   Lets callers ask about a composite state without listing its children
+****************************************************************************/
+bool ES_HsmIsIn(const ES_Hsm_t *pMe, uint8_t State)
+{
+  uint8_t Test;
+
+  for (Test = pMe->CurrentState; Test != ES_HSM_NO_STATE;
+      Test = pMe->pMachine->pStates[Test].Parent)
+  {
+    if (Test == State)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//*********************************
+// private functions
+//*********************************
+static const ES_HsmTransition_t *FindTransition(const ES_HsmState_t *pState,
+    ES_Event_t ThisEvent)
+{
+  const ES_HsmTransition_t *pTransition = pState->pTransitions;
+  uint8_t                  i;
+
+  for (i = 0; i < pState->NumTransitions; i++, pTransition++)
+  {
+    if ((pTransition->EventType == ThisEvent.EventType) &&
+        ((pTransition->Guard == NULL) || pTransition->Guard(ThisEvent)))
+    {
+      return pTransition;
+    }
+  }
+  return NULL;
+}
+
+// the innermost state the transition stays inside, ES_HSM_NO_STATE for
+// none. When one end contains the other that state is left as well.
+static uint8_t FindTop(const ES_HsmState_t *pStates, uint8_t Source,
+    uint8_t Target)
+{
+  uint8_t SourceDepth;
+  uint8_t TargetDepth;
+
+  // siblings, or a self transition, are most of them
+  if (pStates[Source].Parent == pStates[Target].Parent)
+  {
+    return pStates[Source].Parent;
+  }
+  SourceDepth = GetDepth(pStates, Source);
+  TargetDepth = GetDepth(pStates, Target);
+  while (SourceDepth > TargetDepth)
+  {
+    Source = pStates[Source].Parent;
+    SourceDepth--;
+  }
+  while (TargetDepth > SourceDepth)
+  {
+    Target = pStates[Target].Parent;
+    TargetDepth--;
+  }
+  if (Source == Target)
+  {
+    // one end contains the other (or they are the same state)
+    return pStates[Source].Parent;
+  }
+  while (Source != Target)
+  {
+    Source = pStates[Source].Parent;
+    Target = pStates[Target].Parent;
+  }
+  return Source;
+}
+
+static uint8_t GetDepth(const ES_HsmState_t *pStates, uint8_t State)
+{
+  uint8_t Depth = 0;
+
+  while (State != ES_HSM_NO_STATE)
+  {
+    Depth++;
+    State = pStates[State].Parent;
+  }
+  return Depth;
+}
+
+// runs the exit functions from the current state out to, not including, Top
+static void ExitTo(ES_Hsm_t *pMe, uint8_t Top, ES_Event_t ThisEvent)
+{
+  const ES_HsmState_t *pStates = pMe->pMachine->pStates;
+  uint8_t             State;
+
+  for (State = pMe->CurrentState; State != Top; State = pStates[State].Parent)
+  {
+    if (pStates[State].Exit != NULL)
+    {
+      pStates[State].Exit(ThisEvent);
+    }
+  }
+}
+
+// runs the entry functions from just inside Top down to Target, then on
+// down its initial children to a leaf, which becomes the current state
+static void EnterFrom(ES_Hsm_t *pMe, uint8_t Top, uint8_t Target,
+    ES_Event_t ThisEvent)
+{
+  const ES_HsmState_t *pStates = pMe->pMachine->pStates;
+  uint8_t             Path[ES_HSM_MAX_DEPTH];
+  uint8_t             Depth = 0;
+  uint8_t             State;
+
+  for (State = Target; (State != Top) && (Depth < ES_HSM_MAX_DEPTH);
+      State = pStates[State].Parent)
+  {
+    Path[Depth++] = State;
+  }
+  while (Depth > 0)
+  {
+    State = Path[--Depth];
+    if (pStates[State].Entry != NULL)
+    {
+      pStates[State].Entry(ThisEvent);
+    }
+  }
+  State = Target;
+  while (pStates[State].InitialChild != ES_HSM_NO_STATE)
+  {
+    State = pStates[State].InitialChild;
+    if (pStates[State].Entry != NULL)
+    {
+      pStates[State].Entry(ThisEvent);
+    }
+  }
+  pMe->CurrentState = State;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+#ifdef TEST_HSM
+/* HSM engine harness (make -f Makefile.host hsm_bench).
+   Part 1 runs a 3 level machine through self, inner, outer, guarded,
+   internal and ancestor transitions and checks the entry/exit/action
+   order against what the module Notes promise.
+   Part 2 times the button debouncer and the Jetson machine, each written
+   both ways: Sw... is the nested switch form the services used to have,
+   Tb... is the same machine as ES_Hsm tables. Both call the same stub
+   actions so only the dispatch differs. The hsm_bench target also prints
+   the code + table size of each form from the object file; ES_Hsm itself
+   is counted once, shared by every machine. */
+#include <stdio.h>
+#include <string.h>
+#include "ES_General.h"
+#include "ES_Port.h"
+
+#define BENCH_PASSES 200000u
+
+static bool TestFailed = false;
+
+/*------------------------- Part 1: transition order ----------------------*/
+// Init -> A { A1, A2 }, B.
+enum { T_INIT, T_A, T_A1, T_A2, T_B };
+
+static char OrderLog[128];
+
+static void Log(const char *pStep)
+{
+  strcat(OrderLog, pStep);
+  strcat(OrderLog, " ");
+}
+
+static void EnterA(ES_Event_t E) { (void)E; Log("eA"); }
+static void ExitA(ES_Event_t E) { (void)E; Log("xA"); }
+static void EnterA1(ES_Event_t E) { (void)E; Log("eA1"); }
+static void ExitA1(ES_Event_t E) { (void)E; Log("xA1"); }
+static void EnterA2(ES_Event_t E) { (void)E; Log("eA2"); }
+static void ExitA2(ES_Event_t E) { (void)E; Log("xA2"); }
+static void EnterB(ES_Event_t E) { (void)E; Log("eB"); }
+static void ExitB(ES_Event_t E) { (void)E; Log("xB"); }
+static void ActT(ES_Event_t E) { (void)E; Log("t"); }
+static void ActI(ES_Event_t E) { (void)E; Log("i"); }
+static bool Never(ES_Event_t E) { (void)E; return false; }
+static bool IsOdd(ES_Event_t E) { return (E.EventParam & 1) != 0; }
+
+static const ES_HsmTransition_t TInitTrans[] = {
+  { ES_INIT, T_A, NULL, NULL },
+};
+static const ES_HsmTransition_t TATrans[] = {
+  { ES_TIMEOUT, T_B, NULL, ActT },
+  { ES_SHORT_TIMEOUT, ES_HSM_INTERNAL, NULL, ActI },
+};
+static const ES_HsmTransition_t TA1Trans[] = {
+  { ES_NEW_KEY, T_A2, NULL, NULL },
+};
+static const ES_HsmTransition_t TA2Trans[] = {
+  { ES_NEW_KEY, T_A2, NULL, NULL },
+  { ES_LOCK, T_A, NULL, NULL },
+  // odd params are taken here, even ones fall through to A
+  { ES_SHORT_TIMEOUT, T_A1, IsOdd, NULL },
+};
+static const ES_HsmTransition_t TBTrans[] = {
+  { ES_TIMEOUT, T_A1, Never, NULL },
+  { ES_TIMEOUT, T_A, NULL, ActT },
+};
+static const ES_HsmState_t TStates[] = {
+  [T_INIT] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE, NULL, NULL,
+      TInitTrans),
+  [T_A] = ES_HSM_STATE(ES_HSM_NO_STATE, T_A1, EnterA, ExitA, TATrans),
+  [T_A1] = ES_HSM_STATE(T_A, ES_HSM_NO_STATE, EnterA1, ExitA1, TA1Trans),
+  [T_A2] = ES_HSM_STATE(T_A, ES_HSM_NO_STATE, EnterA2, ExitA2, TA2Trans),
+  [T_B] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE, EnterB, ExitB,
+      TBTrans),
+};
+static const ES_HsmMachine_t TMachine = { TStates, ARRAY_SIZE(TStates), NULL };
+
+static void Step(ES_Hsm_t *pMe, ES_EventType_t Type, uint16_t Param,
+    bool Taken, uint8_t State, const char *pExpected)
+{
+  ES_Event_t ThisEvent = { Type, Param };
+  bool       WasTaken;
+
+  OrderLog[0] = '\0';
+  WasTaken = ES_HsmDispatch(pMe, ThisEvent);
+  if ((WasTaken != Taken) || (ES_HsmGetState(pMe) != State) ||
+      (strcmp(OrderLog, pExpected) != 0))
+  {
+    printf("order: event %u: got \"%s\" state %u, expected \"%s\" state %u\r\n",
+        (unsigned)Type, OrderLog, ES_HsmGetState(pMe), pExpected, State);
+    TestFailed = true;
+  }
+}
+
+static void TestOrder(void)
+{
+  ES_Hsm_t Me;
+
+  ES_HsmInit(&Me, &TMachine, T_INIT);
+  Step(&Me, ES_INIT, 0, true, T_A1, "eA eA1 ");
+  Step(&Me, ES_UNLOCK, 0, false, T_A1, "");             // nobody wants it
+  Step(&Me, ES_NEW_KEY, 0, true, T_A2, "xA1 eA2 ");     // sibling
+  Step(&Me, ES_NEW_KEY, 0, true, T_A2, "xA2 eA2 ");     // self
+  Step(&Me, ES_SHORT_TIMEOUT, 0, true, T_A2, "i ");     // guard fails, parent
+  Step(&Me, ES_SHORT_TIMEOUT, 1, true, T_A1, "xA2 eA1 "); // guard passes
+  Step(&Me, ES_NEW_KEY, 0, true, T_A2, "xA1 eA2 ");
+  Step(&Me, ES_LOCK, 0, true, T_A1, "xA2 xA eA eA1 ");  // to the parent
+  Step(&Me, ES_TIMEOUT, 0, true, T_B, "xA1 xA t eB ");  // inherited, outward
+  Step(&Me, ES_TIMEOUT, 0, true, T_A1, "xB t eA eA1 "); // first guard fails
+  if (!ES_HsmIsIn(&Me, T_A) || ES_HsmIsIn(&Me, T_B))
+  {
+    printf("order: ES_HsmIsIn wrong\r\n");
+    TestFailed = true;
+  }
+}
+
+/*---------------------- Part 2: switch vs table timing -------------------*/
+// the actions both forms call, kept out of line like the real ones
+static volatile uint32_t StubCalls;
+
+static void __attribute__((noinline)) StubTimer(void) { StubCalls++; }
+static void __attribute__((noinline)) StubReport(bool Pressed)
+{
+  StubCalls += Pressed ? 1 : 2;
+}
+static void __attribute__((noinline)) StubLeds(bool Active)
+{
+  StubCalls += Active ? 1 : 2;
+}
+static void __attribute__((noinline)) StubReply(uint8_t Which)
+{
+  StubCalls += Which;
+}
+static void __attribute__((noinline)) StubStop(void) { StubCalls++; }
+
+// Jetson frames stand in as EventParam codes, the guards compare bytes the
+// same way in both forms
+enum { F_HELLO = 1, F_CONFIRM, F_VELOCITY, F_DIAG, F_SHUTDOWN, F_JUNK };
+
+enum { D_INIT, D_WAIT, D_FALL, D_RISE };
+enum { J_INIT, J_INACTIVE, J_CONNECTED, J_PENDING, J_ACTIVE };
+
+/* the switch forms, as in Button1DebouncerSM.c and JetsonSM.c before */
+static uint8_t SwDebounceState;
+
+static void __attribute__((noinline)) SwDebounceRun(ES_Event_t ThisEvent)
+{
+  switch (SwDebounceState)
+  {
+    case D_INIT:
+    {
+      if (ThisEvent.EventType == ES_INIT)
+      {
+        SwDebounceState = D_WAIT;
+      }
+    }
+    break;
+
+    case D_WAIT:
+    {
+      switch (ThisEvent.EventType)
+      {
+        case EV_BUTTON1_DOWN:
+        {
+          StubTimer();
+          SwDebounceState = D_FALL;
+        }
+        break;
+
+        case EV_BUTTON1_UP:
+        {
+          StubTimer();
+          SwDebounceState = D_RISE;
+        }
+        break;
+
+        default:
+          ;
+      }
+    }
+    break;
+
+    case D_FALL:
+    {
+      switch (ThisEvent.EventType)
+      {
+        case EV_BUTTON1_UP:
+        {
+          SwDebounceState = D_WAIT;
+        }
+        break;
+
+        case ES_TIMEOUT:
+        {
+          SwDebounceState = D_WAIT;
+          StubReport(true);
+        }
+        break;
+
+        default:
+          ;
+      }
+    }
+    break;
+
+    case D_RISE:
+    {
+      switch (ThisEvent.EventType)
+      {
+        case EV_BUTTON1_DOWN:
+        {
+          SwDebounceState = D_WAIT;
+        }
+        break;
+
+        case ES_TIMEOUT:
+        {
+          SwDebounceState = D_WAIT;
+          StubReport(false);
+        }
+        break;
+
+        default:
+          ;
+      }
+    }
+    break;
+
+    default:
+      ;
+  }
+}
+
+static uint8_t SwJetsonState;
+static uint8_t SwJetsonMessage;
+
+static void __attribute__((noinline)) SwJetsonRun(ES_Event_t ThisEvent)
+{
+  switch (SwJetsonState)
+  {
+    case J_INIT:
+    {
+      if (ThisEvent.EventType == ES_INIT)
+      {
+        SwJetsonState = J_INACTIVE;
+        SwJetsonMessage = 0;
+      }
+    }
+    break;
+
+    case J_INACTIVE:
+    {
+      if (ThisEvent.EventType == EV_JETSON_MESSAGE_RECEIVED)
+      {
+        if (ThisEvent.EventParam == F_HELLO)
+        {
+          StubReply(0);
+          StubTimer();
+          SwJetsonState = J_PENDING;
+        }
+        else
+        {
+          StubReply(0);
+        }
+      }
+    }
+    break;
+
+    case J_PENDING:
+    {
+      switch (ThisEvent.EventType)
+      {
+        case EV_JETSON_MESSAGE_RECEIVED:
+        {
+          if (ThisEvent.EventParam == F_CONFIRM)
+          {
+            StubLeds(true);
+            StubTimer();
+            SwJetsonState = J_ACTIVE;
+          }
+          else
+          {
+            StubReply(0);
+          }
+        }
+        break;
+
+        case ES_TIMEOUT:
+        {
+          StubLeds(false);
+          SwJetsonState = J_INACTIVE;
+        }
+        break;
+
+        default:
+          ;
+      }
+    }
+    break;
+
+    case J_ACTIVE:
+    {
+      switch (ThisEvent.EventType)
+      {
+        case EV_JETSON_MESSAGE_RECEIVED:
+        {
+          switch (ThisEvent.EventParam)
+          {
+            case F_SHUTDOWN:
+            {
+              StubStop();
+              StubTimer();
+              StubLeds(false);
+              SwJetsonMessage = 0;
+              SwJetsonState = J_INACTIVE;
+            }
+            break;
+
+            case F_DIAG:
+            {
+              StubTimer();
+              StubReply(5);
+            }
+            break;
+
+            case F_VELOCITY:
+            {
+              StubTimer();
+              StubReply(SwJetsonMessage + 1);
+              SwJetsonMessage = (SwJetsonMessage + 1) & 3;
+            }
+            break;
+
+            default:
+              ;
+          }
+        }
+        break;
+
+        case ES_TIMEOUT:
+        {
+          StubStop();
+          StubLeds(false);
+          SwJetsonMessage = 0;
+          SwJetsonState = J_INACTIVE;
+        }
+        break;
+
+        default:
+          ;
+      }
+    }
+    break;
+
+    default:
+      ;
+  }
+}
+
+/* the table forms, as in the services now */
+static ES_Hsm_t TbDebounce;
+
+static void TbDebounceStartTimer(ES_Event_t E) { (void)E; StubTimer(); }
+static void TbDebouncePressed(ES_Event_t E) { (void)E; StubReport(true); }
+static void TbDebounceReleased(ES_Event_t E) { (void)E; StubReport(false); }
+
+static const ES_HsmTransition_t TbDebounceInitTrans[] = {
+  { ES_INIT, D_WAIT, NULL, NULL },
+};
+static const ES_HsmTransition_t TbDebounceWaitTrans[] = {
+  { EV_BUTTON1_DOWN, D_FALL, NULL, NULL },
+  { EV_BUTTON1_UP, D_RISE, NULL, NULL },
+};
+static const ES_HsmTransition_t TbDebounceFallTrans[] = {
+  { EV_BUTTON1_UP, D_WAIT, NULL, NULL },
+  { ES_TIMEOUT, D_WAIT, NULL, TbDebouncePressed },
+};
+static const ES_HsmTransition_t TbDebounceRiseTrans[] = {
+  { EV_BUTTON1_DOWN, D_WAIT, NULL, NULL },
+  { ES_TIMEOUT, D_WAIT, NULL, TbDebounceReleased },
+};
+static const ES_HsmState_t TbDebounceStates[] = {
+  [D_INIT] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE, NULL, NULL,
+      TbDebounceInitTrans),
+  [D_WAIT] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE, NULL, NULL,
+      TbDebounceWaitTrans),
+  [D_FALL] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      TbDebounceStartTimer, NULL, TbDebounceFallTrans),
+  [D_RISE] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      TbDebounceStartTimer, NULL, TbDebounceRiseTrans),
+};
+static const ES_HsmMachine_t TbDebounceMachine = {
+  TbDebounceStates, ARRAY_SIZE(TbDebounceStates), NULL
+};
+
+static void __attribute__((noinline)) TbDebounceRun(ES_Event_t ThisEvent)
+{
+  ES_HsmDispatch(&TbDebounce, ThisEvent);
+}
+
+static ES_Hsm_t TbJetson;
+static uint8_t  TbJetsonMessage;
+
+static bool TbJetsonIsHello(ES_Event_t E) { return E.EventParam == F_HELLO; }
+static bool TbJetsonIsConfirm(ES_Event_t E)
+{
+  return E.EventParam == F_CONFIRM;
+}
+static bool TbJetsonIsShutdown(ES_Event_t E)
+{
+  return E.EventParam == F_SHUTDOWN;
+}
+static bool TbJetsonIsDiag(ES_Event_t E) { return E.EventParam == F_DIAG; }
+static bool TbJetsonIsVelocity(ES_Event_t E)
+{
+  return E.EventParam == F_VELOCITY;
+}
+static void TbJetsonStart(ES_Event_t E) { (void)E; TbJetsonMessage = 0; }
+static void TbJetsonClearReply(ES_Event_t E) { (void)E; StubReply(0); }
+static void TbJetsonEnterInactive(ES_Event_t E) { (void)E; StubLeds(false); }
+static void TbJetsonEnterPending(ES_Event_t E) { (void)E; StubTimer(); }
+static void TbJetsonEnterActive(ES_Event_t E)
+{
+  (void)E;
+  StubLeds(true);
+  StubTimer();
+}
+static void TbJetsonExitActive(ES_Event_t E)
+{
+  (void)E;
+  StubStop();
+  TbJetsonMessage = 0;
+}
+static void TbJetsonShutdown(ES_Event_t E) { (void)E; StubTimer(); }
+static void TbJetsonDiag(ES_Event_t E)
+{
+  (void)E;
+  StubTimer();
+  StubReply(5);
+}
+static void TbJetsonVelocity(ES_Event_t E)
+{
+  (void)E;
+  StubTimer();
+  StubReply(TbJetsonMessage + 1);
+  TbJetsonMessage = (TbJetsonMessage + 1) & 3;
+}
+
+static const ES_HsmTransition_t TbJetsonInitTrans[] = {
+  { ES_INIT, J_INACTIVE, NULL, TbJetsonStart },
+};
+static const ES_HsmTransition_t TbJetsonInactiveTrans[] = {
+  { EV_JETSON_MESSAGE_RECEIVED, J_PENDING, TbJetsonIsHello, TbJetsonClearReply },
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, NULL, TbJetsonClearReply },
+};
+static const ES_HsmTransition_t TbJetsonConnectedTrans[] = {
+  { ES_TIMEOUT, J_INACTIVE, NULL, NULL },
+};
+static const ES_HsmTransition_t TbJetsonPendingTrans[] = {
+  { EV_JETSON_MESSAGE_RECEIVED, J_ACTIVE, TbJetsonIsConfirm, NULL },
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, NULL, TbJetsonClearReply },
+};
+static const ES_HsmTransition_t TbJetsonActiveTrans[] = {
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, TbJetsonIsVelocity,
+    TbJetsonVelocity },
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, TbJetsonIsDiag, TbJetsonDiag },
+  { EV_JETSON_MESSAGE_RECEIVED, J_INACTIVE, TbJetsonIsShutdown,
+    TbJetsonShutdown },
+};
+static const ES_HsmState_t TbJetsonStates[] = {
+  [J_INIT] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE, NULL, NULL,
+      TbJetsonInitTrans),
+  [J_INACTIVE] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      TbJetsonEnterInactive, NULL, TbJetsonInactiveTrans),
+  [J_CONNECTED] = ES_HSM_STATE(ES_HSM_NO_STATE, J_PENDING, NULL, NULL,
+      TbJetsonConnectedTrans),
+  [J_PENDING] = ES_HSM_STATE(J_CONNECTED, ES_HSM_NO_STATE,
+      TbJetsonEnterPending, NULL, TbJetsonPendingTrans),
+  [J_ACTIVE] = ES_HSM_STATE(J_CONNECTED, ES_HSM_NO_STATE, TbJetsonEnterActive,
+      TbJetsonExitActive, TbJetsonActiveTrans),
+};
+static const ES_HsmMachine_t TbJetsonMachine = {
+  TbJetsonStates, ARRAY_SIZE(TbJetsonStates), NULL
+};
+
+static void __attribute__((noinline)) TbJetsonRun(ES_Event_t ThisEvent)
+{
+  ES_HsmDispatch(&TbJetson, ThisEvent);
+}
+
+// a press with a bounce, a clean press and release, a release with a bounce
+static const ES_Event_t DebounceScript[] = {
+  { EV_BUTTON1_DOWN, 0 }, { EV_BUTTON1_UP, 0 }, { EV_BUTTON1_DOWN, 0 },
+  { ES_TIMEOUT, 0 }, { EV_BUTTON1_UP, 0 }, { ES_TIMEOUT, 0 },
+  { EV_BUTTON1_DOWN, 0 }, { ES_TIMEOUT, 0 }, { EV_BUTTON1_UP, 0 },
+  { EV_BUTTON1_DOWN, 0 }, { EV_BUTTON1_UP, 0 }, { ES_TIMEOUT, 0 },
+};
+
+// a session: junk, connect, a stream of velocities with a diagnostics
+// request, shut down, connect again and time out
+static const ES_Event_t JetsonScript[] = {
+  { EV_JETSON_MESSAGE_RECEIVED, F_JUNK },
+  { EV_JETSON_MESSAGE_RECEIVED, F_HELLO },
+  { EV_JETSON_MESSAGE_RECEIVED, F_CONFIRM },
+  { EV_JETSON_MESSAGE_RECEIVED, F_VELOCITY },
+  { EV_JETSON_MESSAGE_RECEIVED, F_VELOCITY },
+  { EV_JETSON_MESSAGE_RECEIVED, F_VELOCITY },
+  { EV_JETSON_MESSAGE_RECEIVED, F_DIAG },
+  { EV_JETSON_MESSAGE_RECEIVED, F_VELOCITY },
+  { EV_JETSON_MESSAGE_RECEIVED, F_VELOCITY },
+  { EV_JETSON_MESSAGE_RECEIVED, F_SHUTDOWN },
+  { EV_JETSON_MESSAGE_RECEIVED, F_HELLO },
+  { EV_JETSON_MESSAGE_RECEIVED, F_CONFIRM },
+  { EV_JETSON_MESSAGE_RECEIVED, F_VELOCITY },
+  { ES_TIMEOUT, 0 },
+};
+
+// runs Script through Run BENCH_PASSES times, returns the time taken and
+// the stub calls made, which have to be the same for both forms
+static uint32_t TimeScript(void (*Run)(ES_Event_t), const ES_Event_t *pScript,
+    uint8_t Length, uint32_t *pCalls)
+{
+  ES_Event_t InitEvent = { ES_INIT, 0 };
+  uint32_t   Start;
+  uint32_t   Pass;
+  uint8_t    i;
+
+  Run(InitEvent);
+  StubCalls = 0;
+  Start = ES_GetBenchCount();
+  for (Pass = 0; Pass < BENCH_PASSES; Pass++)
+  {
+    for (i = 0; i < Length; i++)
+    {
+      Run(pScript[i]);
+    }
+  }
+  Start = ES_GetBenchCount() - Start;
+  *pCalls = StubCalls;
+  return Start;
+}
+
+static void Compare(const char *pName, void (*SwRun)(ES_Event_t),
+    void (*TbRun)(ES_Event_t), const ES_Event_t *pScript, uint8_t Length)
+{
+  uint32_t SwTime, TbTime;
+  uint32_t SwCalls, TbCalls;
+  uint32_t Dispatches = BENCH_PASSES * Length;
+
+  SwTime = TimeScript(SwRun, pScript, Length, &SwCalls);
+  TbTime = TimeScript(TbRun, pScript, Length, &TbCalls);
+  if (SwCalls != TbCalls)
+  {
+    printf("%s: the two forms behave differently, %u vs %u stub calls\r\n",
+        pName, SwCalls, TbCalls);
+    TestFailed = true;
+  }
+  printf("%s: %u dispatches, switch %u.%02u %s each, table %u.%02u %s each\r\n",
+      pName, Dispatches,
+      SwTime / Dispatches, (SwTime % Dispatches) * 100 / Dispatches,
+      ES_BENCH_COUNT_UNITS,
+      TbTime / Dispatches, (TbTime % Dispatches) * 100 / Dispatches,
+      ES_BENCH_COUNT_UNITS);
+}
+
+int main(void)
+{
+  TestOrder();
+
+  SwDebounceState = D_INIT;
+  ES_HsmInit(&TbDebounce, &TbDebounceMachine, D_INIT);
+  Compare("debouncer", SwDebounceRun, TbDebounceRun, DebounceScript,
+      ARRAY_SIZE(DebounceScript));
+
+  SwJetsonState = J_INIT;
+  ES_HsmInit(&TbJetson, &TbJetsonMachine, J_INIT);
+  Compare("jetson", SwJetsonRun, TbJetsonRun, JetsonScript,
+      ARRAY_SIZE(JetsonScript));
+
+  printf("hsm: %s\r\n", TestFailed ? "FAILED" : "passed");
+  return TestFailed ? 1 : 0;
+}
+#endif
+/*------------------------------ End of file ------------------------------*/
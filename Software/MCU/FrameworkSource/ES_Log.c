@@ -0,0 +1,351 @@
+/****************************************************************************
+ Module
+     ES_Log.c
+ Description
+     Deferred logging. ES_LOG call sites store the address of their format
+     string and the raw argument words in a RAM ring instead of formatting,
+     and the ring goes out over the terminal as hex lines when ES_Run is
+     idle. HostTools/es_log.py turns them back into the DB_printf text.
+ Notes
+     Compiled in with ES_LOGGING in ES_Configure.h. A record is a time stamp,
+     up to 3 argument words and the offset of the format string from
+     ES_LogAnchor, so the host can read the string out of the .elf the
+     firmware was built from (the offset, unlike the address, also holds
+     for a position independent host build). Writing one is an atomic
+     increment and a handful of stores, cheap enough for the SPI and ADC
+     ISRs, which could not afford DB_printf.
+     A slot is claimed with an atomic increment of the record count, like
+     ES_Trace.c, and Seq is only set once the rest of the record is in, so
+     the reader can tell a finished record from one an ISR is writing over.
+     Seq is the low bits of the record number + 1, skipping 0, which is the
+     mark of a record being written.
+     When the writers get more than ES_LOG_DEPTH records ahead of the
+     terminal the oldest ones are lost, and the lines say how many:
+       #L  ssss tttttttt ffffffff [aaaaaaaa ...]  low bits of the record
+                                                   number, core timer count,
+                                                   format offset, arguments
+       #LL nnnnnnnn                                records lost before the
+                                                   next #L
+     Each line goes to the terminal in one all-or-nothing write, so other
+     terminal output, from a preempting level or an ISR, can come between
+     lines but never inside one.
+
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_Log.h"
+#include "../FrameworkHeaders/ES_Port.h"
+#include "../FrameworkHeaders/terminal.h"
+
+#if ES_LOGGING
+/*----------------------------- Module Defines ----------------------------*/
+#if (ES_LOG_DEPTH & (ES_LOG_DEPTH - 1)) != 0
+#error "ES_LOG_DEPTH must be a power of 2"
+#endif
+
+// "#L " + Seq + Time + Format + 3 arguments, each with a space, + "\r\n"
+#define LINE_LENGTH (3 + 5 + 9 + 9 + (3 * 9) + 2)
+// "#LL " + count + "\r\n", sent with the line that follows the loss
+#define LOST_LENGTH (4 + 8 + 2)
+// left free in the terminal buffer for everybody else, and for a #LL line
+#define DRAIN_MARGIN 64
+
+#ifdef TEST_LOG
+// the host core timer read is a clock_gettime, which would swamp the rest
+// of ES_LogWrite in the bench. A count stands in for it, the bench times
+// the real read on its own
+#undef ES_GetProfileCount
+#define ES_GetProfileCount() (StubCount++)
+static uint32_t StubCount;
+#endif
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t SeqOf(uint32_t Number);
+static bool WriteRecordLine(uint32_t Number, const ES_LogRecord_t *pRecord);
+static uint8_t PutHex(char *pLine, uint32_t Value, uint8_t Digits);
+static uint8_t PutString(char *pLine, const char *pString);
+
+/*---------------------------- Module Variables ---------------------------*/
+// the format strings go into the same read only data as this
+const char ES_LogAnchor[] = "ES_Log";
+
+static ES_LogRecord_t LogRing[ES_LOG_DEPTH];
+static volatile uint32_t RecordCount;   // records ever made, mod 2^32
+static uint32_t ReadNext;               // next record number to send
+static uint32_t Lost;                   // not yet reported in a #LL line
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_LogWrite
+ Parameters
+   const char * : the DB_printf style format, a string literal
+   uint8_t : how many of the arguments are used
+   uint32_t x3 : the arguments
+ Returns
+   None
+ Description
+   Adds one record to the ring, over the oldest one once it is full.
+   Callable from ISRs.
+ Notes
+   normally used through ES_LOG, which counts the arguments
+****************************************************************************/
+void ES_LogWrite(const char *pFormat, uint8_t NumArgs, uint32_t Arg0,
+    uint32_t Arg1, uint32_t Arg2)
+{
+  uint32_t       Number;
+  ES_LogRecord_t *pRecord;
+
+  Number = ES_AtomicFetchInc(&RecordCount);
+  pRecord = &LogRing[Number & (ES_LOG_DEPTH - 1)];
+  pRecord->Seq = 0;
+  ES_MemoryBarrier();
+  pRecord->Time = ES_GetProfileCount();
+  pRecord->Format = (int32_t)((uintptr_t)pFormat - (uintptr_t)ES_LogAnchor);
+  pRecord->Args[0] = Arg0;
+  pRecord->Args[1] = Arg1;
+  pRecord->Args[2] = Arg2;
+  pRecord->NumArgs = NumArgs;
+  ES_MemoryBarrier();
+  pRecord->Seq = SeqOf(Number);
+}
+
+/****************************************************************************
+ Function
+   ES_LogMoveToTerminal
+ Parameters
+   None
+ Returns
+   bool : true while records are still waiting
+ Description
+   Sends as many records as fit in the terminal buffer. Called from the
+   idle part of ES_Run.
+ Notes
+   Only ISRs (and with ES_PREEMPTIVE the higher levels) can write while
+   this runs, and they finish before it goes on, so a record whose Seq
+   is not the one expected has been written over by a newer one.
+****************************************************************************/
+bool ES_LogMoveToTerminal(void)
+{
+  uint32_t       Count;
+  ES_LogRecord_t *pRecord;
+  ES_LogRecord_t Copy;
+
+  while ((ReadNext != RecordCount) &&
+      (Terminal_GetTxSpace() >= (LINE_LENGTH + DRAIN_MARGIN)))
+  {
+    Count = RecordCount;
+    if ((Count - ReadNext) > ES_LOG_DEPTH)
+    {
+      // lapped, skip to the oldest record still in the ring
+      Lost += Count - ReadNext - ES_LOG_DEPTH;
+      ReadNext = Count - ES_LOG_DEPTH;
+    }
+    pRecord = &LogRing[ReadNext & (ES_LOG_DEPTH - 1)];
+    Copy = *pRecord;
+    ES_MemoryBarrier();
+    if ((Copy.Seq != SeqOf(ReadNext)) || (pRecord->Seq != Copy.Seq))
+    {
+      Lost++;   // written over before or while it was copied
+    }
+    else if (!WriteRecordLine(ReadNext, &Copy))
+    {
+      break;    // a higher level took the room, try again next time
+    }
+    ReadNext++;
+  }
+  return ReadNext != RecordCount;
+}
+
+//*********************************
+// private functions
+//*********************************
+// the Seq of record Number, never 0
+static uint16_t SeqOf(uint32_t Number)
+{
+  uint16_t Seq = (uint16_t)(Number + 1);
+
+  return (Seq != 0) ? Seq : 1;
+}
+
+// builds the line for the record, after a #LL line if any were lost, and
+// sends it in one write. False, and nothing sent, if it did not fit
+static bool WriteRecordLine(uint32_t Number, const ES_LogRecord_t *pRecord)
+{
+  char    Line[LOST_LENGTH + LINE_LENGTH];
+  uint8_t Length = 0;
+  uint8_t i;
+
+  if (Lost != 0)
+  {
+    Length += PutString(&Line[Length], "#LL ");
+    Length += PutHex(&Line[Length], Lost, 8);
+    Length += PutString(&Line[Length], "\r\n");
+  }
+  Length += PutString(&Line[Length], "#L ");
+  // the record number rather than Seq, which skips 0
+  Length += PutHex(&Line[Length], Number + 1, 4);
+  Length += PutString(&Line[Length], " ");
+  Length += PutHex(&Line[Length], pRecord->Time, 8);
+  Length += PutString(&Line[Length], " ");
+  Length += PutHex(&Line[Length], (uint32_t)pRecord->Format, 8);
+  for (i = 0; (i < pRecord->NumArgs) && (i < 3); i++)
+  {
+    Length += PutString(&Line[Length], " ");
+    Length += PutHex(&Line[Length], pRecord->Args[i], 8);
+  }
+  Length += PutString(&Line[Length], "\r\n");
+  if (Terminal_Write((const uint8_t *)Line, Length, TERMINAL_TX_DROP) == 0)
+  {
+    return false;
+  }
+  Lost = 0;
+  return true;
+}
+
+static uint8_t PutHex(char *pLine, uint32_t Value, uint8_t Digits)
+{
+  static const char HexDigits[] = "0123456789abcdef";
+  uint8_t i;
+
+  for (i = 0; i < Digits; i++)
+  {
+    pLine[i] = HexDigits[(Value >> (4 * (Digits - 1 - i))) & 0xF];
+  }
+  return Digits;
+}
+
+static uint8_t PutString(char *pLine, const char *pString)
+{
+  uint8_t Length = 0;
+
+  while (pString[Length] != '\0')
+  {
+    pLine[Length] = pString[Length];
+    Length++;
+  }
+  return Length;
+}
+
+#else
+/* ES_LOGGING is off, ES_LOG is DB_printf and there is nothing to drain */
+bool ES_LogMoveToTerminal(void)
+{
+  return false;
+}
+#endif /* ES_LOGGING */
+
+#ifdef TEST_LOG
+/****************************************************************************
+ The log_check target of Makefile.host. "script" logs a set of lines through
+ ES_LOG and drains them, "printf" prints the same lines with DB_printf, and
+ es_log.py has to turn the first into the second byte for byte. The ring is
+ lapped on purpose at the end, so "printf" leaves out the lines the ring
+ loses, as it does the record left part way through at the Seq wrap. "bench"
+ times ES_LOG, with the time stamp stubbed, against DB_printf and against
+ the core timer read the stub stands in for, on stderr.
+ ****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "../FrameworkHeaders/dbprintf.h"
+
+#if !ES_LOGGING
+#error "TEST_LOG needs ES_LOGGING"
+#endif
+
+#define LAP_LINES   (2 * ES_LOG_DEPTH)
+#define BENCH_CALLS 200000u
+
+// the same line either way
+#define SCRIPT_LOG(...) \
+  do { if (Binary) { ES_LOG(__VA_ARGS__); } else { DB_printf(__VA_ARGS__); } } \
+  while (0)
+
+static void RunScript(bool Binary)
+{
+  uint32_t i;
+
+  // start two records short of where Seq wraps, and leave the record there
+  // as an ISR part way through it would, which has to be skipped
+  RecordCount = 0x10000u - 3u;
+  ReadNext = RecordCount;
+  SCRIPT_LOG("no arguments\n");
+  SCRIPT_LOG("signed %d %d %d\n", 0, -12345, INT_MIN);
+  if (Binary)
+  {
+    LogRing[ES_AtomicFetchInc(&RecordCount) & (ES_LOG_DEPTH - 1)].Seq = 0;
+  }
+  SCRIPT_LOG("unsigned %u hex %x\n", UINT_MAX, 0xbeefu);
+  SCRIPT_LOG("char %c, percent %%, bad %l\r\n", 'A');
+  SCRIPT_LOG("three %d %u %x\r\n", -1, 7u, 255u);
+  SCRIPT_LOG("no newline, ");
+  SCRIPT_LOG("same line\n");
+  while (ES_LogMoveToTerminal())
+  {}
+  // nothing drains here, so the ring only keeps the last ES_LOG_DEPTH
+  for (i = 0; i < LAP_LINES; i++)
+  {
+    if (Binary || (i >= (LAP_LINES - ES_LOG_DEPTH)))
+    {
+      SCRIPT_LOG("lap %u\n", i);
+    }
+  }
+  while (ES_LogMoveToTerminal())
+  {}
+}
+
+static void RunBench(void)
+{
+  uint64_t Start;
+  uint64_t LogNanos;
+  uint64_t PrintfNanos;
+  uint64_t ReadNanos;
+  volatile uint32_t Count;
+  uint32_t i;
+
+  Start = _HW_Host_GetNanos();
+  for (i = 0; i < BENCH_CALLS; i++)
+  {
+    ES_LOG("rx_data: %d\r\n", i);
+  }
+  LogNanos = _HW_Host_GetNanos() - Start;
+  Start = _HW_Host_GetNanos();
+  for (i = 0; i < BENCH_CALLS; i++)
+  {
+    DB_printf("rx_data: %d\r\n", i);
+  }
+  PrintfNanos = _HW_Host_GetNanos() - Start;
+  Start = _HW_Host_GetNanos();
+  for (i = 0; i < BENCH_CALLS; i++)
+  {
+    Count = _CP0_GET_COUNT();
+  }
+  ReadNanos = _HW_Host_GetNanos() - Start;
+  (void)Count;
+  fprintf(stderr, "ES_LOG %u.%u ns per call without the time stamp, "
+      "DB_printf %u ns per call, host core timer read %u ns\n",
+      (unsigned)(LogNanos / BENCH_CALLS),
+      (unsigned)(((LogNanos % BENCH_CALLS) * 10) / BENCH_CALLS),
+      (unsigned)(PrintfNanos / BENCH_CALLS),
+      (unsigned)(ReadNanos / BENCH_CALLS));
+}
+
+int main(int argc, char *argv[])
+{
+  const char *pMode = (argc > 1) ? argv[1] : "script";
+
+  if (strcmp(pMode, "bench") == 0)
+  {
+    RunBench();
+  }
+  else
+  {
+    RunScript(strcmp(pMode, "printf") != 0);
+  }
+  fflush(stdout);
+  return 0;
+}
+#endif /* TEST_LOG */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
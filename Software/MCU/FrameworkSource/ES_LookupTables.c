@@ -101,6 +101,15 @@ uint8_t ES_GetMSBitSet(uint16_t Val2Check)
   return ReturnVal;
 }
 
+uint8_t ES_GetMSBitSet32(uint32_t Val2Check)
+{
+  if ((Val2Check >> 16) != 0)
+  {
+    return ES_GetMSBitSet((uint16_t)(Val2Check >> 16)) + 16;
+  }
+  return ES_GetMSBitSet((uint16_t)Val2Check);
+}
+
 /***************************************************************************
  private functions
  ***************************************************************************/
@@ -0,0 +1,354 @@
+/****************************************************************************
+ Module
+     ES_Pool.c
+ Description
+     Fixed size, reference counted blocks for events whose data does not fit
+     in EventParam
+ Notes
+     The free blocks are the set bits of FreeBlocks. ES_PoolAlloc takes the
+     highest one with a clz and claims it with a compare-and-swap on the
+     whole mask, so it is O(1), safe from any ISR and has no ABA problem.
+     A handle is the block number. ES_PoolAlloc hands the caller one
+     reference. Posting an event whose type is in PAYLOAD_EVENT_LIST adds
+     one per queue it lands in, ES_Run drops that one after the run
+     function, and the block goes back to the pool when the count hits 0.
+     So the usual producer is: alloc, fill, post (to one or all), release.
+     A run function that wants the data for longer takes its own reference.
+
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_Pool.h"
+#include "../FrameworkHeaders/ES_Port.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#if (ES_POOL_NUM_BLOCKS < 1) || (ES_POOL_NUM_BLOCKS > 32)
+#error "ES_POOL_NUM_BLOCKS must be between 1 and 32"
+#endif
+
+#define ALL_BLOCKS ((uint32_t)(0xFFFFFFFFull >> (32 - ES_POOL_NUM_BLOCKS)))
+
+// word sized blocks, so a payload can be read as any type
+#define BLOCK_WORDS ((ES_POOL_BLOCK_SIZE + 3) / 4)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void UpdateHighWater(uint32_t NowInUse);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint32_t PoolMem[ES_POOL_NUM_BLOCKS][BLOCK_WORDS];
+static volatile uint32_t RefCount[ES_POOL_NUM_BLOCKS];
+static volatile uint32_t FreeBlocks = ALL_BLOCKS;
+static volatile uint32_t InUse;
+static volatile uint32_t HighWater;
+static volatile uint32_t AllocFailures;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_PoolInit
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Returns every block to the pool and clears the counters
+ Notes
+   called from ES_Initialize, before any of the services can post
+****************************************************************************/
+void ES_PoolInit(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < ES_POOL_NUM_BLOCKS; i++)
+  {
+    RefCount[i] = 0;
+  }
+  FreeBlocks = ALL_BLOCKS;
+  InUse = 0;
+  ES_PoolResetStats();
+}
+
+/****************************************************************************
+ Function
+   ES_PoolAlloc
+ Parameters
+   None
+ Returns
+   uint16_t : handle of a block holding one reference for the caller,
+              ES_POOL_NO_BLOCK if the pool is empty
+ Description
+   Takes a block from the pool. Callable from ISRs.
+****************************************************************************/
+uint16_t ES_PoolAlloc(void)
+{
+  uint32_t Free;
+  uint8_t  Block;
+
+  do
+  {
+    Free = FreeBlocks;
+    if (Free == 0)
+    {
+      ES_AtomicInc(&AllocFailures);
+      return ES_POOL_NO_BLOCK;
+    }
+    Block = ES_GetMSBit32(Free);
+  } while (!ES_CompareAndSwap(&FreeBlocks, Free, Free & ~(1u << Block)));
+
+  RefCount[Block] = 1;
+  ES_AtomicInc(&InUse);
+  UpdateHighWater(InUse);
+  return Block;
+}
+
+/****************************************************************************
+ Function
+   ES_PoolGetPtr
+ Parameters
+   uint16_t : handle from ES_PoolAlloc (or the EventParam of a payload event)
+ Returns
+   void * : the ES_POOL_BLOCK_SIZE bytes of the block, NULL for a bad handle
+ Description
+   Where to read or write the payload
+****************************************************************************/
+void *ES_PoolGetPtr(uint16_t Handle)
+{
+  if (Handle >= ES_POOL_NUM_BLOCKS)
+  {
+    return NULL;
+  }
+  return PoolMem[Handle];
+}
+
+/****************************************************************************
+ Function
+   ES_PoolAddRef
+ Parameters
+   uint16_t : handle of a block the caller already holds a reference to
+ Returns
+   None
+ Description
+   Adds a reference, ES_Framework does this for every queue a payload event
+   is posted to
+****************************************************************************/
+void ES_PoolAddRef(uint16_t Handle)
+{
+  if (Handle < ES_POOL_NUM_BLOCKS)
+  {
+    ES_AtomicInc(&RefCount[Handle]);
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_PoolRelease
+ Parameters
+   uint16_t : handle of a block the caller holds a reference to
+ Returns
+   None
+ Description
+   Drops a reference, the last one puts the block back in the pool.
+   Callable from ISRs.
+****************************************************************************/
+void ES_PoolRelease(uint16_t Handle)
+{
+  if ((Handle < ES_POOL_NUM_BLOCKS) && (RefCount[Handle] != 0))
+  {
+    if (ES_AtomicDec(&RefCount[Handle]) == 0)
+    {
+      (void)ES_AtomicDec(&InUse);
+      ES_AtomicSetBits(&FreeBlocks, 1u << Handle);
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_EventHasPayload
+ Parameters
+   ES_EventType_t : the event type to check
+ Returns
+   bool : true if events of this type carry a block handle in EventParam
+ Description
+   Tests against PAYLOAD_EVENT_LIST from ES_Configure.h
+****************************************************************************/
+bool ES_EventHasPayload(ES_EventType_t EventType)
+{
+#define ES_PAYLOAD_CASE(Event) case Event:
+  switch (EventType)
+  {
+    PAYLOAD_EVENT_LIST(ES_PAYLOAD_CASE)
+    return true;
+
+    default:
+      return false;
+  }
+#undef ES_PAYLOAD_CASE
+}
+
+/****************************************************************************
+ Function
+   ES_PoolGetStats
+ Parameters
+   ES_PoolStats_t * : where to put the numbers
+ Returns
+   None
+ Description
+   Reports the pool size, use and exhaustion since the last
+   ES_PoolResetStats
+****************************************************************************/
+void ES_PoolGetStats(ES_PoolStats_t *pStats)
+{
+  pStats->NumBlocks = ES_POOL_NUM_BLOCKS;
+  pStats->BlockSize = ES_POOL_BLOCK_SIZE;
+  pStats->InUse = (uint8_t)InUse;
+  pStats->HighWater = (uint8_t)HighWater;
+  pStats->AllocFailures = AllocFailures;
+}
+
+/****************************************************************************
+ Function
+   ES_PoolResetStats
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Starts the high water mark over from the current use and clears the
+   failure count
+****************************************************************************/
+void ES_PoolResetStats(void)
+{
+  HighWater = InUse;
+  AllocFailures = 0;
+}
+
+//*********************************
+// private functions
+//*********************************
+// ISRs allocate too, so only ever raise HighWater with a CAS
+static void UpdateHighWater(uint32_t NowInUse)
+{
+  uint32_t Old;
+
+  do
+  {
+    Old = HighWater;
+    if (NowInUse <= Old)
+    {
+      return;
+    }
+  } while (!ES_CompareAndSwap(&HighWater, Old, NowInUse));
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+#ifdef TEST_POOL
+/* Payload pool harness (make -f Makefile.host pool_stress).
+   Two threads stand in for the main loop and an ISR. Each allocates a
+   few more than half the blocks, so the pool runs dry, stamps every word
+   with its thread and a sequence number, takes 1 to 3 extra references
+   as a multicast post would, then drops them one at a time and checks the
+   stamp is still intact before each. A block handed out twice, or freed
+   while still referenced, shows up as a torn stamp. At the end the pool
+   must be full again. */
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define STRESS_ROUNDS 200000u
+#define NUM_THREADS   2
+#define HOLD_BLOCKS   ((ES_POOL_NUM_BLOCKS / 2) + 1)
+
+static volatile bool StressFailed = false;
+
+// checks the block still holds Stamp, then drops one reference
+static void CheckAndRelease(uint16_t Handle, uint32_t Stamp)
+{
+  uint32_t *pWords = ES_PoolGetPtr(Handle);
+
+  if ((pWords[0] != Stamp) || (pWords[BLOCK_WORDS - 1] != Stamp))
+  {
+    printf("pool: block %u torn, %x != %x\r\n", Handle,
+        pWords[BLOCK_WORDS - 1], Stamp);
+    StressFailed = true;
+  }
+  ES_PoolRelease(Handle);
+}
+
+static void *Worker(void *pArg)
+{
+  uint32_t  Which = (uint32_t)(uintptr_t)pArg;
+  uint32_t  Round;
+  uint32_t  Stamp;
+  uint32_t  *pWords;
+  uint16_t  Held[HOLD_BLOCKS];
+  uint8_t   NumHeld;
+  uint8_t   Refs;
+  uint8_t   i, j;
+
+  for (Round = 0; (Round < STRESS_ROUNDS) && !StressFailed; Round++)
+  {
+    // grab a handful, between the two threads more than the pool has
+    Stamp = (Which << 24) | (Round & 0xFFFFFF);
+    Refs = 1 + (Round % 3);
+    for (NumHeld = 0; NumHeld < HOLD_BLOCKS; NumHeld++)
+    {
+      Held[NumHeld] = ES_PoolAlloc();
+      if (Held[NumHeld] == ES_POOL_NO_BLOCK)
+      {
+        break;
+      }
+      pWords = ES_PoolGetPtr(Held[NumHeld]);
+      for (i = 0; i < BLOCK_WORDS; i++)
+      {
+        pWords[i] = Stamp;
+      }
+      for (i = 0; i < Refs; i++)
+      {
+        ES_PoolAddRef(Held[NumHeld]);
+      }
+    }
+    if ((Round & 0x3F) == 0)
+    {
+      sched_yield(); // hold them across a context switch
+    }
+    for (j = 0; j < NumHeld; j++)
+    {
+      for (i = 0; i <= Refs; i++)
+      {
+        CheckAndRelease(Held[j], Stamp);
+      }
+    }
+  }
+  return NULL;
+}
+
+int main(void)
+{
+  pthread_t      Threads[NUM_THREADS];
+  ES_PoolStats_t Stats;
+  uintptr_t      i;
+
+  ES_PoolInit();
+  for (i = 0; i < NUM_THREADS; i++)
+  {
+    pthread_create(&Threads[i], NULL, Worker, (void *)i);
+  }
+  for (i = 0; i < NUM_THREADS; i++)
+  {
+    pthread_join(Threads[i], NULL);
+  }
+  ES_PoolGetStats(&Stats);
+  if ((Stats.InUse != 0) || (FreeBlocks != ALL_BLOCKS))
+  {
+    printf("pool: %u blocks leaked\r\n", Stats.InUse);
+    StressFailed = true;
+  }
+  printf("pool stress: %u threads x %u rounds, high water %u/%u, "
+      "alloc failures %u: %s\r\n", NUM_THREADS, STRESS_ROUNDS,
+      Stats.HighWater, Stats.NumBlocks, Stats.AllocFailures,
+      StressFailed ? "FAILED" : "passed");
+  return StressFailed ? 1 : 0;
+}
+#endif
+/*------------------------------ End of file ------------------------------*/
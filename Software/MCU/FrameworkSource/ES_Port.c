@@ -101,6 +101,8 @@
 #include "ES_Port.h"        // the header file for this module
 #include "ES_Types.h"       // framework type definitions
 #include "ES_Timers.h"      // framework timer prototypes
+#include "ES_Configure.h"   // for TICKLESS_TIMERS
+#include "ES_Framework.h"   // ES_RunLevel for the software interrupts
 
 #include "terminal.h"       // terminal prototypes for init function
 
@@ -111,7 +113,8 @@
 // need to post events from the interrupt response routine. This is necessary
 // for compilers like HTC for the midrange PICs which do not produce re-entrant
 // code so cannot post directly to the queues from within the interrupt resp.
-static volatile uint8_t TickCount;
+// In the tickless build it can be many ticks, hence the 16 bits.
+static volatile uint16_t TickCount;
 
 // Global tick count to monitor number of SysTick Interrupts
 // make uint16_t to maintain backwards compatibility and not overly burden
@@ -122,6 +125,18 @@ static volatile uint16_t SysTickCounter = 0;
 // ensure the interrupts occur periodically
 static volatile TimerRate_t tickPeriod; 
 
+#if TICKLESS_TIMERS
+// Core timer count at the last whole tick counted into SysTickCounter. The
+// count since then, divided by tickPeriod, is the number of new ticks.
+static volatile uint32_t TickBase;
+
+// the longest the compare is ever pushed out when no timer is due sooner,
+// keeps TickBase well inside the 42s wrap of the core timer
+#define MAX_TICKLESS_TICKS 1000u
+
+static void AccountTicks(void);
+#endif
+
 // This variable is used to store the state of the interrupt mask when
 // doing EnterCritical/ExitCritical pairs
 // uint8_t _INTCON_temp;
@@ -181,6 +196,7 @@ void _PBCLK_Init (void)
       // Do nothing, wait for clock divisor logic to not be switching
   }  
   PB2DIVbits.PBDIV = 0b0000011; // Reduce peripheral clock to 50 MHz (divide by 4)
+  Terminal_SetBaud(TERMINAL_BAUD); // U1BRG was set for the reset PBCLK2
     
   // PBCLK3 (ADC, Comparator, Timers, Output Compare, Input Capture)
   while (!PB3DIVbits.PBDIVRDY) {
@@ -244,6 +260,10 @@ void _HW_Timer_Init(const TimerRate_t Rate)
         
     // get the current sys clock time
     uint32_t currTime = _CP0_GET_COUNT();
+#if TICKLESS_TIMERS
+    // ticks are counted from here
+    TickBase = currTime;
+#endif
     // add the rate to i1t         
     // place value into compare register
     _CP0_SET_COMPARE(currTime + Rate);
@@ -270,6 +290,7 @@ void _HW_Timer_Init(const TimerRate_t Rate)
   
 }
 
+#if !TICKLESS_TIMERS
 /****************************************************************************
  Function
      _HW_SysTickIntHandler
@@ -404,6 +425,138 @@ bool _HW_Process_Pending_Ints(void)
   }
   return true;  // always return true to allow loop test in ES_Run to proceed
 }
+#else
+/****************************************************************************
+ Function
+     _HW_SysTickIntHandler
+ Parameters
+     none
+ Returns
+     None.
+ Description
+     Tickless version of the core timer interrupt response. It only fires
+     when the next framework timer is due (or MAX_TICKLESS_TICKS have gone
+     by), counts however many ticks have elapsed and leaves the timers to
+     _HW_Process_Pending_Ints.
+ Notes
+     The compare is pushed out of the way here, _HW_Process_Pending_Ints
+     sets it to the next expiry once the timers have been advanced.
+****************************************************************************/
+void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
+{
+  IFS0CLR = _IFS0_CTIF_MASK;
+
+  // same reasoning as the ticked version, a higher priority interrupt must
+  // not get in between reading the count and writing the compare
+  EnterCritical();
+  AccountTicks();
+  _CP0_SET_COMPARE(TickBase + (MAX_TICKLESS_TICKS * tickPeriod));
+  ExitCritical();
+
+#ifdef LED_DEBUG
+  // Toggle debug line
+  LATBbits.LATB15 = ~LATBbits.LATB15;
+#endif
+}
+
+/****************************************************************************
+ Function
+    _HW_GetTickCount()
+ Parameters
+    none
+ Returns
+    uint16_t   count of number of system ticks that have occurred.
+ Description
+    Tickless version, brings SysTickCounter up to date from the core timer
+    first since there is no longer an interrupt on every tick to do it.
+ Notes
+    Returns the same value the ticked version would at the same moment.
+****************************************************************************/
+uint16_t _HW_GetTickCount(void)
+{
+  EnterCritical();
+  AccountTicks();
+  ExitCritical();
+  return SysTickCounter;
+}
+
+/****************************************************************************
+ Function
+     _HW_Process_Pending_Ints
+ Parameters
+     none
+ Returns
+     always true.
+ Description
+     Tickless version: counts the ticks elapsed since the last pass,
+     advances every timer by all of them in one step, then programs the core
+     timer compare for the next timer expiry.
+ Notes
+     ES_Run calls this every pass, so a timer started after the compare was
+     programmed is still caught on time by the count check here. The
+     interrupt only has to keep the count fresh while the main loop is
+     blocked.
+****************************************************************************/
+bool _HW_Process_Pending_Ints(void)
+{
+  uint16_t Pending;
+  uint32_t NextTicks;
+  uint32_t NextCompare;
+
+  EnterCritical();
+  AccountTicks();
+  Pending = TickCount;
+  TickCount = 0;
+  ExitCritical();
+
+  if (Pending > 0)
+  {
+    /* call the framework tick response to actually run the timers */
+    ES_Timer_Advance(Pending);
+  }
+
+  NextTicks = ES_Timer_GetTicksToNext();
+  if ((NextTicks == 0) || (NextTicks > MAX_TICKLESS_TICKS))
+  {
+    NextTicks = MAX_TICKLESS_TICKS;
+  }
+  EnterCritical();
+  NextCompare = TickBase + (NextTicks * tickPeriod);
+  if (NextCompare != _CP0_GET_COMPARE())
+  {
+    _CP0_SET_COMPARE(NextCompare);
+  }
+  ExitCritical();
+  return true;  // always return true to allow loop test in ES_Run to proceed
+}
+
+/****************************************************************************
+ Function
+     AccountTicks
+ Parameters
+     none
+ Returns
+     none
+ Description
+     Moves TickBase forward by the whole ticks the core timer has counted
+     since it was last updated and adds them to SysTickCounter and TickCount
+ Notes
+     Must be called with interrupts disabled. The divide is skipped on the
+     common pass where less than a tick has gone by.
+****************************************************************************/
+static void AccountTicks(void)
+{
+  uint32_t Elapsed = _CP0_GET_COUNT() - TickBase;
+
+  if ((tickPeriod != 0) && (Elapsed >= tickPeriod))
+  {
+    Elapsed /= tickPeriod;
+    TickBase += Elapsed * tickPeriod;
+    TickCount += Elapsed;
+    SysTickCounter += Elapsed;
+  }
+}
+#endif /* TICKLESS_TIMERS */
 
 /****************************************************************************
  Function
@@ -424,6 +577,128 @@ void _HW_ConsoleInit(void)
   Terminal_HWInit();
 }
 
+#if ES_PREEMPTIVE
+/****************************************************************************
+ Function
+     _HW_LevelsInit
+ Parameters
+     none
+ Returns
+     None.
+ Description
+     Sets up the two core software interrupts that run the ES_PREEMPTIVE
+     levels: CS0 at IPL1 for level 1 and CS1 at IPL2 for level 2, below
+     every hardware interrupt.
+ Notes
+     Called at the end of ES_Initialize. Levels already pended by the
+     ES_INIT posts are taken as soon as they are enabled.
+ ****************************************************************************/
+void _HW_LevelsInit(void)
+{
+  IPC0bits.CS0IP = 1;
+  IPC0bits.CS0IS = 0;
+  IPC0bits.CS1IP = 2;
+  IPC0bits.CS1IS = 0;
+  IEC0SET = _IEC0_CS0IE_MASK | _IEC0_CS1IE_MASK;
+}
+
+/****************************************************************************
+ Function
+     _HW_PendLevel
+ Parameters
+     uint8_t Level, 1 or 2
+ Returns
+     None.
+ Description
+     Requests the software interrupt that runs a level. It is taken as soon
+     as the interrupt priority drops below the level.
+ Notes
+     The core software interrupts are raised through the IP0/IP1 bits of
+     Cause. Updating them is a read-modify-write of a register ISRs also
+     write, so it is done with interrupts off. Callable from ISRs.
+ ****************************************************************************/
+void _HW_PendLevel(uint8_t Level)
+{
+  uint32_t SavedStatus = __builtin_disable_interrupts();
+
+  _CP0_BIS_CAUSE((Level == 1) ? _CP0_CAUSE_IP0_MASK : _CP0_CAUSE_IP1_MASK);
+  if (SavedStatus & _CP0_STATUS_IE_MASK)
+  {
+    __builtin_enable_interrupts();
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_RaiseLevel
+ Parameters
+     uint8_t Level, the ceiling to raise the interrupt priority to
+ Returns
+     uint32_t the Status to hand to _HW_RestoreLevel
+ Description
+     Keeps the software interrupt levels up to Level from running, without
+     holding off any hardware interrupt. Never lowers the priority, so the
+     calls nest.
+ ****************************************************************************/
+uint32_t _HW_RaiseLevel(uint8_t Level)
+{
+  uint32_t Saved = _CP0_GET_STATUS();
+  uint32_t Ceiling = (uint32_t)Level << _CP0_STATUS_IPL_POSITION;
+
+  if ((Saved & _CP0_STATUS_IPL_MASK) < Ceiling)
+  {
+    _CP0_SET_STATUS((Saved & ~_CP0_STATUS_IPL_MASK) | Ceiling);
+    _ehb();
+  }
+  return Saved;
+}
+
+/****************************************************************************
+ Function
+     _HW_RestoreLevel
+ Parameters
+     uint32_t Saved, what _HW_RaiseLevel returned
+ Returns
+     None.
+ Description
+     Puts the interrupt priority back. A level pended while it was raised
+     is taken on the way out.
+ ****************************************************************************/
+void _HW_RestoreLevel(uint32_t Saved)
+{
+  _CP0_SET_STATUS((_CP0_GET_STATUS() & ~_CP0_STATUS_IPL_MASK) |
+      (Saved & _CP0_STATUS_IPL_MASK));
+  _ehb();
+}
+
+/****************************************************************************
+ Function
+     _HW_Level1Handler, _HW_Level2Handler
+ Description
+     The core software interrupts, each runs its level's services until
+     they are all idle. The request is cleared first, so a post made while
+     they run pends it again. Cause is cleared with interrupts off for the
+     same reason it is set that way in _HW_PendLevel.
+ ****************************************************************************/
+void __ISR(_CORE_SOFTWARE_0_VECTOR, IPL1SOFT) _HW_Level1Handler(void)
+{
+  __builtin_disable_interrupts();
+  _CP0_BIC_CAUSE(_CP0_CAUSE_IP0_MASK);
+  IFS0CLR = _IFS0_CS0IF_MASK;
+  __builtin_enable_interrupts();
+  ES_RunLevel(1);
+}
+
+void __ISR(_CORE_SOFTWARE_1_VECTOR, IPL2SOFT) _HW_Level2Handler(void)
+{
+  __builtin_disable_interrupts();
+  _CP0_BIC_CAUSE(_CP0_CAUSE_IP1_MASK);
+  IFS0CLR = _IFS0_CS1IF_MASK;
+  __builtin_enable_interrupts();
+  ES_RunLevel(2);
+}
+#endif /* ES_PREEMPTIVE */
+
 #if 0 // moved to terminal.c
 /****************************************************************************
  Function
@@ -5,6 +5,16 @@
  Description
      Implements a FIFO circular buffer of EF_Event in a block of memory
  Notes
+     Two flavors of queue share the same API. The original one turns
+     interrupts off around each enqueue/dequeue. The lock-free one (set up
+     with ES_InitLockFreeQueue) needs a power of 2 size of at most 32 and
+     never disables interrupts on the FIFO post path: producers claim a slot
+     by compare-and-swap on the tail, write the event, then publish it by
+     setting the slot's bit in Published. The service's own run function is
+     the only consumer, from ES_Run or, with ES_PREEMPTIVE, ES_RunLevel.
+     The claim is a CAS rather than a plain store because every service
+     here is posted to from both ISRs and the main loop, so there is more
+     than one producer even when there is only one per context.
 
  History
  When           Who     What/Why
@@ -27,11 +37,37 @@ typedef struct
   uint8_t QueueSize;
   uint8_t CurrentIndex;
   uint8_t NumEntries;
+  uint8_t QueueType;
 }ES_Queue_t;
 
 typedef ES_Queue_t *pQueue_t;
 
+// header of a lock-free queue, QueueType must stay at the same offset as in
+// ES_Queue_t. Head and Tail are free running, the slot is (index & Mask)
+typedef struct
+{
+  uint8_t           Mask;
+  volatile uint8_t  Head;       // only written by the consumer
+  volatile uint8_t  Tail;       // claimed by producers with a CAS
+  uint8_t           QueueType;
+  volatile uint32_t Published;  // bit n set when slot n holds a new event
+}ES_LFQueue_t;
+
+typedef ES_LFQueue_t *pLFQueue_t;
+
+#define QUEUE_TYPE_LOCKED   0
+#define QUEUE_TYPE_LOCKFREE 1
+
+// the largest lock-free queue, one bit of Published per slot
+#define MAX_LOCKFREE_SIZE 32
+
+// the header lives in the first element of the block, so it has to fit there
+typedef char LFQueueHeaderFits[(sizeof(ES_LFQueue_t) <= sizeof(ES_Event_t)) ?
+    1 : -1];
+
 /*---------------------------- Module Functions ---------------------------*/
+static bool EnQueueLockFree(ES_Event_t *pBlock, ES_Event_t Event2Add);
+static uint8_t DeQueueLockFree(ES_Event_t *pBlock, ES_Event_t *pReturnEvent);
 
 /*---------------------------- Module Variables ---------------------------*/
 
@@ -64,9 +100,46 @@ uint8_t ES_InitQueue(ES_Event_t *pBlock, uint8_t BlockSize)
   pThisQueue->QueueSize     = BlockSize - 1;
   pThisQueue->CurrentIndex  = 0;
   pThisQueue->NumEntries    = 0;
+  pThisQueue->QueueType     = QUEUE_TYPE_LOCKED;
   return pThisQueue->QueueSize;
 }
 
+/****************************************************************************
+ Function
+   ES_InitLockFreeQueue
+ Parameters
+   EF_Event * pBlock : pointer to the block of memory to use for the Queue
+   unsigned char BlockSize: size of the block pointed to by pBlock
+ Returns
+   max number of entries in the created queue, 0 if BlockSize - 1 is not a
+   power of 2 between 1 and 32
+ Description
+   Initializes a lock-free queue structure at the beginning of the block of
+   memory. After this the block is used with the same Enqueue/DeQueue
+   functions as any other queue.
+ Notes
+   as with ES_InitQueue, declare the array with 1 more element than the
+   number of entries wanted
+****************************************************************************/
+uint8_t ES_InitLockFreeQueue(ES_Event_t *pBlock, uint8_t BlockSize)
+{
+  pLFQueue_t pThisQueue;
+  uint8_t    QueueSize = BlockSize - 1;
+
+  if ((QueueSize == 0) || (QueueSize > MAX_LOCKFREE_SIZE) ||
+      ((QueueSize & (QueueSize - 1)) != 0))
+  {
+    return 0;
+  }
+  pThisQueue = (pLFQueue_t)pBlock;
+  pThisQueue->Mask      = QueueSize - 1;
+  pThisQueue->Head      = 0;
+  pThisQueue->Tail      = 0;
+  pThisQueue->Published = 0;
+  pThisQueue->QueueType = QUEUE_TYPE_LOCKFREE;
+  return QueueSize;
+}
+
 /****************************************************************************
  Function
    ES_EnQueueFIFO
@@ -86,6 +159,10 @@ bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add)
 {
   pQueue_t pThisQueue;
   pThisQueue = (pQueue_t)pBlock;
+  if (pThisQueue->QueueType == QUEUE_TYPE_LOCKFREE)
+  {
+    return EnQueueLockFree(pBlock, Event2Add);
+  }
   // index will go from 0 to QueueSize-1 so use '<' to test if there is space
   if (pThisQueue->NumEntries < pThisQueue->QueueSize) // save the new event, use % to create circular buffer in block
   {   
@@ -117,6 +194,10 @@ bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add)
    it the next event to be removed by a DeQueue operation, that is a
    Last In First Out operation.
  Notes
+   On a lock-free queue this moves Head, which only the consumer may do, so
+   it must only be called from the service's own run function (which is how
+   ES_RecallEvents uses it). It still needs a critical region there since a
+   producer could claim the last free slot between the test and the write.
 
   Author
    J. Edward Carryer, 11/02/13, 14:30
@@ -125,6 +206,24 @@ bool ES_EnQueueLIFO(ES_Event_t *pBlock, ES_Event_t Event2Add)
 {
   pQueue_t pThisQueue;
   pThisQueue = (pQueue_t)pBlock;
+  if (pThisQueue->QueueType == QUEUE_TYPE_LOCKFREE)
+  {
+    pLFQueue_t pLFQueue = (pLFQueue_t)pBlock;
+    uint8_t    Slot;
+    bool       ReturnVal = false;
+
+    EnterCritical();
+    if ((uint8_t)(pLFQueue->Tail - pLFQueue->Head) <= pLFQueue->Mask)
+    {
+      Slot = (uint8_t)(pLFQueue->Head - 1) & pLFQueue->Mask;
+      pBlock[1 + Slot] = Event2Add;
+      pLFQueue->Published |= ((uint32_t)BIT0HI << Slot);
+      pLFQueue->Head--;
+      ReturnVal = true;
+    }
+    ExitCritical();
+    return ReturnVal;
+  }
   // index will go from 0 to QueueSize-1 so use '<' to test if there is space
   if (pThisQueue->NumEntries < pThisQueue->QueueSize)
   {
@@ -176,6 +275,10 @@ uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent)
   uint8_t   NumLeft;
 
   pThisQueue = (pQueue_t)pBlock;
+  if (pThisQueue->QueueType == QUEUE_TYPE_LOCKFREE)
+  {
+    return DeQueueLockFree(pBlock, pReturnEvent);
+  }
   if (pThisQueue->NumEntries > 0)
   {
 #ifdef POST_FROM_INTS
@@ -224,6 +327,10 @@ bool ES_IsQueueEmpty(ES_Event_t *pBlock)
   pQueue_t pThisQueue;
 
   pThisQueue = (pQueue_t)pBlock;
+  if (pThisQueue->QueueType == QUEUE_TYPE_LOCKFREE)
+  {
+    return ((pLFQueue_t)pBlock)->Head == ((pLFQueue_t)pBlock)->Tail;
+  }
   return pThisQueue->NumEntries == 0;
 }
 
@@ -257,6 +364,79 @@ void QueueFlushQueue(uint8_t *pBlock)
 /***************************************************************************
  private functions
  ***************************************************************************/
+/****************************************************************************
+ Function
+   EnQueueLockFree
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event Event2Add : event to be added to the Queue
+ Returns
+   bool : true if the add was successful, false if the queue was full
+ Description
+   claims the slot at Tail with a CAS, fills it, then publishes it. If an
+   ISR posts between the claim and the publish it simply takes the next slot.
+****************************************************************************/
+static bool EnQueueLockFree(ES_Event_t *pBlock, ES_Event_t Event2Add)
+{
+  pLFQueue_t pThisQueue = (pLFQueue_t)pBlock;
+  uint8_t    Slot;
+
+  do
+  {
+    Slot = pThisQueue->Tail;
+    if ((uint8_t)(Slot - pThisQueue->Head) > pThisQueue->Mask)
+    {
+      return false; // full
+    }
+  } while (!ES_CompareAndSwap(&pThisQueue->Tail, Slot, (uint8_t)(Slot + 1)));
+
+  ES_InterruptPoint(); // claimed, not yet published
+  Slot &= pThisQueue->Mask;
+  pBlock[1 + Slot] = Event2Add;
+  // the barrier in the atomic OR orders the event write before the publish
+  ES_AtomicSetBits(&pThisQueue->Published, ((uint32_t)BIT0HI << Slot));
+  return true;
+}
+
+/****************************************************************************
+ Function
+   DeQueueLockFree
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event * pReturnEvent : used to return the event pulled from the queue
+ Returns
+   The number of entries remaining (claimed) in the Queue
+ Description
+   takes the event at Head if it has been published. A slot that has been
+   claimed but not yet published reads as ES_NO_EVENT and is left in place.
+   The consumer must never run while a post it can see is between the claim
+   and the publish, or it finds queued events it can not take. An ISR
+   finishes its post before the consumer can run again, and ES_Framework.c
+   makes every other post at the level of the service posted to, so a post
+   from a lower level can not be preempted there by the consumer.
+****************************************************************************/
+static uint8_t DeQueueLockFree(ES_Event_t *pBlock, ES_Event_t *pReturnEvent)
+{
+  pLFQueue_t pThisQueue = (pLFQueue_t)pBlock;
+  uint8_t    Head = pThisQueue->Head;
+  uint8_t    Slot = Head & pThisQueue->Mask;
+
+  if ((Head != pThisQueue->Tail) &&
+      ((pThisQueue->Published & (((uint32_t)BIT0HI << Slot))) != 0))
+  {
+    *pReturnEvent = pBlock[1 + Slot];
+    // clear the publish bit before handing the slot back to the producers
+    ES_AtomicClrBits(&pThisQueue->Published, ((uint32_t)BIT0HI << Slot));
+    pThisQueue->Head = Head + 1;
+  }
+  else
+  {
+    (*pReturnEvent).EventType   = ES_NO_EVENT;
+    (*pReturnEvent).EventParam  = 0;
+  }
+  return (uint8_t)(pThisQueue->Tail - pThisQueue->Head);
+}
+
 #ifdef TEST
 
 #include <stdio.h>
@@ -330,6 +510,148 @@ void main(void)
   }
 }
 
+#endif
+
+#ifdef TEST_LOCKFREE
+/* Lock-free queue harness (make -f Makefile.host queue_stress).
+   Part 1 times an enqueue + dequeue pair on the critical region queue and on
+   the lock-free queue.
+   Part 2 (host only) hammers one lock-free queue from two producer threads,
+   standing in for the main loop and an ISR, while a third thread consumes.
+   Every event carries its producer and a sequence number so loss,
+   duplication and per-producer reordering are all caught. */
+#include <stdio.h>
+#include "ES_General.h"
+
+#define TIMING_PASSES   100000u
+#define STRESS_EVENTS   200000u
+#define NUM_PRODUCERS   2
+
+static ES_Event_t LockedQueue[4 + 1];
+static ES_Event_t LockFreeQueue[4 + 1];
+
+#ifdef ES_PORT_HOST
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static uint32_t TimePairs(ES_Event_t *pBlock)
+{
+  ES_Event_t MyEvent = { ES_NO_EVENT, 0 };
+  uint32_t   Start;
+  uint32_t   i;
+
+  Start = ES_GetBenchCount();
+  for (i = 0; i < TIMING_PASSES; i++)
+  {
+    MyEvent.EventParam = (uint16_t)i;
+    ES_EnQueueFIFO(pBlock, MyEvent);
+    ES_DeQueue(pBlock, &MyEvent);
+  }
+  return ES_GetBenchCount() - Start;
+}
+
+#ifdef ES_PORT_HOST
+static volatile bool StressFailed = false;
+static volatile uint32_t FullRetries[NUM_PRODUCERS];
+
+static void *Producer(void *pArg)
+{
+  uintptr_t  Which = (uintptr_t)pArg;
+  ES_Event_t MyEvent;
+  uint32_t   i;
+
+  // tag with Which + 1, ES_NO_EVENT (0) means claimed but not yet published
+  MyEvent.EventType = (ES_EventType_t)(Which + 1);
+  for (i = 0; i < STRESS_EVENTS; i++)
+  {
+    MyEvent.EventParam = (uint16_t)i;
+    while (!ES_EnQueueFIFO(LockFreeQueue, MyEvent))
+    {
+      FullRetries[Which]++;
+      sched_yield(); // let the consumer drain, matters on a single core
+    }
+  }
+  return NULL;
+}
+
+static void *Consumer(void *pArg)
+{
+  uint16_t   Expected[NUM_PRODUCERS] = { 0 };
+  uint32_t   Received = 0;
+  unsigned   Which;
+  ES_Event_t MyEvent;
+
+  (void)pArg;
+  while (Received < NUM_PRODUCERS * STRESS_EVENTS)
+  {
+    if (ES_IsQueueEmpty(LockFreeQueue))
+    {
+      sched_yield();
+      continue;
+    }
+    ES_DeQueue(LockFreeQueue, &MyEvent);
+    if (MyEvent.EventType == ES_NO_EVENT)
+    {
+      sched_yield(); // claimed but not yet published, let the producer finish
+      continue;
+    }
+    Which = (unsigned)MyEvent.EventType - 1;
+    if ((Which >= NUM_PRODUCERS) || (MyEvent.EventParam != Expected[Which]))
+    {
+      printf("stress: event %u param %u out of order\r\n",
+          (unsigned)MyEvent.EventType, (unsigned)MyEvent.EventParam);
+      StressFailed = true;
+      return NULL;
+    }
+    Expected[Which]++;
+    Received++;
+  }
+  return NULL;
+}
+#endif
+
+int main(void)
+{
+  uint32_t LockedTime;
+  uint32_t LockFreeTime;
+
+  ES_InitQueue(LockedQueue, ARRAY_SIZE(LockedQueue));
+  ES_InitLockFreeQueue(LockFreeQueue, ARRAY_SIZE(LockFreeQueue));
+
+  LockedTime = TimePairs(LockedQueue);
+  LockFreeTime = TimePairs(LockFreeQueue);
+  printf("enqueue+dequeue x %u, critical region: %u %s, lock-free: %u %s\r\n",
+      TIMING_PASSES, LockedTime, ES_BENCH_COUNT_UNITS, LockFreeTime,
+      ES_BENCH_COUNT_UNITS);
+
+#ifdef ES_PORT_HOST
+  {
+    pthread_t Threads[NUM_PRODUCERS + 1];
+    uintptr_t i;
+
+    ES_InitLockFreeQueue(LockFreeQueue, ARRAY_SIZE(LockFreeQueue));
+    pthread_create(&Threads[NUM_PRODUCERS], NULL, Consumer, NULL);
+    for (i = 0; i < NUM_PRODUCERS; i++)
+    {
+      pthread_create(&Threads[i], NULL, Producer, (void *)i);
+    }
+    for (i = 0; i <= NUM_PRODUCERS; i++)
+    {
+      pthread_join(Threads[i], NULL);
+    }
+    printf("stress: %u producers x %u events, full retries %u/%u: %s\r\n",
+        NUM_PRODUCERS, STRESS_EVENTS, FullRetries[0], FullRetries[1],
+        StressFailed ? "FAILED" : "passed");
+    return StressFailed ? 1 : 0;
+  }
+#else
+  while (1)
+  {
+    ;
+  }
+#endif
+}
 #endif
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
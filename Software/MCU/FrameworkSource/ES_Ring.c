@@ -0,0 +1,660 @@
+/****************************************************************************
+ Module
+     ES_Ring.c
+ Description
+     Single producer, single consumer ring buffers of fixed size elements,
+     with bulk copies and contiguous spans for memcpy or DMA
+ Notes
+     Head and Tail are free running element counts, the slot is the low bits
+     (index & Mask), so the capacity has to be a power of 2 and every slot is
+     used. Only the producer moves Head and only the consumer moves Tail, so
+     one context may put while another gets with no critical region. A
+     barrier orders the element copies before the index store that hands
+     them to the other side. More than one producer (or consumer) has to be
+     serialized by the caller, with a ceiling or a critical region.
+     A full ring refuses new elements, nothing is overwritten. A producer
+     that wants to keep only the newest elements and is also the consumer
+     (a history window) can ES_RingSkip the oldest before it puts.
+     ES_RingWriteSpan/ES_RingCommit and ES_RingPeekSpan/ES_RingSkip hand out
+     the storage itself, which never wraps inside one span, so a caller can
+     fill it or send it without an intermediate copy. A span from the second
+     call picks up where the first one stopped at the end of the storage.
+
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <string.h>
+
+#include "../FrameworkHeaders/ES_Ring.h"
+#include "../FrameworkHeaders/ES_Port.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+static void CopyIn(ES_Ring_t *pRing, uint32_t Index, const uint8_t *pFrom,
+    uint32_t N);
+static void CopyOut(const ES_Ring_t *pRing, uint32_t Index, uint8_t *pTo,
+    uint32_t N);
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_RingInit
+ Parameters
+   ES_Ring_t *pRing : the ring to set up
+   void *pStorage : Capacity elements of ElemSize bytes
+   uint16_t ElemSize : size of one element in bytes
+   uint32_t Capacity : number of elements, a power of 2
+ Returns
+   bool : false if Capacity is not a power of 2 or there is no storage
+ Description
+   Sets up an empty ring over the caller's storage
+****************************************************************************/
+bool ES_RingInit(ES_Ring_t *pRing, void *pStorage, uint16_t ElemSize,
+    uint32_t Capacity)
+{
+  if ((pStorage == NULL) || (ElemSize == 0) || (Capacity == 0) ||
+      ((Capacity & (Capacity - 1)) != 0))
+  {
+    return false;
+  }
+  pRing->pStorage = (uint8_t *)pStorage;
+  pRing->Mask     = Capacity - 1;
+  pRing->ElemSize = ElemSize;
+  pRing->Head     = 0;
+  pRing->Tail     = 0;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_RingReset
+ Parameters
+   ES_Ring_t *pRing : the ring to empty
+ Returns
+   None
+ Description
+   Consumer side, drops everything in the ring
+ Notes
+   a producer that calls it has to hold off the consumer while it does
+****************************************************************************/
+void ES_RingReset(ES_Ring_t *pRing)
+{
+  pRing->Tail = pRing->Head;
+}
+
+/****************************************************************************
+ Function
+   ES_RingCount
+ Parameters
+   const ES_Ring_t *pRing : the ring
+ Returns
+   uint32_t : number of elements waiting to be taken
+****************************************************************************/
+uint32_t ES_RingCount(const ES_Ring_t *pRing)
+{
+  return pRing->Head - pRing->Tail;
+}
+
+/****************************************************************************
+ Function
+   ES_RingSpace
+ Parameters
+   const ES_Ring_t *pRing : the ring
+ Returns
+   uint32_t : number of elements that can be put before the ring is full
+****************************************************************************/
+uint32_t ES_RingSpace(const ES_Ring_t *pRing)
+{
+  return (pRing->Mask + 1) - (pRing->Head - pRing->Tail);
+}
+
+/****************************************************************************
+ Function
+   ES_RingCapacity
+ Parameters
+   const ES_Ring_t *pRing : the ring
+ Returns
+   uint32_t : number of elements the ring holds when full
+****************************************************************************/
+uint32_t ES_RingCapacity(const ES_Ring_t *pRing)
+{
+  return pRing->Mask + 1;
+}
+
+/****************************************************************************
+ Function
+   ES_RingPut
+ Parameters
+   ES_Ring_t *pRing : the ring
+   const void *pElem : the element to copy in
+ Returns
+   bool : false if the ring was full, the element is not stored
+ Description
+   Producer side, adds one element
+****************************************************************************/
+bool ES_RingPut(ES_Ring_t *pRing, const void *pElem)
+{
+  uint32_t Head = pRing->Head;
+
+  if ((Head - pRing->Tail) > pRing->Mask)
+  {
+    return false;
+  }
+  memcpy(&pRing->pStorage[(Head & pRing->Mask) * pRing->ElemSize], pElem,
+      pRing->ElemSize);
+  // the element is in memory before the consumer can see the new head
+  ES_MemoryBarrier();
+  pRing->Head = Head + 1;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_RingPutN
+ Parameters
+   ES_Ring_t *pRing : the ring
+   const void *pElems : N elements to copy in
+   uint32_t N : how many
+ Returns
+   uint32_t : how many went in, fewer than N if the ring filled up
+ Description
+   Producer side, adds as many of the elements as fit, in at most two
+   memcpy's, and publishes them all at once
+****************************************************************************/
+uint32_t ES_RingPutN(ES_Ring_t *pRing, const void *pElems, uint32_t N)
+{
+  uint32_t Head = pRing->Head;
+  uint32_t Space = (pRing->Mask + 1) - (Head - pRing->Tail);
+
+  if (N > Space)
+  {
+    N = Space;
+  }
+  if (N == 0)
+  {
+    return 0;
+  }
+  CopyIn(pRing, Head, (const uint8_t *)pElems, N);
+  ES_MemoryBarrier();
+  pRing->Head = Head + N;
+  return N;
+}
+
+/****************************************************************************
+ Function
+   ES_RingWriteSpan
+ Parameters
+   ES_Ring_t *pRing : the ring
+   uint32_t *pLength : returns the number of elements in the span
+ Returns
+   void * : the first free slot, NULL (and *pLength 0) if the ring is full
+ Description
+   Producer side, the free slots from Head up to the end of the storage or
+   the first unread element, whichever is first. Fill some or all of it,
+   then ES_RingCommit the number filled
+****************************************************************************/
+void *ES_RingWriteSpan(ES_Ring_t *pRing, uint32_t *pLength)
+{
+  uint32_t Head = pRing->Head;
+  uint32_t Space = (pRing->Mask + 1) - (Head - pRing->Tail);
+  uint32_t ToEnd = (pRing->Mask + 1) - (Head & pRing->Mask);
+
+  *pLength = (Space < ToEnd) ? Space : ToEnd;
+  if (*pLength == 0)
+  {
+    return NULL;
+  }
+  return &pRing->pStorage[(Head & pRing->Mask) * pRing->ElemSize];
+}
+
+/****************************************************************************
+ Function
+   ES_RingCommit
+ Parameters
+   ES_Ring_t *pRing : the ring
+   uint32_t N : number of elements filled in the last ES_RingWriteSpan
+ Returns
+   None
+ Description
+   Producer side, hands the filled elements to the consumer
+****************************************************************************/
+void ES_RingCommit(ES_Ring_t *pRing, uint32_t N)
+{
+  ES_MemoryBarrier();
+  pRing->Head += N;
+}
+
+/****************************************************************************
+ Function
+   ES_RingGet
+ Parameters
+   ES_Ring_t *pRing : the ring
+   void *pElem : where to copy the oldest element
+ Returns
+   bool : false if the ring was empty
+ Description
+   Consumer side, takes one element
+****************************************************************************/
+bool ES_RingGet(ES_Ring_t *pRing, void *pElem)
+{
+  uint32_t Tail = pRing->Tail;
+
+  if (Tail == pRing->Head)
+  {
+    return false;
+  }
+  // read the head before the element it covers
+  ES_MemoryBarrier();
+  memcpy(pElem, &pRing->pStorage[(Tail & pRing->Mask) * pRing->ElemSize],
+      pRing->ElemSize);
+  // the copy is done before the producer can reuse the slot
+  ES_MemoryBarrier();
+  pRing->Tail = Tail + 1;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_RingGetN
+ Parameters
+   ES_Ring_t *pRing : the ring
+   void *pElems : room for N elements
+   uint32_t N : how many to take
+ Returns
+   uint32_t : how many were taken, fewer than N if the ring ran out
+ Description
+   Consumer side, takes the oldest elements in at most two memcpy's
+****************************************************************************/
+uint32_t ES_RingGetN(ES_Ring_t *pRing, void *pElems, uint32_t N)
+{
+  N = ES_RingPeekN(pRing, pElems, N);
+  if (N != 0)
+  {
+    ES_MemoryBarrier();
+    pRing->Tail += N;
+  }
+  return N;
+}
+
+/****************************************************************************
+ Function
+   ES_RingPeekN
+ Parameters
+   const ES_Ring_t *pRing : the ring
+   void *pElems : room for N elements
+   uint32_t N : how many to copy
+ Returns
+   uint32_t : how many were copied, fewer than N if the ring ran out
+ Description
+   Consumer side, copies the oldest elements without taking them
+****************************************************************************/
+uint32_t ES_RingPeekN(const ES_Ring_t *pRing, void *pElems, uint32_t N)
+{
+  uint32_t Tail = pRing->Tail;
+  uint32_t Count = pRing->Head - Tail;
+
+  if (N > Count)
+  {
+    N = Count;
+  }
+  if (N == 0)
+  {
+    return 0;
+  }
+  ES_MemoryBarrier();
+  CopyOut(pRing, Tail, (uint8_t *)pElems, N);
+  return N;
+}
+
+/****************************************************************************
+ Function
+   ES_RingPeekSpan
+ Parameters
+   const ES_Ring_t *pRing : the ring
+   uint32_t Offset : elements past the oldest to start at
+   uint32_t *pLength : returns the number of elements in the span
+ Returns
+   void * : the element Offset past the oldest, NULL (and *pLength 0) if
+            there are not more than Offset elements
+ Description
+   Consumer side, the waiting elements from Tail + Offset up to the end of
+   the storage or the newest element, whichever is first. The span stays
+   valid until it is ES_RingSkip'ed. The consumer may change the elements
+   in place
+****************************************************************************/
+void *ES_RingPeekSpan(const ES_Ring_t *pRing, uint32_t Offset,
+    uint32_t *pLength)
+{
+  uint32_t Start = pRing->Tail + Offset;
+  uint32_t Count = pRing->Head - pRing->Tail;
+  uint32_t ToEnd = (pRing->Mask + 1) - (Start & pRing->Mask);
+
+  if (Offset >= Count)
+  {
+    *pLength = 0;
+    return NULL;
+  }
+  Count -= Offset;
+  *pLength = (Count < ToEnd) ? Count : ToEnd;
+  ES_MemoryBarrier();
+  return &pRing->pStorage[(Start & pRing->Mask) * pRing->ElemSize];
+}
+
+/****************************************************************************
+ Function
+   ES_RingSkip
+ Parameters
+   ES_Ring_t *pRing : the ring
+   uint32_t N : how many of the oldest elements to drop
+ Returns
+   None
+ Description
+   Consumer side, drops up to N elements, typically once a span from
+   ES_RingPeekSpan has been used
+****************************************************************************/
+void ES_RingSkip(ES_Ring_t *pRing, uint32_t N)
+{
+  uint32_t Count = pRing->Head - pRing->Tail;
+
+  if (N > Count)
+  {
+    N = Count;
+  }
+  ES_MemoryBarrier();
+  pRing->Tail += N;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// copies N elements into the slots from Index on, the caller has checked
+// there is room
+static void CopyIn(ES_Ring_t *pRing, uint32_t Index, const uint8_t *pFrom,
+    uint32_t N)
+{
+  uint32_t Slot = Index & pRing->Mask;
+  uint32_t First = (pRing->Mask + 1) - Slot;
+
+  if (First > N)
+  {
+    First = N;
+  }
+  memcpy(&pRing->pStorage[Slot * pRing->ElemSize], pFrom,
+      First * pRing->ElemSize);
+  if (N > First)
+  {
+    memcpy(pRing->pStorage, &pFrom[First * pRing->ElemSize],
+        (N - First) * pRing->ElemSize);
+  }
+}
+
+// copies N elements out of the slots from Index on, the caller has checked
+// they are there
+static void CopyOut(const ES_Ring_t *pRing, uint32_t Index, uint8_t *pTo,
+    uint32_t N)
+{
+  uint32_t Slot = Index & pRing->Mask;
+  uint32_t First = (pRing->Mask + 1) - Slot;
+
+  if (First > N)
+  {
+    First = N;
+  }
+  memcpy(pTo, &pRing->pStorage[Slot * pRing->ElemSize],
+      First * pRing->ElemSize);
+  if (N > First)
+  {
+    memcpy(&pTo[First * pRing->ElemSize], pRing->pStorage,
+        (N - First) * pRing->ElemSize);
+  }
+}
+
+#ifdef TEST_RING
+/* Ring buffer harness (make -f Makefile.host ring_bench).
+   Part 1 times the cost per element of moving bytes and int16_t's through
+   a ring one at a time with ES_RingPut/ES_RingGet, in blocks with
+   ES_RingPutN/ES_RingGetN, and through the modulo indexed, overwriting
+   ring that matt_circular_buffer.c used to be.
+   Part 2 (host only) runs a producer and a consumer thread on one byte
+   ring with odd sized blocks, so both wrap all the time, and checks every
+   byte arrives once and in order. */
+#include <stdio.h>
+
+#define TIMING_ELEMS    (1u << 22)
+#define BLOCK_ELEMS     48u
+#define RING_ELEMS      256u
+#define STRESS_BYTES    (1u << 26)
+
+#ifdef ES_PORT_HOST
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ES_RING_DEFINE(ByteRing, uint8_t, RING_ELEMS);
+ES_RING_DEFINE(WordRing, int16_t, RING_ELEMS);
+
+// the old ring, for comparison
+typedef struct
+{
+  int16_t  *buffer;
+  uint16_t head;
+  uint16_t tail;
+  uint16_t max;
+  bool     full;
+}ModuloRing_t;
+
+static int16_t ModuloStorage[RING_ELEMS - 1];
+static ModuloRing_t ModuloRing = { ModuloStorage, 0, 0, RING_ELEMS - 1, false };
+
+static volatile uint32_t Sink; // keeps the optimizer honest
+
+static void ModuloPut(ModuloRing_t *cb, int16_t data)
+{
+  cb->buffer[cb->head] = data;
+  if (cb->full)
+  {
+    cb->tail = (cb->tail + 1) % cb->max;
+  }
+  cb->head = (cb->head + 1) % cb->max;
+  cb->full = (cb->head == cb->tail);
+}
+
+static bool ModuloGet(ModuloRing_t *cb, int16_t *data)
+{
+  if (!cb->full && (cb->head == cb->tail))
+  {
+    return false;
+  }
+  *data = cb->buffer[cb->tail];
+  cb->full = false;
+  cb->tail = (cb->tail + 1) % cb->max;
+  return true;
+}
+
+static void PrintCost(const char *pWhat, uint32_t Time)
+{
+  printf("%-28s %6.2f %s/element\r\n", pWhat,
+      (double)Time / TIMING_ELEMS, ES_BENCH_COUNT_UNITS);
+}
+
+static void TimeSingle(ES_Ring_t *pRing, const char *pWhat)
+{
+  uint8_t  Elem[sizeof(int16_t)] = { 0 };
+  uint32_t Start;
+  uint32_t i;
+
+  Start = ES_GetBenchCount();
+  for (i = 0; i < TIMING_ELEMS; i++)
+  {
+    Elem[0] = (uint8_t)i;
+    ES_RingPut(pRing, Elem);
+    ES_RingGet(pRing, Elem);
+    Sink += Elem[0];
+  }
+  PrintCost(pWhat, ES_GetBenchCount() - Start);
+}
+
+static void TimeBulk(ES_Ring_t *pRing, const char *pWhat)
+{
+  static int16_t Block[BLOCK_ELEMS];
+  uint32_t       Start;
+  uint32_t       i;
+
+  Start = ES_GetBenchCount();
+  for (i = 0; i < TIMING_ELEMS; i += BLOCK_ELEMS)
+  {
+    Block[0] = (int16_t)i;
+    ES_RingPutN(pRing, Block, BLOCK_ELEMS);
+    ES_RingGetN(pRing, Block, BLOCK_ELEMS);
+    Sink += (uint32_t)Block[0];
+  }
+  PrintCost(pWhat, ES_GetBenchCount() - Start);
+}
+
+static void TimeModulo(void)
+{
+  int16_t  Elem = 0;
+  uint32_t Start;
+  uint32_t i;
+
+  Start = ES_GetBenchCount();
+  for (i = 0; i < TIMING_ELEMS; i++)
+  {
+    ModuloPut(&ModuloRing, (int16_t)i);
+    ModuloGet(&ModuloRing, &Elem);
+    Sink += (uint32_t)Elem;
+  }
+  PrintCost("int16_t, modulo ring", ES_GetBenchCount() - Start);
+}
+
+#ifdef ES_PORT_HOST
+static volatile bool StressFailed = false;
+
+static void *Producer(void *pArg)
+{
+  uint8_t  Block[61];
+  uint32_t Sent = 0;
+  uint32_t Length;
+  uint32_t Put;
+  uint32_t i;
+
+  (void)pArg;
+  while ((Sent < STRESS_BYTES) && !StressFailed)
+  {
+    // alternate the copy and the span forms, in blocks of 1 to 61 bytes
+    Length = 1 + (Sent % 61);
+    if (Length > (STRESS_BYTES - Sent))
+    {
+      Length = STRESS_BYTES - Sent;
+    }
+    if (Sent & 1)
+    {
+      for (i = 0; i < Length; i++)
+      {
+        Block[i] = (uint8_t)(Sent + i);
+      }
+      Put = ES_RingPutN(&ByteRing, Block, Length);
+    }
+    else
+    {
+      uint8_t *pSpan = ES_RingWriteSpan(&ByteRing, &Put);
+
+      if (Put > Length)
+      {
+        Put = Length;
+      }
+      for (i = 0; i < Put; i++)
+      {
+        pSpan[i] = (uint8_t)(Sent + i);
+      }
+      ES_RingCommit(&ByteRing, Put);
+    }
+    if (Put == 0)
+    {
+      sched_yield(); // full, let the consumer drain, matters on a single core
+    }
+    Sent += Put;
+  }
+  return NULL;
+}
+
+static void *Consumer(void *pArg)
+{
+  uint8_t  Block[37];
+  uint8_t  *pFrom;
+  uint32_t Received = 0;
+  uint32_t Length;
+  uint32_t i;
+
+  (void)pArg;
+  while ((Received < STRESS_BYTES) && !StressFailed)
+  {
+    if (Received & 1)
+    {
+      Length = ES_RingGetN(&ByteRing, Block, sizeof(Block));
+      pFrom = Block;
+    }
+    else
+    {
+      pFrom = ES_RingPeekSpan(&ByteRing, 0, &Length);
+    }
+    if (Length == 0)
+    {
+      sched_yield();
+      continue;
+    }
+    for (i = 0; i < Length; i++)
+    {
+      if (pFrom[i] != (uint8_t)(Received + i))
+      {
+        printf("stress: byte %u is %u\r\n", Received + i, pFrom[i]);
+        StressFailed = true;
+        break;
+      }
+    }
+    if (pFrom != Block)
+    {
+      ES_RingSkip(&ByteRing, Length);
+    }
+    Received += Length;
+  }
+  return NULL;
+}
+#endif
+
+int main(void)
+{
+  ES_RingInitStatic(ByteRing);
+  ES_RingInitStatic(WordRing);
+
+  TimeSingle(&ByteRing, "uint8_t, ES_RingPut/Get");
+  TimeSingle(&WordRing, "int16_t, ES_RingPut/Get");
+  TimeBulk(&WordRing, "int16_t, ES_RingPutN/GetN");
+  TimeModulo();
+
+#ifdef ES_PORT_HOST
+  {
+    pthread_t Threads[2];
+
+    ES_RingReset(&ByteRing);
+    pthread_create(&Threads[0], NULL, Consumer, NULL);
+    pthread_create(&Threads[1], NULL, Producer, NULL);
+    pthread_join(Threads[1], NULL);
+    pthread_join(Threads[0], NULL);
+    printf("stress: %u bytes through %u: %s\r\n", STRESS_BYTES, RING_ELEMS,
+        (StressFailed || (ES_RingCount(&ByteRing) != 0)) ? "FAILED" :
+        "passed");
+    return StressFailed ? 1 : 0;
+  }
+#else
+  while (1)
+  {
+    ;
+  }
+#endif
+}
+#endif
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,237 @@
+/****************************************************************************
+ Module
+     ES_Snapshot.c
+ Description
+     Snapshots: a value of any size that one context publishes and any other
+     reads whole, with no critical region on either side
+ Notes
+     A sequence lock over two buffers. Seq counts the values published, and
+     the newest one is in buffer Seq & 1. The writer fills the other buffer
+     and then moves Seq on, so the buffer a reader is sent to is never the
+     one being written. A reader copies the buffer and reads Seq again, and
+     copies again if it moved. It takes two publishes during a copy to
+     overwrite the buffer being copied, one is enough to copy again. A
+     reader that interrupts the writer gets the last value in one copy, so
+     it is never kept waiting, and the writer never waits for a reader.
+     Barriers order the copies against the stores and loads of Seq.
+     There has to be one writer at a time. Writers at different levels have
+     to hold each other off, with a ceiling or by masking the interrupt.
+
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <string.h>
+
+#include "../FrameworkHeaders/ES_Snapshot.h"
+#include "../FrameworkHeaders/ES_Port.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_SnapshotPublish
+ Parameters
+   ES_Snapshot_t *pSnapshot : the snapshot
+   const void *pValue : the new value, pSnapshot->Size bytes
+ Returns
+   None
+ Description
+   Writer side, makes pValue the value readers get from now on
+****************************************************************************/
+void ES_SnapshotPublish(ES_Snapshot_t *pSnapshot, const void *pValue)
+{
+  uint32_t Next = pSnapshot->Seq + 1;
+
+  memcpy(pSnapshot->pBuffers + (Next & 1) * pSnapshot->Size, pValue,
+      pSnapshot->Size);
+  ES_MemoryBarrier(); // the value is in before the readers are sent to it
+  pSnapshot->Seq = Next;
+}
+
+/****************************************************************************
+ Function
+   ES_SnapshotRead
+ Parameters
+   const ES_Snapshot_t *pSnapshot : the snapshot
+   void *pValue : where to copy the value, pSnapshot->Size bytes
+ Returns
+   uint32_t : how many values had been published, 0 for none
+ Description
+   Reader side, copies the newest value, all of it from one publish. Can be
+   called from any level, including one that interrupts the writer
+****************************************************************************/
+uint32_t ES_SnapshotRead(const ES_Snapshot_t *pSnapshot, void *pValue)
+{
+  uint32_t Seq;
+
+  do
+  {
+    Seq = pSnapshot->Seq;
+    ES_MemoryBarrier(); // Seq is read before the buffer it names
+    memcpy(pValue, pSnapshot->pBuffers + (Seq & 1) * pSnapshot->Size,
+        pSnapshot->Size);
+    ES_MemoryBarrier(); // and the buffer is read before Seq again
+  } while (pSnapshot->Seq != Seq);
+  return Seq;
+}
+
+#ifdef TEST_SNAPSHOT
+/* Snapshot harness (make -f Makefile.host snapshot_stress).
+   Part 1 times a publish and a read of a 24 byte value, the size of
+   MotorSM's odometry.
+   Part 2 (host only) has a writer thread publish values whose every word
+   is worked out from the publish count, and reader threads check that each
+   value they read is whole and from the publish the count says, and that
+   the count never goes back. */
+#include <stdio.h>
+
+#define TIMING_VALUES   (1u << 22)
+#define STRESS_VALUES   (1u << 24)
+#define STRESS_READERS  2
+#define VALUE_WORDS     6
+
+typedef struct
+{
+  uint32_t Words[VALUE_WORDS];
+}Value_t;
+
+#ifdef ES_PORT_HOST
+#include <pthread.h>
+#endif
+
+ES_SNAPSHOT_DEFINE(TestSnapshot, Value_t);
+
+static volatile uint32_t Sink;
+
+// the value of publish N, each word different
+static void MakeValue(Value_t *pValue, uint32_t N)
+{
+  uint8_t i;
+
+  for (i = 0; i < VALUE_WORDS; i++)
+  {
+    pValue->Words[i] = N * (2 * i + 3) + i;
+  }
+}
+
+static void PrintCost(const char *pWhat, uint32_t Counts)
+{
+  printf("%s: %u.%02u " ES_BENCH_COUNT_UNITS " each\r\n", pWhat,
+      Counts / TIMING_VALUES,
+      (uint32_t)(((uint64_t)(Counts % TIMING_VALUES) * 100) / TIMING_VALUES));
+}
+
+static void TimePublishRead(void)
+{
+  Value_t  Value;
+  uint32_t Start;
+  uint32_t i;
+
+  MakeValue(&Value, 1);
+  Start = ES_GetBenchCount();
+  for (i = 0; i < TIMING_VALUES; i++)
+  {
+    Value.Words[0] = i;
+    ES_SnapshotPublish(&TestSnapshot, &Value);
+  }
+  PrintCost("ES_SnapshotPublish", ES_GetBenchCount() - Start);
+
+  Start = ES_GetBenchCount();
+  for (i = 0; i < TIMING_VALUES; i++)
+  {
+    ES_SnapshotRead(&TestSnapshot, &Value);
+    Sink += Value.Words[0];
+  }
+  PrintCost("ES_SnapshotRead", ES_GetBenchCount() - Start);
+}
+
+#ifdef ES_PORT_HOST
+static volatile bool StressFailed = false;
+static volatile bool WriterDone = false;
+static uint32_t Reads[STRESS_READERS];
+
+static void *Writer(void *pArg)
+{
+  Value_t  Value;
+  uint32_t N;
+
+  (void)pArg;
+  for (N = TestSnapshot.Seq + 1; (N <= STRESS_VALUES) && !StressFailed; N++)
+  {
+    MakeValue(&Value, N);
+    ES_SnapshotPublish(&TestSnapshot, &Value);
+  }
+  WriterDone = true;
+  return NULL;
+}
+
+static void *Reader(void *pArg)
+{
+  uint32_t *pReads = pArg;
+  Value_t  Value;
+  Value_t  Expected;
+  uint32_t Seq;
+  uint32_t Previous = 0;
+
+  while (!WriterDone && !StressFailed)
+  {
+    Seq = ES_SnapshotRead(&TestSnapshot, &Value);
+    MakeValue(&Expected, Seq);
+    if (memcmp(&Value, &Expected, sizeof(Value)) != 0)
+    {
+      printf("stress: value read for publish %u is torn\r\n", Seq);
+      StressFailed = true;
+    }
+    else if (Seq < Previous)
+    {
+      printf("stress: publish %u read after %u\r\n", Seq, Previous);
+      StressFailed = true;
+    }
+    Previous = Seq;
+    (*pReads)++;
+  }
+  return NULL;
+}
+#endif
+
+int main(void)
+{
+  TimePublishRead();
+
+#ifdef ES_PORT_HOST
+  {
+    pthread_t Threads[STRESS_READERS + 1];
+    Value_t   Value;
+    uint32_t  i;
+
+    // start over at a count the values check against
+    MakeValue(&Value, TestSnapshot.Seq + 1);
+    ES_SnapshotPublish(&TestSnapshot, &Value);
+    for (i = 0; i < STRESS_READERS; i++)
+    {
+      pthread_create(&Threads[i], NULL, Reader, &Reads[i]);
+    }
+    pthread_create(&Threads[STRESS_READERS], NULL, Writer, NULL);
+    for (i = 0; i <= STRESS_READERS; i++)
+    {
+      pthread_join(Threads[i], NULL);
+    }
+    printf("stress: %u publishes, %u and %u reads: %s\r\n",
+        TestSnapshot.Seq, Reads[0], Reads[1],
+        StressFailed ? "FAILED" : "passed");
+    return StressFailed ? 1 : 0;
+  }
+#else
+  while (1)
+  {
+    ;
+  }
+#endif
+}
+#endif
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -3,12 +3,23 @@
      ES_Timers.c
 
  Description
-     This is a module implementing  8 16 bit timers all using the RTI
+     This is a module implementing NUM_TIMERS 16 bit timers all using the RTI
      timebase
 
  Notes
      Everything is done in terms of RTI Ticks, which can change from
      application to application.
+     The active timers are kept in a delta list sorted by expiry, each entry
+     holding the ticks from the expiry of the one before it. A tick only has
+     to decrement the head of the list, so its cost does not grow with the
+     number of running timers. Starting and stopping walk the list instead,
+     which happens in the services rather than on every tick. Both run from
+     the main loop (the tick response is called from
+     _HW_Process_Pending_Ints), so the list needs no critical regions.
+     With ES_PREEMPTIVE the services above level 0 start and stop timers
+     from their software interrupts, so everything that touches the list
+     does it under a ceiling of ES_MAX_LEVEL. The timeouts posted to those
+     services run as soon as the tick response is done with the list.
 
  History
  When           Who     What/Why
@@ -50,48 +61,46 @@
 #include "../FrameworkHeaders/ES_LookupTables.h"
 #include "../FrameworkHeaders/ES_Timers.h"
 #include "../FrameworkHeaders/ES_Port.h"
+#include "../FrameworkHeaders/ES_Trace.h"
 /*--------------------------- External Variables --------------------------*/
 
 /*----------------------------- Module Defines ----------------------------*/
+// marks the end of the delta list and unlinked entries
+#define NO_TIMER 0xFF
 
-/*------------------------------ Module Types -----------------------------*/
+#if (NUM_TIMERS != 16) && (NUM_TIMERS != 32) && (NUM_TIMERS != 48) && \
+  (NUM_TIMERS != 64)
+#error NUM_TIMERS must be 16, 32, 48 or 64
+#endif
 
-/*
-   the size of Tflag sets the number of timers, uint8 = 8, uint16 = 16 ...)
-   to add more timers, you will need to change the data type and modify
-   the initialization of TMR_TimerArray and TMR_MaskArray
-*/
-
-typedef uint16_t Tflag_t;
+/*------------------------------ Module Types -----------------------------*/
 
 typedef uint16_t Timer_t; // sets size of timers to 16 bits
 
+typedef uint8_t TimerNum_t; // index into the timer arrays, NO_TIMER for none
+
 /*---------------------------- Module Functions ---------------------------*/
+static void LinkTimer(TimerNum_t Num, Timer_t Ticks);
+static void UnlinkTimer(TimerNum_t Num);
+static Timer_t GetRemaining(TimerNum_t Num);
 
 /*---------------------------- Module Variables ---------------------------*/
-static Timer_t TMR_TimerArray[sizeof(Tflag_t) * BITS_PER_BYTE] =
-{
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0
-};
+/*
+   For an active timer this holds the number of ticks between the expiry of
+   the timer before it in the delta list and its own expiry. For a stopped
+   timer it holds the ticks it still has to run, so StartTimer resumes it
+   where it left off, just as the old count-down array did.
+*/
+static Timer_t TMR_TimerArray[NUM_TIMERS];
 
-static Tflag_t TMR_ActiveFlags;
+// doubly linked delta list of the active timers, soonest expiry first
+static TimerNum_t TMR_Next[NUM_TIMERS];
+static TimerNum_t TMR_Prev[NUM_TIMERS];
+static TimerNum_t TMR_ListHead = NO_TIMER;
+static bool TMR_IsActive[NUM_TIMERS];
 
-static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
+#ifndef TEST_TIMERS
+static pPostFunc const Timer2PostFunc[NUM_TIMERS] =
 {
   TIMER0_RESP_FUNC,
   TIMER1_RESP_FUNC,
@@ -108,8 +117,70 @@ static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
   TIMER12_RESP_FUNC,
   TIMER13_RESP_FUNC,
   TIMER14_RESP_FUNC,
-  TIMER15_RESP_FUNC
+  TIMER15_RESP_FUNC,
+#if NUM_TIMERS > 16
+  TIMER16_RESP_FUNC,
+  TIMER17_RESP_FUNC,
+  TIMER18_RESP_FUNC,
+  TIMER19_RESP_FUNC,
+  TIMER20_RESP_FUNC,
+  TIMER21_RESP_FUNC,
+  TIMER22_RESP_FUNC,
+  TIMER23_RESP_FUNC,
+  TIMER24_RESP_FUNC,
+  TIMER25_RESP_FUNC,
+  TIMER26_RESP_FUNC,
+  TIMER27_RESP_FUNC,
+  TIMER28_RESP_FUNC,
+  TIMER29_RESP_FUNC,
+  TIMER30_RESP_FUNC,
+  TIMER31_RESP_FUNC,
+#endif
+#if NUM_TIMERS > 32
+  TIMER32_RESP_FUNC,
+  TIMER33_RESP_FUNC,
+  TIMER34_RESP_FUNC,
+  TIMER35_RESP_FUNC,
+  TIMER36_RESP_FUNC,
+  TIMER37_RESP_FUNC,
+  TIMER38_RESP_FUNC,
+  TIMER39_RESP_FUNC,
+  TIMER40_RESP_FUNC,
+  TIMER41_RESP_FUNC,
+  TIMER42_RESP_FUNC,
+  TIMER43_RESP_FUNC,
+  TIMER44_RESP_FUNC,
+  TIMER45_RESP_FUNC,
+  TIMER46_RESP_FUNC,
+  TIMER47_RESP_FUNC,
+#endif
+#if NUM_TIMERS > 48
+  TIMER48_RESP_FUNC,
+  TIMER49_RESP_FUNC,
+  TIMER50_RESP_FUNC,
+  TIMER51_RESP_FUNC,
+  TIMER52_RESP_FUNC,
+  TIMER53_RESP_FUNC,
+  TIMER54_RESP_FUNC,
+  TIMER55_RESP_FUNC,
+  TIMER56_RESP_FUNC,
+  TIMER57_RESP_FUNC,
+  TIMER58_RESP_FUNC,
+  TIMER59_RESP_FUNC,
+  TIMER60_RESP_FUNC,
+  TIMER61_RESP_FUNC,
+  TIMER62_RESP_FUNC,
+  TIMER63_RESP_FUNC,
+#endif
 };
+#else
+// the harness routes every timer to its own counter so all can be armed
+static bool PostTestTimeout(ES_Event_t ThisEvent);
+static pPostFunc const Timer2PostFunc[NUM_TIMERS] =
+{
+  [0 ... (NUM_TIMERS - 1)] = PostTestTimeout
+};
+#endif
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -130,6 +201,17 @@ static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
 ****************************************************************************/
 void ES_Timer_Init(TimerRate_t Rate)
 {
+  uint8_t i;
+
+  // start with every timer stopped and the delta list empty
+  for (i = 0; i < NUM_TIMERS; i++)
+  {
+    TMR_TimerArray[i] = 0;
+    TMR_Next[i] = NO_TIMER;
+    TMR_Prev[i] = NO_TIMER;
+    TMR_IsActive[i] = false;
+  }
+  TMR_ListHead = NO_TIMER;
   // call the hardware init routine
   _HW_Timer_Init(Rate);
 }
@@ -146,12 +228,15 @@ void ES_Timer_Init(TimerRate_t Rate)
  Description
      sets the time for a timer, but does not make it active.
  Notes
-     None.
+     As before, setting the time on a timer that is already running restarts
+     its count from NewTime and leaves it running.
  Author
      J. Edward Carryer, 02/24/97 17:11
 ****************************************************************************/
 ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
 {
+  ES_Ceiling_t Saved;
+
   /* tried to set a timer that doesn't exist */
   if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
       /* tried to set a timer without a service */
@@ -160,7 +245,17 @@ ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
   {
     return ES_Timer_ERR;
   }
-  TMR_TimerArray[Num] = NewTime;
+  Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+  if (TMR_IsActive[Num])
+  {
+    UnlinkTimer(Num);
+    LinkTimer(Num, NewTime);
+  }
+  else
+  {
+    TMR_TimerArray[Num] = NewTime;
+  }
+  ES_ExitCeiling(Saved);
   return ES_Timer_OK;
 }
 
@@ -172,8 +267,8 @@ ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
  Returns
      ES_Timer_ERR for error ES_Timer_OK for success
  Description
-     simply sets the active flag in TMR_ActiveFlags to (re)start a
-     stopped timer.
+     links a stopped timer back into the delta list with whatever time it
+     had left, starting an already running timer has no effect.
  Notes
      None.
  Author
@@ -181,15 +276,26 @@ ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
 ****************************************************************************/
 ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
 {
-  /* tried to set a timer that doesn't exist */
-  if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
-      /* tried to set a timer with no time on it */
-      (TMR_TimerArray[Num] == 0))
+  ES_Ceiling_t     Saved;
+  ES_TimerReturn_t ReturnVal = ES_Timer_OK;
+
+  if (Num >= ARRAY_SIZE(TMR_TimerArray))
   {
-    return ES_Timer_ERR;
+    return ES_Timer_ERR;  /* tried to set a timer that doesn't exist */
   }
-  TMR_ActiveFlags |= BitNum2SetMask[Num];  /* set timer as active */
-  return ES_Timer_OK;
+  Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+  /* tried to set a timer with no time on it (a running timer's delta
+     can legitimately be 0) */
+  if (!TMR_IsActive[Num] && (TMR_TimerArray[Num] == 0))
+  {
+    ReturnVal = ES_Timer_ERR;
+  }
+  else if (!TMR_IsActive[Num])
+  {
+    LinkTimer(Num, TMR_TimerArray[Num]);  /* set timer as active */
+  }
+  ES_ExitCeiling(Saved);
+  return ReturnVal;
 }
 
 /****************************************************************************
@@ -200,8 +306,8 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
  Returns
      ES_Timer_ERR for error (timer doesn't exist) ES_Timer_OK for success.
  Description
-     simply clears the bit in TMR_ActiveFlags associated with this
-     timer. This will cause it to stop counting.
+     takes the timer out of the delta list, saving the time it had left.
+     This will cause it to stop counting.
  Notes
      None.
  Author
@@ -209,11 +315,21 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
 ****************************************************************************/
 ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
 {
+  ES_Ceiling_t Saved;
+
   if (Num >= ARRAY_SIZE(TMR_TimerArray))
   {
     return ES_Timer_ERR;    /* tried to set a timer that doesn't exist */
   }
-  TMR_ActiveFlags &= BitNum2ClrMask[Num];  /* set timer as inactive */
+  Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+  if (TMR_IsActive[Num])
+  {
+    Timer_t Remaining = GetRemaining(Num);
+
+    UnlinkTimer(Num);             /* set timer as inactive */
+    TMR_TimerArray[Num] = Remaining;
+  }
+  ES_ExitCeiling(Saved);
   return ES_Timer_OK;
 }
 
@@ -235,6 +351,8 @@ ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
 ****************************************************************************/
 ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
 {
+  ES_Ceiling_t Saved;
+
   /* tried to set a timer that doesn't exist */
   if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
       /* tried to set a timer without a service */
@@ -244,8 +362,13 @@ ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
   {
     return ES_Timer_ERR;
   }
-  TMR_TimerArray[Num] = NewTime;
-  TMR_ActiveFlags     |= BitNum2SetMask[Num]; /* set timer as active */
+  Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+  if (TMR_IsActive[Num])
+  {
+    UnlinkTimer(Num);
+  }
+  LinkTimer(Num, NewTime);  /* set timer as active */
+  ES_ExitCeiling(Saved);
   return ES_Timer_OK;
 }
 
@@ -279,45 +402,411 @@ uint16_t ES_Timer_GetTime(void)
      None.
  Description
      This is the new Tick response routine to support the timer module.
-     It will increment time, to maintain the functionality of the
-     GetTime() timer and it will check through the active timers,
-     decrementing each active timers count, if the count goes to 0, it
-     will post an event to the corresponding SM and clear the active flag to
-     prevent further counting.
+     It counts the whole delta list down by one tick, posting an event to
+     the corresponding SM for every timer that times out.
  Notes
      Called from _Timer_Int_Resp in ES_Port.c.
+     The cost no longer depends on the number of active timers, only on the
+     number that expire on this tick. Timers that expire on the same tick
+     are posted in the order they were started.
  Author
      J. Edward Carryer, 02/24/97 15:06
 ****************************************************************************/
 void ES_Timer_Tick_Resp(void)
 {
-  static Tflag_t  NeedsProcessing;
-  static uint8_t  NextTimer2Process;
+  ES_Timer_Advance(1);
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_Advance
+ Parameters
+     uint16_t Ticks, the number of ticks that have gone by
+ Returns
+     None.
+ Description
+     Moves every active timer forward by Ticks in one step. The timers that
+     run out are unlinked and their timeout events posted in expiry order,
+     exactly as Ticks calls to ES_Timer_Tick_Resp would have.
+ Notes
+     This is the tick response for the tickless port, which only interrupts
+     when the next timer is due and then catches up on all of the elapsed
+     ticks at once.
+****************************************************************************/
+void ES_Timer_Advance(uint16_t Ticks)
+{
   static ES_Event_t NewEvent;
+  TimerNum_t        Expired;
+  ES_Ceiling_t      Saved = ES_EnterCeiling(ES_MAX_LEVEL);
 
-  if (TMR_ActiveFlags != 0) /* if !=0 , then at least 1 timer is active */
+  while ((TMR_ListHead != NO_TIMER) && (Ticks >= TMR_TimerArray[TMR_ListHead]))
   {
-    // start by getting a list of all the active timers
-    NeedsProcessing = TMR_ActiveFlags;
-    do
+    /* take it off the list first, with nothing left to hand on */
+    Expired = TMR_ListHead;
+    Ticks -= TMR_TimerArray[Expired];
+    TMR_TimerArray[Expired] = 0;
+    UnlinkTimer(Expired);
+    NewEvent.EventType  = ES_TIMEOUT;
+    NewEvent.EventParam = Expired;
+    ES_TRACE_EVENT(ES_TRACE_TIMER_EXPIRED, Expired, NewEvent, 0);
+    /* post the timeout event to the right Service */
+    Timer2PostFunc[Expired](NewEvent);
+  }
+  if (TMR_ListHead != NO_TIMER)
+  {
+    TMR_TimerArray[TMR_ListHead] -= Ticks;
+  }
+  ES_ExitCeiling(Saved);
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetTicksToNext
+ Parameters
+     None.
+ Returns
+     uint16_t ticks until the next timer times out, 0 if none are running
+ Description
+     Lets the tickless port program the next interrupt for the next expiry
+ Notes
+     Counted from the last tick passed to ES_Timer_Advance/Tick_Resp
+****************************************************************************/
+uint16_t ES_Timer_GetTicksToNext(void)
+{
+  uint16_t     Ticks = 0;
+  ES_Ceiling_t Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+
+  if (TMR_ListHead != NO_TIMER)
+  {
+    Ticks = TMR_TimerArray[TMR_ListHead];
+  }
+  ES_ExitCeiling(Saved);
+  return Ticks;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+/* inserts Num into the delta list so that it expires Ticks from now. Walks
+   the list, so the cost is paid by the service starting the timer rather
+   than by every tick. A timer goes after any that expire on the same tick.
+*/
+static void LinkTimer(TimerNum_t Num, Timer_t Ticks)
+{
+  TimerNum_t Prev = NO_TIMER;
+  TimerNum_t Next = TMR_ListHead;
+
+  while ((Next != NO_TIMER) && (Ticks >= TMR_TimerArray[Next]))
+  {
+    Ticks -= TMR_TimerArray[Next];
+    Prev = Next;
+    Next = TMR_Next[Next];
+  }
+  TMR_TimerArray[Num] = Ticks;
+  TMR_Prev[Num] = Prev;
+  TMR_Next[Num] = Next;
+  if (Next != NO_TIMER)
+  {
+    // the following timer now counts from our expiry
+    TMR_TimerArray[Next] -= Ticks;
+    TMR_Prev[Next] = Num;
+  }
+  if (Prev != NO_TIMER)
+  {
+    TMR_Next[Prev] = Num;
+  }
+  else
+  {
+    TMR_ListHead = Num;
+  }
+  TMR_IsActive[Num] = true;
+}
+
+/* removes an active timer from the delta list, handing its delta on to the
+   timer after it so that one still expires on time
+*/
+static void UnlinkTimer(TimerNum_t Num)
+{
+  TimerNum_t Prev = TMR_Prev[Num];
+  TimerNum_t Next = TMR_Next[Num];
+
+  if (Next != NO_TIMER)
+  {
+    TMR_TimerArray[Next] += TMR_TimerArray[Num];
+    TMR_Prev[Next] = Prev;
+  }
+  if (Prev != NO_TIMER)
+  {
+    TMR_Next[Prev] = Next;
+  }
+  else
+  {
+    TMR_ListHead = Next;
+  }
+  TMR_Next[Num] = NO_TIMER;
+  TMR_Prev[Num] = NO_TIMER;
+  TMR_IsActive[Num] = false;
+}
+
+/* ticks left before an active timer expires, the sum of its delta and the
+   deltas of every timer ahead of it
+*/
+static Timer_t GetRemaining(TimerNum_t Num)
+{
+  Timer_t Remaining = 0;
+
+  while (Num != NO_TIMER)
+  {
+    Remaining += TMR_TimerArray[Num];
+    Num = TMR_Prev[Num];
+  }
+  return Remaining;
+}
+
+#ifdef TEST_TIMERS
+/* Timer engine harness (make -f Makefile.host timer_bench).
+   Part 1 runs a long pseudo-random mix of Init/Set/Start/Stop calls against
+   a plain count-down model of the old timer array and checks that the same
+   timers time out on the same ticks with the same return codes.
+   Part 2 times the tick response against the number of active timers, next
+   to the old walk over every active timer for comparison.
+   With "trace" as its argument (host only) it instead drives the port's
+   _HW_Process_Pending_Ints through a scripted run of timer calls and clock
+   jumps, printing ES_Timer_GetTime and the timeouts after every step.
+   make -f Makefile.host tickless_check runs that against a ticked and a
+   tickless build and compares the two traces.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#define MODEL_TICKS   200000u
+#define BENCH_TICKS   50000u
+#define MAX_TEST_TIME 300u
+#define TRACE_STEPS   20000u
+
+static uint64_t Fired;  // bit n set when timer n posted its timeout
+static bool     Tracing = false;
+
+static bool PostTestTimeout(ES_Event_t ThisEvent)
+{
+  Fired |= (uint64_t)1 << ThisEvent.EventParam;
+  if (Tracing)
+  {
+    printf(" %u", (unsigned)ThisEvent.EventParam);
+  }
+  return true;
+}
+
+static uint32_t Random(void)
+{
+  static uint32_t Seed = 12345;
+
+  Seed = Seed * 1103515245u + 12345u;
+  return Seed >> 16;
+}
+
+static bool ModelCheck(void)
+{
+  static Timer_t ModelTime[NUM_TIMERS];
+  static bool    ModelActive[NUM_TIMERS];
+  uint64_t         Expected;
+  ES_TimerReturn_t Returned;
+  ES_TimerReturn_t ModelReturned;
+  uint32_t         Tick;
+  uint8_t          Num;
+  Timer_t          NewTime;
+
+  ES_Timer_Init(ES_Timer_RATE_OFF);
+  for (Tick = 0; Tick < MODEL_TICKS; Tick++)
+  {
+    // a few API calls between most ticks
+    while ((Random() % 4) != 0)
     {
-      // find the MSB that is set
-      NextTimer2Process = ES_GetMSBitSet(NeedsProcessing);
-      /* decrement that timer, check if timed out */
-      if (--TMR_TimerArray[NextTimer2Process] == 0)
+      Num = Random() % NUM_TIMERS;
+      NewTime = 1 + (Random() % MAX_TEST_TIME);
+      ModelReturned = ES_Timer_OK;
+      switch (Random() % 4)
       {
-        NewEvent.EventType  = ES_TIMEOUT;
-        NewEvent.EventParam = NextTimer2Process;
-        /* post the timeout event to the right Service */
-        Timer2PostFunc[NextTimer2Process](NewEvent);
-        /* and stop counting */
-        TMR_ActiveFlags &= BitNum2ClrMask[NextTimer2Process];
+        case 0:
+        {
+          Returned = ES_Timer_InitTimer(Num, NewTime);
+          ModelTime[Num] = NewTime;
+          ModelActive[Num] = true;
+        }
+        break;
+        case 1:
+        {
+          Returned = ES_Timer_SetTimer(Num, NewTime);
+          ModelTime[Num] = NewTime;
+        }
+        break;
+        case 2:
+        {
+          Returned = ES_Timer_StartTimer(Num);
+          if (ModelTime[Num] == 0)
+          {
+            ModelReturned = ES_Timer_ERR;
+          }
+          else
+          {
+            ModelActive[Num] = true;
+          }
+        }
+        break;
+        default:
+        {
+          Returned = ES_Timer_StopTimer(Num);
+          ModelActive[Num] = false;
+        }
+        break;
       }
-      // mark off the active timer that we just processed
-      NeedsProcessing &= BitNum2ClrMask[NextTimer2Process];
-    } while (NeedsProcessing != 0);
+      if (Returned != ModelReturned)
+      {
+        printf("model: tick %u timer %u returned %d, expected %d\r\n",
+            Tick, Num, Returned, ModelReturned);
+        return false;
+      }
+    }
+    // the old engine: count every active timer down
+    Expected = 0;
+    for (Num = 0; Num < NUM_TIMERS; Num++)
+    {
+      if (ModelActive[Num] && (--ModelTime[Num] == 0))
+      {
+        Expected |= (uint64_t)1 << Num;
+        ModelActive[Num] = false;
+      }
+    }
+    Fired = 0;
+    ES_Timer_Tick_Resp();
+    if (Fired != Expected)
+    {
+      printf("model: tick %u fired %llx, expected %llx\r\n", Tick,
+          (unsigned long long)Fired, (unsigned long long)Expected);
+      return false;
+    }
+  }
+  return true;
+}
+
+// the tick response this module used to have, for comparison
+static Timer_t  OldTimerArray[NUM_TIMERS];
+static uint64_t OldActiveFlags;
+
+static void OldTickResp(void)
+{
+  uint64_t NeedsProcessing = OldActiveFlags;
+  uint8_t  Next;
+
+  while (NeedsProcessing != 0)
+  {
+    Next = 63 - __builtin_clzll(NeedsProcessing);
+    if (--OldTimerArray[Next] == 0)
+    {
+      Fired |= (uint64_t)1 << Next;
+      OldActiveFlags &= ~((uint64_t)1 << Next);
+    }
+    NeedsProcessing &= ~((uint64_t)1 << Next);
+  }
+}
+
+#ifdef ES_PORT_HOST
+static void RunTrace(void)
+{
+  uint32_t Step;
+  uint32_t Counts;
+  uint8_t  Num;
+
+  _HW_PIC32Init();
+  _HW_Host_SetTimeScale(0);
+  ES_Timer_Init(ES_Timer_RATE_1mS);
+  Tracing = true;
+  for (Step = 0; Step < TRACE_STEPS; Step++)
+  {
+    // now and then start or stop a timer
+    if ((Random() % 4) == 0)
+    {
+      Num = Random() % NUM_TIMERS;
+      if ((Random() % 4) == 0)
+      {
+        ES_Timer_StopTimer(Num);
+      }
+      else
+      {
+        ES_Timer_InitTimer(Num, 1 + (Random() % MAX_TEST_TIME));
+      }
+    }
+    // mostly less than a tick at a time, sometimes a long block
+    Counts = (Random() << 16) | Random();
+    if ((Random() % 32) == 0)
+    {
+      _HW_Host_AdvanceTime(Counts % (ES_Timer_RATE_1mS * 50));
+    }
+    else
+    {
+      _HW_Host_AdvanceTime(Counts % (ES_Timer_RATE_1mS * 3 / 2));
+    }
+    printf("%u:", Step);
+    _HW_Process_Pending_Ints();
+    printf(" @%u\n", (unsigned)ES_Timer_GetTime());
+  }
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  uint32_t NewTime;
+  uint32_t OldTime;
+  uint32_t Start;
+  uint32_t i;
+  uint8_t  NumActive;
+  uint8_t  Num;
+
+#ifdef ES_PORT_HOST
+  if ((argc > 1) && (strcmp(argv[1], "trace") == 0))
+  {
+    RunTrace();
+    return 0;
+  }
+#endif
+  (void)argc;
+  (void)argv;
+  printf("delta list vs count-down model, %u ticks: %s\r\n", MODEL_TICKS,
+      ModelCheck() ? "passed" : "FAILED");
+
+  printf("tick response cost (%s per tick) vs active timers\r\n",
+      ES_BENCH_COUNT_UNITS);
+  printf("active  delta list  old walk\r\n");
+  for (NumActive = 1; NumActive <= NUM_TIMERS; NumActive *= 2)
+  {
+    // long times, so nothing expires while we are timing
+    ES_Timer_Init(ES_Timer_RATE_OFF);
+    OldActiveFlags = 0;
+    for (Num = 0; Num < NumActive; Num++)
+    {
+      ES_Timer_InitTimer(Num, 60000 - Num);
+      OldTimerArray[Num] = 60000 - Num;
+      OldActiveFlags |= (uint64_t)1 << Num;
+    }
+    Start = ES_GetBenchCount();
+    for (i = 0; i < BENCH_TICKS; i++)
+    {
+      ES_Timer_Tick_Resp();
+    }
+    NewTime = ES_GetBenchCount() - Start;
+    Start = ES_GetBenchCount();
+    for (i = 0; i < BENCH_TICKS; i++)
+    {
+      OldTickResp();
+    }
+    OldTime = ES_GetBenchCount() - Start;
+    printf("%6u  %10.1f  %8.1f\r\n", NumActive,
+        (double)NewTime / BENCH_TICKS, (double)OldTime / BENCH_TICKS);
   }
+  return 0;
 }
+#endif
 
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
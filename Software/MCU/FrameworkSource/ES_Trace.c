@@ -0,0 +1,287 @@
+/****************************************************************************
+ Module
+     ES_Trace.c
+ Description
+     Records what the framework does (posts, dispatches, run function entry
+     and exit, timer expiries) in a RAM ring with core timer time stamps,
+     and sends the ring out over the terminal on request
+ Notes
+     Compiled in with ES_TRACE in ES_Configure.h. The ring keeps the last
+     ES_TRACE_DEPTH records. A slot is claimed with an atomic increment of
+     the record count, so ISRs can record at any time.
+     The dump is sent a line at a time from the idle part of ES_Run, only
+     as fast as the terminal buffer drains, and recording stops until it is
+     done so the ring holds still. Each line is built in a local buffer and
+     sent with one all-or-nothing Terminal_Write, so DB_printf output from
+     the services can come between lines but never inside one. A line that
+     does not fit waits for the next call, the #TH header too. Each #T line
+     is one ES_TraceRecord_t as hex:
+       #TH vv ss nnnnnnnn rrrrrrrr llllllll   version, record size, number of
+                                              records, core timer counts/s,
+                                              records lost to wrap around
+       #T  <record, 2 hex digits per byte, in ES_TraceRecord_t order>
+       #TE
+     HostTools/es_trace.py turns a captured log into Perfetto/Chrome JSON
+     and into a replay script for the host build.
+
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "../FrameworkHeaders/ES_Configure.h"
+#include "../FrameworkHeaders/ES_Trace.h"
+#include "../FrameworkHeaders/ES_Port.h"
+#include "../FrameworkHeaders/terminal.h"
+
+#if ES_TRACE
+/*----------------------------- Module Defines ----------------------------*/
+#if (ES_TRACE_DEPTH & (ES_TRACE_DEPTH - 1)) != 0
+#error "ES_TRACE_DEPTH must be a power of 2"
+#endif
+
+#define TRACE_VERSION 1
+#define TRACE_COUNTS_PER_SEC 100000000u   // core timer, SYSCLK/2
+
+// "#T " + 2 hex digits per record byte + "\r\n"
+#define LINE_LENGTH (3 + (2 * sizeof(ES_TraceRecord_t)) + 2)
+// "\r\n#TH " + version + size + count + rate + lost, each with a space,
+// + "\r\n"
+#define HEADER_LENGTH (6 + 2 + 3 + 9 + 9 + 9 + 2)
+// left free in the terminal buffer for everybody else during a dump
+#define DUMP_MARGIN 64
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool WriteHeaderLine(void);
+static bool WriteRecordLine(const ES_TraceRecord_t *pRecord);
+static bool WriteLine(const char *pLine, uint8_t Length);
+static uint8_t PutHex(char *pLine, uint32_t Value, uint8_t Digits);
+static uint8_t PutString(char *pLine, const char *pString);
+
+/*---------------------------- Module Variables ---------------------------*/
+static ES_TraceRecord_t TraceRing[ES_TRACE_DEPTH];
+static volatile uint32_t RecordCount;   // records ever made, mod 2^32
+static volatile bool Dumping = false;
+static bool HeaderSent;                 // the #TH line of this dump is out
+static uint32_t DumpNext;               // next record number to send
+static uint32_t DumpEnd;                // one past the last one to send
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_TraceRecord
+ Parameters
+   ES_TraceKind_t : what happened
+   uint8_t : the service (or timer) it happened to
+   ES_Event_t : the event involved
+   uint8_t : queue depth, for ES_TRACE_DEQUEUE
+ Returns
+   None
+ Description
+   Adds one record to the ring, over the oldest one once it is full.
+   Callable from ISRs.
+ Notes
+   normally used through ES_TRACE_EVENT, which compiles away when ES_TRACE
+   is false
+****************************************************************************/
+void ES_TraceRecord(ES_TraceKind_t Kind, uint8_t Which, ES_Event_t ThisEvent,
+    uint8_t Depth)
+{
+  uint32_t         Seq;
+  ES_TraceRecord_t *pRecord;
+
+  if (Dumping)
+  {
+    return;
+  }
+  Seq = ES_AtomicFetchInc(&RecordCount);
+  pRecord = &TraceRing[Seq & (ES_TRACE_DEPTH - 1)];
+  pRecord->Time = ES_GetProfileCount();
+  pRecord->Param = ThisEvent.EventParam;
+  pRecord->Type = (uint8_t)ThisEvent.EventType;
+  pRecord->Kind = (uint8_t)Kind | (ES_InISR() ? ES_TRACE_FROM_ISR : 0);
+  pRecord->Which = Which;
+  pRecord->Depth = Depth;
+  pRecord->Seq = (uint16_t)Seq;
+}
+
+/****************************************************************************
+ Function
+   ES_TraceClear
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Empties the ring, so the next dump starts from now
+****************************************************************************/
+void ES_TraceClear(void)
+{
+  RecordCount = 0;
+}
+
+/****************************************************************************
+ Function
+   ES_TraceStartDump
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Stops recording and queues up the whole ring to go out over the
+   terminal, ES_TraceMoveToTerminal does the sending
+****************************************************************************/
+void ES_TraceStartDump(void)
+{
+  if (Dumping)
+  {
+    return;
+  }
+  Dumping = true;
+  DumpEnd = RecordCount;
+  if (DumpEnd > ES_TRACE_DEPTH)
+  {
+    DumpNext = DumpEnd - ES_TRACE_DEPTH;
+  }
+  else
+  {
+    DumpNext = 0;
+  }
+  HeaderSent = WriteHeaderLine();
+}
+
+/****************************************************************************
+ Function
+   ES_TraceMoveToTerminal
+ Parameters
+   None
+ Returns
+   bool : true while a dump is still going
+ Description
+   Sends as many dump lines as fit in the terminal buffer, then recording
+   starts again once the last one is out. Called from the idle part of
+   ES_Run.
+****************************************************************************/
+bool ES_TraceMoveToTerminal(void)
+{
+  if (!Dumping)
+  {
+    return false;
+  }
+  if (!HeaderSent)
+  {
+    HeaderSent = WriteHeaderLine();
+    if (!HeaderSent)
+    {
+      return true;
+    }
+  }
+  while ((DumpNext != DumpEnd) &&
+      (Terminal_GetTxSpace() >= (LINE_LENGTH + DUMP_MARGIN)))
+  {
+    if (!WriteRecordLine(&TraceRing[DumpNext & (ES_TRACE_DEPTH - 1)]))
+    {
+      break;    // a higher level took the room, try again next time
+    }
+    DumpNext++;
+  }
+  if ((DumpNext == DumpEnd) && WriteLine("#TE\r\n", 5))
+  {
+    Dumping = false;
+  }
+  return Dumping;
+}
+
+//*********************************
+// private functions
+//*********************************
+// the #TH line, after a line break in case the terminal is mid line.
+// False, and nothing sent, if it did not fit
+static bool WriteHeaderLine(void)
+{
+  char    Line[HEADER_LENGTH];
+  uint8_t Length = 0;
+
+  Length += PutString(&Line[Length], "\r\n#TH ");
+  Length += PutHex(&Line[Length], TRACE_VERSION, 2);
+  Length += PutString(&Line[Length], " ");
+  Length += PutHex(&Line[Length], sizeof(ES_TraceRecord_t), 2);
+  Length += PutString(&Line[Length], " ");
+  Length += PutHex(&Line[Length], DumpEnd - DumpNext, 8);
+  Length += PutString(&Line[Length], " ");
+  Length += PutHex(&Line[Length], TRACE_COUNTS_PER_SEC, 8);
+  Length += PutString(&Line[Length], " ");
+  Length += PutHex(&Line[Length], DumpNext, 8);
+  Length += PutString(&Line[Length], "\r\n");
+  return WriteLine(Line, Length);
+}
+
+// the bytes go out least significant first whatever the CPU, so the host
+// tool only has one layout to read. False, and nothing sent, if it did not
+// fit
+static bool WriteRecordLine(const ES_TraceRecord_t *pRecord)
+{
+  char    Line[LINE_LENGTH];
+  uint8_t Length = 0;
+  uint8_t i;
+
+  Length += PutString(&Line[Length], "#T ");
+  for (i = 0; i < 4; i++)
+  {
+    Length += PutHex(&Line[Length], pRecord->Time >> (8 * i), 2);
+  }
+  Length += PutHex(&Line[Length], pRecord->Param, 2);
+  Length += PutHex(&Line[Length], pRecord->Param >> 8, 2);
+  Length += PutHex(&Line[Length], pRecord->Type, 2);
+  Length += PutHex(&Line[Length], pRecord->Kind, 2);
+  Length += PutHex(&Line[Length], pRecord->Which, 2);
+  Length += PutHex(&Line[Length], pRecord->Depth, 2);
+  Length += PutHex(&Line[Length], pRecord->Seq, 2);
+  Length += PutHex(&Line[Length], pRecord->Seq >> 8, 2);
+  Length += PutString(&Line[Length], "\r\n");
+  return WriteLine(Line, Length);
+}
+
+static bool WriteLine(const char *pLine, uint8_t Length)
+{
+  return Terminal_Write((const uint8_t *)pLine, Length, TERMINAL_TX_DROP) != 0;
+}
+
+static uint8_t PutHex(char *pLine, uint32_t Value, uint8_t Digits)
+{
+  static const char HexDigits[] = "0123456789abcdef";
+  uint8_t i;
+
+  for (i = 0; i < Digits; i++)
+  {
+    pLine[i] = HexDigits[(Value >> (4 * (Digits - 1 - i))) & 0xF];
+  }
+  return Digits;
+}
+
+static uint8_t PutString(char *pLine, const char *pString)
+{
+  uint8_t Length = 0;
+
+  while (pString[Length] != '\0')
+  {
+    pLine[Length] = pString[Length];
+    Length++;
+  }
+  return Length;
+}
+
+#else
+/* ES_TRACE is off, keep the calls in UsbService and ES_Run harmless */
+void ES_TraceClear(void)
+{
+}
+
+void ES_TraceStartDump(void)
+{
+}
+
+bool ES_TraceMoveToTerminal(void)
+{
+  return false;
+}
+#endif /* ES_TRACE */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
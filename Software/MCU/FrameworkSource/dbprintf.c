@@ -15,7 +15,12 @@
     The maximum line length from a single call to DB_printf() is LINE_LEN
     characters. This is the size of an allocated buffer. If you exceed this,
     you will overrun the stack. The length of any number field in the
-    resulting line can not be longer than FIELD_LEN.
+    resulting line can not be longer than FIELD_LEN. Each \n takes two, it
+    is expanded to \r\n as the line is built.
+    The line goes to the terminal in one Terminal_Write, so nothing else can
+    print into the middle of it. DB_printf drops a line that does not fit
+    in the transmit buffer (TERMINAL_TX_DEFAULT), DB_printfPolicy lets the
+    caller choose.
 
  History
  When           Who     What/Why
@@ -43,6 +48,8 @@
 #define CR 0x0d
 #define LF 0x0a
 /*---------------------------- Module Functions ---------------------------*/
+static void FormatAndSend(Terminal_TxPolicy_t Policy, const char *Format,
+    va_list Arguments);
 static void uitoa(char **buf, unsigned int i, unsigned int baseNum);
 
 /*---------------------------- Module Variables ---------------------------*/
@@ -73,19 +80,56 @@ static void uitoa(char **buf, unsigned int i, unsigned int baseNum);
 void DB_printf(const char *Format, ...)
 {
   va_list Arguments;
+
+  va_start(Arguments,Format);
+  FormatAndSend(TERMINAL_TX_DEFAULT, Format, Arguments);
+  va_end(Arguments);
+}
+
+/****************************************************************************
+ Function
+    DB_printfPolicy
+
+ Parameters
+    Terminal_TxPolicy_t : what to do if the line does not fit in the
+    terminal transmit buffer, then the DB_printf arguments
+
+ Returns
+    None.
+
+ Description
+    DB_printf for callers that would rather wait (TERMINAL_TX_BLOCK) or send
+    part of the line (TERMINAL_TX_PARTIAL) than lose it
+****************************************************************************/
+void DB_printfPolicy(Terminal_TxPolicy_t Policy, const char *Format, ...)
+{
+  va_list Arguments;
+
+  va_start(Arguments,Format);
+  FormatAndSend(Policy, Format, Arguments);
+  va_end(Arguments);
+}
+
+/* builds the line and hands it to the terminal */
+static void FormatAndSend(Terminal_TxPolicy_t Policy, const char *Format,
+    va_list Arguments)
+{
   char *pBuffer;
   char *pString;
   int   i;
 	unsigned int u;
   char  LineBuffer[LINE_LEN+1];
 
-  va_start(Arguments,Format);
   pBuffer = LineBuffer;
   *pBuffer = 0;                 /* make sure that Line starts out NULL term */
   while (*Format)               /* step through the format string */
   {    
     if (*Format != '%')            /* if not a format specifier */
     {      
+      if (*Format == '\n')
+      {
+        *pBuffer++ = CR;
+      }
       *pBuffer++ = *Format++;  /* simply copy to the output buffer */
     }else
     {
@@ -111,14 +155,24 @@ void DB_printf(const char *Format, ...)
              uitoa(&pBuffer, u, 10);
              break;
           case 'c':               /* %c, a single character */
-             *pBuffer++ = (char) va_arg(Arguments,unsigned int);
+             *pBuffer = (char) va_arg(Arguments,unsigned int);
+             if (*pBuffer == '\n')
+             {
+                *pBuffer++ = CR;
+                *pBuffer = LF;
+             }
+             pBuffer++;
              break;
           case 's':               /* %s, a string of characters */
              pString = va_arg(Arguments,char *);
              if (!pString)
                 pString = "(null)";
              while (*pString)
+             {
+                if (*pString == '\n')
+                   *pBuffer++ = CR;
                 *pBuffer++ = *pString++;
+             }
              break;
           case '%':               /* quoted % */
              *pBuffer++ = '%';
@@ -132,20 +186,9 @@ void DB_printf(const char *Format, ...)
        Format++;
     }
   }
-  *pBuffer = 0;                     /* null terminate the output string */
-
-/* now, spit the built up line out 1 character at a time */
-   for (pBuffer = LineBuffer; *pBuffer != 0; pBuffer++)
-   {
-      if (*pBuffer != '\n')
-      {   
-        putchar(*pBuffer);
-      }else
-      {
-         putchar(CR);
-         putchar(LF);
-      }
-   }
+/* now, send the built up line in one piece */
+   Terminal_Write((const uint8_t *)LineBuffer,
+       (uint16_t)(pBuffer - LineBuffer), Policy);
    return;
 }
 /* integer to ascii conversion for unsigned numbers  */
@@ -11,6 +11,18 @@
   emulator through a UART-USB bridge interface.
  Notes
   For the PIC32 port, we are using UART 1
+  Transmit goes through an ES_Ring that DMA channel 0 empties into U1TXREG,
+  a byte each time U1TXIF says the FIFO has room, in blocks of whatever is
+  contiguous in the ring. The block complete interrupt starts the next
+  block, so sending costs the main loop nothing. Writers pend that same
+  interrupt when the DMA is idle. The writers are the ring's producer and
+  the DMA ISR is its consumer.
+  With ES_PREEMPTIVE services of every level write to the transmit buffer,
+  so the writes are made under a ceiling of ES_MAX_LEVEL, below the DMA
+  interrupt. ISRs should log with ES_LOG instead.
+  A write that does not fit is handled by its Terminal_TxPolicy_t and the
+  bytes that never go in are counted, see Terminal_GetTxDropped. Nothing
+  already in the ring is overwritten.
 
  History
  When           Who     What/Why
@@ -23,27 +35,42 @@
 
 // Hardware
 #include <xc.h>
+#include <sys/attribs.h>
+#include <sys/kmem.h>
 #include <stdio.h>
 
 #include "ES_General.h"
 #include "ES_Port.h"
-#include "circular_buffer.h"
+#include "ES_Framework.h"   // for the ES_PREEMPTIVE ceilings
+#include "ES_Ring.h"
 #include "dbprintf.h"
 
 //this module
 #include "terminal.h"
 /*----------------------------- Module Defines ----------------------------*/
-#define BAUD_CONST 216 // sets up baud rate for 115200
-//#define BAUD_CONST 21 // sets up baud rate for 230400
+#define SYSCLK_FREQ 200000000u  // PBCLK2 is this over PB2DIV + 1
+
+#if (XMIT_BUFFER_SIZE & (XMIT_BUFFER_SIZE - 1)) != 0
+#error "XMIT_BUFFER_SIZE must be a power of 2"
+#endif
+
+// above the ES_PREEMPTIVE levels, so a writer waiting at any level drains
+#define TX_DMA_IPL 3
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static uint16_t CopyToBuffer(const uint8_t *pData, uint16_t Length,
+    bool AllOrNothing);
+static void ServiceTxDMA(void);
 
 /*---------------------------- Module Variables ---------------------------*/
-static uint8_t xmitBuffer[XMIT_BUFFER_SIZE];
-static cbuf_handle_t xmitBufferHandle;
+// coherent puts it in uncached memory, so the DMA sees what was written
+static uint8_t __attribute__((coherent)) xmitBuffer[XMIT_BUFFER_SIZE];
+static ES_Ring_t xmitRing;
+static volatile uint16_t xmitInFlight;  // length of the DMA block under way
+static uint32_t DroppedBytes;
 
 /*------------------------------ Module Code ------------------------------*/
 /*******************************************************************************
@@ -72,8 +99,9 @@ void Terminal_HWInit(void)
   U1MODEbits.BRGH = 1;
   // Diable TX inversion, everything else we don't care about
   U1STA = 0;
-  // Set the baud rate based on the constant
-  U1BRG = BAUD_CONST;
+  // the TX interrupt flag is set while the FIFO has room, that paces the DMA
+  U1STAbits.UTXISEL = 0b00;
+  Terminal_SetBaud(TERMINAL_BAUD);
   
   // redirect printf to UART1 using X32 built in cross over
   __XC_UART = 1; 
@@ -83,11 +111,47 @@ void Terminal_HWInit(void)
   U1STAbits.URXEN = 1; // enable receive
   U1MODEbits.ON = 1; // turn peripheral on
   
-  // now initialize the circular buffer for transmitting
-  xmitBufferHandle = circular_buf_init( xmitBuffer, ARRAY_SIZE(xmitBuffer) );
+  // DMA channel 0 moves a byte from the buffer to U1TXREG on each U1TXIF,
+  // and interrupts at the end of a block. The source is set per block
+  ES_RingInit(&xmitRing, xmitBuffer, sizeof(xmitBuffer[0]),
+      ARRAY_SIZE(xmitBuffer));
+  xmitInFlight = 0;
+  DMACONbits.ON = 1;
+  DCH0CON = 0;
+  DCH0ECON = 0;
+  DCH0ECONbits.CHSIRQ = _UART1_TX_VECTOR;
+  DCH0ECONbits.SIRQEN = 1;
+  DCH0DSA = KVA_TO_PA(&U1TXREG);
+  DCH0DSIZ = 1;
+  DCH0CSIZ = 1;
+  DCH0INT = 0;
+  DCH0INTbits.CHBCIE = 1;
+  IPC33bits.DMA0IP = TX_DMA_IPL;
+  IPC33bits.DMA0IS = 0;
+  IFS4CLR = _IFS4_DMA0IF_MASK;
+  IEC4SET = _IEC4_DMA0IE_MASK;
   
   return;
 }
+
+/*******************************************************************************
+ * Function: Terminal_SetBaud
+ * Arguments: the baud rate
+ * Returns nothing
+ *
+ * Description: Sets U1BRG for the baud rate from the PBCLK2 divider in force.
+ * _PBCLK_Init calls it again after it changes PBCLK2.
+ ******************************************************************************/
+void Terminal_SetBaud(uint32_t Baud)
+{
+  uint32_t PBClk2 = SYSCLK_FREQ / (PB2DIVbits.PBDIV + 1);
+
+  // let the last byte out at the old rate
+  while (!U1STAbits.TRMT)
+  {}
+  // with BRGH set the rate is PBCLK2 / (4 * (U1BRG + 1)), rounded here
+  U1BRG = ((PBClk2 + (2 * Baud)) / (4 * Baud)) - 1;
+}
 /*******************************************************************************
  * Function: Terminal_ReadByte
  * Arguments: None
@@ -123,10 +187,64 @@ void Terminal_WriteByte(uint8_t txByte)
   // write the byte to the register
   U1TXREG = txByte;
 #else
-  circular_buf_put(xmitBufferHandle, txByte);
+  Terminal_Write(&txByte, 1, TERMINAL_TX_DEFAULT);
 #endif  
   return;
 }
+
+/*******************************************************************************
+ * Function: Terminal_Write
+ * Arguments: the bytes, how many, and what to do if they do not all fit
+ * Returns the number of bytes that went into the transmit buffer
+ *
+ * Description: Copies the bytes into the transmit buffer in one go, other
+ *              writers can not get in between them. TERMINAL_TX_BLOCK waits
+ *              for room a piece at a time instead, and is taken as
+ *              TERMINAL_TX_DROP in an ISR, which may be holding off the DMA
+ *              interrupt. Bytes that do not go in are counted as dropped.
+ ******************************************************************************/
+uint16_t Terminal_Write(const uint8_t *pData, uint16_t Length,
+    Terminal_TxPolicy_t Policy)
+{
+  uint16_t Written;
+
+#ifdef NO_BUFFER
+  for (Written = 0; Written < Length; Written++)
+  {
+    Terminal_WriteByte(pData[Written]);
+  }
+#else
+  if ((Policy == TERMINAL_TX_BLOCK) && ES_InISR())
+  {
+    Policy = TERMINAL_TX_DROP;
+  }
+  Written = CopyToBuffer(pData, Length, Policy == TERMINAL_TX_DROP);
+  while ((Written < Length) && (Policy == TERMINAL_TX_BLOCK))
+  {
+    while (Terminal_GetTxSpace() == 0)
+    {}
+    Written += CopyToBuffer(&pData[Written], Length - Written, false);
+  }
+  if (Written < Length)
+  {
+    ES_Ceiling_t Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+
+    DroppedBytes += Length - Written;
+    ES_ExitCeiling(Saved);
+  }
+#endif
+  return Written;
+}
+
+/*******************************************************************************
+ * Function: Terminal_GetTxDropped
+ * Arguments: none
+ * Returns bytes refused for lack of room since reset, for the 't' stats
+ ******************************************************************************/
+uint32_t Terminal_GetTxDropped(void)
+{
+  return DroppedBytes;
+}
 /*******************************************************************************
  * Function: Terminal_IsRxData
  * Arguments: none
@@ -147,6 +265,22 @@ bool Terminal_IsRxData(void)
     return U1STAbits.URXDA;
 }
 
+/*******************************************************************************
+ * Function: Terminal_GetTxSpace
+ * Arguments: none
+ * Returns number of bytes that can be written without any being dropped
+ * 
+ * Description: lets bulk writers (the ES_Trace dump) pace themselves
+ ******************************************************************************/
+uint16_t Terminal_GetTxSpace(void)
+{
+#ifdef NO_BUFFER
+  return U1STAbits.UTXBF ? 0 : 1;
+#else
+  return (uint16_t)ES_RingSpace(&xmitRing);
+#endif
+}
+
 /*******************************************************************************
  * Function: _mon_putc
  * Arguments: char c
@@ -159,7 +293,7 @@ bool Terminal_IsRxData(void)
  ******************************************************************************/
 void _mon_putc (char c)
 {
-  circular_buf_put(xmitBufferHandle, c);
+  Terminal_WriteByte((uint8_t)c);
 }
 
 /*******************************************************************************
@@ -168,21 +302,31 @@ void _mon_putc (char c)
  * Returns none
  * 
  * Created by: Ed Carryer
- * Description: this functions pulls bytes, if any available, from the
- *              circular buffer and stuffs them into the UART1 buffer
- *              until we either run out of bytes in the circular buffer
- *              or we run out of space in the UART FIFO
+ * Description: the DMA moves the bytes now, this only restarts it should
+ *              it be idle with bytes waiting. ES_Run still calls it when idle.
  ******************************************************************************/
 void Terminal_MoveBuffer2UART( void )
 {
-  while ( (!circular_buf_empty(xmitBufferHandle)) && (!U1STAbits.UTXBF))
+  if ((xmitInFlight == 0) && (ES_RingCount(&xmitRing) != 0))
   {
-    uint8_t byte2Xmit;
-    circular_buf_get(xmitBufferHandle, &byte2Xmit);
-    U1TXREG = byte2Xmit;
+    IFS4SET = _IFS4_DMA0IF_MASK;
   }
 }
 
+/*******************************************************************************
+ * Function: TxDMAHandler
+ * Arguments: none
+ * Returns none
+ *
+ * Description: DMA channel 0 interrupt, at the end of each block and when a
+ *              writer pends it to start the DMA
+ ******************************************************************************/
+void __ISR(_DMA0_VECTOR, IPL3AUTO) TxDMAHandler(void)
+{
+  IFS4CLR = _IFS4_DMA0IF_MASK;
+  ServiceTxDMA();
+}
+
 void __attribute__((noreturn)) _fassert(int nLineNumber,
                                         const char * sFileName,
                                         const char * sFailedExpression,
@@ -190,15 +334,68 @@ void __attribute__((noreturn)) _fassert(int nLineNumber,
 {
   DB_printf("Assert \"%s\" Failed at Line: %d, in File: %s \n\r", 
             sFailedExpression, nLineNumber, sFileName, sFunction);
-    // now pump the bytes out of the buffer into the UART
+    // now pump the bytes out of the buffer into the UART, by polling the
+    // DMA since the assert may be in an ISR that holds off its interrupt
+    __builtin_disable_interrupts();
     while(1) 
     {
-        Terminal_MoveBuffer2UART();
+        ServiceTxDMA();
     }
 }
 /***************************************************************************
  private functions
  ***************************************************************************/
+// copies as much as fits (or nothing, if AllOrNothing and it does not all
+// fit) and starts the DMA if it is idle
+static uint16_t CopyToBuffer(const uint8_t *pData, uint16_t Length,
+    bool AllOrNothing)
+{
+  ES_Ceiling_t Saved = ES_EnterCeiling(ES_MAX_LEVEL);
+
+  if (AllOrNothing && (Length > ES_RingSpace(&xmitRing)))
+  {
+    Length = 0;
+  }
+  Length = (uint16_t)ES_RingPutN(&xmitRing, pData, Length);
+  ES_ExitCeiling(Saved);
+  if ((Length > 0) && (xmitInFlight == 0))
+  {
+    IFS4SET = _IFS4_DMA0IF_MASK;
+  }
+  return Length;
+}
+
+// retires a finished block and starts the next one, from the DMA ISR (or
+// _fassert with interrupts off)
+static void ServiceTxDMA(void)
+{
+  uint8_t  *pBlock;
+  uint32_t Waiting;
+
+  if (DCH0INTbits.CHBCIF)
+  {
+    DCH0INTCLR = _DCH0INT_CHBCIF_MASK;
+    ES_RingSkip(&xmitRing, xmitInFlight);
+    xmitInFlight = 0;
+  }
+  if (xmitInFlight != 0)
+  {
+    return;
+  }
+  // a span never wraps, the part after the end of the buffer is the next
+  pBlock = ES_RingPeekSpan(&xmitRing, 0, &Waiting);
+  if (Waiting == 0)
+  {
+    return;
+  }
+  xmitInFlight = (uint16_t)Waiting;
+  DCH0SSA = KVA_TO_PA(pBlock);
+  DCH0SSIZ = Waiting;
+  // the UART sets U1TXIF again straight away while the FIFO has room, that
+  // edge starts the first byte
+  IFS3CLR = _IFS3_U1TXIF_MASK;
+  DCH0CONSET = _DCH0CON_CHEN_MASK;
+}
 // module test harness:
 #ifdef TEST
 int main(void)
@@ -0,0 +1,41 @@
+/****************************************************************************
+ Module
+     MotorPlant.h (host only)
+
+ Description
+     The two drive wheels as a simulated plant for MotorSM: gear motors,
+     quadrature encoders and the timers, input captures and PWM that
+     connect them to the firmware, run through the register shim.
+*****************************************************************************/
+#ifndef MotorPlant_H
+#define MotorPlant_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+  PlantLeft = 0,
+  PlantRight = 1
+} PlantWheel_t;
+
+// time spent in one of MotorSM's interrupt handlers, host ns
+typedef struct
+{
+  const char *pName;
+  uint32_t Calls;
+  uint64_t Nanos;
+  uint32_t MaxNanos;
+} PlantIsrStats_t;
+
+void MotorPlant_Init(void);
+void MotorPlant_Run(double Seconds);
+double MotorPlant_GetTime(void);
+double MotorPlant_GetWheelRPM(PlantWheel_t Which);
+double MotorPlant_GetMeasuredRPM(PlantWheel_t Which);
+double MotorPlant_GetDuty(PlantWheel_t Which);
+void MotorPlant_SetLoad(PlantWheel_t Which, double NewtonMeters);
+const PlantIsrStats_t *MotorPlant_GetIsrStats(uint8_t *pCount);
+void MotorPlant_ResetIsrStats(void);
+
+#endif /* MotorPlant_H */
@@ -0,0 +1,14 @@
+/****************************************************************************
+ Module
+     sys/attribs.h (host shim)
+
+ Description
+     The host build has no interrupt attributes, __ISR is defined away in the
+     host xc.h so the handlers compile as plain functions.
+*****************************************************************************/
+#ifndef HOST_SYS_ATTRIBS_H
+#define HOST_SYS_ATTRIBS_H
+
+#include <xc.h>
+
+#endif /* HOST_SYS_ATTRIBS_H */
@@ -0,0 +1,903 @@
+/****************************************************************************
+ Module
+     xc.h (host shim)
+
+ Description
+     Stand-in for the XC32 device header when the project is compiled as a
+     normal Linux process (ES_PORT_HOST). Every special function register the
+     project touches is backed by a plain 32 bit word, the xxxbits views are
+     overlaid on the same word with the real PIC32MZ EF bit positions, and the
+     CLR/SET/INV aliases are separate words that HostSFR_Sync() folds back into
+     the register.
+
+ Notes
+     This header is only ever found by the host build (HostHeaders is first on
+     the include path there). The PIC build keeps using the real <xc.h>.
+     Registers are memory, not peripherals: nothing shifts out of SPIxBUF and
+     no flag is set by hardware unless the host code sets it. Status bits that
+     firmware polls during init are given "ready" reset values by HostSFR_Reset.
+     Add a register to HOST_SFR_LIST (and a bits view below if the code uses
+     one) the first time a module needs it.
+*****************************************************************************/
+#ifndef HOST_XC_H
+#define HOST_XC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef ES_PORT_HOST
+#error "HostHeaders/xc.h is only for the host build, define ES_PORT_HOST"
+#endif
+
+/*---------------------------- Register List ------------------------------*/
+// every register gets NAME, NAMECLR, NAMESET and NAMEINV
+#define HOST_SFR_LIST \
+    HOST_SFR(ANSELA) HOST_SFR(TRISA) HOST_SFR(PORTA) HOST_SFR(LATA) \
+    HOST_SFR(ANSELB) HOST_SFR(TRISB) HOST_SFR(PORTB) HOST_SFR(LATB) \
+    HOST_SFR(ANSELC) HOST_SFR(TRISC) HOST_SFR(PORTC) HOST_SFR(LATC) \
+    HOST_SFR(ANSELD) HOST_SFR(TRISD) HOST_SFR(PORTD) HOST_SFR(LATD) \
+    HOST_SFR(ANSELE) HOST_SFR(TRISE) HOST_SFR(PORTE) HOST_SFR(LATE) \
+    HOST_SFR(ANSELF) HOST_SFR(TRISF) HOST_SFR(PORTF) HOST_SFR(LATF) \
+    HOST_SFR(ANSELG) HOST_SFR(TRISG) HOST_SFR(PORTG) HOST_SFR(LATG) \
+    HOST_SFR(ANSELH) HOST_SFR(TRISH) HOST_SFR(PORTH) HOST_SFR(LATH) \
+    HOST_SFR(ANSELJ) HOST_SFR(TRISJ) HOST_SFR(PORTJ) HOST_SFR(LATJ) \
+    HOST_SFR(ANSELK) HOST_SFR(TRISK) HOST_SFR(PORTK) HOST_SFR(LATK) \
+    HOST_SFR(CNCONH) HOST_SFR(CNENH) HOST_SFR(CNNEH) HOST_SFR(CNFH) \
+    HOST_SFR(T1CON) HOST_SFR(TMR1) HOST_SFR(PR1) HOST_SFR(T2CON) \
+    HOST_SFR(TMR2) HOST_SFR(PR2) HOST_SFR(T3CON) HOST_SFR(TMR3) \
+    HOST_SFR(PR3) HOST_SFR(T4CON) HOST_SFR(TMR4) HOST_SFR(PR4) HOST_SFR(T5CON) \
+    HOST_SFR(TMR5) HOST_SFR(PR5) HOST_SFR(T6CON) HOST_SFR(TMR6) \
+    HOST_SFR(PR6) HOST_SFR(T7CON) HOST_SFR(TMR7) HOST_SFR(PR7) HOST_SFR(IC1CON) \
+    HOST_SFR(IC1BUF) HOST_SFR(IC2CON) HOST_SFR(IC2BUF) HOST_SFR(IC3CON) \
+    HOST_SFR(IC3BUF) HOST_SFR(IC4CON) HOST_SFR(IC4BUF) HOST_SFR(OC1CON) \
+    HOST_SFR(OC1R) HOST_SFR(OC1RS) HOST_SFR(OC2CON) HOST_SFR(OC2R) \
+    HOST_SFR(OC2RS) HOST_SFR(SPI1CON) HOST_SFR(SPI1CON2) HOST_SFR(SPI1STAT) \
+    HOST_SFR(SPI1BUF) HOST_SFR(SPI1BRG) HOST_SFR(SPI2CON) HOST_SFR(SPI2CON2) \
+    HOST_SFR(SPI2STAT) HOST_SFR(SPI2BUF) HOST_SFR(SPI2BRG) HOST_SFR(SPI4CON) \
+    HOST_SFR(SPI4CON2) HOST_SFR(SPI4STAT) HOST_SFR(SPI4BUF) HOST_SFR(SPI4BRG) \
+    HOST_SFR(SPI5CON) HOST_SFR(SPI5CON2) HOST_SFR(SPI5STAT) HOST_SFR(SPI5BUF) \
+    HOST_SFR(SPI5BRG) HOST_SFR(U1MODE) HOST_SFR(U1STA) HOST_SFR(U1BRG) \
+    HOST_SFR(U1TXREG) HOST_SFR(U1RXREG) HOST_SFR(INTCON) HOST_SFR(PRISS) \
+    HOST_SFR(IFS0) HOST_SFR(IEC0) HOST_SFR(IFS1) HOST_SFR(IEC1) \
+    HOST_SFR(IFS2) HOST_SFR(IEC2) HOST_SFR(IFS3) HOST_SFR(IEC3) \
+    HOST_SFR(IFS4) HOST_SFR(IEC4) HOST_SFR(IFS5) HOST_SFR(IEC5) \
+    HOST_SFR(IPC0) HOST_SFR(IPC1) HOST_SFR(IPC2) HOST_SFR(IPC3) \
+    HOST_SFR(IPC4) HOST_SFR(IPC5) HOST_SFR(IPC6) HOST_SFR(IPC7) \
+    HOST_SFR(IPC8) HOST_SFR(IPC9) HOST_SFR(IPC10) HOST_SFR(IPC11) \
+    HOST_SFR(IPC12) HOST_SFR(IPC13) HOST_SFR(IPC14) HOST_SFR(IPC15) \
+    HOST_SFR(IPC16) HOST_SFR(IPC17) HOST_SFR(IPC18) HOST_SFR(IPC19) \
+    HOST_SFR(IPC20) HOST_SFR(IPC21) HOST_SFR(IPC22) HOST_SFR(IPC23) \
+    HOST_SFR(IPC24) HOST_SFR(IPC25) HOST_SFR(IPC26) HOST_SFR(IPC27) \
+    HOST_SFR(IPC28) HOST_SFR(IPC29) HOST_SFR(IPC30) HOST_SFR(IPC31) \
+    HOST_SFR(IPC32) HOST_SFR(IPC33) HOST_SFR(IPC34) HOST_SFR(IPC35) \
+    HOST_SFR(IPC36) HOST_SFR(IPC37) HOST_SFR(IPC38) HOST_SFR(IPC39) \
+    HOST_SFR(IPC40) HOST_SFR(IPC41) HOST_SFR(IPC42) HOST_SFR(IPC43) \
+    HOST_SFR(IPC44) HOST_SFR(IPC45) HOST_SFR(IPC46) HOST_SFR(IPC47) \
+    HOST_SFR(PB1DIV) HOST_SFR(PB2DIV) HOST_SFR(PB3DIV) HOST_SFR(PB4DIV) \
+    HOST_SFR(PB5DIV) HOST_SFR(PB7DIV) HOST_SFR(PB8DIV) HOST_SFR(CFGCON) \
+    HOST_SFR(RPA15R) HOST_SFR(RPD3R) HOST_SFR(RPD4R) HOST_SFR(RPD5R) \
+    HOST_SFR(RPD9R) HOST_SFR(RPF2R) HOST_SFR(RPF5R) HOST_SFR(RPF12R) \
+    HOST_SFR(RPG0R) HOST_SFR(RPG8R) HOST_SFR(IC1R) HOST_SFR(IC2R) \
+    HOST_SFR(IC3R) HOST_SFR(IC4R) HOST_SFR(INT2R) HOST_SFR(SDI1R) \
+    HOST_SFR(SDI2R) HOST_SFR(SDI4R) HOST_SFR(SDI5R) HOST_SFR(SS2R) \
+    HOST_SFR(U1RXR) HOST_SFR(ADCCON1) HOST_SFR(ADCCON2) HOST_SFR(ADCCON3) \
+    HOST_SFR(ADCTRGMODE) HOST_SFR(ADCIMCON1) HOST_SFR(ADCIMCON2) \
+    HOST_SFR(ADCIMCON3) HOST_SFR(ADCTRGSNS) HOST_SFR(ADC0TIME) HOST_SFR(ADC1TIME) \
+    HOST_SFR(ADC2TIME) HOST_SFR(ADC3TIME) HOST_SFR(ADC4TIME) HOST_SFR(ADCEIEN1) \
+    HOST_SFR(ADCEIEN2) HOST_SFR(ADCANCON) HOST_SFR(ADCBASE) HOST_SFR(ADCTRG1) \
+    HOST_SFR(ADCTRG2) HOST_SFR(ADCTRG3) HOST_SFR(ADCCSS1) HOST_SFR(ADCCSS2) \
+    HOST_SFR(ADCGIRQEN1) HOST_SFR(ADCGIRQEN2) HOST_SFR(ADCCMPCON1) \
+    HOST_SFR(ADCCMPEN1) HOST_SFR(ADCFLTR1) HOST_SFR(ADCCMPCON2) \
+    HOST_SFR(ADCCMPEN2) HOST_SFR(ADCFLTR2) HOST_SFR(ADCCMPCON3) \
+    HOST_SFR(ADCCMPEN3) HOST_SFR(ADCFLTR3) HOST_SFR(ADCCMPCON4) \
+    HOST_SFR(ADCCMPEN4) HOST_SFR(ADCFLTR4) HOST_SFR(ADCCMPCON5) \
+    HOST_SFR(ADCCMPEN5) HOST_SFR(ADCFLTR5) HOST_SFR(ADCCMPCON6) \
+    HOST_SFR(ADCCMPEN6) HOST_SFR(ADCFLTR6) HOST_SFR(ADC0CFG) HOST_SFR(ADC1CFG) \
+    HOST_SFR(ADC2CFG) HOST_SFR(ADC3CFG) HOST_SFR(ADC4CFG) HOST_SFR(ADC7CFG) \
+    HOST_SFR(ADCDATA4) HOST_SFR(ADCDATA6) HOST_SFR(ADCDATA37)
+
+#define HOST_SFR(name) \
+  extern volatile uint32_t name, name##CLR, name##SET, name##INV;
+HOST_SFR_LIST
+#undef HOST_SFR
+
+// the calibration words live in config flash on the part, plain words here
+extern volatile uint32_t DEVADC0, DEVADC1, DEVADC2, DEVADC3, DEVADC4, DEVADC7;
+
+// the xxxbits views alias the register word, the same way the XC32 headers
+// do it, so T2CON = 0 and T2CONbits.ON = 1 touch the same storage
+#define HOST_SFR_BITS(name, type) \
+  extern volatile type name##bits __asm__(#name);
+
+/*---------------------------- Bit Field Views ----------------------------*/
+// 16 bit wide port registers (ANSEL, TRIS, PORT, LAT)
+#define HOST_PORT_FIELDS(p) \
+  unsigned p##0:1;  unsigned p##1:1;  unsigned p##2:1;  unsigned p##3:1;  \
+  unsigned p##4:1;  unsigned p##5:1;  unsigned p##6:1;  unsigned p##7:1;  \
+  unsigned p##8:1;  unsigned p##9:1;  unsigned p##10:1; unsigned p##11:1; \
+  unsigned p##12:1; unsigned p##13:1; unsigned p##14:1; unsigned p##15:1; \
+  unsigned :16;
+
+typedef struct { HOST_PORT_FIELDS(ANSA) } __ANSELAbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISA) } __TRISAbits_t;
+typedef struct { HOST_PORT_FIELDS(RA) } __PORTAbits_t;
+typedef struct { HOST_PORT_FIELDS(LATA) } __LATAbits_t;
+HOST_SFR_BITS(ANSELA, __ANSELAbits_t)
+HOST_SFR_BITS(TRISA, __TRISAbits_t)
+HOST_SFR_BITS(PORTA, __PORTAbits_t)
+HOST_SFR_BITS(LATA, __LATAbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSB) } __ANSELBbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISB) } __TRISBbits_t;
+typedef struct { HOST_PORT_FIELDS(RB) } __PORTBbits_t;
+typedef struct { HOST_PORT_FIELDS(LATB) } __LATBbits_t;
+HOST_SFR_BITS(ANSELB, __ANSELBbits_t)
+HOST_SFR_BITS(TRISB, __TRISBbits_t)
+HOST_SFR_BITS(PORTB, __PORTBbits_t)
+HOST_SFR_BITS(LATB, __LATBbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSC) } __ANSELCbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISC) } __TRISCbits_t;
+typedef struct { HOST_PORT_FIELDS(RC) } __PORTCbits_t;
+typedef struct { HOST_PORT_FIELDS(LATC) } __LATCbits_t;
+HOST_SFR_BITS(ANSELC, __ANSELCbits_t)
+HOST_SFR_BITS(TRISC, __TRISCbits_t)
+HOST_SFR_BITS(PORTC, __PORTCbits_t)
+HOST_SFR_BITS(LATC, __LATCbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSD) } __ANSELDbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISD) } __TRISDbits_t;
+typedef struct { HOST_PORT_FIELDS(RD) } __PORTDbits_t;
+typedef struct { HOST_PORT_FIELDS(LATD) } __LATDbits_t;
+HOST_SFR_BITS(ANSELD, __ANSELDbits_t)
+HOST_SFR_BITS(TRISD, __TRISDbits_t)
+HOST_SFR_BITS(PORTD, __PORTDbits_t)
+HOST_SFR_BITS(LATD, __LATDbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSE) } __ANSELEbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISE) } __TRISEbits_t;
+typedef struct { HOST_PORT_FIELDS(RE) } __PORTEbits_t;
+typedef struct { HOST_PORT_FIELDS(LATE) } __LATEbits_t;
+HOST_SFR_BITS(ANSELE, __ANSELEbits_t)
+HOST_SFR_BITS(TRISE, __TRISEbits_t)
+HOST_SFR_BITS(PORTE, __PORTEbits_t)
+HOST_SFR_BITS(LATE, __LATEbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSF) } __ANSELFbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISF) } __TRISFbits_t;
+typedef struct { HOST_PORT_FIELDS(RF) } __PORTFbits_t;
+typedef struct { HOST_PORT_FIELDS(LATF) } __LATFbits_t;
+HOST_SFR_BITS(ANSELF, __ANSELFbits_t)
+HOST_SFR_BITS(TRISF, __TRISFbits_t)
+HOST_SFR_BITS(PORTF, __PORTFbits_t)
+HOST_SFR_BITS(LATF, __LATFbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSG) } __ANSELGbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISG) } __TRISGbits_t;
+typedef struct { HOST_PORT_FIELDS(RG) } __PORTGbits_t;
+typedef struct { HOST_PORT_FIELDS(LATG) } __LATGbits_t;
+HOST_SFR_BITS(ANSELG, __ANSELGbits_t)
+HOST_SFR_BITS(TRISG, __TRISGbits_t)
+HOST_SFR_BITS(PORTG, __PORTGbits_t)
+HOST_SFR_BITS(LATG, __LATGbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSH) } __ANSELHbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISH) } __TRISHbits_t;
+typedef struct { HOST_PORT_FIELDS(RH) } __PORTHbits_t;
+typedef struct { HOST_PORT_FIELDS(LATH) } __LATHbits_t;
+HOST_SFR_BITS(ANSELH, __ANSELHbits_t)
+HOST_SFR_BITS(TRISH, __TRISHbits_t)
+HOST_SFR_BITS(PORTH, __PORTHbits_t)
+HOST_SFR_BITS(LATH, __LATHbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSJ) } __ANSELJbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISJ) } __TRISJbits_t;
+typedef struct { HOST_PORT_FIELDS(RJ) } __PORTJbits_t;
+typedef struct { HOST_PORT_FIELDS(LATJ) } __LATJbits_t;
+HOST_SFR_BITS(ANSELJ, __ANSELJbits_t)
+HOST_SFR_BITS(TRISJ, __TRISJbits_t)
+HOST_SFR_BITS(PORTJ, __PORTJbits_t)
+HOST_SFR_BITS(LATJ, __LATJbits_t)
+typedef struct { HOST_PORT_FIELDS(ANSK) } __ANSELKbits_t;
+typedef struct { HOST_PORT_FIELDS(TRISK) } __TRISKbits_t;
+typedef struct { HOST_PORT_FIELDS(RK) } __PORTKbits_t;
+typedef struct { HOST_PORT_FIELDS(LATK) } __LATKbits_t;
+HOST_SFR_BITS(ANSELK, __ANSELKbits_t)
+HOST_SFR_BITS(TRISK, __TRISKbits_t)
+HOST_SFR_BITS(PORTK, __PORTKbits_t)
+HOST_SFR_BITS(LATK, __LATKbits_t)
+
+// Timer1 is a type A timer, the rest are type B
+typedef struct {
+  unsigned :1; unsigned TCS:1; unsigned TSYNC:1; unsigned :1;
+  unsigned TCKPS:2; unsigned :1; unsigned TGATE:1; unsigned :3;
+  unsigned TWIP:1; unsigned TWDIS:1; unsigned SIDL:1; unsigned :1;
+  unsigned ON:1; unsigned :16;
+} __T1CONbits_t;
+typedef struct {
+  unsigned :1; unsigned TCS:1; unsigned :1; unsigned T32:1;
+  unsigned TCKPS:3; unsigned TGATE:1; unsigned :5; unsigned SIDL:1;
+  unsigned :1; unsigned ON:1; unsigned :16;
+} __T2CONbits_t;
+typedef __T2CONbits_t __T3CONbits_t, __T4CONbits_t, __T5CONbits_t,
+                      __T6CONbits_t, __T7CONbits_t;
+HOST_SFR_BITS(T1CON, __T1CONbits_t)
+HOST_SFR_BITS(T2CON, __T2CONbits_t)
+HOST_SFR_BITS(T3CON, __T3CONbits_t)
+HOST_SFR_BITS(T4CON, __T4CONbits_t)
+HOST_SFR_BITS(T5CON, __T5CONbits_t)
+HOST_SFR_BITS(T6CON, __T6CONbits_t)
+HOST_SFR_BITS(T7CON, __T7CONbits_t)
+#define _T1CON_ON_MASK 0x00008000
+#define _T2CON_ON_MASK 0x00008000
+#define _T3CON_ON_MASK 0x00008000
+#define _T4CON_ON_MASK 0x00008000
+#define _T5CON_ON_MASK 0x00008000
+#define _T6CON_ON_MASK 0x00008000
+#define _T7CON_ON_MASK 0x00008000
+
+typedef struct {
+  unsigned ICM:3; unsigned ICBNE:1; unsigned ICOV:1; unsigned ICI:2;
+  unsigned ICTMR:1; unsigned C32:1; unsigned FEDGE:1; unsigned :3;
+  unsigned SIDL:1; unsigned :1; unsigned ON:1; unsigned :16;
+} __IC1CONbits_t;
+typedef __IC1CONbits_t __IC2CONbits_t, __IC3CONbits_t, __IC4CONbits_t;
+HOST_SFR_BITS(IC1CON, __IC1CONbits_t)
+HOST_SFR_BITS(IC2CON, __IC2CONbits_t)
+HOST_SFR_BITS(IC3CON, __IC3CONbits_t)
+HOST_SFR_BITS(IC4CON, __IC4CONbits_t)
+
+// change notice, only the edge detect style (EDGEDETECT set) is modeled:
+// CNENx picks the rising edges and CNNEx the falling ones that set CNFx
+#define _CNCONH_EDGEDETECT_MASK 0x00000800
+#define _CNCONH_ON_MASK 0x00008000
+#define _CNENH_CNIEH8_MASK 0x00000100
+#define _CNNEH_CNNEH8_MASK 0x00000100
+#define _CNFH_CNFH8_MASK 0x00000100
+
+typedef struct {
+  unsigned OCM:3; unsigned OCTSEL:1; unsigned OCFLT:1; unsigned OC32:1;
+  unsigned :7; unsigned SIDL:1; unsigned :1; unsigned ON:1; unsigned :16;
+} __OC1CONbits_t;
+typedef __OC1CONbits_t __OC2CONbits_t;
+HOST_SFR_BITS(OC1CON, __OC1CONbits_t)
+HOST_SFR_BITS(OC2CON, __OC2CONbits_t)
+
+typedef struct {
+  unsigned SRXISEL:2; unsigned STXISEL:2; unsigned DISSDI:1;
+  unsigned MSTEN:1; unsigned CKP:1; unsigned SSEN:1; unsigned CKE:1;
+  unsigned SMP:1; unsigned MODE16:1; unsigned MODE32:1; unsigned DISSDO:1;
+  unsigned SIDL:1; unsigned :1; unsigned ON:1; unsigned ENHBUF:1;
+  unsigned SPIFE:1; unsigned :5; unsigned MCLKSEL:1; unsigned FRMCNT:3;
+  unsigned FRMSYPW:1; unsigned MSSEN:1; unsigned FRMPOL:1;
+  unsigned FRMSYNC:1; unsigned FRMEN:1;
+} __SPI1CONbits_t;
+typedef struct {
+  unsigned AUDMOD:2; unsigned :1; unsigned AUDMONO:1; unsigned :3;
+  unsigned AUDEN:1; unsigned IGNTUR:1; unsigned IGNROV:1;
+  unsigned SPITUREN:1; unsigned SPIROVEN:1; unsigned FRMERREN:1;
+  unsigned :2; unsigned SPISGNEXT:1; unsigned :16;
+} __SPI1CON2bits_t;
+typedef struct {
+  unsigned SPIRBF:1; unsigned SPITBF:1; unsigned :1; unsigned SPITBE:1;
+  unsigned :1; unsigned SPIRBE:1; unsigned SPIROV:1; unsigned SRMT:1;
+  unsigned SPITUR:1; unsigned :2; unsigned SPIBUSY:1; unsigned FRMERR:1;
+  unsigned :3; unsigned TXBUFELM:5; unsigned :3; unsigned RXBUFELM:5;
+  unsigned :3;
+} __SPI1STATbits_t;
+typedef __SPI1CONbits_t __SPI2CONbits_t, __SPI4CONbits_t, __SPI5CONbits_t;
+typedef __SPI1CON2bits_t __SPI2CON2bits_t, __SPI4CON2bits_t,
+                         __SPI5CON2bits_t;
+typedef __SPI1STATbits_t __SPI2STATbits_t, __SPI4STATbits_t,
+                         __SPI5STATbits_t;
+HOST_SFR_BITS(SPI1CON, __SPI1CONbits_t)
+HOST_SFR_BITS(SPI2CON, __SPI2CONbits_t)
+HOST_SFR_BITS(SPI4CON, __SPI4CONbits_t)
+HOST_SFR_BITS(SPI5CON, __SPI5CONbits_t)
+HOST_SFR_BITS(SPI1CON2, __SPI1CON2bits_t)
+HOST_SFR_BITS(SPI2CON2, __SPI2CON2bits_t)
+HOST_SFR_BITS(SPI4CON2, __SPI4CON2bits_t)
+HOST_SFR_BITS(SPI5CON2, __SPI5CON2bits_t)
+HOST_SFR_BITS(SPI1STAT, __SPI1STATbits_t)
+HOST_SFR_BITS(SPI2STAT, __SPI2STATbits_t)
+HOST_SFR_BITS(SPI4STAT, __SPI4STATbits_t)
+HOST_SFR_BITS(SPI5STAT, __SPI5STATbits_t)
+
+typedef struct {
+  unsigned STSEL:1; unsigned PDSEL:2; unsigned BRGH:1; unsigned RXINV:1;
+  unsigned ABAUD:1; unsigned LPBACK:1; unsigned WAKE:1; unsigned UEN:2;
+  unsigned :1; unsigned RTSMD:1; unsigned IREN:1; unsigned SIDL:1;
+  unsigned :1; unsigned ON:1; unsigned :16;
+} __U1MODEbits_t;
+typedef struct {
+  unsigned URXDA:1; unsigned OERR:1; unsigned FERR:1; unsigned PERR:1;
+  unsigned RIDLE:1; unsigned ADDEN:1; unsigned URXISEL:2; unsigned TRMT:1;
+  unsigned UTXBF:1; unsigned UTXEN:1; unsigned UTXBRK:1; unsigned URXEN:1;
+  unsigned UTXINV:1; unsigned UTXISEL:2; unsigned ADDR:8;
+  unsigned ADM_EN:1; unsigned :7;
+} __U1STAbits_t;
+HOST_SFR_BITS(U1MODE, __U1MODEbits_t)
+HOST_SFR_BITS(U1STA, __U1STAbits_t)
+
+/*---------------------------- Interrupt Controller -----------------------*/
+typedef struct {
+  unsigned INT0EP:1; unsigned INT1EP:1; unsigned INT2EP:1; unsigned INT3EP:1;
+  unsigned INT4EP:1; unsigned :3; unsigned TPC:3; unsigned :1;
+  unsigned MVEC:1; unsigned :19;
+} __INTCONbits_t;
+typedef struct {
+  unsigned SS0:1; unsigned :3; unsigned PRI1SS:4; unsigned PRI2SS:4;
+  unsigned PRI3SS:4; unsigned PRI4SS:4; unsigned PRI5SS:4; unsigned PRI6SS:4;
+  unsigned PRI7SS:4;
+} __PRISSbits_t;
+HOST_SFR_BITS(INTCON, __INTCONbits_t)
+HOST_SFR_BITS(PRISS, __PRISSbits_t)
+
+// vectors 0-31 share the IFS0/IEC0 bit order
+#define HOST_VEC0_FIELDS(s) \
+  unsigned CT##s:1; unsigned CS0##s:1; unsigned CS1##s:1; unsigned INT0##s:1; \
+  unsigned T1##s:1; unsigned IC1E##s:1; unsigned IC1##s:1; unsigned OC1##s:1; \
+  unsigned INT1##s:1; unsigned T2##s:1; unsigned IC2E##s:1; unsigned IC2##s:1;\
+  unsigned OC2##s:1; unsigned INT2##s:1; unsigned T3##s:1; unsigned IC3E##s:1;\
+  unsigned IC3##s:1; unsigned OC3##s:1; unsigned INT3##s:1; unsigned T4##s:1; \
+  unsigned IC4E##s:1; unsigned IC4##s:1; unsigned OC4##s:1; unsigned INT4##s:1;\
+  unsigned T5##s:1; unsigned IC5E##s:1; unsigned IC5##s:1; unsigned OC5##s:1; \
+  unsigned T6##s:1; unsigned IC6E##s:1; unsigned IC6##s:1; unsigned OC6##s:1;
+typedef struct { HOST_VEC0_FIELDS(IF) } __IFS0bits_t;
+typedef struct { HOST_VEC0_FIELDS(IE) } __IEC0bits_t;
+HOST_SFR_BITS(IFS0, __IFS0bits_t)
+HOST_SFR_BITS(IEC0, __IEC0bits_t)
+
+// IPCn holds vectors 4n..4n+3, one byte each: IS in bits 0-1, IP in bits 2-4
+#define HOST_IPC_FIELDS(v0, v1, v2, v3) \
+  unsigned v0##IS:2; unsigned v0##IP:3; unsigned :3; \
+  unsigned v1##IS:2; unsigned v1##IP:3; unsigned :3; \
+  unsigned v2##IS:2; unsigned v2##IP:3; unsigned :3; \
+  unsigned v3##IS:2; unsigned v3##IP:3; unsigned :3;
+typedef struct { HOST_IPC_FIELDS(CT, CS0, CS1, INT0) } __IPC0bits_t;
+typedef struct { HOST_IPC_FIELDS(T1, IC1E, IC1, OC1) } __IPC1bits_t;
+typedef struct { HOST_IPC_FIELDS(INT1, T2, IC2E, IC2) } __IPC2bits_t;
+typedef struct { HOST_IPC_FIELDS(OC2, INT2, T3, IC3E) } __IPC3bits_t;
+typedef struct { HOST_IPC_FIELDS(IC3, OC3, INT3, T4) } __IPC4bits_t;
+typedef struct { HOST_IPC_FIELDS(IC4E, IC4, OC4, INT4) } __IPC5bits_t;
+typedef struct { HOST_IPC_FIELDS(T5, IC5E, IC5, OC5) } __IPC6bits_t;
+typedef struct { HOST_IPC_FIELDS(T6, IC6E, IC6, OC6) } __IPC7bits_t;
+typedef struct { HOST_IPC_FIELDS(T7, IC7E, IC7, OC7) } __IPC8bits_t;
+typedef struct { HOST_IPC_FIELDS(ADC, ADCFIFO, ADCDC1, ADCDC2) } __IPC11bits_t;
+typedef struct { HOST_IPC_FIELDS(SPI1E, SPI1F, SPI1RX, SPI1TX) } __IPC27bits_t;
+typedef struct { HOST_IPC_FIELDS(CNG, CNH, CNJ, CNK) } __IPC31bits_t;
+typedef struct { HOST_IPC_FIELDS(CMP2, USB, SPI2E, SPI2RX) } __IPC35bits_t;
+typedef struct { HOST_IPC_FIELDS(SPI2TX, U3E, U3RX, U3TX) } __IPC36bits_t;
+typedef struct { HOST_IPC_FIELDS(SPI4RX, SPI4TX, RES166, RES167) } __IPC41bits_t;
+typedef struct { HOST_IPC_FIELDS(SPI5E, SPI5RX, SPI5TX, RES179) } __IPC44bits_t;
+HOST_SFR_BITS(IPC0, __IPC0bits_t)
+HOST_SFR_BITS(IPC1, __IPC1bits_t)
+HOST_SFR_BITS(IPC2, __IPC2bits_t)
+HOST_SFR_BITS(IPC3, __IPC3bits_t)
+HOST_SFR_BITS(IPC4, __IPC4bits_t)
+HOST_SFR_BITS(IPC5, __IPC5bits_t)
+HOST_SFR_BITS(IPC6, __IPC6bits_t)
+HOST_SFR_BITS(IPC7, __IPC7bits_t)
+HOST_SFR_BITS(IPC8, __IPC8bits_t)
+HOST_SFR_BITS(IPC11, __IPC11bits_t)
+HOST_SFR_BITS(IPC27, __IPC27bits_t)
+HOST_SFR_BITS(IPC31, __IPC31bits_t)
+HOST_SFR_BITS(IPC35, __IPC35bits_t)
+HOST_SFR_BITS(IPC36, __IPC36bits_t)
+HOST_SFR_BITS(IPC41, __IPC41bits_t)
+HOST_SFR_BITS(IPC44, __IPC44bits_t)
+
+// vector numbers for the PIC32MZ EF family, the IFS/IEC bit is vector % 32
+#define _CORE_TIMER_VECTOR        0
+#define _CORE_SOFTWARE_0_VECTOR   1
+#define _CORE_SOFTWARE_1_VECTOR   2
+#define _TIMER_1_VECTOR           4
+#define _INPUT_CAPTURE_1_VECTOR   6
+#define _OUTPUT_COMPARE_1_VECTOR  7
+#define _TIMER_2_VECTOR           9
+#define _INPUT_CAPTURE_2_VECTOR   11
+#define _OUTPUT_COMPARE_2_VECTOR  12
+#define _TIMER_3_VECTOR           14
+#define _INPUT_CAPTURE_3_VECTOR   16
+#define _TIMER_4_VECTOR           19
+#define _INPUT_CAPTURE_4_VECTOR   21
+#define _TIMER_5_VECTOR           24
+#define _TIMER_6_VECTOR           28
+#define _TIMER_7_VECTOR           32
+#define _ADC_VECTOR               44
+#define _SPI1_RX_VECTOR           110
+#define _SPI1_TX_VECTOR           111
+#define _CHANGE_NOTICE_H_VECTOR   125
+#define _SPI2_RX_VECTOR           143
+#define _SPI2_TX_VECTOR           144
+#define _SPI4_RX_VECTOR           164
+#define _SPI4_TX_VECTOR           165
+#define _SPI5_RX_VECTOR           177
+#define _SPI5_TX_VECTOR           178
+
+#define HOST_VEC_MASK(v) (1u << ((v) % 32))
+#define _IFS0_CTIF_MASK     HOST_VEC_MASK(_CORE_TIMER_VECTOR)
+#define _IEC0_CTIE_MASK     HOST_VEC_MASK(_CORE_TIMER_VECTOR)
+#define _IFS0_CS0IF_MASK    HOST_VEC_MASK(_CORE_SOFTWARE_0_VECTOR)
+#define _IEC0_CS0IE_MASK    HOST_VEC_MASK(_CORE_SOFTWARE_0_VECTOR)
+#define _IFS0_CS1IF_MASK    HOST_VEC_MASK(_CORE_SOFTWARE_1_VECTOR)
+#define _IEC0_CS1IE_MASK    HOST_VEC_MASK(_CORE_SOFTWARE_1_VECTOR)
+#define _IFS0_T1IF_MASK     HOST_VEC_MASK(_TIMER_1_VECTOR)
+#define _IEC0_T1IE_MASK     HOST_VEC_MASK(_TIMER_1_VECTOR)
+#define _IFS0_IC1IF_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_1_VECTOR)
+#define _IEC0_IC1IE_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_1_VECTOR)
+#define _IFS0_T2IF_MASK     HOST_VEC_MASK(_TIMER_2_VECTOR)
+#define _IEC0_T2IE_MASK     HOST_VEC_MASK(_TIMER_2_VECTOR)
+#define _IFS0_IC2IF_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_2_VECTOR)
+#define _IEC0_IC2IE_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_2_VECTOR)
+#define _IFS0_T3IF_MASK     HOST_VEC_MASK(_TIMER_3_VECTOR)
+#define _IEC0_T3IE_MASK     HOST_VEC_MASK(_TIMER_3_VECTOR)
+#define _IFS0_IC3IF_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_3_VECTOR)
+#define _IEC0_IC3IE_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_3_VECTOR)
+#define _IFS0_T4IF_MASK     HOST_VEC_MASK(_TIMER_4_VECTOR)
+#define _IEC0_T4IE_MASK     HOST_VEC_MASK(_TIMER_4_VECTOR)
+#define _IFS0_IC4IF_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_4_VECTOR)
+#define _IEC0_IC4IE_MASK    HOST_VEC_MASK(_INPUT_CAPTURE_4_VECTOR)
+#define _IFS0_T5IF_MASK     HOST_VEC_MASK(_TIMER_5_VECTOR)
+#define _IEC0_T5IE_MASK     HOST_VEC_MASK(_TIMER_5_VECTOR)
+#define _IFS0_T6IF_MASK     HOST_VEC_MASK(_TIMER_6_VECTOR)
+#define _IEC0_T6IE_MASK     HOST_VEC_MASK(_TIMER_6_VECTOR)
+#define _IFS1_T7IF_MASK     HOST_VEC_MASK(_TIMER_7_VECTOR)
+#define _IEC1_T7IE_MASK     HOST_VEC_MASK(_TIMER_7_VECTOR)
+#define _IFS1_ADCIF_MASK    HOST_VEC_MASK(_ADC_VECTOR)
+#define _IEC1_ADCIE_MASK    HOST_VEC_MASK(_ADC_VECTOR)
+#define _IFS3_SPI1RXIF_MASK HOST_VEC_MASK(_SPI1_RX_VECTOR)
+#define _IEC3_SPI1RXIE_MASK HOST_VEC_MASK(_SPI1_RX_VECTOR)
+#define _IFS3_SPI1TXIF_MASK HOST_VEC_MASK(_SPI1_TX_VECTOR)
+#define _IEC3_SPI1TXIE_MASK HOST_VEC_MASK(_SPI1_TX_VECTOR)
+#define _IFS3_CNHIF_MASK    HOST_VEC_MASK(_CHANGE_NOTICE_H_VECTOR)
+#define _IEC3_CNHIE_MASK    HOST_VEC_MASK(_CHANGE_NOTICE_H_VECTOR)
+#define _IFS4_SPI2RXIF_MASK HOST_VEC_MASK(_SPI2_RX_VECTOR)
+#define _IEC4_SPI2RXIE_MASK HOST_VEC_MASK(_SPI2_RX_VECTOR)
+#define _IFS4_SPI2TXIF_MASK HOST_VEC_MASK(_SPI2_TX_VECTOR)
+#define _IEC4_SPI2TXIE_MASK HOST_VEC_MASK(_SPI2_TX_VECTOR)
+#define _IFS5_SPI4RXIF_MASK HOST_VEC_MASK(_SPI4_RX_VECTOR)
+#define _IEC5_SPI4RXIE_MASK HOST_VEC_MASK(_SPI4_RX_VECTOR)
+#define _IFS5_SPI4TXIF_MASK HOST_VEC_MASK(_SPI4_TX_VECTOR)
+#define _IEC5_SPI4TXIE_MASK HOST_VEC_MASK(_SPI4_TX_VECTOR)
+#define _IFS5_SPI5RXIF_MASK HOST_VEC_MASK(_SPI5_RX_VECTOR)
+#define _IEC5_SPI5RXIE_MASK HOST_VEC_MASK(_SPI5_RX_VECTOR)
+#define _IFS5_SPI5TXIF_MASK HOST_VEC_MASK(_SPI5_TX_VECTOR)
+#define _IEC5_SPI5TXIE_MASK HOST_VEC_MASK(_SPI5_TX_VECTOR)
+
+/*---------------------------- Clocks & Config ----------------------------*/
+typedef struct {
+  unsigned PBDIV:7; unsigned :4; unsigned PBDIVRDY:1; unsigned :3;
+  unsigned ON:1; unsigned :16;
+} __PB1DIVbits_t;
+typedef __PB1DIVbits_t __PB2DIVbits_t, __PB3DIVbits_t, __PB4DIVbits_t,
+                       __PB5DIVbits_t, __PB7DIVbits_t, __PB8DIVbits_t;
+HOST_SFR_BITS(PB1DIV, __PB1DIVbits_t)
+HOST_SFR_BITS(PB2DIV, __PB2DIVbits_t)
+HOST_SFR_BITS(PB3DIV, __PB3DIVbits_t)
+HOST_SFR_BITS(PB4DIV, __PB4DIVbits_t)
+HOST_SFR_BITS(PB5DIV, __PB5DIVbits_t)
+HOST_SFR_BITS(PB7DIV, __PB7DIVbits_t)
+HOST_SFR_BITS(PB8DIV, __PB8DIVbits_t)
+
+typedef struct {
+  unsigned TDOEN:1; unsigned :2; unsigned JTAGEN:1; unsigned :3;
+  unsigned IOANCPEN:1; unsigned :8; unsigned OCACLK:1; unsigned ICACLK:1;
+  unsigned :14;
+} __CFGCONbits_t;
+HOST_SFR_BITS(CFGCON, __CFGCONbits_t)
+
+/*---------------------------- ADC ----------------------------------------*/
+typedef struct {
+  unsigned :11; unsigned AICPMPEN:1; unsigned CVDEN:1; unsigned FSPBCLKEN:1;
+  unsigned FSSCLKEN:1; unsigned ON:1; unsigned STRGSRC:5; unsigned SELRES:2;
+  unsigned FRACT:1; unsigned TRBSLV:3; unsigned TRBMST:3; unsigned TRBERR:1;
+  unsigned TRBEN:1;
+} __ADCCON1bits_t;
+typedef struct {
+  unsigned ADCDIV:7; unsigned :1; unsigned ADCEIS:3; unsigned :1;
+  unsigned ADCEIOVR:1; unsigned EOSIEN:1; unsigned REFFLTIEN:1;
+  unsigned BGVRIEN:1; unsigned SAMC:10; unsigned :2; unsigned CVDCPL:3;
+  unsigned EOSRDY:1; unsigned REFFLT:1; unsigned BGVRRDY:1;
+} __ADCCON2bits_t;
+typedef struct {
+  unsigned CVDEN:6; unsigned GSWTRG:1; unsigned GLSWTRG:1; unsigned RQCNVRT:1;
+  unsigned SAMP:1; unsigned UPDRDY:1; unsigned UPDIEN:1; unsigned TRGSUSP:1;
+  unsigned VREFSEL:3; unsigned DIGEN0:1; unsigned DIGEN1:1; unsigned DIGEN2:1;
+  unsigned DIGEN3:1; unsigned DIGEN4:1; unsigned :2; unsigned DIGEN7:1;
+  unsigned CONCLKDIV:6; unsigned ADCSEL:2;
+} __ADCCON3bits_t;
+typedef struct {
+  unsigned SAMC:10; unsigned :6; unsigned ADCDIV:7; unsigned :1;
+  unsigned SELRES:2; unsigned ADCEIS:3; unsigned :3;
+} __ADC4TIMEbits_t;
+typedef struct {
+  unsigned ANEN0:1; unsigned ANEN1:1; unsigned ANEN2:1; unsigned ANEN3:1;
+  unsigned ANEN4:1; unsigned :2; unsigned ANEN7:1; unsigned WKRDY0:1;
+  unsigned WKRDY1:1; unsigned WKRDY2:1; unsigned WKRDY3:1; unsigned WKRDY4:1;
+  unsigned :2; unsigned WKRDY7:1; unsigned WKIEN0:1; unsigned WKIEN1:1;
+  unsigned WKIEN2:1; unsigned WKIEN3:1; unsigned WKIEN4:1; unsigned :2;
+  unsigned WKIEN7:1; unsigned WKUPCLKCNT:4; unsigned :4;
+} __ADCANCONbits_t;
+typedef struct {
+  unsigned CSS0:1; unsigned CSS1:1; unsigned CSS2:1; unsigned CSS3:1;
+  unsigned CSS4:1; unsigned CSS5:1; unsigned CSS6:1; unsigned :25;
+} __ADCCSS1bits_t;
+typedef struct {
+  unsigned :5; unsigned CSS37:1; unsigned :26;
+} __ADCCSS2bits_t;
+typedef struct {
+  unsigned :8; unsigned SIGN4:1; unsigned DIFF4:1; unsigned :2;
+  unsigned SIGN6:1; unsigned DIFF6:1; unsigned :18;
+} __ADCIMCON1bits_t;
+typedef struct {
+  unsigned :10; unsigned SIGN37:1; unsigned DIFF37:1; unsigned :20;
+} __ADCIMCON3bits_t;
+typedef struct {
+  unsigned TRGSRC4:5; unsigned :3; unsigned TRGSRC5:5; unsigned :3;
+  unsigned TRGSRC6:5; unsigned :3; unsigned TRGSRC7:5; unsigned :3;
+} __ADCTRG2bits_t;
+HOST_SFR_BITS(ADCCON1, __ADCCON1bits_t)
+HOST_SFR_BITS(ADCCON2, __ADCCON2bits_t)
+HOST_SFR_BITS(ADCCON3, __ADCCON3bits_t)
+HOST_SFR_BITS(ADC4TIME, __ADC4TIMEbits_t)
+HOST_SFR_BITS(ADCANCON, __ADCANCONbits_t)
+HOST_SFR_BITS(ADCCSS1, __ADCCSS1bits_t)
+HOST_SFR_BITS(ADCCSS2, __ADCCSS2bits_t)
+HOST_SFR_BITS(ADCIMCON1, __ADCIMCON1bits_t)
+HOST_SFR_BITS(ADCIMCON3, __ADCIMCON3bits_t)
+HOST_SFR_BITS(ADCTRG2, __ADCTRG2bits_t)
+
+/*---------------------------- Port Masks ---------------------------------*/
+#define _TRISA_TRISA0_MASK 0x00000001
+#define _TRISA_TRISA1_MASK 0x00000002
+#define _TRISA_TRISA2_MASK 0x00000004
+#define _TRISA_TRISA3_MASK 0x00000008
+#define _TRISA_TRISA4_MASK 0x00000010
+#define _TRISA_TRISA5_MASK 0x00000020
+#define _TRISA_TRISA6_MASK 0x00000040
+#define _TRISA_TRISA7_MASK 0x00000080
+#define _TRISA_TRISA8_MASK 0x00000100
+#define _TRISA_TRISA9_MASK 0x00000200
+#define _TRISA_TRISA10_MASK 0x00000400
+#define _TRISA_TRISA11_MASK 0x00000800
+#define _TRISA_TRISA12_MASK 0x00001000
+#define _TRISA_TRISA13_MASK 0x00002000
+#define _TRISA_TRISA14_MASK 0x00004000
+#define _TRISA_TRISA15_MASK 0x00008000
+#define _TRISB_TRISB0_MASK 0x00000001
+#define _TRISB_TRISB1_MASK 0x00000002
+#define _TRISB_TRISB2_MASK 0x00000004
+#define _TRISB_TRISB3_MASK 0x00000008
+#define _TRISB_TRISB4_MASK 0x00000010
+#define _TRISB_TRISB5_MASK 0x00000020
+#define _TRISB_TRISB6_MASK 0x00000040
+#define _TRISB_TRISB7_MASK 0x00000080
+#define _TRISB_TRISB8_MASK 0x00000100
+#define _TRISB_TRISB9_MASK 0x00000200
+#define _TRISB_TRISB10_MASK 0x00000400
+#define _TRISB_TRISB11_MASK 0x00000800
+#define _TRISB_TRISB12_MASK 0x00001000
+#define _TRISB_TRISB13_MASK 0x00002000
+#define _TRISB_TRISB14_MASK 0x00004000
+#define _TRISB_TRISB15_MASK 0x00008000
+#define _TRISC_TRISC0_MASK 0x00000001
+#define _TRISC_TRISC1_MASK 0x00000002
+#define _TRISC_TRISC2_MASK 0x00000004
+#define _TRISC_TRISC3_MASK 0x00000008
+#define _TRISC_TRISC4_MASK 0x00000010
+#define _TRISC_TRISC5_MASK 0x00000020
+#define _TRISC_TRISC6_MASK 0x00000040
+#define _TRISC_TRISC7_MASK 0x00000080
+#define _TRISC_TRISC8_MASK 0x00000100
+#define _TRISC_TRISC9_MASK 0x00000200
+#define _TRISC_TRISC10_MASK 0x00000400
+#define _TRISC_TRISC11_MASK 0x00000800
+#define _TRISC_TRISC12_MASK 0x00001000
+#define _TRISC_TRISC13_MASK 0x00002000
+#define _TRISC_TRISC14_MASK 0x00004000
+#define _TRISC_TRISC15_MASK 0x00008000
+#define _TRISD_TRISD0_MASK 0x00000001
+#define _TRISD_TRISD1_MASK 0x00000002
+#define _TRISD_TRISD2_MASK 0x00000004
+#define _TRISD_TRISD3_MASK 0x00000008
+#define _TRISD_TRISD4_MASK 0x00000010
+#define _TRISD_TRISD5_MASK 0x00000020
+#define _TRISD_TRISD6_MASK 0x00000040
+#define _TRISD_TRISD7_MASK 0x00000080
+#define _TRISD_TRISD8_MASK 0x00000100
+#define _TRISD_TRISD9_MASK 0x00000200
+#define _TRISD_TRISD10_MASK 0x00000400
+#define _TRISD_TRISD11_MASK 0x00000800
+#define _TRISD_TRISD12_MASK 0x00001000
+#define _TRISD_TRISD13_MASK 0x00002000
+#define _TRISD_TRISD14_MASK 0x00004000
+#define _TRISD_TRISD15_MASK 0x00008000
+#define _TRISE_TRISE0_MASK 0x00000001
+#define _TRISE_TRISE1_MASK 0x00000002
+#define _TRISE_TRISE2_MASK 0x00000004
+#define _TRISE_TRISE3_MASK 0x00000008
+#define _TRISE_TRISE4_MASK 0x00000010
+#define _TRISE_TRISE5_MASK 0x00000020
+#define _TRISE_TRISE6_MASK 0x00000040
+#define _TRISE_TRISE7_MASK 0x00000080
+#define _TRISE_TRISE8_MASK 0x00000100
+#define _TRISE_TRISE9_MASK 0x00000200
+#define _TRISE_TRISE10_MASK 0x00000400
+#define _TRISE_TRISE11_MASK 0x00000800
+#define _TRISE_TRISE12_MASK 0x00001000
+#define _TRISE_TRISE13_MASK 0x00002000
+#define _TRISE_TRISE14_MASK 0x00004000
+#define _TRISE_TRISE15_MASK 0x00008000
+#define _TRISF_TRISF0_MASK 0x00000001
+#define _TRISF_TRISF1_MASK 0x00000002
+#define _TRISF_TRISF2_MASK 0x00000004
+#define _TRISF_TRISF3_MASK 0x00000008
+#define _TRISF_TRISF4_MASK 0x00000010
+#define _TRISF_TRISF5_MASK 0x00000020
+#define _TRISF_TRISF6_MASK 0x00000040
+#define _TRISF_TRISF7_MASK 0x00000080
+#define _TRISF_TRISF8_MASK 0x00000100
+#define _TRISF_TRISF9_MASK 0x00000200
+#define _TRISF_TRISF10_MASK 0x00000400
+#define _TRISF_TRISF11_MASK 0x00000800
+#define _TRISF_TRISF12_MASK 0x00001000
+#define _TRISF_TRISF13_MASK 0x00002000
+#define _TRISF_TRISF14_MASK 0x00004000
+#define _TRISF_TRISF15_MASK 0x00008000
+#define _TRISG_TRISG0_MASK 0x00000001
+#define _TRISG_TRISG1_MASK 0x00000002
+#define _TRISG_TRISG2_MASK 0x00000004
+#define _TRISG_TRISG3_MASK 0x00000008
+#define _TRISG_TRISG4_MASK 0x00000010
+#define _TRISG_TRISG5_MASK 0x00000020
+#define _TRISG_TRISG6_MASK 0x00000040
+#define _TRISG_TRISG7_MASK 0x00000080
+#define _TRISG_TRISG8_MASK 0x00000100
+#define _TRISG_TRISG9_MASK 0x00000200
+#define _TRISG_TRISG10_MASK 0x00000400
+#define _TRISG_TRISG11_MASK 0x00000800
+#define _TRISG_TRISG12_MASK 0x00001000
+#define _TRISG_TRISG13_MASK 0x00002000
+#define _TRISG_TRISG14_MASK 0x00004000
+#define _TRISG_TRISG15_MASK 0x00008000
+#define _TRISH_TRISH0_MASK 0x00000001
+#define _TRISH_TRISH1_MASK 0x00000002
+#define _TRISH_TRISH2_MASK 0x00000004
+#define _TRISH_TRISH3_MASK 0x00000008
+#define _TRISH_TRISH4_MASK 0x00000010
+#define _TRISH_TRISH5_MASK 0x00000020
+#define _TRISH_TRISH6_MASK 0x00000040
+#define _TRISH_TRISH7_MASK 0x00000080
+#define _TRISH_TRISH8_MASK 0x00000100
+#define _TRISH_TRISH9_MASK 0x00000200
+#define _TRISH_TRISH10_MASK 0x00000400
+#define _TRISH_TRISH11_MASK 0x00000800
+#define _TRISH_TRISH12_MASK 0x00001000
+#define _TRISH_TRISH13_MASK 0x00002000
+#define _TRISH_TRISH14_MASK 0x00004000
+#define _TRISH_TRISH15_MASK 0x00008000
+#define _TRISJ_TRISJ0_MASK 0x00000001
+#define _TRISJ_TRISJ1_MASK 0x00000002
+#define _TRISJ_TRISJ2_MASK 0x00000004
+#define _TRISJ_TRISJ3_MASK 0x00000008
+#define _TRISJ_TRISJ4_MASK 0x00000010
+#define _TRISJ_TRISJ5_MASK 0x00000020
+#define _TRISJ_TRISJ6_MASK 0x00000040
+#define _TRISJ_TRISJ7_MASK 0x00000080
+#define _TRISJ_TRISJ8_MASK 0x00000100
+#define _TRISJ_TRISJ9_MASK 0x00000200
+#define _TRISJ_TRISJ10_MASK 0x00000400
+#define _TRISJ_TRISJ11_MASK 0x00000800
+#define _TRISJ_TRISJ12_MASK 0x00001000
+#define _TRISJ_TRISJ13_MASK 0x00002000
+#define _TRISJ_TRISJ14_MASK 0x00004000
+#define _TRISJ_TRISJ15_MASK 0x00008000
+#define _TRISK_TRISK0_MASK 0x00000001
+#define _TRISK_TRISK1_MASK 0x00000002
+#define _TRISK_TRISK2_MASK 0x00000004
+#define _TRISK_TRISK3_MASK 0x00000008
+#define _TRISK_TRISK4_MASK 0x00000010
+#define _TRISK_TRISK5_MASK 0x00000020
+#define _TRISK_TRISK6_MASK 0x00000040
+#define _TRISK_TRISK7_MASK 0x00000080
+#define _TRISK_TRISK8_MASK 0x00000100
+#define _TRISK_TRISK9_MASK 0x00000200
+#define _TRISK_TRISK10_MASK 0x00000400
+#define _TRISK_TRISK11_MASK 0x00000800
+#define _TRISK_TRISK12_MASK 0x00001000
+#define _TRISK_TRISK13_MASK 0x00002000
+#define _TRISK_TRISK14_MASK 0x00004000
+#define _TRISK_TRISK15_MASK 0x00008000
+
+#define _ANSELA_ANSA0_MASK 0x00000001
+#define _ANSELA_ANSA1_MASK 0x00000002
+#define _ANSELA_ANSA2_MASK 0x00000004
+#define _ANSELA_ANSA3_MASK 0x00000008
+#define _ANSELA_ANSA4_MASK 0x00000010
+#define _ANSELA_ANSA5_MASK 0x00000020
+#define _ANSELA_ANSA6_MASK 0x00000040
+#define _ANSELA_ANSA7_MASK 0x00000080
+#define _ANSELA_ANSA8_MASK 0x00000100
+#define _ANSELA_ANSA9_MASK 0x00000200
+#define _ANSELA_ANSA10_MASK 0x00000400
+#define _ANSELA_ANSA11_MASK 0x00000800
+#define _ANSELA_ANSA12_MASK 0x00001000
+#define _ANSELA_ANSA13_MASK 0x00002000
+#define _ANSELA_ANSA14_MASK 0x00004000
+#define _ANSELA_ANSA15_MASK 0x00008000
+#define _ANSELB_ANSB0_MASK 0x00000001
+#define _ANSELB_ANSB1_MASK 0x00000002
+#define _ANSELB_ANSB2_MASK 0x00000004
+#define _ANSELB_ANSB3_MASK 0x00000008
+#define _ANSELB_ANSB4_MASK 0x00000010
+#define _ANSELB_ANSB5_MASK 0x00000020
+#define _ANSELB_ANSB6_MASK 0x00000040
+#define _ANSELB_ANSB7_MASK 0x00000080
+#define _ANSELB_ANSB8_MASK 0x00000100
+#define _ANSELB_ANSB9_MASK 0x00000200
+#define _ANSELB_ANSB10_MASK 0x00000400
+#define _ANSELB_ANSB11_MASK 0x00000800
+#define _ANSELB_ANSB12_MASK 0x00001000
+#define _ANSELB_ANSB13_MASK 0x00002000
+#define _ANSELB_ANSB14_MASK 0x00004000
+#define _ANSELB_ANSB15_MASK 0x00008000
+#define _ANSELC_ANSC0_MASK 0x00000001
+#define _ANSELC_ANSC1_MASK 0x00000002
+#define _ANSELC_ANSC2_MASK 0x00000004
+#define _ANSELC_ANSC3_MASK 0x00000008
+#define _ANSELC_ANSC4_MASK 0x00000010
+#define _ANSELC_ANSC5_MASK 0x00000020
+#define _ANSELC_ANSC6_MASK 0x00000040
+#define _ANSELC_ANSC7_MASK 0x00000080
+#define _ANSELC_ANSC8_MASK 0x00000100
+#define _ANSELC_ANSC9_MASK 0x00000200
+#define _ANSELC_ANSC10_MASK 0x00000400
+#define _ANSELC_ANSC11_MASK 0x00000800
+#define _ANSELC_ANSC12_MASK 0x00001000
+#define _ANSELC_ANSC13_MASK 0x00002000
+#define _ANSELC_ANSC14_MASK 0x00004000
+#define _ANSELC_ANSC15_MASK 0x00008000
+#define _ANSELD_ANSD0_MASK 0x00000001
+#define _ANSELD_ANSD1_MASK 0x00000002
+#define _ANSELD_ANSD2_MASK 0x00000004
+#define _ANSELD_ANSD3_MASK 0x00000008
+#define _ANSELD_ANSD4_MASK 0x00000010
+#define _ANSELD_ANSD5_MASK 0x00000020
+#define _ANSELD_ANSD6_MASK 0x00000040
+#define _ANSELD_ANSD7_MASK 0x00000080
+#define _ANSELD_ANSD8_MASK 0x00000100
+#define _ANSELD_ANSD9_MASK 0x00000200
+#define _ANSELD_ANSD10_MASK 0x00000400
+#define _ANSELD_ANSD11_MASK 0x00000800
+#define _ANSELD_ANSD12_MASK 0x00001000
+#define _ANSELD_ANSD13_MASK 0x00002000
+#define _ANSELD_ANSD14_MASK 0x00004000
+#define _ANSELD_ANSD15_MASK 0x00008000
+#define _ANSELE_ANSE0_MASK 0x00000001
+#define _ANSELE_ANSE1_MASK 0x00000002
+#define _ANSELE_ANSE2_MASK 0x00000004
+#define _ANSELE_ANSE3_MASK 0x00000008
+#define _ANSELE_ANSE4_MASK 0x00000010
+#define _ANSELE_ANSE5_MASK 0x00000020
+#define _ANSELE_ANSE6_MASK 0x00000040
+#define _ANSELE_ANSE7_MASK 0x00000080
+#define _ANSELE_ANSE8_MASK 0x00000100
+#define _ANSELE_ANSE9_MASK 0x00000200
+#define _ANSELE_ANSE10_MASK 0x00000400
+#define _ANSELE_ANSE11_MASK 0x00000800
+#define _ANSELE_ANSE12_MASK 0x00001000
+#define _ANSELE_ANSE13_MASK 0x00002000
+#define _ANSELE_ANSE14_MASK 0x00004000
+#define _ANSELE_ANSE15_MASK 0x00008000
+#define _ANSELF_ANSF0_MASK 0x00000001
+#define _ANSELF_ANSF1_MASK 0x00000002
+#define _ANSELF_ANSF2_MASK 0x00000004
+#define _ANSELF_ANSF3_MASK 0x00000008
+#define _ANSELF_ANSF4_MASK 0x00000010
+#define _ANSELF_ANSF5_MASK 0x00000020
+#define _ANSELF_ANSF6_MASK 0x00000040
+#define _ANSELF_ANSF7_MASK 0x00000080
+#define _ANSELF_ANSF8_MASK 0x00000100
+#define _ANSELF_ANSF9_MASK 0x00000200
+#define _ANSELF_ANSF10_MASK 0x00000400
+#define _ANSELF_ANSF11_MASK 0x00000800
+#define _ANSELF_ANSF12_MASK 0x00001000
+#define _ANSELF_ANSF13_MASK 0x00002000
+#define _ANSELF_ANSF14_MASK 0x00004000
+#define _ANSELF_ANSF15_MASK 0x00008000
+#define _ANSELG_ANSG0_MASK 0x00000001
+#define _ANSELG_ANSG1_MASK 0x00000002
+#define _ANSELG_ANSG2_MASK 0x00000004
+#define _ANSELG_ANSG3_MASK 0x00000008
+#define _ANSELG_ANSG4_MASK 0x00000010
+#define _ANSELG_ANSG5_MASK 0x00000020
+#define _ANSELG_ANSG6_MASK 0x00000040
+#define _ANSELG_ANSG7_MASK 0x00000080
+#define _ANSELG_ANSG8_MASK 0x00000100
+#define _ANSELG_ANSG9_MASK 0x00000200
+#define _ANSELG_ANSG10_MASK 0x00000400
+#define _ANSELG_ANSG11_MASK 0x00000800
+#define _ANSELG_ANSG12_MASK 0x00001000
+#define _ANSELG_ANSG13_MASK 0x00002000
+#define _ANSELG_ANSG14_MASK 0x00004000
+#define _ANSELG_ANSG15_MASK 0x00008000
+#define _ANSELH_ANSH0_MASK 0x00000001
+#define _ANSELH_ANSH1_MASK 0x00000002
+#define _ANSELH_ANSH2_MASK 0x00000004
+#define _ANSELH_ANSH3_MASK 0x00000008
+#define _ANSELH_ANSH4_MASK 0x00000010
+#define _ANSELH_ANSH5_MASK 0x00000020
+#define _ANSELH_ANSH6_MASK 0x00000040
+#define _ANSELH_ANSH7_MASK 0x00000080
+#define _ANSELH_ANSH8_MASK 0x00000100
+#define _ANSELH_ANSH9_MASK 0x00000200
+#define _ANSELH_ANSH10_MASK 0x00000400
+#define _ANSELH_ANSH11_MASK 0x00000800
+#define _ANSELH_ANSH12_MASK 0x00001000
+#define _ANSELH_ANSH13_MASK 0x00002000
+#define _ANSELH_ANSH14_MASK 0x00004000
+#define _ANSELH_ANSH15_MASK 0x00008000
+#define _ANSELJ_ANSJ0_MASK 0x00000001
+#define _ANSELJ_ANSJ1_MASK 0x00000002
+#define _ANSELJ_ANSJ2_MASK 0x00000004
+#define _ANSELJ_ANSJ3_MASK 0x00000008
+#define _ANSELJ_ANSJ4_MASK 0x00000010
+#define _ANSELJ_ANSJ5_MASK 0x00000020
+#define _ANSELJ_ANSJ6_MASK 0x00000040
+#define _ANSELJ_ANSJ7_MASK 0x00000080
+#define _ANSELJ_ANSJ8_MASK 0x00000100
+#define _ANSELJ_ANSJ9_MASK 0x00000200
+#define _ANSELJ_ANSJ10_MASK 0x00000400
+#define _ANSELJ_ANSJ11_MASK 0x00000800
+#define _ANSELJ_ANSJ12_MASK 0x00001000
+#define _ANSELJ_ANSJ13_MASK 0x00002000
+#define _ANSELJ_ANSJ14_MASK 0x00004000
+#define _ANSELJ_ANSJ15_MASK 0x00008000
+#define _ANSELK_ANSK0_MASK 0x00000001
+#define _ANSELK_ANSK1_MASK 0x00000002
+#define _ANSELK_ANSK2_MASK 0x00000004
+#define _ANSELK_ANSK3_MASK 0x00000008
+#define _ANSELK_ANSK4_MASK 0x00000010
+#define _ANSELK_ANSK5_MASK 0x00000020
+#define _ANSELK_ANSK6_MASK 0x00000040
+#define _ANSELK_ANSK7_MASK 0x00000080
+#define _ANSELK_ANSK8_MASK 0x00000100
+#define _ANSELK_ANSK9_MASK 0x00000200
+#define _ANSELK_ANSK10_MASK 0x00000400
+#define _ANSELK_ANSK11_MASK 0x00000800
+#define _ANSELK_ANSK12_MASK 0x00001000
+#define _ANSELK_ANSK13_MASK 0x00002000
+#define _ANSELK_ANSK14_MASK 0x00004000
+#define _ANSELK_ANSK15_MASK 0x00008000
+
+/*---------------------------- Core ---------------------------------------*/
+// the ISR decoration goes away, the handlers become ordinary functions that
+// the host code can call by name
+#define __ISR(vector, ipl)
+#define __reentrant
+
+// interrupts are simulated synchronously, so a critical region only has to
+// remember that it is in one
+extern volatile bool HostSFR_IntsEnabled;
+#define __builtin_disable_interrupts() ((void)(HostSFR_IntsEnabled = false))
+#define __builtin_enable_interrupts()  ((void)(HostSFR_IntsEnabled = true))
+
+// the core timer is the host port's virtual 100 MHz clock
+uint32_t _CP0_GET_COUNT(void);
+uint32_t _CP0_GET_COMPARE(void);
+void _CP0_SET_COMPARE(uint32_t Compare);
+
+// Status only holds the interrupt priority level. The simulated hardware
+// interrupts run at priority 0 from the main loop, the host port raises it
+// for the core software interrupts and the ES_PREEMPTIVE ceilings
+extern volatile uint32_t HostSFR_Status;
+#define _CP0_STATUS_IPL_POSITION 10
+#define _CP0_STATUS_IPL_MASK 0x0000FC00
+#define _CP0_GET_STATUS() (HostSFR_Status)
+#define _CP0_SET_STATUS(Value) ((void)(HostSFR_Status = (Value)))
+
+// called by ES_InterruptPoint() where the firmware has a window that no core
+// timer read falls in, the host port sets it to take an interrupt there
+extern void (*volatile HostSFR_InterruptPoint)(void);
+
+/*---------------------------- Host Functions -----------------------------*/
+void HostSFR_Reset(void);
+void HostSFR_Sync(void);
+bool HostSFR_IsIntEnabled(uint8_t Vector);
+bool HostSFR_IsIntFlagSet(uint8_t Vector);
+void HostSFR_SetIntFlag(uint8_t Vector);
+
+#endif /* HOST_XC_H */
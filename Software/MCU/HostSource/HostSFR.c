@@ -0,0 +1,182 @@
+/****************************************************************************
+ Module
+   HostSFR.c
+
+ Revision
+   1.0.1
+
+ Description
+   Storage for the special function registers declared in the host xc.h,
+   plus the small amount of behavior the firmware relies on: the CLR/SET/INV
+   aliases and the reset values of the status bits polled during init.
+
+ Notes
+   Only linked into the host build. The atomic CLR/SET/INV writes are not
+   applied at the moment of the write (C has no hook for that), they are
+   folded into the register by HostSFR_Sync, which the host port calls every
+   pass through ES_Run and before it runs any simulated interrupt.
+ ***************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <xc.h>
+#include <stddef.h>
+
+/*----------------------------- Module Defines ----------------------------*/
+#define NUM_IFS_REGS 6
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+  volatile uint32_t *pReg;
+  volatile uint32_t *pClr;
+  volatile uint32_t *pSet;
+  volatile uint32_t *pInv;
+}SFRAlias_t;
+
+/*---------------------------- Module Variables ---------------------------*/
+#define HOST_SFR(name) \
+  volatile uint32_t name, name##CLR, name##SET, name##INV;
+HOST_SFR_LIST
+#undef HOST_SFR
+
+volatile uint32_t DEVADC0, DEVADC1, DEVADC2, DEVADC3, DEVADC4, DEVADC7;
+
+volatile bool HostSFR_IntsEnabled = false;
+volatile uint32_t HostSFR_Status = 0;
+void (*volatile HostSFR_InterruptPoint)(void) = NULL;
+
+#define HOST_SFR(name) { &name, &name##CLR, &name##SET, &name##INV },
+static const SFRAlias_t AliasTable[] = { HOST_SFR_LIST };
+#undef HOST_SFR
+
+static volatile uint32_t * const IFSRegs[NUM_IFS_REGS] =
+{ &IFS0, &IFS1, &IFS2, &IFS3, &IFS4, &IFS5 };
+static volatile uint32_t * const IECRegs[NUM_IFS_REGS] =
+{ &IEC0, &IEC1, &IEC2, &IEC3, &IEC4, &IEC5 };
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     HostSFR_Reset
+ Parameters
+     None
+ Returns
+     None
+ Description
+     Puts every register back to 0 and then sets the status bits that the
+     init code busy-waits on, so that the waits fall through the way they do
+     once the real peripheral comes ready.
+****************************************************************************/
+void HostSFR_Reset(void)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof(AliasTable) / sizeof(AliasTable[0]); i++)
+  {
+    *AliasTable[i].pReg = 0;
+    *AliasTable[i].pClr = 0;
+    *AliasTable[i].pSet = 0;
+    *AliasTable[i].pInv = 0;
+  }
+
+  // UART transmit shift register empty
+  U1STAbits.TRMT = 1;
+  // SPI receive buffers empty, transmit buffers empty
+  SPI1STATbits.SPIRBE = 1;
+  SPI1STATbits.SPITBE = 1;
+  SPI2STATbits.SPIRBE = 1;
+  SPI2STATbits.SPITBE = 1;
+  SPI4STATbits.SPIRBE = 1;
+  SPI4STATbits.SPITBE = 1;
+  SPI5STATbits.SPIRBE = 1;
+  SPI5STATbits.SPITBE = 1;
+  // peripheral bus clock dividers are never switching
+  PB1DIVbits.PBDIVRDY = 1;
+  PB2DIVbits.PBDIVRDY = 1;
+  PB3DIVbits.PBDIVRDY = 1;
+  PB4DIVbits.PBDIVRDY = 1;
+  PB5DIVbits.PBDIVRDY = 1;
+  PB7DIVbits.PBDIVRDY = 1;
+  PB8DIVbits.PBDIVRDY = 1;
+  // band gap reference is up
+  ADCCON2bits.BGVRRDY = 1;
+
+  HostSFR_IntsEnabled = false;
+  HostSFR_Status = 0;
+}
+
+/****************************************************************************
+ Function
+     HostSFR_Sync
+ Parameters
+     None
+ Returns
+     None
+ Description
+     Applies any pending writes to the CLR, SET and INV aliases to their
+     registers and zeroes the aliases, as the hardware would have done at
+     the time of the write.
+****************************************************************************/
+void HostSFR_Sync(void)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof(AliasTable) / sizeof(AliasTable[0]); i++)
+  {
+    const SFRAlias_t *pAlias = &AliasTable[i];
+
+    if ((*pAlias->pClr | *pAlias->pSet | *pAlias->pInv) != 0)
+    {
+      *pAlias->pReg = ((*pAlias->pReg & ~*pAlias->pClr) | *pAlias->pSet) ^
+          *pAlias->pInv;
+      *pAlias->pClr = 0;
+      *pAlias->pSet = 0;
+      *pAlias->pInv = 0;
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+     HostSFR_IsIntEnabled
+ Parameters
+     uint8_t Vector, one of the _xxx_VECTOR numbers
+ Returns
+     bool, true if the IECx bit for the vector is set
+ Description
+     Lets the host simulation decide whether an interrupt source would
+     actually vector on the part
+****************************************************************************/
+bool HostSFR_IsIntEnabled(uint8_t Vector)
+{
+  return (*IECRegs[Vector / 32] & (1u << (Vector % 32))) != 0;
+}
+
+/****************************************************************************
+ Function
+     HostSFR_IsIntFlagSet
+ Parameters
+     uint8_t Vector, one of the _xxx_VECTOR numbers
+ Returns
+     bool, true if the IFSx bit for the vector is set
+****************************************************************************/
+bool HostSFR_IsIntFlagSet(uint8_t Vector)
+{
+  return (*IFSRegs[Vector / 32] & (1u << (Vector % 32))) != 0;
+}
+
+/****************************************************************************
+ Function
+     HostSFR_SetIntFlag
+ Parameters
+     uint8_t Vector, one of the _xxx_VECTOR numbers
+ Returns
+     None
+ Description
+     Raises the IFSx bit for a vector, the way the peripheral would
+****************************************************************************/
+void HostSFR_SetIntFlag(uint8_t Vector)
+{
+  *IFSRegs[Vector / 32] |= (1u << (Vector % 32));
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,1112 @@
+/****************************************************************************
+ Module
+   MotorPlant.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host simulation of the drive train MotorSM controls, so a change to the
+   speed loop can be tried without the robot. Each wheel is a DC gear motor
+   driven by its PWM output compare, turning a quadrature encoder whose
+   edges feed the input captures. The timers, input captures and output
+   compares are modeled from their registers in the host xc.h shim, and
+   MotorSM's own interrupt handlers are called when their flags come up,
+   so the control code under test is the firmware's, unchanged.
+
+ Notes
+   Time is counted in PBCLK3 cycles (50 MHz) and advances one PWM period at
+   a time. At the start of a period each output compare latches OCxRS, as
+   the hardware does, and the motor speeds are stepped over the period with
+   the averaged drive voltage (the winding time constant is much longer
+   than the 100 us PWM period). Inside the period the encoder edges and the
+   timer period matches are taken in time order, with the wheel angle
+   interpolated linearly across the period.
+   Motor: stall torque and no load speed at the gearbox output (linear
+   torque-speed curve), rotor inertia reflected through GEAR_RATIO plus half
+   the robot's mass at WHEEL_RADIUS, gearbox friction, rolling resistance
+   and an optional load torque. The figures are nominal ones for the motor
+   each MOTOR_TYPE names, not measured. The two wheels are not coupled
+   through the chassis.
+   Encoder: ENCODER_LINES of channel A per wheel revolution, channel B a
+   quarter line behind it. IC1 sees channel A of the right encoder, IC3/IC4
+   channels A/B of the left one, with the edge modes of ICM (every edge,
+   every rising or falling, every 4th or 16th rising) and the capture taken
+   from the timer C32 and ICTMR pick. Right channel B is on RH8, which has no
+   input capture, and reaches the firmware through edge detect change
+   notice on port H. All four levels are on their port pins. The right
+   encoder counts down going forward, as the mirrored motor does on the
+   robot.
+   Timers: Timer2/4 with T32 set run as 32 bit timers with Timer3/5, and
+   the output compares take Timer4/5 in place of Timer2/3 when CFGCON
+   OCACLK is set.
+   Drive: LATJ3/LATF8 are the left/right direction pins. A wheel driven
+   backward gets the low part of its PWM period, which is why MotorPWM.c
+   writes the complement of the duty for it. The pins are read with the
+   duty at the start of each period.
+   Interrupt handlers run to completion in priority order, and the time
+   each one takes on the host is kept per handler. They are held off while
+   interrupts are disabled, their flags stay up until they are enabled.
+ ***************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <xc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "MotorPlant.h"
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "MotorSM.h"
+#include "MotorControl.h"
+#include "MotorPWM.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PBCLK3_HZ 50000000.0
+
+// channel A cycles per wheel revolution
+#define ENCODER_LINES    (ENCODER_EDGES_PER_REV / 4)
+
+#if (MOTOR_TYPE==1)
+#define NO_LOAD_RPM      350.0  // at the gearbox output, 12 V
+#define STALL_TORQUE     0.35   // N m at the gearbox output, 12 V
+#elif (MOTOR_TYPE==2)
+#define NO_LOAD_RPM      122.0
+#define STALL_TORQUE     1.0
+#endif
+
+#define GEAR_RATIO       34.0   // WHEEL_RADIUS is in ES_Configure.h
+#define ROBOT_MASS       3.0    // kg, half of it on each wheel
+#define ROTOR_INERTIA    2.0e-6 // kg m^2, at the motor shaft
+#define GEAR_FRICTION    0.03   // N m at the gearbox output
+#define ROLLING_FRICTION (0.02 * ROBOT_MASS / 2 * 9.81 * WHEEL_RADIUS)
+
+#define WHEEL_INERTIA \
+  (ROTOR_INERTIA * GEAR_RATIO * GEAR_RATIO + ROBOT_MASS / 2 * WHEEL_RADIUS * \
+   WHEEL_RADIUS)
+#define NO_LOAD_OMEGA    (NO_LOAD_RPM * 2 * M_PI / 60)
+
+#define NUM_WHEELS       2
+#define NUM_PLANT_TIMERS 6
+#define NUM_ICS          3
+#define NUM_CNS          1
+#define CHANNEL_A        0
+#define CHANNEL_B        1
+
+#define TIMER_ON_MASK    0x00008000u
+#define TIMER_T32_MASK   0x00000008u
+#define IC_C32_MASK      0x00000100u
+#define MAX_ISR_PASSES   64
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+  volatile uint32_t *pCon;
+  volatile uint32_t *pTmr;
+  volatile uint32_t *pPr;
+  uint8_t Vector;
+  bool TypeA;     // Timer1, 2 bit prescaler
+  bool Pair;      // Timer2/4, which run Timer3/5 with them when T32 is set
+  bool WasOn;
+  uint32_t Phase; // PBCLK3 cycles into the current timer tick
+} PlantTimer_t;
+
+typedef struct
+{
+  volatile uint32_t *pCon;
+  volatile uint32_t *pBuf;
+  uint8_t Vector;
+  uint8_t Wheel;
+  uint8_t Channel;
+  uint32_t Rising; // rising edges seen, for the every 4th and 16th modes
+} PlantIC_t;
+
+typedef struct
+{
+  volatile uint32_t *pPort;
+  uint8_t Bit;
+} PlantPin_t;
+
+// one port's change notice, edge detect style
+typedef struct
+{
+  volatile uint32_t *pPort;
+  volatile uint32_t *pCon;
+  volatile uint32_t *pEnable;        // rising edges, CNENx
+  volatile uint32_t *pFallingEnable; // CNNEx
+  volatile uint32_t *pFlags;         // CNFx
+  uint8_t Vector;
+} PlantCN_t;
+
+typedef struct
+{
+  double Omega;     // rad/s, positive forward
+  double Lines;     // encoder position in lines, the angle times ENCODER_LINES
+  double Load;      // N m, opposing motion
+  double Duty;      // drive this period, -1 to 1, positive forward
+  int8_t Sign;      // encoder count direction going forward
+  PlantPin_t PinA;
+  PlantPin_t PinB;
+} PlantWheelState_t;
+
+typedef struct
+{
+  void (*pHandler)(void);
+  uint8_t Vector;
+} PlantIsr_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+// MotorSM's handlers, plain functions in the host build
+void IC1Handler(void);
+void IC2Handler(void);
+void IC3Handler(void);
+void IC4Handler(void);
+void CNHHandler(void);
+void T1Handler(void);
+void T4Handler(void);
+void T7Handler(void);
+
+static uint32_t Prescale(const PlantTimer_t *pTimer);
+static bool Is32Bit(const PlantTimer_t *pTimer);
+static const PlantTimer_t *OCTimer(volatile uint32_t *pOCCon);
+static double LoopRPMPerWheelRPM(PlantWheel_t Which);
+static void AdvanceTimers(uint32_t Cycles);
+static uint64_t CyclesToMatch(const PlantTimer_t *pTimer);
+static void LatchDuty(void);
+static void StepWheel(PlantWheelState_t *pWheel, double Seconds);
+static void EncoderEdge(uint8_t Wheel, int32_t Quarter, bool Up);
+static void SetPin(const PlantPin_t *pPin, bool High);
+static void TakeInterrupts(void);
+static void RunPeriod(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+static PlantTimer_t Timers[NUM_PLANT_TIMERS] =
+{
+  { &T1CON, &TMR1, &PR1, _TIMER_1_VECTOR, true, false },
+  { &T2CON, &TMR2, &PR2, _TIMER_2_VECTOR, false, true },
+  { &T3CON, &TMR3, &PR3, _TIMER_3_VECTOR, false, false },
+  { &T4CON, &TMR4, &PR4, _TIMER_4_VECTOR, false, true },
+  { &T5CON, &TMR5, &PR5, _TIMER_5_VECTOR, false, false },
+  { &T7CON, &TMR7, &PR7, _TIMER_7_VECTOR, false, false },
+};
+
+static PlantIC_t ICs[NUM_ICS] =
+{
+  { &IC1CON, &IC1BUF, _INPUT_CAPTURE_1_VECTOR, PlantRight, CHANNEL_A },
+  { &IC3CON, &IC3BUF, _INPUT_CAPTURE_3_VECTOR, PlantLeft, CHANNEL_A },
+  { &IC4CON, &IC4BUF, _INPUT_CAPTURE_4_VECTOR, PlantLeft, CHANNEL_B },
+};
+
+static const PlantCN_t CNs[NUM_CNS] =
+{
+  { &PORTH, &CNCONH, &CNENH, &CNNEH, &CNFH, _CHANGE_NOTICE_H_VECTOR },
+};
+
+static PlantWheelState_t Wheels[NUM_WHEELS];
+
+// highest priority first, IPL7 (encoder edges, then PWM period start,
+// then T1), then IPL6
+static const PlantIsr_t Isrs[] =
+{
+  { IC1Handler, _INPUT_CAPTURE_1_VECTOR },
+  { IC2Handler, _INPUT_CAPTURE_2_VECTOR },
+  { IC3Handler, _INPUT_CAPTURE_3_VECTOR },
+  { IC4Handler, _INPUT_CAPTURE_4_VECTOR },
+  { CNHHandler, _CHANGE_NOTICE_H_VECTOR },
+  { T4Handler, _TIMER_4_VECTOR },
+  { T1Handler, _TIMER_1_VECTOR },
+  { T7Handler, _TIMER_7_VECTOR },
+};
+#define NUM_ISRS (sizeof(Isrs) / sizeof(Isrs[0]))
+
+static PlantIsrStats_t IsrStats[NUM_ISRS] =
+{
+  { "IC1" }, { "IC2" }, { "IC3" }, { "IC4" }, { "CNH" }, { "T4" }, { "T1" },
+  { "T7" }
+};
+
+static uint64_t Now;           // PBCLK3 cycles since MotorPlant_Init
+static uint32_t TimingOverhead; // ns the time stamps themselves take
+
+static const uint32_t TypeAPrescale[4] = { 1, 8, 64, 256 };
+static const uint32_t TypeBPrescale[8] = { 1, 2, 4, 8, 16, 32, 64, 256 };
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     MotorPlant_Init
+ Parameters
+     None
+ Returns
+     None
+ Description
+     Resets the registers, puts both wheels at rest with no load and runs
+     InitMotorSM, the way the part comes out of reset. The framework is not
+     started, so the ES_INIT MotorSM posts to itself goes nowhere.
+****************************************************************************/
+void MotorPlant_Init(void)
+{
+  uint32_t Fastest = UINT32_MAX;
+  uint8_t i;
+
+  HostSFR_Reset();
+  memset(Wheels, 0, sizeof(Wheels));
+  for (i = 0; i < NUM_PLANT_TIMERS; i++)
+  {
+    Timers[i].WasOn = false;
+    Timers[i].Phase = 0;
+  }
+  for (i = 0; i < NUM_ICS; i++)
+  {
+    ICs[i].Rising = 0;
+  }
+  Wheels[PlantLeft].Sign = 1;
+  Wheels[PlantLeft].PinA = (PlantPin_t){ &PORTC, 1 };
+  Wheels[PlantLeft].PinB = (PlantPin_t){ &PORTC, 4 };
+  Wheels[PlantRight].Sign = -1;
+  Wheels[PlantRight].PinA = (PlantPin_t){ &PORTD, 0 };
+  Wheels[PlantRight].PinB = (PlantPin_t){ &PORTH, 8 };
+  Now = 0;
+
+  // the encoders start part way into a line, away from any edge
+  for (i = 0; i < NUM_WHEELS; i++)
+  {
+    Wheels[i].Lines = 0.1;
+    SetPin(&Wheels[i].PinA, true);
+    SetPin(&Wheels[i].PinB, true);
+  }
+
+  InitMotorSM(0);
+  HostSFR_Sync();
+
+  // the smallest gap between two time stamps is taken off every handler time
+  for (i = 0; i < 100; i++)
+  {
+    uint64_t Start = _HW_Host_GetNanos();
+    uint32_t Gap = (uint32_t)(_HW_Host_GetNanos() - Start);
+
+    if (Gap < Fastest)
+    {
+      Fastest = Gap;
+    }
+  }
+  TimingOverhead = Fastest;
+  MotorPlant_ResetIsrStats();
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_Run
+ Parameters
+     double Seconds: simulated time to run for
+ Returns
+     None
+ Description
+     Runs whole PWM periods until at least Seconds more have gone by
+****************************************************************************/
+void MotorPlant_Run(double Seconds)
+{
+  uint64_t End = Now + (uint64_t)(Seconds * PBCLK3_HZ);
+
+  // pick up anything the caller wrote through SET/CLR
+  TakeInterrupts();
+  while (Now < End)
+  {
+    RunPeriod();
+  }
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_GetTime
+ Returns
+     double seconds of simulated time since MotorPlant_Init
+****************************************************************************/
+double MotorPlant_GetTime(void)
+{
+  return Now / PBCLK3_HZ;
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_GetWheelRPM
+ Parameters
+     PlantWheel_t Which: the wheel
+ Returns
+     double the wheel's true speed, RPM, negative going backward
+****************************************************************************/
+double MotorPlant_GetWheelRPM(PlantWheel_t Which)
+{
+  return Wheels[Which].Omega * 60 / (2 * M_PI);
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_GetMeasuredRPM
+ Parameters
+     PlantWheel_t Which: the wheel
+ Returns
+     double the wheel's speed in the units of the speed loop, negative
+         going backward
+ Description
+     What SPEED_CONVERSION_FACTOR over the pulse length reads at the wheel's
+     true speed with no edge jitter. This is the value to compare with the
+     set point.
+****************************************************************************/
+double MotorPlant_GetMeasuredRPM(PlantWheel_t Which)
+{
+  return MotorPlant_GetWheelRPM(Which) * LoopRPMPerWheelRPM(Which);
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_GetDuty
+ Parameters
+     PlantWheel_t Which: the wheel
+ Returns
+     double the drive the wheel got this PWM period, -1 to 1
+****************************************************************************/
+double MotorPlant_GetDuty(PlantWheel_t Which)
+{
+  return Wheels[Which].Duty;
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_SetLoad
+ Parameters
+     PlantWheel_t Which: the wheel
+     double NewtonMeters: torque opposing the wheel's motion, on top of the
+         friction
+ Returns
+     None
+****************************************************************************/
+void MotorPlant_SetLoad(PlantWheel_t Which, double NewtonMeters)
+{
+  Wheels[Which].Load = NewtonMeters;
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_GetIsrStats
+ Parameters
+     uint8_t *pCount: set to the number of entries
+ Returns
+     const PlantIsrStats_t * the handler times since the last reset
+****************************************************************************/
+const PlantIsrStats_t *MotorPlant_GetIsrStats(uint8_t *pCount)
+{
+  *pCount = NUM_ISRS;
+  return IsrStats;
+}
+
+/****************************************************************************
+ Function
+     MotorPlant_ResetIsrStats
+****************************************************************************/
+void MotorPlant_ResetIsrStats(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < NUM_ISRS; i++)
+  {
+    IsrStats[i].Calls = 0;
+    IsrStats[i].Nanos = 0;
+    IsrStats[i].MaxNanos = 0;
+  }
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static uint32_t Prescale(const PlantTimer_t *pTimer)
+{
+  if (pTimer->TypeA)
+  {
+    return TypeAPrescale[(*pTimer->pCon >> 4) & 0x3];
+  }
+  return TypeBPrescale[(*pTimer->pCon >> 4) & 0x7];
+}
+
+// Timer2/4 with T32 set count 32 bits in TMRx/PRx, flag the match with the
+// odd timer's interrupt and leave that timer's own registers alone
+static bool Is32Bit(const PlantTimer_t *pTimer)
+{
+  return pTimer->Pair && (*pTimer->pCon & TIMER_T32_MASK);
+}
+
+// the 16 bit timer an output compare runs from: OCTSEL picks x or y of
+// Timer2/3, or of Timer4/5 with CFGCON OCACLK set (OC1 to OC3)
+static const PlantTimer_t *OCTimer(volatile uint32_t *pOCCon)
+{
+  uint8_t Index = CFGCONbits.OCACLK ? 3 : 1;
+
+  return &Timers[Index + ((*pOCCon & 0x8) ? 1 : 0)];
+}
+
+// the speed loop's RPM for one wheel RPM. SPEED_CONVERSION_FACTOR takes
+// the pulse length, 1/ENCODER_RESOLUTION of a turn, in SPEED_LOOP_TIMER_HZ
+// ticks, and it is counted in ticks of the capture timer (Timer2/3) as it
+// is set now
+static double LoopRPMPerWheelRPM(PlantWheel_t Which)
+{
+  (void)Which;
+  return SPEED_LOOP_TIMER_HZ / (PBCLK3_HZ / Prescale(&Timers[1]));
+}
+
+// cycles until TMRx matches PRx, counting through the top if it is past
+static uint64_t CyclesToMatch(const PlantTimer_t *pTimer)
+{
+  uint32_t Mask = Is32Bit(pTimer) ? 0xFFFFFFFF : 0xFFFF;
+  uint64_t Ticks = (uint64_t)((*pTimer->pPr - *pTimer->pTmr) & Mask) + 1;
+
+  // a timer just turned on starts with a cleared prescaler
+  return Ticks * Prescale(pTimer) - (pTimer->WasOn ? pTimer->Phase : 0);
+}
+
+// moves every running timer on, raising its flag at the period match
+static void AdvanceTimers(uint32_t Cycles)
+{
+  uint8_t i;
+
+  for (i = 0; i < NUM_PLANT_TIMERS; i++)
+  {
+    PlantTimer_t *pTimer = &Timers[i];
+    uint32_t Presc, Ticks, Mask;
+    uint64_t ToMatch;
+
+    if (((*pTimer->pCon & TIMER_ON_MASK) == 0) ||
+        ((i > 0) && Is32Bit(&Timers[i - 1])))
+    {
+      pTimer->WasOn = false;
+      continue;
+    }
+    if (!pTimer->WasOn)
+    {
+      // turning the timer on clears the prescaler
+      pTimer->Phase = 0;
+      pTimer->WasOn = true;
+    }
+    Presc = Prescale(pTimer);
+    Ticks = (pTimer->Phase + Cycles) / Presc;
+    pTimer->Phase = (pTimer->Phase + Cycles) % Presc;
+    Mask = Is32Bit(pTimer) ? 0xFFFFFFFF : 0xFFFF;
+    ToMatch = (uint64_t)((*pTimer->pPr - *pTimer->pTmr) & Mask) + 1;
+    if (Ticks >= ToMatch)
+    {
+      // the match resets the count the next tick
+      *pTimer->pTmr = (uint32_t)((Ticks - ToMatch) %
+          ((uint64_t)(*pTimer->pPr & Mask) + 1));
+      HostSFR_SetIntFlag(Is32Bit(pTimer) ? Timers[i + 1].Vector :
+          pTimer->Vector);
+    }
+    else
+    {
+      *pTimer->pTmr = (*pTimer->pTmr + Ticks) & Mask;
+    }
+  }
+}
+
+// the output compares load OCxRS at the start of each PWM period
+static void LatchDuty(void)
+{
+  const PlantTimer_t *pLeftTimer = OCTimer(&OC2CON);
+  const PlantTimer_t *pRightTimer = OCTimer(&OC1CON);
+  bool LeftOn = OC2CONbits.ON && (OC2CONbits.OCM == 0x6) &&
+      (*pLeftTimer->pCon & TIMER_ON_MASK);
+  bool RightOn = OC1CONbits.ON && (OC1CONbits.OCM == 0x6) &&
+      (*pRightTimer->pCon & TIMER_ON_MASK);
+  double Left, Right;
+
+  OC1R = OC1RS;
+  OC2R = OC2RS;
+  Left = LeftOn ? fmin((double)(OC2R & 0xFFFF) /
+      ((*pLeftTimer->pPr & 0xFFFF) + 1), 1) : 0;
+  Right = RightOn ? fmin((double)(OC1R & 0xFFFF) /
+      ((*pRightTimer->pPr & 0xFFFF) + 1), 1) : 0;
+
+  // backward drives in the low part of the period
+  Wheels[PlantLeft].Duty = LATJbits.LATJ3 ? -(1 - Left) : Left;
+  Wheels[PlantRight].Duty = LATFbits.LATF8 ? -(1 - Right) : Right;
+  if (!LeftOn)
+  {
+    Wheels[PlantLeft].Duty = 0;
+  }
+  if (!RightOn)
+  {
+    Wheels[PlantRight].Duty = 0;
+  }
+}
+
+// one wheel's speed over a PWM period, friction holds a stopped wheel
+// until the drive overcomes it
+static void StepWheel(PlantWheelState_t *pWheel, double Seconds)
+{
+  double Drive = STALL_TORQUE * (pWheel->Duty - pWheel->Omega / NO_LOAD_OMEGA);
+  double Resist = GEAR_FRICTION + ROLLING_FRICTION + pWheel->Load;
+  double Omega;
+
+  if (pWheel->Omega == 0)
+  {
+    if (fabs(Drive) <= Resist)
+    {
+      return;
+    }
+    Omega = (Drive - copysign(Resist, Drive)) / WHEEL_INERTIA * Seconds;
+  }
+  else
+  {
+    Omega = pWheel->Omega + (Drive - copysign(Resist, pWheel->Omega)) /
+        WHEEL_INERTIA * Seconds;
+    if ((Omega * pWheel->Omega) < 0)
+    {
+      Omega = 0; // friction stops it, it does not reverse it
+    }
+  }
+  pWheel->Omega = Omega;
+}
+
+// drives an encoder pin, and flags the edge to a change notice set up for it
+static void SetPin(const PlantPin_t *pPin, bool High)
+{
+  uint32_t Mask = 1u << pPin->Bit;
+  bool Was = (*pPin->pPort & Mask) != 0;
+  uint8_t i;
+
+  if (High)
+  {
+    *pPin->pPort |= Mask;
+  }
+  else
+  {
+    *pPin->pPort &= ~Mask;
+  }
+  if (Was == High)
+  {
+    return;
+  }
+  for (i = 0; i < NUM_CNS; i++)
+  {
+    const PlantCN_t *pCN = &CNs[i];
+
+    if ((pCN->pPort != pPin->pPort) ||
+        ((*pCN->pCon & _CNCONH_ON_MASK) == 0) ||
+        ((*pCN->pCon & _CNCONH_EDGEDETECT_MASK) == 0))
+    {
+      continue;
+    }
+    if (*(High ? pCN->pEnable : pCN->pFallingEnable) & Mask)
+    {
+      *pCN->pFlags |= Mask;
+      HostSFR_SetIntFlag(pCN->Vector);
+    }
+  }
+}
+
+// crossing quarter line Quarter (position Quarter / 4) moving up or down.
+// A is high for the first half of a line, B from 3/4 of a line to 1/4 of
+// the next
+static void EncoderEdge(uint8_t Wheel, int32_t Quarter, bool Up)
+{
+  PlantWheelState_t *pWheel = &Wheels[Wheel];
+  uint8_t Phase = (uint8_t)(((Quarter % 4) + 4) % 4);
+  uint8_t Channel = (Phase & 1) ? CHANNEL_B : CHANNEL_A;
+  bool High;
+  uint8_t i;
+
+  switch (Phase)
+  {
+    case 0: High = Up; break;   // A
+    case 1: High = !Up; break;  // B
+    case 2: High = !Up; break;  // A
+    default: High = Up; break;  // B
+  }
+  SetPin((Channel == CHANNEL_A) ? &pWheel->PinA : &pWheel->PinB, High);
+
+  for (i = 0; i < NUM_ICS; i++)
+  {
+    PlantIC_t *pIC = &ICs[i];
+    bool Capture;
+
+    if ((pIC->Wheel != Wheel) || (pIC->Channel != Channel))
+    {
+      continue;
+    }
+    if ((*pIC->pCon & TIMER_ON_MASK) == 0)
+    {
+      pIC->Rising = 0;
+      continue;
+    }
+    if (High)
+    {
+      pIC->Rising++;
+    }
+    switch (*pIC->pCon & 0x7)
+    {
+      case 0x1: Capture = true; break;
+      case 0x2: Capture = !High; break;
+      case 0x3: Capture = High; break;
+      case 0x4: Capture = High && ((pIC->Rising % 4) == 0); break;
+      case 0x5: Capture = High && ((pIC->Rising % 16) == 0); break;
+      default: Capture = false; break;
+    }
+    if (Capture)
+    {
+      // C32 set is the 32 bit Timer2/3, otherwise ICTMR set is Timer2,
+      // clear is Timer3
+      if (*pIC->pCon & IC_C32_MASK)
+      {
+        *pIC->pBuf = TMR2;
+      }
+      else
+      {
+        *pIC->pBuf = (*pIC->pCon & 0x80) ? (TMR2 & 0xFFFF) : TMR3;
+      }
+      HostSFR_SetIntFlag(pIC->Vector);
+    }
+  }
+}
+
+// runs every enabled handler with its flag up, highest priority first, as
+// many times as they keep getting raised. None while interrupts are disabled
+static void TakeInterrupts(void)
+{
+  uint8_t Passes = 0;
+  uint8_t i;
+
+  HostSFR_Sync();
+  if (!HostSFR_IntsEnabled)
+  {
+    return;
+  }
+  for (i = 0; i < NUM_ISRS; i++)
+  {
+    if (HostSFR_IsIntEnabled(Isrs[i].Vector) &&
+        HostSFR_IsIntFlagSet(Isrs[i].Vector))
+    {
+      uint64_t Start = _HW_Host_GetNanos();
+      uint32_t Nanos;
+
+      Isrs[i].pHandler();
+      Nanos = (uint32_t)(_HW_Host_GetNanos() - Start);
+      Nanos = (Nanos > TimingOverhead) ? (Nanos - TimingOverhead) : 0;
+      IsrStats[i].Calls++;
+      IsrStats[i].Nanos += Nanos;
+      if (Nanos > IsrStats[i].MaxNanos)
+      {
+        IsrStats[i].MaxNanos = Nanos;
+      }
+      HostSFR_Sync();
+
+      if (++Passes == MAX_ISR_PASSES)
+      {
+        fprintf(stderr, "plant: %s keeps its flag up\n", IsrStats[i].pName);
+        exit(1);
+      }
+      i = UINT8_MAX; // back to the top
+    }
+  }
+}
+
+// one PWM period: latch the duty cycles, step the motors, then take the
+// encoder edges and timer matches inside it in time order
+static void RunPeriod(void)
+{
+  const PlantTimer_t *pPwmTimer = OCTimer(&OC1CON);
+  uint32_t Period = ((*pPwmTimer->pPr & 0xFFFF) + 1) * Prescale(pPwmTimer);
+  double Start[NUM_WHEELS], Travel[NUM_WHEELS];
+  int32_t Next[NUM_WHEELS]; // the next quarter line each wheel crosses
+  uint32_t Elapsed = 0;
+  uint8_t w;
+
+  LatchDuty();
+  for (w = 0; w < NUM_WHEELS; w++)
+  {
+    double OldOmega = Wheels[w].Omega;
+
+    StepWheel(&Wheels[w], Period / PBCLK3_HZ);
+    Start[w] = Wheels[w].Lines;
+    Travel[w] = Wheels[w].Sign * (OldOmega + Wheels[w].Omega) / 2 *
+        (Period / PBCLK3_HZ) / (2 * M_PI) * ENCODER_LINES;
+    Wheels[w].Lines += Travel[w];
+    Next[w] = (Travel[w] > 0) ? (int32_t)floor(Start[w] * 4) + 1 :
+        (int32_t)ceil(Start[w] * 4) - 1;
+  }
+
+  for (;;)
+  {
+    uint32_t Event = Period;
+    int8_t Edge = -1;
+    uint8_t i;
+
+    for (w = 0; w < NUM_WHEELS; w++)
+    {
+      double Fraction;
+      uint32_t When;
+
+      if (Travel[w] == 0)
+      {
+        continue;
+      }
+      Fraction = (Next[w] / 4.0 - Start[w]) / Travel[w];
+      if (Fraction > 1)
+      {
+        continue;
+      }
+      When = (uint32_t)ceil(Fraction * Period);
+      if (When < Elapsed)
+      {
+        When = Elapsed;
+      }
+      if ((When < Event) || ((When == Event) && (Edge < 0)))
+      {
+        Event = When;
+        Edge = (int8_t)w;
+      }
+    }
+    for (i = 0; i < NUM_PLANT_TIMERS; i++)
+    {
+      if ((*Timers[i].pCon & TIMER_ON_MASK) &&
+          !((i > 0) && Is32Bit(&Timers[i - 1])))
+      {
+        uint64_t When = Elapsed + CyclesToMatch(&Timers[i]);
+
+        if (When < Event)
+        {
+          Event = When;
+          Edge = -1;
+        }
+      }
+    }
+
+    AdvanceTimers(Event - Elapsed);
+    Elapsed = Event;
+    if (Edge >= 0)
+    {
+      EncoderEdge((uint8_t)Edge, Next[Edge], Travel[Edge] > 0);
+      Next[Edge] += (Travel[Edge] > 0) ? 1 : -1;
+    }
+    TakeInterrupts();
+
+    if ((Elapsed == Period) && (Edge < 0))
+    {
+      break;
+    }
+  }
+  Now += Period;
+}
+
+#ifdef TEST_PLANT
+/* Closed loop benchmark (make -f Makefile.host motor_bench).
+   Drives the real MotorSM through the plant with SetDesiredSpeed, the way
+   JetsonSM does, over step, ramp, reversal, turn, load and crawl
+   scenarios. Each one starts from rest. For the last set point of a scenario it reports,
+   per wheel, in the speed loop's own RPM (see MotorPlant_GetMeasuredRPM):
+   the 10-90% rise time, the overshoot past the set point, and the mean
+   steady state error and the RMS ripple about it over the last 0.5 s. A
+   scenario can run the PWM at its own frequency, set at rest with
+   MotorPWM_SetFrequency. Then both wheels are reversed with a PWM period
+   start between the two, as when T1Handler is late, and any period either
+   is driven the wrong way after it fails the bench. Then the time MotorSM's
+   handlers took on the host, per call and per simulated second.
+   With a file argument, every millisecond of every scenario is written
+   there as CSV for plotting. */
+#define SAMPLE_PERIOD 0.001
+#define SETTLE_WINDOW 0.5
+#define REST_TIME     1.0
+
+typedef struct
+{
+  const char *pName;
+  double Duration;   // s
+  double ChangeAt;   // s, when the measured set point is given
+  double V0, W0;     // before ChangeAt (m/s, rad/s)
+  double V1, W1;     // from ChangeAt on
+  double RampTime;   // s, V0 to V1 in Jetson sized steps, 0 for a step
+  double LoadAt;     // s, when LoadTorque is put on, 0 for none
+  double LoadTorque; // N m on each wheel
+  uint32_t PwmHz;    // 0 for MOTOR_PWM_HZ
+} Scenario_t;
+
+static const Scenario_t Scenarios[] =
+{
+  { "step 0.1 m/s",      2.0, 0.0, 0, 0, 0.10, 0, 0, 0, 0 },
+  { "step 0.3 m/s",      2.0, 0.0, 0, 0, 0.30, 0, 0, 0, 0 },
+  { "ramp 0-0.3 m/s 1s", 2.5, 0.0, 0, 0, 0.30, 0, 1.0, 0, 0 },
+  { "reverse +-0.2 m/s", 4.0, 2.0, 0.2, 0, -0.20, 0, 0, 0, 0 },
+  { "turn 1.5 rad/s",    2.0, 0.0, 0, 0, 0, 1.5, 0, 0, 0 },
+  { "load 0.2 Nm",       4.0, 0.0, 0, 0, 0.20, 0, 0, 2.0, 0.2 },
+  { "crawl 0.02 m/s",     3.0, 0.0, 0, 0, 0.02, 0, 0, 0, 0 },
+  { "crawl 20 kHz PWM",   3.0, 0.0, 0, 0, 0.02, 0, 0, 0, 0, 20000 },
+};
+
+typedef struct
+{
+  double Target;    // set point, speed loop RPM, negative backward
+  double Start;     // speed when the set point was given
+  double Rise10;    // s, 0 until reached
+  double Rise90;
+  double Peak;      // furthest past the set point
+  double ErrorSum;  // over the settle window
+  double SquareSum; // of the speed, over the settle window
+  double SpeedSum;
+  uint32_t ErrorCount;
+} WheelResult_t;
+
+static FILE *pTrace;
+
+static void Command(double V, double W)
+{
+  SetDesiredSpeed((float)V, (float)W);
+}
+
+// reverses both wheels from forward with a period start between the two,
+// interrupts held off as they are in T1Handler. Returns the periods after
+// that either wheel is driven forward
+static uint8_t ReverseAcrossPeriodStart(void)
+{
+  const int16_t Drive = MOTOR_PWM_FULL / 2;
+  double Period;
+  uint8_t Wrong = 0;
+  uint8_t n;
+
+  // stop, so T1Handler is off and the drives are the bench's
+  Command(0, 0);
+  MotorPWM_SetFrequency(MOTOR_PWM_HZ);
+  MotorPlant_Run(REST_TIME);
+  Period = 1.0 / MotorPWM_GetFrequency();
+
+  MotorPWM_SetDrive(MotorPWMLeft, Drive);
+  MotorPWM_SetDrive(MotorPWMRight, Drive);
+  MotorPlant_Run(4 * Period);
+
+  __builtin_disable_interrupts();
+  MotorPWM_SetDrive(MotorPWMLeft, -Drive);
+  MotorPlant_Run(Period / 2); // to the next period start
+  MotorPWM_SetDrive(MotorPWMRight, -Drive);
+  __builtin_enable_interrupts();
+
+  for (n = 0; n < 4; n++)
+  {
+    MotorPlant_Run(Period / 2);
+    if ((MotorPlant_GetDuty(PlantLeft) > 0) ||
+        (MotorPlant_GetDuty(PlantRight) > 0))
+    {
+      Wrong++;
+    }
+  }
+
+  MotorPWM_SetDrive(MotorPWMLeft, 0);
+  MotorPWM_SetDrive(MotorPWMRight, 0);
+  MotorPlant_Run(REST_TIME);
+  return Wrong;
+}
+
+static void RunScenario(const Scenario_t *pScenario)
+{
+  WheelResult_t Result[NUM_WHEELS];
+  double T = 0;
+  bool Changed = false;
+  bool Loaded = false;
+  double LastRampStep = -1;
+  uint8_t w;
+
+  // stop, and wait for the wheels to come to rest and their speed
+  // estimates to time out
+  Command(0, 0);
+  MotorPlant_SetLoad(PlantLeft, 0);
+  MotorPlant_SetLoad(PlantRight, 0);
+  MotorPWM_SetFrequency(pScenario->PwmHz ? pScenario->PwmHz : MOTOR_PWM_HZ);
+  MotorPlant_Run(REST_TIME);
+
+  memset(Result, 0, sizeof(Result));
+  if (pScenario->ChangeAt > 0)
+  {
+    Command(pScenario->V0, pScenario->W0);
+  }
+  while (T < pScenario->Duration)
+  {
+    if (!Changed && (T >= pScenario->ChangeAt))
+    {
+      uint16_t Desired[NUM_WHEELS];
+      // the direction SetDesiredSpeed sets the pins for
+      double Wheel[NUM_WHEELS] = {
+        pScenario->V1 - pScenario->W1 * WHEEL_BASE / 2,
+        pScenario->V1 + pScenario->W1 * WHEEL_BASE / 2 };
+
+      // a ramp is measured against the set point it ends at, and starts
+      // from the top of the loop below
+      Changed = true;
+      Command(pScenario->V1, pScenario->W1);
+      QueryDesiredRPM(&Desired[PlantLeft], &Desired[PlantRight]);
+      for (w = 0; w < NUM_WHEELS; w++)
+      {
+        Result[w].Target = (Wheel[w] < 0) ? -Desired[w] : Desired[w];
+        Result[w].Start = MotorPlant_GetMeasuredRPM((PlantWheel_t)w);
+      }
+    }
+    // the Jetson sends a new set point every 20 ms
+    if ((pScenario->RampTime > 0) && (T < pScenario->RampTime) &&
+        (T - LastRampStep >= 0.02))
+    {
+      LastRampStep = T;
+      Command(pScenario->V1 * (T + 0.02) / pScenario->RampTime,
+          pScenario->W1);
+    }
+    else if ((pScenario->RampTime > 0) && (T >= pScenario->RampTime) &&
+        (LastRampStep < pScenario->RampTime))
+    {
+      LastRampStep = pScenario->RampTime;
+      Command(pScenario->V1, pScenario->W1);
+    }
+    if (!Loaded && (pScenario->LoadAt > 0) && (T >= pScenario->LoadAt))
+    {
+      Loaded = true;
+      MotorPlant_SetLoad(PlantLeft, pScenario->LoadTorque);
+      MotorPlant_SetLoad(PlantRight, pScenario->LoadTorque);
+    }
+
+    MotorPlant_Run(SAMPLE_PERIOD);
+    T += SAMPLE_PERIOD;
+
+    for (w = 0; w < NUM_WHEELS; w++)
+    {
+      WheelResult_t *pResult = &Result[w];
+      double Speed = MotorPlant_GetMeasuredRPM((PlantWheel_t)w);
+      double Span = pResult->Target - pResult->Start;
+      double Over;
+
+      if (!Changed)
+      {
+        continue;
+      }
+      // rise is measured from where the wheel was, toward the set point
+      if ((pResult->Rise10 == 0) &&
+          ((Speed - pResult->Start) * Span >= 0.1 * Span * Span))
+      {
+        pResult->Rise10 = T;
+      }
+      if ((pResult->Rise90 == 0) &&
+          ((Speed - pResult->Start) * Span >= 0.9 * Span * Span))
+      {
+        pResult->Rise90 = T;
+      }
+      Over = (Span < 0) ? (pResult->Target - Speed) : (Speed - pResult->Target);
+      if (Over > pResult->Peak)
+      {
+        pResult->Peak = Over;
+      }
+      if (T > pScenario->Duration - SETTLE_WINDOW)
+      {
+        // positive is short of the set point
+        pResult->ErrorSum += (pResult->Target < 0) ? (Speed - pResult->Target) :
+            (pResult->Target - Speed);
+        pResult->SpeedSum += Speed;
+        pResult->SquareSum += Speed * Speed;
+        pResult->ErrorCount++;
+      }
+    }
+    if (pTrace != NULL)
+    {
+      fprintf(pTrace, "%s,%.3f,%.0f,%.1f,%.1f,%.3f,%.3f\n", pScenario->pName, T,
+          Result[PlantLeft].Target,
+          MotorPlant_GetMeasuredRPM(PlantLeft),
+          MotorPlant_GetMeasuredRPM(PlantRight),
+          MotorPlant_GetDuty(PlantLeft), MotorPlant_GetDuty(PlantRight));
+    }
+  }
+
+  for (w = 0; w < NUM_WHEELS; w++)
+  {
+    const WheelResult_t *pResult = &Result[w];
+    char Rise[16];
+    double Ripple = 0;
+
+    if (pResult->Rise90 > 0)
+    {
+      snprintf(Rise, sizeof(Rise), "%.0f",
+          (pResult->Rise90 - pResult->Rise10) * 1000);
+    }
+    else
+    {
+      snprintf(Rise, sizeof(Rise), "-");
+    }
+    if (pResult->ErrorCount && (pResult->Target != 0))
+    {
+      double Mean = pResult->SpeedSum / pResult->ErrorCount;
+
+      Ripple = 100 * sqrt(fmax(pResult->SquareSum / pResult->ErrorCount -
+          Mean * Mean, 0)) / fabs(pResult->Target);
+    }
+    printf("%-19s %-5s %6.0f %8s %9.1f %9.1f %6.1f %8.2f\n",
+        (w == 0) ? pScenario->pName : "", (w == PlantLeft) ? "left" : "right",
+        pResult->Target, Rise,
+        (pResult->Target != 0) ? 100 * pResult->Peak / fabs(pResult->Target) : 0,
+        pResult->ErrorCount ? pResult->ErrorSum / pResult->ErrorCount : 0,
+        (pResult->ErrorCount && (pResult->Target != 0)) ? 100 *
+          pResult->ErrorSum / pResult->ErrorCount / fabs(pResult->Target) : 0,
+        Ripple);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  const PlantIsrStats_t *pStats;
+  uint64_t Wall;
+  double Simulated;
+  uint8_t Count, Wrong, i;
+
+  if (argc > 1)
+  {
+    pTrace = fopen(argv[1], "w");
+    if (pTrace == NULL)
+    {
+      printf("plant: can not open %s\n", argv[1]);
+      return 1;
+    }
+    fprintf(pTrace, "scenario,t,target,left,right,left duty,right duty\n");
+  }
+
+  MotorPlant_Init();
+  printf("speed loop RPM = %.2f x wheel RPM\n",
+      LoopRPMPerWheelRPM(PlantLeft));
+  printf("%-19s %-5s %6s %8s %9s %9s %6s %8s\n", "scenario", "wheel",
+      "target", "rise ms", "overshot%", "ss error", "ss %", "ripple%");
+
+  Wall = _HW_Host_GetNanos();
+  for (i = 0; i < sizeof(Scenarios) / sizeof(Scenarios[0]); i++)
+  {
+    RunScenario(&Scenarios[i]);
+  }
+  Wrong = ReverseAcrossPeriodStart();
+  Wall = _HW_Host_GetNanos() - Wall;
+  Simulated = MotorPlant_GetTime();
+  printf("\nreversal across a PWM period start: %u periods driven the wrong"
+      " way\n", Wrong);
+
+  printf("\n%-5s %12s %9s %9s %13s\n", "isr", "calls/sim s", "ns/call",
+      "max ns", "ns/sim s");
+  pStats = MotorPlant_GetIsrStats(&Count);
+  for (i = 0; i < Count; i++)
+  {
+    if (pStats[i].Calls == 0)
+    {
+      continue;
+    }
+    printf("%-5s %12.0f %9.1f %9u %13.0f\n", pStats[i].pName,
+        pStats[i].Calls / Simulated, (double)pStats[i].Nanos / pStats[i].Calls,
+        (unsigned)pStats[i].MaxNanos, pStats[i].Nanos / Simulated);
+  }
+  printf("%.1f s simulated in %.2f s, %.0fx real time\n", Simulated,
+      Wall / 1e9, Simulated / (Wall / 1e9));
+
+  if (pTrace != NULL)
+  {
+    fclose(pTrace);
+  }
+  return (Wrong == 0) ? 0 : 1;
+}
+#endif /* TEST_PLANT */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Format ES_LOG records (see FrameworkSource/ES_Log.c).
+
+    es_log.py decode <log> <elf> [-o out.txt] [-t]
+        Replaces every #L line of a terminal capture with the text DB_printf
+        would have printed for it, and leaves all other lines alone. The
+        format strings are read out of <elf>, which has to be the image the
+        firmware was running (the .elf MPLAB X builds, or a host build).
+        -t puts the time of each record, in ms from the first one, in front.
+
+Records the ring lost are reported on stderr, as are gaps in the record
+numbers of the capture.
+"""
+import argparse
+import struct
+import sys
+
+ANCHOR = 'ES_LogAnchor'
+COUNTS_PER_MS = 100000      # core timer, SYSCLK/2
+SHT_PROGBITS, SHT_SYMTAB = 1, 2
+SHF_ALLOC = 0x2
+
+
+class Image:
+    """just enough of an ELF file to read C strings by address"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            sys.exit('%s: not an ELF file' % path)
+        wide = self.data[4] == 2
+        self.order = '<' if self.data[5] == 1 else '>'
+        if wide:
+            shoff, = struct.unpack_from(self.order + 'Q', self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(
+                self.order + 'HHH', self.data, 0x3A)
+            section = struct.Struct(self.order + 'IIQQQQIIQQ')
+            self.symbol = struct.Struct(self.order + 'IBBHQQ')
+        else:
+            shoff, = struct.unpack_from(self.order + 'I', self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(
+                self.order + 'HHH', self.data, 0x2E)
+            section = struct.Struct(self.order + 'IIIIIIIIII')
+            self.symbol = struct.Struct(self.order + 'IIIBBH')
+        self.wide = wide
+        self.sections = [section.unpack_from(self.data, shoff + i * shentsize)
+                         for i in range(shnum)]
+        self.anchor = self.find_symbol(ANCHOR)
+        if self.anchor is None:
+            sys.exit('%s: no %s, built without ES_LOGGING?' % (path, ANCHOR))
+
+    def find_symbol(self, name):
+        for (_, kind, _, _, offset, size, link, _, _, entsize) in self.sections:
+            if kind != SHT_SYMTAB:
+                continue
+            names = self.sections[link]
+            for at in range(offset, offset + size, entsize):
+                fields = self.symbol.unpack_from(self.data, at)
+                if self.wide:
+                    name_at, value = fields[0], fields[4]
+                else:
+                    name_at, value = fields[0], fields[1]
+                if self.string_at(names[4] + name_at) == name:
+                    return value
+        return None
+
+    def string_at(self, at):
+        end = self.data.index(b'\0', at)
+        return self.data[at:end].decode('latin-1')
+
+    def string(self, address):
+        """the C string at a run time address, None if not in the image"""
+        for (_, kind, flags, addr, offset, size, _, _, _, _) in self.sections:
+            if (kind == SHT_PROGBITS and flags & SHF_ALLOC and
+                    addr <= address < addr + size):
+                return self.string_at(offset + address - addr)
+        return None
+
+
+def db_printf(format_string, args):
+    """the text FrameworkSource/dbprintf.c makes of format_string"""
+    out = []
+    args = list(args)
+    i = 0
+    while i < len(format_string):
+        c = format_string[i]
+        i += 1
+        if c != '%':
+            out.append(c)
+            continue
+        spec = format_string[i] if i < len(format_string) else ''
+        i += 1
+        if spec in 'dxuc' and spec and not args:
+            out.append('<missing>')
+            continue
+        if spec == 'd':
+            value = args.pop(0)
+            if value & 0x80000000:
+                out.append('-')
+                value = (-value) & 0xFFFFFFFF
+            out.append(str(value))
+        elif spec == 'x':
+            out.append('%x' % args.pop(0))
+        elif spec == 'u':
+            out.append(str(args.pop(0)))
+        elif spec == 'c':
+            out.append(chr(args.pop(0) & 0xFF))
+        elif spec == 's':
+            out.append('<%s>')   # can not be logged
+        elif spec == '%':
+            out.append('%')
+        else:
+            out.append('BAD')
+    return ''.join(out).replace('\n', '\r\n')
+
+
+def decode(args):
+    image = Image(args.elf)
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    first_time = None
+    previous_seq = None
+    lost = records = 0
+    with open(args.log, 'rb') as f:
+        for raw in f:
+            line = raw.decode('latin-1')
+            start = line.find('#L')
+            if start < 0:
+                out.write(line)
+                continue
+            out.write(line[:start])
+            fields = line[start:].split()
+            if fields[0] == '#LL':
+                count = int(fields[1], 16)
+                lost += count
+                print('%d log records lost' % count, file=sys.stderr)
+                if previous_seq is not None:
+                    previous_seq = (previous_seq + count) & 0xFFFF
+                continue
+            if fields[0] != '#L' or len(fields) < 4:
+                out.write(line[start:])
+                continue
+            seq, time, offset = [int(x, 16) for x in fields[1:4]]
+            values = [int(x, 16) for x in fields[4:]]
+            if previous_seq is not None and seq != (previous_seq + 1) & 0xFFFF:
+                print('gap in the record numbers at %d -> %d'
+                      % (previous_seq, seq), file=sys.stderr)
+            previous_seq = seq
+            if offset & 0x80000000:
+                offset -= 1 << 32
+            format_string = image.string(image.anchor + offset)
+            if format_string is None:
+                format_string = '<format %d not in the image>\n' % offset
+            if args.time:
+                if first_time is None:
+                    first_time = time
+                out.write('[%.3f] ' % (((time - first_time) & 0xFFFFFFFF)
+                                       / COUNTS_PER_MS))
+            out.write(db_printf(format_string, values))
+            records += 1
+    print('%d log records, %d lost' % (records, lost), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest='command', required=True)
+    command = commands.add_parser('decode')
+    command.add_argument('log')
+    command.add_argument('elf')
+    command.add_argument('-o', '--output')
+    command.add_argument('-t', '--time', action='store_true',
+                         help='time stamp each record')
+    command.set_defaults(function=decode)
+    args = parser.parse_args()
+    args.function(args)
+
+
+if __name__ == '__main__':
+    main()
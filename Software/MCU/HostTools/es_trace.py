@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+"""Decode ES_Trace dumps (the 'r' key, see FrameworkSource/ES_Trace.c).
+
+    es_trace.py decode <log> [-o trace.json]
+        Perfetto / chrome://tracing JSON: one track per service with a slice
+        per run function call, posts as instants, queue depths as counters
+        and timer expiries on their own track.
+
+    es_trace.py replay <log> [-o replay.txt]
+        The posts that came from outside the services (ISRs, event checkers,
+        the idle loop), for ES_HOST_REPLAY=replay.txt host_build/robot_host.
+        Timeouts are left out, the replay regenerates them, as are ES_INIT
+        and payload events, whose blocks are not in the trace.
+
+<log> is a terminal capture and may contain other output; only the #TH/#T/
+#TE lines of the last complete dump are used. Event, service and timer
+names come from ES_Configure.h.
+"""
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+RECORD = struct.Struct('<IHBBBBH')   # ES_TraceRecord_t
+FROM_ISR = 0x80
+KINDS = ['post', 'post failed', 'dequeue', 'run start', 'run end',
+         'timer expired', 'post coalesced']
+(POST, POST_FAILED, DEQUEUE, RUN_START, RUN_END, TIMER_EXPIRED,
+ POST_COALESCED) = range(7)
+
+DEFAULT_CONFIG = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                              '..', 'FrameworkHeaders', 'ES_Configure.h')
+
+
+class Config:
+    """the names the trace numbers stand for, read from ES_Configure.h"""
+
+    def __init__(self, path):
+        with open(path) as f:
+            text = f.read()
+        # comments out of the way first, they contain commas and braces
+        text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+        text = re.sub(r'//[^\n]*', '', text)
+        enum = re.search(r'typedef\s+enum\s*\{([^}]*)\}\s*ES_EventType_t',
+                         text)
+        self.events = {}
+        value = 0
+        for entry in enum.group(1).split(','):
+            entry = entry.strip()
+            if not entry:
+                continue
+            if '=' in entry:
+                entry, number = [x.strip() for x in entry.split('=')]
+                value = int(number, 0)
+            self.events[value] = entry
+            value += 1
+        self.event_numbers = {v: k for k, v in self.events.items()}
+        self.services = re.findall(r'SERVICE\(\s*(\w+)\s*,', text)
+        self.timers = {int(n): name for name, n in
+                       re.findall(r'#define\s+(\w+_TIMER)\s+(\d+)', text)}
+        payload = re.search(r'#define\s+PAYLOAD_EVENT_LIST\(EVENT\)(.*?)\n\s*\n',
+                            text + '\n\n', re.S)
+        self.payload_events = set(re.findall(r'EVENT\(\s*(\w+)\s*\)',
+                                             payload.group(1))) if payload else set()
+
+    def event(self, number):
+        return self.events.get(number, 'event %d' % number)
+
+    def service(self, number):
+        if number < len(self.services):
+            return self.services[number]
+        return 'service %d' % number
+
+    def timer(self, number):
+        return self.timers.get(number, 'timer %d' % number)
+
+
+def read_dump(path):
+    """returns (counts per second, [record tuples]) of the last whole dump"""
+    dumps = []
+    current = None
+    with open(path, 'rb') as f:
+        for raw in f:
+            line = raw.decode('ascii', 'replace').strip()
+            start = line.find('#T')
+            if start < 0:
+                continue
+            line = line[start:]
+            if line.startswith('#TH '):
+                fields = line.split()
+                version, size = int(fields[1], 16), int(fields[2], 16)
+                if version != 1 or size != RECORD.size:
+                    sys.exit('%s: trace version %d, record size %d not '
+                             'understood' % (path, version, size))
+                current = {'rate': int(fields[4], 16), 'lost': int(fields[5], 16),
+                           'records': []}
+            elif line.startswith('#TE') and current is not None:
+                dumps.append(current)
+                current = None
+            elif line.startswith('#T ') and current is not None:
+                data = bytes.fromhex(line[3:].strip())
+                if len(data) == RECORD.size:
+                    current['records'].append(RECORD.unpack(data))
+    if not dumps:
+        sys.exit('%s: no complete trace dump (#TH ... #TE) found' % path)
+    dump = dumps[-1]
+    if dump['lost']:
+        print('%d older records were overwritten before the dump'
+              % dump['lost'], file=sys.stderr)
+    check_sequence(dump['records'])
+    return dump['rate'], dump['records']
+
+
+def check_sequence(records):
+    for previous, record in zip(records, records[1:]):
+        if record[6] != (previous[6] + 1) & 0xFFFF:
+            print('gap in the record sequence at %d -> %d'
+                  % (previous[6], record[6]), file=sys.stderr)
+
+
+def unwrap_times(records):
+    """32 bit core timer counts to counts since the first record. Records
+    are in claim order, an ISR can stamp a little ahead of the record before
+    it, so only a big step back is taken as a wrap"""
+    times = []
+    offset = 0
+    previous = None
+    for record in records:
+        time = record[0]
+        if previous is not None and previous - time > 0x80000000:
+            offset += 1 << 32
+        previous = time
+        times.append(time + offset)
+    first = times[0] if times else 0
+    return [t - first for t in times]
+
+
+def decode(args):
+    config = Config(args.config)
+    rate, records = read_dump(args.log)
+    times = unwrap_times(records)
+    us_per_count = 1e6 / rate
+    timer_track = len(config.services)
+    trace = []
+    for number, name in enumerate(config.services + ['Timers']):
+        trace.append({'name': 'thread_name', 'ph': 'M', 'pid': 1,
+                      'tid': number, 'args': {'name': name}})
+        trace.append({'name': 'thread_sort_index', 'ph': 'M', 'pid': 1,
+                      'tid': number, 'args': {'sort_index': -number}})
+    open_runs = set()
+    for time, record in zip(times, records):
+        _, param, event_type, kind, which, depth, seq = record
+        isr = bool(kind & FROM_ISR)
+        kind &= ~FROM_ISR
+        ts = time * us_per_count
+        event = config.event(event_type)
+        common = {'pid': 1, 'ts': ts,
+                  'args': {'param': param, 'isr': isr, 'seq': seq}}
+        if kind == RUN_START:
+            trace.append(dict(common, name=event, ph='B', tid=which))
+            open_runs.add(which)
+        elif kind == RUN_END:
+            if which in open_runs:  # the dump can start mid run
+                trace.append(dict(common, name=event, ph='E', tid=which))
+                open_runs.discard(which)
+        elif kind == DEQUEUE:
+            trace.append({'name': 'queue ' + config.service(which), 'ph': 'C',
+                          'pid': 1, 'ts': ts, 'args': {'waiting': depth}})
+        elif kind in (POST, POST_FAILED, POST_COALESCED):
+            name = {POST: 'post ', POST_FAILED: 'POST FAILED ',
+                    POST_COALESCED: 'post coalesced '}[kind] + event
+            trace.append(dict(common, name=name, ph='i', s='t', tid=which))
+        elif kind == TIMER_EXPIRED:
+            trace.append(dict(common, name=config.timer(which), ph='i', s='t',
+                              tid=timer_track))
+    out = open(args.output, 'w') if args.output else sys.stdout
+    json.dump({'traceEvents': trace, 'displayTimeUnit': 'ns'}, out)
+    out.write('\n')
+    print('%d records, %.3f ms' % (len(records),
+          (times[-1] * us_per_count / 1000) if times else 0), file=sys.stderr)
+
+
+def replay(args):
+    config = Config(args.config)
+    _, records = read_dump(args.log)
+    times = unwrap_times(records)
+    skip = set(config.event_numbers[name] for name in
+               ('ES_INIT', 'ES_TIMEOUT', 'ES_SHORT_TIMEOUT')
+               if name in config.event_numbers)
+    payload = set(config.event_numbers[name] for name in
+                  config.payload_events if name in config.event_numbers)
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write('# <counts (10ns) from the start> <service> <event type> '
+              '<param>\n')
+    # run functions in progress, with ES_PREEMPTIVE a level 1 or 2 run nests
+    # inside a level 0 one and is not marked as ISR
+    depth = 0
+    posts = dropped = 0
+    for time, record in zip(times, records):
+        _, param, event_type, kind, which, _, _ = record
+        isr = bool(kind & FROM_ISR)
+        kind &= ~FROM_ISR
+        if not isr and kind == RUN_START:
+            depth += 1
+        elif not isr and kind == RUN_END:
+            depth = max(depth - 1, 0)   # the dump can start mid run
+        elif (kind in (POST, POST_COALESCED) and (isr or depth == 0) and
+              event_type not in skip):
+            if event_type in payload:
+                dropped += 1
+                continue
+            out.write('%d %d %d %d # %s -> %s\n'
+                      % (time, which, event_type, param,
+                         config.event(event_type), config.service(which)))
+            posts += 1
+    print('%d posts to replay, %d payload events left out' % (posts, dropped),
+          file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--config', default=DEFAULT_CONFIG,
+                        help='ES_Configure.h to take the names from')
+    commands = parser.add_subparsers(dest='command', required=True)
+    for name, function in (('decode', decode), ('replay', replay)):
+        command = commands.add_parser(name)
+        command.add_argument('log')
+        command.add_argument('-o', '--output')
+        command.set_defaults(function=function)
+    args = parser.parse_args()
+    args.function(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Check that no interrupt handler does double precision math.
+
+    isr_float_check.py check <object>... -s <source>...
+        Finds the handlers in the sources (the functions declared with
+        __ISR), disassembles the objects with objdump, and follows the calls
+        from each handler through every function the objects define. Each
+        handler is reported with the functions it reaches and the double
+        instructions and double libm calls in them. Exits 1 if there are any.
+
+The objects are host (x86-64) builds, where float math is the SSE ss forms
+and double math the sd forms, and a float meets a double through cvtss2sd.
+Build them at -O0 like the PIC32 build, so the calls are still there to
+follow. A call to a function none of the objects defines is a leaf, and is
+counted if it is a libm double function.
+"""
+import argparse
+import re
+import subprocess
+import sys
+
+ISR = re.compile(r'__ISR\s*\([^)]*\)\s*(\w+)\s*\(')
+FUNCTION = re.compile(r'^[0-9a-f]+ <([\w.]+)>:$')
+INSTRUCTION = re.compile(r'^\s+[0-9a-f]+:\s+(\S+)\s*(.*)$')
+CALL_TARGET = re.compile(r'<([\w.]+)>')
+RELOCATION = re.compile(r'^\s+[0-9a-f]+:\s+R_X86_64_(?:PLT32|PC32)\s+([\w.]+)')
+DOUBLE = re.compile(r'^(?:(?:add|sub|mul|div|sqrt|min|max|u?comi)sd|'
+                    r'cvt\w*sd\w*)$')
+LIBM_DOUBLE = {
+    'sin', 'cos', 'tan', 'asin', 'acos', 'atan', 'atan2', 'sqrt', 'exp',
+    'log', 'log10', 'pow', 'fabs', 'floor', 'ceil', 'round', 'lround',
+    'llround', 'trunc', 'fmod', 'hypot', 'sincos',
+}
+
+
+def handlers(sources):
+    names = []
+    for source in sources:
+        with open(source, encoding='latin-1') as f:
+            names += ISR.findall(f.read())
+    return names
+
+
+def disassemble(objects):
+    """{function: (double instructions, callees)} over all the objects"""
+    functions = {}
+    for obj in objects:
+        listing = subprocess.run(['objdump', '-dr', '--no-show-raw-insn', obj],
+                                 capture_output=True, text=True, check=True)
+        current = None
+        pending_call = False
+        for line in listing.stdout.splitlines():
+            match = FUNCTION.match(line)
+            if match:
+                current = functions.setdefault(match.group(1), ([], set()))
+                pending_call = False
+                continue
+            if current is None:
+                continue
+            match = RELOCATION.match(line)
+            if match:
+                # the call's target is the relocation, objdump put 0 there
+                if pending_call:
+                    current[1].add(match.group(1))
+                pending_call = False
+                continue
+            match = INSTRUCTION.match(line)
+            if not match:
+                continue
+            mnemonic, operands = match.groups()
+            pending_call = mnemonic.startswith('call')
+            if DOUBLE.match(mnemonic):
+                current[0].append(mnemonic)
+            if pending_call:
+                # a call out of the section shows as to itself plus the
+                # offset, with the relocation after it
+                target = CALL_TARGET.search(operands)
+                if target:
+                    current[1].add(target.group(1))
+                    pending_call = False
+    return functions
+
+
+def reached(root, functions):
+    """the functions root reaches, root first, and the leaves it calls"""
+    order, leaves, stack = [], set(), [root]
+    while stack:
+        name = stack.pop()
+        if name in order:
+            continue
+        if name not in functions:
+            leaves.add(name)
+            continue
+        order.append(name)
+        stack.extend(sorted(functions[name][1], reverse=True))
+    return order, leaves
+
+
+def check(args):
+    functions = disassemble(args.objects)
+    failed = False
+    for handler in handlers(args.source):
+        if handler not in functions:
+            # under an #if the build leaves out, PCB_REV for one
+            print('%-14s not built' % handler)
+            continue
+        order, leaves = reached(handler, functions)
+        found = []
+        for name in order:
+            doubles = functions[name][0]
+            if doubles:
+                found.append('%s: %d (%s)' % (name, len(doubles),
+                             ', '.join(sorted(set(doubles)))))
+        for name in sorted(leaves & LIBM_DOUBLE):
+            found.append('calls %s' % name)
+        print('%-14s %3d functions, %s' % (handler, len(order),
+              'no double math' if not found else 'double math:'))
+        for line in found:
+            print('    ' + line)
+        failed |= bool(found)
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest='command', required=True)
+    command = commands.add_parser('check')
+    command.add_argument('objects', nargs='+')
+    command.add_argument('-s', '--source', action='append', required=True)
+    command.set_defaults(function=check)
+    args = parser.parse_args()
+    sys.exit(args.function(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Turn an RL capture (see ProjectSource/RLCapture.c) into CSV.
+
+    rl_capture.py decode <capture> [-o out.csv]
+        Writes one row per #R line of a terminal capture, under a header
+        naming the values MotorSM records. All other lines are left out.
+        The record numbers, 16 bits on the wire, count on past 65535.
+
+Lines with a bad CRC are dropped, and they, the records the ring lost and
+gaps in the record numbers of the capture are reported on stderr.
+"""
+import argparse
+import csv
+import sys
+
+VALUES = 32
+CRC_POLY, CRC_INIT = 0x1021, 0xFFFF
+
+
+def columns():
+    """the values in the order Store_RL_Data in MotorSM.c writes them"""
+    names = []
+    for step in ('t-2', 't-1', 't', 't+1', 't+8', 't+9', 't+10'):
+        names += ['%s_%s' % (name, step)
+                  for name in ('rpm', 'desired', 'prev_duty')]
+    names.append('action')
+    names += ['reward_t+%d' % step for step in range(1, 11)]
+    return names
+
+
+def crc(words):
+    value = CRC_INIT
+    for word in words:
+        value ^= word
+        for _ in range(16):
+            value = ((value << 1) ^ CRC_POLY if value & 0x8000
+                     else value << 1) & 0xFFFF
+    return value
+
+
+def decode(args):
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    writer = csv.writer(out, lineterminator='\n')
+    writer.writerow(['seq'] + columns())
+    previous = None
+    count = records = bad = lost = 0
+    with open(args.capture, 'rb') as f:
+        for number, raw in enumerate(f, 1):
+            fields = raw.decode('latin-1').split()
+            if not fields:
+                continue
+            if fields[0] == '#RL' and len(fields) == 2:
+                lost = int(fields[1], 16)
+                continue
+            if fields[0] != '#R':
+                continue
+            try:
+                words = [int(x, 16) for x in fields[1:]]
+            except ValueError:
+                words = []
+            if len(words) != VALUES + 2 or crc(words[:-1]) != words[-1]:
+                print('line %d: bad record, dropped' % number, file=sys.stderr)
+                bad += 1
+                continue
+            seq = words[0]
+            if previous is None:
+                count = seq
+            else:
+                step = (seq - previous) & 0xFFFF
+                if step != 1:
+                    print('gap in the record numbers at %d -> %d'
+                          % (previous, seq), file=sys.stderr)
+                count += step
+            previous = seq
+            writer.writerow([count] + [w - 0x10000 if w & 0x8000 else w
+                                       for w in words[1:-1]])
+            records += 1
+    print('%d records, %d lost, %d bad' % (records, lost, bad),
+          file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest='command', required=True)
+    command = commands.add_parser('decode')
+    command.add_argument('capture')
+    command.add_argument('-o', '--output')
+    command.set_defaults(function=decode)
+    args = parser.parse_args()
+    args.function(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,29 @@
+/****************************************************************************
+
+  Header file for the single precision math kernels the interrupt handlers
+  use in place of libm, for the dead reckoning and the attitude filter
+
+ ****************************************************************************/
+
+#ifndef FastMath_H
+#define FastMath_H
+
+#include "ES_Types.h"
+
+// the largest |x| FastMath_Sin/Cos/SinCos hold their error for, rad
+#define FAST_MATH_TRIG_RANGE 8192.0f
+
+// Public Function Prototypes
+
+// max error 1.2e-7 absolute for |x| <= FAST_MATH_TRIG_RANGE
+float FastMath_Sin(float x);
+float FastMath_Cos(float x);
+void FastMath_SinCos(float x, float *pSin, float *pCos);
+// max error 3e-7 rad, about an ulp of pi, atan2(0, 0) is 0
+float FastMath_Atan2(float y, float x);
+// max error 3e-7 rad, |x| > 1 is taken as +-1
+float FastMath_Asin(float x);
+// max error 5e-6 relative, x > 0
+float FastMath_InvSqrt(float x);
+
+#endif /* FastMath_H */
@@ -14,9 +14,11 @@
 
 // typedefs for the states
 // State definitions for use with the query function
+// RobotConnected contains RobotPending and RobotActive, the query function
+// only ever returns the leaf states
 typedef enum
 {
-  InitPState_Jetson, RobotInactive, RobotPending, RobotActive
+  InitPState_Jetson, RobotInactive, RobotPending, RobotActive, RobotConnected
 }JetsonState_t;
 
 // Public Function Prototypes
@@ -0,0 +1,79 @@
+/****************************************************************************
+
+  Header file for the wheel speed control law run by T1Handler in MotorSM.c
+
+ ****************************************************************************/
+
+#ifndef MotorControl_H
+#define MotorControl_H
+
+#include "ES_Configure.h" /* gets us MOTOR_TYPE and the MOTOR_PID options */
+#include "ES_Types.h"
+
+#if (MOTOR_TYPE==1)
+#define ENCODER_RESOLUTION 374 // Number of pulses per revolution
+#define ENCODER_EDGES_PER_REV (4 * 374) // A and B edges per revolution
+#elif (MOTOR_TYPE==2)
+//#define ENCODER_RESOLUTION 1440 // Number of pulses per revolution
+#define ENCODER_RESOLUTION 360
+#define ENCODER_EDGES_PER_REV (4 * 1440)
+#endif
+
+// quadrature edges in one pulse, the 1/ENCODER_RESOLUTION of a turn the
+// pulse length is measured over
+#define EDGES_PER_PULSE (ENCODER_EDGES_PER_REV / ENCODER_RESOLUTION)
+
+// the pulse length is taken to be in ticks of this. The input captures
+// stamp the edges at WHEEL_SPEED_TIMER_HZ (6.25 MHz), so the speed loop's
+// RPM is 2.56 wheel RPM. It is kept on purpose: the gains were tuned on the
+// robot in these units, and the set points SetDesiredSpeed gives are in
+// them too. The odometry works from WHEEL_SPEED_TIMER_HZ
+#define SPEED_LOOP_TIMER_HZ 16000000u
+
+// RPM is this over the pulse length from the input capture ISRs
+#define SPEED_CONVERSION_FACTOR (SPEED_LOOP_TIMER_HZ * 60.0 / ENCODER_RESOLUTION)
+// the same as an integer, (a / b) / c == a / (b * c) for integers, so the
+// integer RPM is the truncated float one
+#define SPEED_CONVERSION_COUNTS (SPEED_LOOP_TIMER_HZ * 60u / ENCODER_RESOLUTION)
+
+// the laws measure the speed, and take the error, in 1/SPEED_SCALE RPM
+#define SPEED_SCALE 10
+
+// one wheel's controller state, float and fixed point
+typedef struct
+{
+    float ErrorSum;
+    float PrevError;
+    float Error;        // this step's error, 1/SPEED_SCALE RPM
+    uint32_t Speed;     // this step's measured speed, 1/SPEED_SCALE RPM
+} MotorPIDFloat_t;
+
+typedef struct
+{
+    int32_t ErrorSum;
+    int32_t PrevError;
+    int32_t Error;
+    uint32_t Speed;
+} MotorPIDFixed_t;
+
+// Public Function Prototypes
+
+void MotorPIDFloat_Reset(MotorPIDFloat_t *pPID);
+int16_t MotorPIDFloat_Step(MotorPIDFloat_t *pPID, uint16_t DesiredRPM,
+    uint32_t PulseLength);
+void MotorPIDFixed_Reset(MotorPIDFixed_t *pPID);
+int16_t MotorPIDFixed_Step(MotorPIDFixed_t *pPID, uint16_t DesiredRPM,
+    uint32_t PulseLength);
+
+// the law T1Handler runs
+#if MOTOR_PID_FIXED
+typedef MotorPIDFixed_t MotorPID_t;
+#define MotorPID_Reset MotorPIDFixed_Reset
+#define MotorPID_Step MotorPIDFixed_Step
+#else
+typedef MotorPIDFloat_t MotorPID_t;
+#define MotorPID_Reset MotorPIDFloat_Reset
+#define MotorPID_Step MotorPIDFloat_Step
+#endif
+
+#endif /* MotorControl_H */
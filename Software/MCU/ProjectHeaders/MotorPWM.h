@@ -0,0 +1,35 @@
+/****************************************************************************
+
+  Header file for the motor PWM driver, OC1/OC2 on Timer4 and the two
+  direction pins
+
+ ****************************************************************************/
+
+#ifndef MotorPWM_H
+#define MotorPWM_H
+
+#include "ES_Configure.h" /* gets us MOTOR_PWM_HZ */
+#include "ES_Types.h"
+
+// drives are Q15 fractions of the supply, positive forward
+#define MOTOR_PWM_FULL 32767
+
+// the PWM frequencies the driver can run at, Timer4 at 1:1 with PR4 in
+// 16 bits and at least 500 steps of duty
+#define MOTOR_PWM_MIN_HZ 763
+#define MOTOR_PWM_MAX_HZ 100000
+
+typedef enum
+{
+    MotorPWMLeft,  // OC2, direction on RJ3
+    MotorPWMRight  // OC1, direction on RF8
+} MotorPWMWheel_t;
+
+// Public Function Prototypes
+
+void MotorPWM_Init(uint32_t Hz);
+bool MotorPWM_SetFrequency(uint32_t Hz);
+uint32_t MotorPWM_GetFrequency(void);
+void MotorPWM_SetDrive(MotorPWMWheel_t Which, int16_t Drive);
+
+#endif /* MotorPWM_H */
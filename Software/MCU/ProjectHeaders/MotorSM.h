@@ -19,24 +19,23 @@ typedef enum
   InitPState_Motor, MotorWait
 }MotorState_t;
 
-typedef struct
-{
-    uint16_t TimerBits;
-    uint16_t RolloverBits;
-} TimerByBytes_t;
-
-typedef union
-{
-    TimerByBytes_t TimeStruct;
-    uint32_t FullTime;
-} MotorTimer_t;
-
 typedef enum
 {
     Forward,
     Backward
 } Direction_t;
 
+// the dead reckoning state, all of it from one update of T7Handler
+typedef struct
+{
+    float x;       // m
+    float y;       // m
+    float theta;   // rad, -pi to pi
+    float V;       // linear velocity, m/s
+    float w;       // angular velocity, rad/s
+    uint32_t Time; // Timer2/3 count of the update, WHEEL_SPEED_TIMER_HZ
+} Odometry_t;
+
 // Public Function Prototypes
 
 bool InitMotorSM(uint8_t Priority);
@@ -44,8 +43,10 @@ bool PostMotorSM(ES_Event_t ThisEvent);
 ES_Event_t RunMotorSM(ES_Event_t ThisEvent);
 MotorState_t QueryMotorSM(void);
 void SetDesiredRPM(uint16_t LeftRPM, uint16_t RightRPM);
+void QueryDesiredRPM(uint16_t *pLeftRPM, uint16_t *pRightRPM);
 void SetDesiredSpeed(float LinearVelocity, float AngularVelocity);
 void MultiplyDesiredSpeed(float Factor);
+uint32_t QueryOdometry(Odometry_t *pOdometry);
 void WritePositionToSPI(uint8_t *Message2Send);
 void WriteDeadReckoningVelocityToSPI(uint8_t *Message2Send);
 void ResetPosition(void);
@@ -0,0 +1,57 @@
+/****************************************************************************
+
+  Header file for the streaming capture of the RL motor data, written by
+  T1Handler in MotorSM.c and sent out over the terminal
+
+ ****************************************************************************/
+
+#ifndef RLCapture_H
+#define RLCapture_H
+
+#include "ES_Configure.h" /* gets us RL_MOTOR_LOGGING */
+#include "ES_Types.h"
+
+// values in one record, a row of the host's CSV
+#define RL_CAPTURE_VALUES 32
+
+// records the ring holds, a power of 2. The recordings after a new set
+// point come once a control step for the first 0.15 s, faster than the
+// terminal sends them, and all of them fit
+#ifndef RL_CAPTURE_DEPTH
+#define RL_CAPTURE_DEPTH 128
+#endif
+
+// recordings one schedule can hold, a power of 2
+#ifndef RL_CAPTURE_TRIGGERS
+#define RL_CAPTURE_TRIGGERS 128
+#endif
+
+// a run of recordings in a schedule: at control steps First, First + Every,
+// and so on up to Last, counted from the step the schedule is made at. A
+// single recording is First = Last
+typedef struct
+{
+    uint16_t First;
+    uint16_t Last;
+    uint16_t Every;
+} RLCaptureRun_t;
+
+typedef struct
+{
+    uint16_t Seq; // record number, lost ones included, mod 2^16
+    int16_t Values[RL_CAPTURE_VALUES];
+} RLCaptureRecord_t;
+
+// Public Function Prototypes
+
+void RLCapture_Init(void);
+void RLCapture_Start(void);
+void RLCapture_Stop(void);
+bool RLCapture_IsOn(void);
+int16_t *RLCapture_Claim(void);
+void RLCapture_Commit(void);
+bool RLCapture_MoveToTerminal(void);
+bool RLCapture_Schedule(const RLCaptureRun_t *pRuns, uint8_t NumRuns);
+bool RLCapture_IsDue(void);
+
+#endif /* RLCapture_H */
@@ -0,0 +1,66 @@
+/****************************************************************************
+
+  Header file for the wheel speed estimator, fed by the encoder edge
+  handlers in MotorSM.c
+
+ ****************************************************************************/
+
+#ifndef WheelSpeed_H
+#define WheelSpeed_H
+
+#include <math.h>
+#include "ES_Configure.h" /* gets us WHEEL_RADIUS */
+#include "ES_Types.h"
+#include "MotorControl.h" /* gets us the encoder resolution */
+
+// the edge time stamps are timer2/3 counts, PBCLK3 / 8, 32 bits
+#define WHEEL_SPEED_TIMER_HZ 6250000
+
+// a wheel with no edge for this long is at rest, 0.34 s
+#define WHEEL_SPEED_STOP_TICKS 2097152u
+
+// the shortest time a speed is measured over, in timer ticks. Longer
+// smooths more and reacts later; one control period by default
+#ifndef WHEEL_SPEED_WINDOW
+#define WHEEL_SPEED_WINDOW 10000
+#endif
+
+// edge times kept per wheel, a power of 2. Enough for the window at full
+// speed, about 20 edges
+#define WHEEL_SPEED_HISTORY 32
+
+#define WHEEL_SPEED_CHANNEL_A 0x2 // the channel bits of State
+#define WHEEL_SPEED_CHANNEL_B 0x1
+
+#define WHEEL_SPEED_STOPPED 4294967295u // the pulse length of a wheel at rest
+
+#define WHEEL_SPEED_METERS_PER_EDGE \
+    (2 * M_PI * WHEEL_RADIUS / ENCODER_EDGES_PER_REV)
+
+// one wheel's quadrature decoder and speed estimate. The edge handlers of
+// its two channels write it, readers at a lower priority have to hold
+// them off while they read
+typedef struct
+{
+    uint8_t State;      // channel A level in bit 1, channel B in bit 0
+    int8_t Sign;        // +1 if the encoder counts up going forward
+    int8_t LastStep;    // +1 or -1, the direction of the last edge
+    uint8_t Held;       // edge times held, since a reversal or a stop
+    uint8_t Newest;     // index of the newest of them
+    uint8_t SpanEdges;  // the estimate: edges, 0 for none,
+    uint32_t Span;      // over this many ticks
+    uint32_t Window;    // the shortest span to measure over, ticks
+    int32_t Count;      // edges, forward positive
+    uint32_t EdgeTimes[WHEEL_SPEED_HISTORY];
+} WheelSpeed_t;
+
+// Public Function Prototypes
+
+void WheelSpeed_Init(WheelSpeed_t *pSpeed, int8_t Sign, uint8_t State,
+    uint32_t Window);
+void WheelSpeed_Edge(WheelSpeed_t *pSpeed, uint8_t Channel, uint32_t Time);
+void WheelSpeed_Expire(WheelSpeed_t *pSpeed, uint32_t Now);
+uint32_t WheelSpeed_GetPulseLength(const WheelSpeed_t *pSpeed, uint32_t Now);
+float WheelSpeed_GetMetersPerSecond(const WheelSpeed_t *pSpeed, uint32_t Now);
+
+#endif /* WheelSpeed_H */
@@ -189,10 +189,14 @@ void InitADC(void) {
     enables the bias circuitry for these ADC SAR Cores).
    */ 
    ADCANCONbits.ANEN7 = 1; // Enable, ADC 7
+#ifndef ES_PORT_HOST // the host register shim has no SAR cores to wake up
    while(!ADCANCONbits.WKRDY7); // Wait until ADC7 is ready
+#endif
    
    ADCANCONbits.ANEN4 = 1; // Enable ADC 4
+#ifndef ES_PORT_HOST
    while (!ADCANCONbits.WKRDY4); // Wait until ADC4 is ready
+#endif
    
    /*
     Step 6: Set the DIGENx bit (ADCCON3<15,13:8>) to
@@ -10,6 +10,8 @@
    button
 
  Notes
+   The machine is the const tables below, run by ES_Hsm. The debounce
+   timer is started on entry to the two debouncing states.
 
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
@@ -18,6 +20,7 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Hsm.h"
 #include "Button1DebouncerSM.h"
 #include "EventCheckers.h"
 #include "dbprintf.h"
@@ -30,11 +33,41 @@
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
 */
+static void StartDebounceTimer(ES_Event_t ThisEvent);
+static void ReportPressed(ES_Event_t ThisEvent);
+static void ReportReleased(ES_Event_t ThisEvent);
 
 /*---------------------------- Module Variables ---------------------------*/
-// everybody needs a state variable, you may need others as well.
-// type of state variable should match that of enum in header file
-static Button1DebouncerState_t CurrentState;
+// the machine, as data. A state's row lists the transitions out of it
+static const ES_HsmTransition_t InitTransitions[] = {
+  { ES_INIT, Button1DebouncingWait, NULL, NULL },
+};
+static const ES_HsmTransition_t WaitTransitions[] = {
+  { EV_BUTTON1_DOWN, Button1DebouncingFall, NULL, NULL },
+  { EV_BUTTON1_UP, Button1DebouncingRise, NULL, NULL },
+};
+static const ES_HsmTransition_t FallTransitions[] = {
+  { EV_BUTTON1_UP, Button1DebouncingWait, NULL, NULL },
+  { ES_TIMEOUT, Button1DebouncingWait, NULL, ReportPressed },
+};
+static const ES_HsmTransition_t RiseTransitions[] = {
+  { EV_BUTTON1_DOWN, Button1DebouncingWait, NULL, NULL },
+  { ES_TIMEOUT, Button1DebouncingWait, NULL, ReportReleased },
+};
+static const ES_HsmState_t States[] = {
+  [InitPState_Button1Debouncer] = ES_HSM_STATE(ES_HSM_NO_STATE,
+      ES_HSM_NO_STATE, NULL, NULL, InitTransitions),
+  [Button1DebouncingWait] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      NULL, NULL, WaitTransitions),
+  [Button1DebouncingFall] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      StartDebounceTimer, NULL, FallTransitions),
+  [Button1DebouncingRise] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      StartDebounceTimer, NULL, RiseTransitions),
+};
+static const ES_HsmMachine_t Machine = { States, ARRAY_SIZE(States), NULL };
+
+// everybody needs a state variable, here it lives in the machine instance
+static ES_Hsm_t Me;
 
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
@@ -62,7 +95,7 @@ bool InitButton1DebouncerSM(uint8_t Priority)
 
   MyPriority = Priority;
   // put us into the Initial PseudoState
-  CurrentState = InitPState_Button1Debouncer;
+  ES_HsmInit(&Me, &Machine, InitPState_Button1Debouncer);
     
   InitButton1(); // Init the button event checker
   
@@ -109,108 +142,17 @@ bool PostButton1DebouncerSM(ES_Event_t ThisEvent)
    ES_Event_t, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   Debounces the button: a change has to hold for DEBOUNCE_TIME before it
+   is reported
  Notes
-   uses nested switch/case to implement the machine.
+   the transitions are the tables at the top of the file
 ****************************************************************************/
 ES_Event_t RunButton1DebouncerSM(ES_Event_t ThisEvent)
 {
   ES_Event_t ReturnEvent;
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
 
-  switch (CurrentState)
-  {
-    case InitPState_Button1Debouncer:
-    {
-      if (ThisEvent.EventType == ES_INIT) 
-      {
-        CurrentState = Button1DebouncingWait;
-      }
-    }
-    break;
-
-    case Button1DebouncingWait: 
-    {
-        switch (ThisEvent.EventType)
-        {
-            case EV_BUTTON1_DOWN: 
-            {  
-                ES_Timer_InitTimer(BUTTON1_TIMER, DEBOUNCE_TIME);           
-                CurrentState = Button1DebouncingFall; 
-            }
-            break;
-        
-            case EV_BUTTON1_UP:
-            {
-                ES_Timer_InitTimer(BUTTON1_TIMER, DEBOUNCE_TIME);           
-                CurrentState = Button1DebouncingRise; 
-            }
-            break;
-        
-            default:
-            ;
-        }
-    }
-    break;
-    
-    case Button1DebouncingFall:
-    {
-        switch (ThisEvent.EventType)
-        {
-            case EV_BUTTON1_UP:
-            {       
-                CurrentState = Button1DebouncingWait; 
-            }
-            break;
-            
-            case ES_TIMEOUT:
-            {
-                ES_Event_t NewEvent = {EV_BUTTON1_PRESSED, 0};           
-                // TODO: Post to proper SM                 
-                CurrentState = Button1DebouncingWait; 
-                // U1MODEbits.ON = 1; // turn peripheral on
-                
-                UpdateButtonStatus(1, true);
-                
-                #ifdef DEBUG
-                DB_printf("Button 1 Pressed\r\n");
-                #endif
-            }
-            break;
-        }
-    }
-    break;
-    
-    case Button1DebouncingRise:
-    {
-        switch (ThisEvent.EventType)
-        {
-            case EV_BUTTON1_DOWN:
-            {       
-                CurrentState = Button1DebouncingWait; 
-            }
-            break;
-            
-            case ES_TIMEOUT:
-            {
-                ES_Event_t NewEvent = {EV_BUTTON1_RELEASED, 0};           
-                // TODO: Post to proper SM         
-                CurrentState = Button1DebouncingWait; 
-                
-                UpdateButtonStatus(1, false);
-                
-                #ifdef DEBUG
-                DB_printf("Button 1 Released\r\n");
-                #endif
-            }
-            break;
-        }
-    }
-    break;
-    
-    default:
-      ;
-  }
+  ES_HsmDispatch(&Me, ThisEvent);
   return ReturnEvent;
 }
 
@@ -231,10 +173,52 @@ ES_Event_t RunButton1DebouncerSM(ES_Event_t ThisEvent)
 ****************************************************************************/
 Button1DebouncerState_t QueryButton1DebouncerSM(void)
 {
-  return CurrentState;
+  return (Button1DebouncerState_t)ES_HsmGetState(&Me);
 }
 
 /***************************************************************************
  private functions
  ***************************************************************************/
 
+/****************************************************************************
+ Function
+    StartDebounceTimer
+
+ Description
+    Entry to both debouncing states, the change has to last this long
+****************************************************************************/
+static void StartDebounceTimer(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  ES_Timer_InitTimer(BUTTON1_TIMER, DEBOUNCE_TIME);
+}
+
+/****************************************************************************
+ Function
+    ReportPressed / ReportReleased
+
+ Description
+    The button stayed down (up) for the whole debounce time
+****************************************************************************/
+static void ReportPressed(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  UpdateButtonStatus(1, true);
+
+  #ifdef DEBUG
+  DB_printf("Button 1 Pressed\r\n");
+  #endif
+}
+
+static void ReportReleased(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  UpdateButtonStatus(1, false);
+
+  #ifdef DEBUG
+  DB_printf("Button 1 Released\r\n");
+  #endif
+}
@@ -27,6 +27,7 @@
 #include "ES_Framework.h"
 #include "EEPROMSM.h"
 #include "dbprintf.h"
+#include "ES_Log.h"
 #include "sys/attribs.h"
 /*----------------------------- Module Defines ----------------------------*/
 #define WREN 0b00000110
@@ -542,7 +543,7 @@ void __ISR(_SPI5_TX_VECTOR, IPL7SRS) SPI5TXHandler(void)
            uint8_t address_byte2 = (CurrentAddress >> 8) & 0xFF;
            uint8_t address_byte1 = (CurrentAddress >> 16) & 0xFF;
 
-           DB_printf("Writing to address: %d\r\n", CurrentAddress);
+           ES_LOG("Writing to address: %d\r\n", CurrentAddress);
 
            // LATFbits.LATF12 = 0;
            // Send Write Sequence
@@ -562,7 +563,7 @@ void __ISR(_SPI5_TX_VECTOR, IPL7SRS) SPI5TXHandler(void)
         
         // Check if still have bytes to send
         if (tx_index == num_bytes_to_write) {
-            DB_printf("tx_index: %d\r\n", tx_index);
+            ES_LOG("tx_index: %d\r\n", tx_index);
             transferring = false;  // Done with TX
             transfer_wait = true; // Now just wait for TX to finish
             SPI5CONbits.STXISEL = 0b00; // Interrupt is generated when the last transfer is shifted out of SPISR and transmit operations are complete
@@ -600,7 +601,7 @@ void __ISR(_SPI5_TX_VECTOR, IPL7SRS) SPI5TXHandler(void)
             uint8_t address_byte2 = (ReadAddress >> 8) & 0xFF;
             uint8_t address_byte1 = (ReadAddress >> 16) & 0xFF;
             
-            DB_printf("Reading starting at address: %d\r\n", ReadAddress);
+            ES_LOG("Reading starting at address: %d\r\n", ReadAddress);
             
             SPI5BUF = READ;
             SPI5BUF = address_byte3;
@@ -640,7 +641,7 @@ void __ISR(_SPI5_RX_VECTOR, IPL7SRS) SPI5RXHandler(void) {
             
             // Only care about actual data (prev data is only setup bits)
             if (rx_indx >= 4) {
-                DB_printf("rx_data: %d\r\n", rx_data);
+                ES_LOG("rx_data: %d\r\n", rx_data);
                 bytes_read[rx_indx-4] = rx_data;
             } 
             
@@ -648,7 +649,7 @@ void __ISR(_SPI5_RX_VECTOR, IPL7SRS) SPI5RXHandler(void) {
             
             if (rx_indx-4 >= num_bytes_to_read) {
                 
-                DB_printf("rx_indx: %d\r\n", rx_indx);
+                ES_LOG("rx_indx: %d\r\n", rx_indx);
                 
                 // We read all the bytes we expected to
                 rx_indx = 0;
@@ -665,7 +666,7 @@ void __ISR(_SPI5_RX_VECTOR, IPL7SRS) SPI5RXHandler(void) {
             
             rx_indx += 1;
             if (rx_indx == 2) {
-                DB_printf("Status is: %d\r\n", rx_data);
+                ES_LOG("Status is: %d\r\n", rx_data);
                 rx_indx = 0;
                 
                 status_reading = false;
@@ -0,0 +1,509 @@
+/****************************************************************************
+ Module
+   FastMath.c
+
+ Description
+   Single precision sin, cos, atan2, asin and inverse square root for the
+   interrupt handlers: T7Handler's dead reckoning and the Mahony filter and
+   GetAngles in IMU_SM.c. They used libm, which is written for any
+   argument and every special case, and goes through double in places.
+
+ Notes
+   All float. sin and cos reduce x by the nearest multiple of pi/2, taken
+   off in three parts (Cody-Waite) so the reduction stays exact to well
+   past the +-pi the callers use, then take a polynomial over +-pi/4 and
+   pick the quadrant. SinCos does both from one reduction. atan2 works on
+   the smaller over the larger of |y| and |x|, brings ratios over
+   tan(pi/8) down by the atan(1) identity, and puts the octant back. asin
+   takes the half angle identity above 0.5. The polynomials are the
+   minimax ones of the Cephes library (S. L. Moshier) for single
+   precision. The inverse square root is the bit pattern estimate with two
+   Newton steps, no divide and no sqrt.
+   The max errors in FastMath.h are against libm in double, over the whole
+   range, make -f Makefile.host math_check measures them and fails if one
+   is exceeded.
+
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "FastMath.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PI_F        3.14159265f
+#define PI_2_F      1.57079633f
+#define PI_4_F      0.785398163f
+#define TWO_OVER_PI 0.636619772f
+#define TAN_PI_8    0.414213562f
+
+// pi/2 in three parts, the first two with few enough bits that k times
+// them is exact for any k the range allows
+#define PI_2_HI  1.5703125f
+#define PI_2_MID 4.83751297e-4f
+#define PI_2_LO  7.54978995e-8f
+
+// sin(r) = r + r^3 (S1 + r^2 (S2 + r^2 S3)), |r| <= pi/4
+#define S1 -1.6666654611e-1f
+#define S2  8.3321608736e-3f
+#define S3 -1.9515295891e-4f
+// cos(r) = 1 - r^2 / 2 + r^4 (C1 + r^2 (C2 + r^2 C3)), |r| <= pi/4
+#define C1  4.166664568298827e-2f
+#define C2 -1.388731625493765e-3f
+#define C3  2.443315711809948e-5f
+// atan(t) = t + t^3 (A1 + t^2 (A2 + t^2 (A3 + t^2 A4))), |t| <= tan(pi/8)
+#define A1 -3.33329491539e-1f
+#define A2  1.99777106478e-1f
+#define A3 -1.38776856032e-1f
+#define A4  8.05374449538e-2f
+// asin(s) = s + s^3 (P1 + s^2 (P2 + ...)), |s| <= 0.5
+#define P1 1.6666752422e-1f
+#define P2 7.4953002686e-2f
+#define P3 4.5470025998e-2f
+#define P4 2.4181311049e-2f
+#define P5 4.2163199048e-2f
+
+#define INV_SQRT_MAGIC 0x5f375a86u
+
+/*---------------------------- Module Functions ---------------------------*/
+static int32_t Reduce(float x, float *pR);
+static float SinPoly(float r, float r2);
+static float CosPoly(float r2);
+static float AtanPoly(float t);
+static float AsinPoly(float s, float s2);
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     FastMath_Sin
+
+ Parameters
+     float x: the angle, rad
+
+ Returns
+     float sin(x)
+****************************************************************************/
+float FastMath_Sin(float x)
+{
+    float r;
+    int32_t Quadrant = Reduce(x, &r);
+    float r2 = r * r;
+
+    switch (Quadrant & 3) {
+        case 0:
+            return SinPoly(r, r2);
+        case 1:
+            return CosPoly(r2);
+        case 2:
+            return -SinPoly(r, r2);
+        default:
+            return -CosPoly(r2);
+    }
+}
+
+/****************************************************************************
+ Function
+     FastMath_Cos
+
+ Parameters
+     float x: the angle, rad
+
+ Returns
+     float cos(x)
+****************************************************************************/
+float FastMath_Cos(float x)
+{
+    float r;
+    int32_t Quadrant = Reduce(x, &r);
+    float r2 = r * r;
+
+    switch (Quadrant & 3) {
+        case 0:
+            return CosPoly(r2);
+        case 1:
+            return -SinPoly(r, r2);
+        case 2:
+            return -CosPoly(r2);
+        default:
+            return SinPoly(r, r2);
+    }
+}
+
+/****************************************************************************
+ Function
+     FastMath_SinCos
+
+ Parameters
+     float x: the angle, rad
+     float *pSin, *pCos: where to put sin(x) and cos(x)
+
+ Returns
+     None
+
+ Description
+     Both from one range reduction, for the callers that need both
+****************************************************************************/
+void FastMath_SinCos(float x, float *pSin, float *pCos)
+{
+    float r;
+    int32_t Quadrant = Reduce(x, &r);
+    float r2 = r * r;
+    float s = SinPoly(r, r2);
+    float c = CosPoly(r2);
+
+    switch (Quadrant & 3) {
+        case 0:
+            *pSin = s;
+            *pCos = c;
+            break;
+        case 1:
+            *pSin = c;
+            *pCos = -s;
+            break;
+        case 2:
+            *pSin = -s;
+            *pCos = -c;
+            break;
+        default:
+            *pSin = -c;
+            *pCos = s;
+            break;
+    }
+}
+
+/****************************************************************************
+ Function
+     FastMath_Atan2
+
+ Parameters
+     float y, x: the point
+
+ Returns
+     float the angle of (x, y), -pi to pi, rad
+****************************************************************************/
+float FastMath_Atan2(float y, float x)
+{
+    float ax = (x < 0) ? -x : x;
+    float ay = (y < 0) ? -y : y;
+    float Angle;
+
+    if (ay <= ax) {
+        if (ax == 0) {
+            return 0;
+        }
+        Angle = AtanPoly(ay / ax);
+    } else {
+        Angle = PI_2_F - AtanPoly(ax / ay);
+    }
+    if (x < 0) {
+        Angle = PI_F - Angle;
+    }
+    return (y < 0) ? -Angle : Angle;
+}
+
+/****************************************************************************
+ Function
+     FastMath_Asin
+
+ Parameters
+     float x: the sine, -1 to 1
+
+ Returns
+     float asin(x), -pi/2 to pi/2, rad
+****************************************************************************/
+float FastMath_Asin(float x)
+{
+    float a = (x < 0) ? -x : x;
+    float Angle;
+
+    if (a >= 1) {
+        Angle = PI_2_F;
+    } else if (a > 0.5f) {
+        // asin(a) = pi/2 - 2 asin(sqrt((1 - a) / 2))
+        float z = 0.5f * (1 - a);
+        float y = FastMath_InvSqrt(z);
+        float s;
+
+        // a third Newton step, the angle is 2 s and s comes near 0.5
+        y = y * (1.5f - 0.5f * z * y * y);
+        s = z * y;
+
+        Angle = PI_2_F - 2 * AsinPoly(s, z);
+    } else {
+        Angle = AsinPoly(a, a * a);
+    }
+    return (x < 0) ? -Angle : Angle;
+}
+
+/****************************************************************************
+ Function
+     FastMath_InvSqrt
+
+ Parameters
+     float x: greater than 0
+
+ Returns
+     float 1 / sqrt(x)
+****************************************************************************/
+float FastMath_InvSqrt(float x)
+{
+    union {
+        float f;
+        uint32_t i;
+    } Bits;
+    float y;
+
+    // halving the exponent of x, negated, is a first estimate to 3.4%
+    Bits.f = x;
+    Bits.i = INV_SQRT_MAGIC - (Bits.i >> 1);
+    y = Bits.f;
+    // each Newton step squares the relative error
+    y = y * (1.5f - 0.5f * x * y * y);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// the quadrant of x, and x less that many times pi/2 in *pR, +-pi/4
+static int32_t Reduce(float x, float *pR)
+{
+    int32_t k = (int32_t)(x * TWO_OVER_PI + ((x < 0) ? -0.5f : 0.5f));
+    float kf = (float)k;
+
+    *pR = ((x - kf * PI_2_HI) - kf * PI_2_MID) - kf * PI_2_LO;
+    return k;
+}
+
+static float SinPoly(float r, float r2)
+{
+    return r + r * r2 * (S1 + r2 * (S2 + r2 * S3));
+}
+
+static float CosPoly(float r2)
+{
+    return 1 - 0.5f * r2 + r2 * r2 * (C1 + r2 * (C2 + r2 * C3));
+}
+
+// atan(t), 0 <= t <= 1
+static float AtanPoly(float t)
+{
+    float Offset = 0;
+    float t2;
+
+    if (t > TAN_PI_8) {
+        // atan(t) = pi/4 + atan((t - 1) / (t + 1))
+        t = (t - 1) / (t + 1);
+        Offset = PI_4_F;
+    }
+    t2 = t * t;
+    return Offset + t + t * t2 * (A1 + t2 * (A2 + t2 * (A3 + t2 * A4)));
+}
+
+// asin(s), 0 <= s <= 0.5, with s2 = s^2
+static float AsinPoly(float s, float s2)
+{
+    return s + s * s2 * (P1 + s2 * (P2 + s2 * (P3 + s2 * (P4 + s2 * P5))));
+}
+
+#ifdef TEST_FAST_MATH
+/* Math kernel harness (make -f Makefile.host math_check).
+   Runs each kernel over a dense sweep of its range, plus the ends and the
+   special cases, against libm in double, and prints the max error, next
+   to that of the libm float function it replaced. Fails if a kernel is
+   over the max error FastMath.h gives for it. Then the cost of each
+   against the libm float function on the same arguments. */
+#include <math.h>
+#include <stdio.h>
+#include "ES_Port.h"
+
+#define SWEEP_POINTS  2000001u
+#define TIMING_POINTS 4096u
+#define TIMING_PASSES 256u
+
+typedef enum
+{
+    Sin, Cos, SinCosSin, SinCosCos, Atan2, Asin, InvSqrt, NUM_KERNELS
+} Kernel_t;
+
+static const char *KernelNames[NUM_KERNELS] = {
+    "sin", "cos", "sincos sin", "sincos cos", "atan2", "asin", "invsqrt"
+};
+// the max errors in FastMath.h, relative for invsqrt
+static const double Limits[NUM_KERNELS] = {
+    1.2e-7, 1.2e-7, 1.2e-7, 1.2e-7, 3e-7, 3e-7, 5e-6
+};
+
+static double FastErrors[NUM_KERNELS];
+static double LibmErrors[NUM_KERNELS];
+static float Arguments[TIMING_POINTS];
+static float Arguments2[TIMING_POINTS];
+static volatile float Sink;
+static bool Failed = false;
+
+static void Track(Kernel_t Kernel, double Fast, double Libm, double Exact)
+{
+    double FastError = fabs(Fast - Exact);
+    double LibmError = fabs(Libm - Exact);
+
+    if (Kernel == InvSqrt) {
+        FastError /= Exact;
+        LibmError /= Exact;
+    }
+    // a NaN is never less than anything, so it is always over
+    if (!(FastError <= FastErrors[Kernel])) {
+        FastErrors[Kernel] = FastError;
+    }
+    if (LibmError > LibmErrors[Kernel]) {
+        LibmErrors[Kernel] = LibmError;
+    }
+}
+
+static void CheckTrig(float x)
+{
+    float s, c;
+
+    Track(Sin, FastMath_Sin(x), sinf(x), sin(x));
+    Track(Cos, FastMath_Cos(x), cosf(x), cos(x));
+    FastMath_SinCos(x, &s, &c);
+    Track(SinCosSin, s, sinf(x), sin(x));
+    Track(SinCosCos, c, cosf(x), cos(x));
+}
+
+static void CheckAccuracy(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < SWEEP_POINTS; i++) {
+        double u = (double)i / (SWEEP_POINTS - 1); // 0 to 1
+        float x;
+
+        // +-2 pi densely, then out to the end of the range
+        CheckTrig((float)(4 * M_PI * u - 2 * M_PI));
+        CheckTrig((float)(2 * FAST_MATH_TRIG_RANGE * u -
+            FAST_MATH_TRIG_RANGE));
+
+        // around the circle at radii from 1e-3 to 1e3
+        x = (float)(2 * M_PI * u - M_PI);
+        {
+            float Radius = (float)pow(10, 6 * fmod(u * 7919, 1) - 3);
+            float px = Radius * cosf(x);
+            float py = Radius * sinf(x);
+
+            Track(Atan2, FastMath_Atan2(py, px), atan2f(py, px),
+                atan2(py, px));
+        }
+
+        x = (float)(2 * u - 1);
+        Track(Asin, FastMath_Asin(x), asinf(x), asin(x));
+
+        // 1e-6 to 1e6, the accelerometer norm is around 1 g
+        x = (float)pow(10, 12 * u - 6);
+        Track(InvSqrt, FastMath_InvSqrt(x), 1 / sqrtf(x), 1 / sqrt(x));
+    }
+
+    // the ends and the axes
+    CheckTrig(0);
+    CheckTrig(PI_F);
+    CheckTrig(-PI_F);
+    Track(Atan2, FastMath_Atan2(0, 1), atan2f(0, 1), 0);
+    Track(Atan2, FastMath_Atan2(1, 0), atan2f(1, 0), M_PI / 2);
+    Track(Atan2, FastMath_Atan2(0, -1), atan2f(0, -1), M_PI);
+    Track(Atan2, FastMath_Atan2(-1, 0), atan2f(-1, 0), -M_PI / 2);
+    Track(Atan2, FastMath_Atan2(1, 1), atan2f(1, 1), M_PI / 4);
+    Track(Atan2, FastMath_Atan2(0, 0), 0, 0);
+    Track(Asin, FastMath_Asin(1), asinf(1), M_PI / 2);
+    Track(Asin, FastMath_Asin(-1), asinf(-1), -M_PI / 2);
+    if (FastMath_Asin(1.0001f) != FastMath_Asin(1)) {
+        printf("math: asin(1.0001) is not asin(1)\r\n");
+        Failed = true;
+    }
+}
+
+static void PrintAccuracy(void)
+{
+    Kernel_t Kernel;
+
+    printf("%-12s %12s %12s %12s\r\n", "max error", "FastMath", "libm float",
+        "limit");
+    for (Kernel = 0; Kernel < NUM_KERNELS; Kernel++) {
+        printf("%-12s %12.3g %12.3g %12.3g\r\n", KernelNames[Kernel],
+            FastErrors[Kernel], LibmErrors[Kernel], Limits[Kernel]);
+        if (!(FastErrors[Kernel] <= Limits[Kernel])) {
+            printf("math: %s is over its limit\r\n", KernelNames[Kernel]);
+            Failed = true;
+        }
+    }
+}
+
+static void PrintCost(const char *pWhat, uint32_t Fast, uint32_t Libm)
+{
+    printf("%-12s %9.1f %s, libm %9.1f %s\r\n", pWhat,
+        (double)Fast / (TIMING_PASSES * TIMING_POINTS), ES_BENCH_COUNT_UNITS,
+        (double)Libm / (TIMING_PASSES * TIMING_POINTS), ES_BENCH_COUNT_UNITS);
+}
+
+// times Expression over Arguments, Arguments2, into Counts
+#define TIME(Counts, Expression) \
+    do { \
+        uint32_t Start = ES_GetBenchCount(); \
+        uint32_t Pass, i; \
+        for (Pass = 0; Pass < TIMING_PASSES; Pass++) { \
+            for (i = 0; i < TIMING_POINTS; i++) { \
+                Sink = (Expression); \
+            } \
+        } \
+        (Counts) = ES_GetBenchCount() - Start; \
+    } while (0)
+
+static void TimeKernels(void)
+{
+    uint32_t Fast, Libm;
+    uint32_t i;
+
+    // the angles and points T7Handler and the filter see
+    for (i = 0; i < TIMING_POINTS; i++) {
+        Arguments[i] = (float)(2 * M_PI * i / TIMING_POINTS - M_PI);
+        Arguments2[i] = (float)(0.5 + (double)i / TIMING_POINTS);
+    }
+
+    TIME(Fast, FastMath_Sin(Arguments[i]));
+    TIME(Libm, sinf(Arguments[i]));
+    PrintCost("sin", Fast, Libm);
+    TIME(Fast, FastMath_Cos(Arguments[i]));
+    TIME(Libm, cosf(Arguments[i]));
+    PrintCost("cos", Fast, Libm);
+    {
+        float s, c;
+
+        TIME(Fast, (FastMath_SinCos(Arguments[i], &s, &c), s + c));
+        TIME(Libm, sinf(Arguments[i]) + cosf(Arguments[i]));
+        PrintCost("sincos", Fast, Libm);
+    }
+    TIME(Fast, FastMath_Atan2(Arguments[i], Arguments2[i] - 1));
+    TIME(Libm, atan2f(Arguments[i], Arguments2[i] - 1));
+    PrintCost("atan2", Fast, Libm);
+    TIME(Fast, FastMath_Asin(Arguments2[i] - 1));
+    TIME(Libm, asinf(Arguments2[i] - 1));
+    PrintCost("asin", Fast, Libm);
+    TIME(Fast, FastMath_InvSqrt(Arguments2[i]));
+    TIME(Libm, 1 / sqrtf(Arguments2[i]));
+    PrintCost("invsqrt", Fast, Libm);
+}
+
+int main(void)
+{
+    CheckAccuracy();
+    PrintAccuracy();
+    TimeKernels();
+
+    if (Failed) {
+        printf("math: FAILED\r\n");
+        return 1;
+    }
+    printf("math: kernel checks passed\r\n");
+    return 0;
+}
+#endif /* TEST_FAST_MATH */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -21,7 +21,7 @@
 #include "IMU_SM.h"
 #include <sys/attribs.h>
 #include "dbprintf.h"
-#include <math.h>
+#include "FastMath.h"
 
 /*----------------------------- Module Defines ----------------------------*/
 #define READ  0b10000000
@@ -381,42 +381,42 @@ void GetIMUData(float *ImuResults)
     } else {
         signed_data = Accel[0].FullData;
     }
-    ImuResults[0] = (float)signed_data / 8.19 * 9.81 / 1000;
+    ImuResults[0] = (float)signed_data / 8.19f * 9.81f / 1000;
 
     if (Accel[1].FullData & 0x8000) {
         signed_data = -((~Accel[1].FullData & 0xFFFF) + 1);
     } else {
         signed_data = Accel[1].FullData;
     }
-    ImuResults[1] = (float)signed_data / 8.19 * 9.81 / 1000;
+    ImuResults[1] = (float)signed_data / 8.19f * 9.81f / 1000;
     
     if (Accel[2].FullData & 0x8000) {
         signed_data = -((~Accel[2].FullData & 0xFFFF) + 1);
     } else {
         signed_data = Accel[2].FullData;
     }
-    ImuResults[2] = (float)signed_data / 8.19 * 9.81 / 1000;
+    ImuResults[2] = (float)signed_data / 8.19f * 9.81f / 1000;
 
     if (Gyro[0].FullData & 0x8000) {
         signed_data = -((~Gyro[0].FullData & 0xFFFF) + 1);
     } else {
         signed_data = Gyro[0].FullData;
     }
-    ImuResults[3] = (float)signed_data / 131.2;
+    ImuResults[3] = (float)signed_data / 131.2f;
     
     if (Gyro[1].FullData & 0x8000) {
         signed_data = -((~Gyro[1].FullData & 0xFFFF) + 1);
     } else {
         signed_data = Gyro[1].FullData;
     }
-    ImuResults[4] = (float)signed_data / 131.2;
+    ImuResults[4] = (float)signed_data / 131.2f;
 
     if (Gyro[2].FullData & 0x8000) {
         signed_data = -((~Gyro[2].FullData & 0xFFFF) + 1);
     } else {
         signed_data = Gyro[2].FullData;
     }
-    ImuResults[5] = (float)signed_data / 131.2;
+    ImuResults[5] = (float)signed_data / 131.2f;
     
     return;
 }
@@ -445,7 +445,7 @@ void WriteImuToSPI(uint8_t *Message2Send)
   }
   
   for (uint8_t j = 0; j < 7; j++) {
-    Message2Send[j+13] = 0; // Fill rest of buffer with 0's
+    Message2Send[j+9] = 0; // Fill rest of buffer with 0's (bytes 10-16)
   }
 }
 
@@ -461,8 +461,8 @@ void WriteImuToSPI(uint8_t *Message2Send)
 void GetAngles(float* roll, float* pitch)
 {
     // Compute pitch and roll (in degrees)
-    *roll = atan2f(q0*q1 + q2*q3, 0.5 - q1*q1 + q2*q2) * 57.29578;
-    *pitch = asinf(2.0 * (q0*q2 - q3*q1)) * 57.29578;
+    *roll = FastMath_Atan2(q0*q1 + q2*q3, 0.5f - q1*q1 + q2*q2) * 57.29578f;
+    *pitch = FastMath_Asin(2.0f * (q0*q2 - q3*q1)) * 57.29578f;
 }
 
 /***************************************************************************
@@ -491,10 +491,12 @@ void InitIMU(void)
     uint16_t data = ReadIMU16(0x00); // Dummy call to set up SPI  
     
     data = ReadIMU8(0x00); // Get chip ID
+#ifndef ES_PORT_HOST // no BMI323 on the other end of the host SPI registers
     while (data != 0b01000011) {
         DB_printf("Incorrect Chip ID: %d\r\n", data);
         data = ReadIMU16(0x00); // Get chip ID
     }
+#endif
     DB_printf("Chip ID: %d\r\n", data);
 
     // Get the status of the chip
@@ -687,7 +689,7 @@ void PrintImuData(void)
     } else {
         signed_data = Accel[0].FullData;
     }
-    float x_accel = (float)signed_data / 8.19 * 9.81 / 1000;
+    float x_accel = (float)signed_data / 8.19f * 9.81f / 1000;
     DB_printf("Accel x: %d m/s^2\r\n", (int16_t)x_accel);
 
     if (Accel[1].FullData & 0x8000) {
@@ -695,7 +697,7 @@ void PrintImuData(void)
     } else {
         signed_data = Accel[1].FullData;
     }
-    float y_accel = (float)signed_data / 8.19 * 9.81 / 1000;
+    float y_accel = (float)signed_data / 8.19f * 9.81f / 1000;
     DB_printf("Accel y: %d m/s^2\r\n", (int16_t)y_accel);
 
     if (Accel[2].FullData & 0x8000) {
@@ -703,7 +705,7 @@ void PrintImuData(void)
     } else {
         signed_data = Accel[2].FullData;
     }
-    float z_accel = (float)signed_data / 8.19 * 9.81 / 1000;
+    float z_accel = (float)signed_data / 8.19f * 9.81f / 1000;
     DB_printf("Accel z: %d m/s^2\r\n", (int16_t)z_accel);
 
     if (Gyro[0].FullData & 0x8000) {
@@ -711,7 +713,7 @@ void PrintImuData(void)
     } else {
         signed_data = Gyro[0].FullData;
     }
-    float x_vel = (float)signed_data / 131.2;
+    float x_vel = (float)signed_data / 131.2f;
     DB_printf("Vel x: %d deg/sec\r\n", (int16_t)x_vel);
     
     if (Gyro[1].FullData & 0x8000) {
@@ -719,7 +721,7 @@ void PrintImuData(void)
     } else {
         signed_data = Gyro[1].FullData;
     }
-    float y_vel = (float)signed_data / 131.2;
+    float y_vel = (float)signed_data / 131.2f;
     DB_printf("Vel y: %d deg/sec\r\n", (int16_t)y_vel);
 
     if (Gyro[2].FullData & 0x8000) {
@@ -727,7 +729,7 @@ void PrintImuData(void)
     } else {
         signed_data = Gyro[2].FullData;
     }
-    float z_vel = (float)signed_data / 131.2;
+    float z_vel = (float)signed_data / 131.2f;
     DB_printf("Vel z: %d deg/sec\r\n\r\n", (int16_t)z_vel);
 }
 
@@ -758,12 +760,12 @@ void MahonyUpdate(float ax, float ay, float az, float gx, float gy, float gz, fl
     static float qc = 0.0;
         
     // Convert gyroscope degrees/sec to radians/sec
-	gx *= 0.0174533;
-	gy *= 0.0174533;
-	gz *= 0.0174533;
+	gx *= 0.0174533f;
+	gy *= 0.0174533f;
+	gz *= 0.0174533f;
     
     // Normalize accelerometer
-    recipNorm = 1/sqrtf(ax*ax + ay*ay + az*az);
+    recipNorm = FastMath_InvSqrt(ax*ax + ay*ay + az*az);
     ax *= recipNorm;
     ay *= recipNorm;
     az *= recipNorm;
@@ -771,7 +773,7 @@ void MahonyUpdate(float ax, float ay, float az, float gx, float gy, float gz, fl
     // Estimate the direction of gravity
     halfvx = q1*q3 - q0*q2;
     halfvy = q0*q1 + q2*q3;
-    halfvz = q0*q0 - 0.5 + q3*q3;
+    halfvz = q0*q0 - 0.5f + q3*q3;
     
     // Error (cross product of estimated and measured direction of gravity)
     halfex = (ay * halfvz - az * halfvy);
@@ -799,9 +801,9 @@ void MahonyUpdate(float ax, float ay, float az, float gx, float gy, float gz, fl
     gz += TWO_KP * halfez;
     
     // Integrate rate of change of quaternion
-	gx *= (0.5 * dt);		// pre-multiply common factors
-	gy *= (0.5 * dt);
-	gz *= (0.5 * dt);
+	gx *= (0.5f * dt);		// pre-multiply common factors
+	gy *= (0.5f * dt);
+	gz *= (0.5f * dt);
 	qa = q0;
 	qb = q1;
 	qc = q2;
@@ -811,7 +813,7 @@ void MahonyUpdate(float ax, float ay, float az, float gx, float gy, float gz, fl
 	q3 += (qa * gz + qb * gy - qc * gx);
 
 	// Normalize quaternion
-	recipNorm = 1/sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+	recipNorm = FastMath_InvSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
 	q0 *= recipNorm;
 	q1 *= recipNorm;
 	q2 *= recipNorm;
@@ -15,6 +15,17 @@
    state.
 
  Notes
+   The SPI RX ISR receives each frame into its own ES_Pool block and posts
+   the block handle, velocity commands in EV_JETSON_VELOCITY_RECEIVED and
+   every other frame in EV_JETSON_MESSAGE_RECEIVED. A frame that arrives
+   while the pool is empty is dropped. Velocity commands are coalesced
+   (COALESCED_EVENT_LIST), if the machine falls behind it gets the newest
+   one and the older ones are dropped, rather than filling the queue and
+   losing the frames after them.
+   The machine is the const tables below, run by ES_Hsm. RobotPending and
+   RobotActive are both inside RobotConnected, whose ES_TIMEOUT transition
+   covers losing the Jetson in either. Leaving RobotActive always stops
+   the motors, entering RobotInactive always puts the yellow LED back.
 
  History
  When           Who     What/Why
@@ -27,6 +38,8 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Hsm.h"
+#include "ES_Pool.h"
 #include <sys/attribs.h>
 #include "JetsonSM.h"
 #include "MotorSM.h"
@@ -39,20 +52,96 @@
 #define PENDING_TIMEOUT 1000 // Timeout to receive confirmation that Jetson recieved our confirmation message
 #define YELLOW_LATCH LATJbits.LATJ4
 #define GREEN_LATCH LATJbits.LATJ5
+#define DIAG_REQUEST 0b00001111 // Operations message byte 1, asks for diagnostics
+#define DIAG_MESSAGE 11 // Message type of the diagnostics reply
+#define DIAG_SUMMARY_PAGE 0xFF // Page number of the CPU load/totals page
+#define VELOCITY_MESSAGE 45 // Message type of a velocity command
+
+#if ES_POOL_BLOCK_SIZE < 16
+#error "JetsonSM needs ES_POOL_BLOCK_SIZE of at least 16 for a frame"
+#endif
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
 */
+static void WriteDiagnosticsToSPI(uint8_t *Message2Send, uint8_t Page);
+static void PutUint32(uint8_t *pDest, uint32_t Value);
+static float GetFloat(const uint8_t *pSource);
+
+// guards, all on the received frame
+static bool IsHello(ES_Event_t ThisEvent);
+static bool IsConfirm(ES_Event_t ThisEvent);
+static bool IsShutdown(ES_Event_t ThisEvent);
+static bool IsDiagRequest(ES_Event_t ThisEvent);
+
+// entry, exit and transition actions
+static void StartLink(ES_Event_t ThisEvent);
+static void EnterInactive(ES_Event_t ThisEvent);
+static void EnterPending(ES_Event_t ThisEvent);
+static void EnterActive(ES_Event_t ThisEvent);
+static void ExitActive(ES_Event_t ThisEvent);
+static void SendHelloReply(ES_Event_t ThisEvent);
+static void ClearReply(ES_Event_t ThisEvent);
+static void SetStartPose(ES_Event_t ThisEvent);
+static void ReportTimeout(ES_Event_t ThisEvent);
+static void Shutdown(ES_Event_t ThisEvent);
+static void SendDiagnostics(ES_Event_t ThisEvent);
+static void TakeVelocity(ES_Event_t ThisEvent);
+static void TraceTransition(uint8_t From, uint8_t To, ES_Event_t ThisEvent);
 
 /*---------------------------- Module Variables ---------------------------*/
-// everybody needs a state variable, you may need others as well.
-// type of state variable should match htat of enum in header file
-static JetsonState_t CurrentState;
+// the machine, as data. A state's row lists the transitions out of it, the
+// first one whose guard passes is taken
+static const ES_HsmTransition_t InitTransitions[] = {
+  { ES_INIT, RobotInactive, NULL, StartLink },
+};
+static const ES_HsmTransition_t InactiveTransitions[] = {
+  { EV_JETSON_MESSAGE_RECEIVED, RobotPending, IsHello, SendHelloReply },
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, NULL, ClearReply },
+  { EV_JETSON_VELOCITY_RECEIVED, ES_HSM_INTERNAL, NULL, ClearReply },
+};
+static const ES_HsmTransition_t ConnectedTransitions[] = {
+  { ES_TIMEOUT, RobotInactive, NULL, ReportTimeout },
+};
+static const ES_HsmTransition_t PendingTransitions[] = {
+  { EV_JETSON_MESSAGE_RECEIVED, RobotActive, IsConfirm, SetStartPose },
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, NULL, ClearReply },
+  { EV_JETSON_VELOCITY_RECEIVED, ES_HSM_INTERNAL, NULL, ClearReply },
+};
+static const ES_HsmTransition_t ActiveTransitions[] = {
+  { EV_JETSON_VELOCITY_RECEIVED, ES_HSM_INTERNAL, NULL, TakeVelocity },
+  { EV_JETSON_MESSAGE_RECEIVED, ES_HSM_INTERNAL, IsDiagRequest,
+    SendDiagnostics },
+  { EV_JETSON_MESSAGE_RECEIVED, RobotInactive, IsShutdown, Shutdown },
+};
+static const ES_HsmState_t States[] = {
+  [InitPState_Jetson] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      NULL, NULL, InitTransitions),
+  [RobotInactive] = ES_HSM_STATE(ES_HSM_NO_STATE, ES_HSM_NO_STATE,
+      EnterInactive, NULL, InactiveTransitions),
+  [RobotConnected] = ES_HSM_STATE(ES_HSM_NO_STATE, RobotPending,
+      NULL, NULL, ConnectedTransitions),
+  [RobotPending] = ES_HSM_STATE(RobotConnected, ES_HSM_NO_STATE,
+      EnterPending, NULL, PendingTransitions),
+  [RobotActive] = ES_HSM_STATE(RobotConnected, ES_HSM_NO_STATE,
+      EnterActive, ExitActive, ActiveTransitions),
+};
+static const ES_HsmMachine_t Machine = {
+  States, ARRAY_SIZE(States), TraceTransition
+};
+
+// for the trace, in JetsonState_t order
+static const char * const StateNames[] = {
+  "InitPState_Jetson", "RobotInactive", "RobotPending", "RobotActive",
+  "RobotConnected"
+};
+
+// everybody needs a state variable, here it lives in the machine instance
+static ES_Hsm_t Me;
 
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
 
-static uint8_t ReceiveBuffer[2][16];
 static uint8_t MessageToSend[16];
 
 // Indicates what message we are currently sending from MCU to Jetson
@@ -143,7 +232,7 @@ bool InitJetsonSM(uint8_t Priority)
   
   MyPriority = Priority;
   // put us into the Initial PseudoState
-  CurrentState = InitPState_Jetson;
+  ES_HsmInit(&Me, &Machine, InitPState_Jetson);
   // post the initial transition event
   ThisEvent.EventType = ES_INIT;
   if (ES_PostToService(MyPriority, ThisEvent) == true)
@@ -185,250 +274,15 @@ bool PostJetsonSM(ES_Event_t ThisEvent)
    ES_Event_t, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   Runs the link with the Jetson, the transitions are the tables at the top
+   of the file. A received frame is a pool block, ours until we return.
 ****************************************************************************/
 ES_Event_t RunJetsonSM(ES_Event_t ThisEvent)
 {
   ES_Event_t ReturnEvent;
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
 
-  switch (CurrentState)
-  {
-    case InitPState_Jetson:       
-    {
-      if (ThisEvent.EventType == ES_INIT) 
-      {
-        // now put the machine into the actual initial state
-        CurrentState = RobotInactive;
-        
-        CurrentMessage = 0; // Start with message 0
-        
-        // Preload buffer with 0
-        SPI2BUF = 0;
-      }
-    }
-    break;
-
-    case RobotInactive:      
-    {
-      switch (ThisEvent.EventType)
-      {
-        case EV_JETSON_MESSAGE_RECEIVED:  
-        { 
-          if (ReceiveBuffer[ThisEvent.EventParam][1] == 0b11111111 && ReceiveBuffer[ThisEvent.EventParam][0] == 90) {
-
-            // Send message received message to Jetson
-            MessageToSend[0] = 0;
-            MessageToSend[1] = 0b11111111;
-            MessageToSend[2] = 0; 
-            MessageToSend[3] = ROBOT_ID; // Send Robot ID
-            for (uint8_t ii = 4; ii < 16; ii++) {
-                MessageToSend[ii] = 0; // Fill rest of buffer with 0's
-            }
-            
-            // Start pending timeout timer
-            ES_Timer_InitTimer(JETSON_TIMER, PENDING_TIMEOUT);
-            
-            CurrentState = RobotPending;  
-            DB_printf("Moving to RobotPending\r\n");
-          } else {
-              for (uint8_t ii = 0; ii < 16; ii++) {
-                MessageToSend[ii] = 0; // Fill rest of buffer with 0's
-            }
-          }
-        }
-        break;
-
-        default:
-          ;
-      } 
-    }
-    break;
-    
-    case RobotPending:
-    {
-      switch (ThisEvent.EventType)
-      {
-        case EV_JETSON_MESSAGE_RECEIVED:  
-        { 
-          if (ReceiveBuffer[ThisEvent.EventParam][0] == 90 && ReceiveBuffer[ThisEvent.EventParam][1] == 0b10101010) {
-            // We received confirmation that the message was received
-            
-            // Get starting position(s)
-            float x_pos;
-            uint32_t combined_bytes = ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][2] << 24) | 
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][3] << 16) |
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][4] << 8) |
-                        ReceiveBuffer[ThisEvent.EventParam][5];
-            *((uint32_t*)&x_pos) = combined_bytes;
-            
-            float y_pos;
-            combined_bytes = ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][6] << 24) | 
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][7] << 16) |
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][8] << 8) |
-                        ReceiveBuffer[ThisEvent.EventParam][9];
-            *((uint32_t*)&y_pos) = combined_bytes;
-            
-            float theta_pos;
-            combined_bytes = ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][10] << 24) | 
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][11] << 16) |
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][12] << 8) |
-                        ReceiveBuffer[ThisEvent.EventParam][13];
-            *((uint32_t*)&theta_pos) = combined_bytes;
-            
-            DB_printf("x: %d\n", (uint32_t)(x_pos*100));
-            DB_printf("y: %d\n", (uint32_t)(y_pos*100));
-            DB_printf("th: %d\n", (uint32_t)(theta_pos*100));
-            
-            // Use provided position to set the initial dead reckoning positions
-            SetPosition(x_pos, y_pos, theta_pos);
-            
-            YELLOW_LATCH = 0; // Turn yellow LED off
-            GREEN_LATCH = 1; // Turn green LED on
-            ES_Timer_InitTimer(JETSON_TIMER, JETSON_TIMEOUT); // Start timeout timer
-            
-            CurrentState = RobotActive;  
-            DB_printf("Moving to RobotActive\r\n");
-          } else {
-              for (uint8_t ii = 0; ii < 16; ii++) {
-                  MessageToSend[ii] = 0;
-              }
-          }
-        }
-        break;
-        
-        case ES_TIMEOUT:
-        {
-            // Didn't receive confirmation in time
-            CurrentState = RobotInactive;
-            DB_printf("Moving to RobotInactive");
-        }
-        break;
-            
-        default:
-          ;
-      } 
-    }
-    break;
-    
-    case RobotActive:      
-    {
-      switch (ThisEvent.EventType)
-      {
-        case EV_JETSON_MESSAGE_RECEIVED:  
-        { 
-          // Determine what message type we have
-          switch (ReceiveBuffer[ThisEvent.EventParam][0])
-          {
-            case 90: // Operations Message
-            {
-                if (ReceiveBuffer[ThisEvent.EventParam][1] == 0b11110000) {
-                    // Received Shutdown message
-                    SetDesiredRPM(0, 0); // Stop all movement of the robot
-                    ES_Timer_StopTimer(JETSON_TIMER); // Stop timer
-
-                    YELLOW_LATCH = 1; // Turn yellow LED on
-                    GREEN_LATCH = 0;  // Turn green LED off
-                    CurrentState = RobotInactive;  
-
-                    CurrentMessage = 0;
-                    ResetPosition();
-                    DB_printf("Received End Message: going to RobotInactive\r\n");
-                }
-            }
-            break;
-            
-            case 45: // Velocity Message
-            {
-                float desired_lin_v;
-                float desired_ang_v;
-
-                ES_Timer_InitTimer(JETSON_TIMER, JETSON_TIMEOUT); // Restart timeout timer
-                switch (CurrentMessage)
-                {
-                    case 0:
-                    {
-                        // Write the cliff sensor/button data
-                        WriteCliffToSPI(MessageToSend);
-                        CurrentMessage = 1;
-                    }
-                    break;
-
-                    case 1:
-                    {
-                        // Write the IMU data
-                        WriteImuToSPI(MessageToSend);
-                        CurrentMessage = 2;
-                    }
-                    break;
-
-                    case 2:
-                    {
-                        // Write the position as determined by dead reckoning
-                        WritePositionToSPI(MessageToSend);
-                        CurrentMessage = 3;
-                    }
-                    break;
-
-                    case 3:
-                    {
-                        // Write the velocity as determined by dead reckoning
-                        WriteDeadReckoningVelocityToSPI(MessageToSend);
-                        CurrentMessage = 0;
-                    }
-                    break;
-                }
-
-
-                // Convert Received Data to float
-                uint32_t combined_bytes = ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][1] << 24) | 
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][2] << 16) |
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][3] << 8) |
-                        ReceiveBuffer[ThisEvent.EventParam][4];
-                *((uint32_t*)&desired_lin_v) = combined_bytes;
-                // DB_printf("%d, ", (int)(desired_lin_v));
-
-                combined_bytes = ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][5] << 24) | 
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][6] << 16) |
-                        ((uint32_t)ReceiveBuffer[ThisEvent.EventParam][7] << 8) |
-                        ReceiveBuffer[ThisEvent.EventParam][8];
-                *((uint32_t*)&desired_ang_v) = combined_bytes;
-
-                // DB_printf("%d \r\n", (int)combined_bytes);
-                SetDesiredSpeed(desired_lin_v, desired_ang_v);
-            }
-            break;
-            
-            default:
-              ;  
-          }       
-        }
-        break;
-        
-        case ES_TIMEOUT:
-        {
-          // Timed out: Shutdown the robot
-          SetDesiredRPM(0, 0); // Stop all movement of the robot
-            
-          YELLOW_LATCH = 1; // Turn yellow LED on
-          GREEN_LATCH = 0;  // Turn green LED off
-          CurrentState = RobotInactive;
-                    
-          DB_printf("Timed out, moving to Robot Inactive\r\n");
-          
-          CurrentMessage = 0;
-        }
-        break;
-            
-        default:
-          ;
-      } 
-    }
-    break;
-    
-    default:
-      ;
-  }                                  
+  ES_HsmDispatch(&Me, ThisEvent);
   return ReturnEvent;
 }
 
@@ -447,13 +301,379 @@ ES_Event_t RunJetsonSM(ES_Event_t ThisEvent)
 ****************************************************************************/
 JetsonState_t QueryJetsonSM(void)
 {
-  return CurrentState;
+  return (JetsonState_t)ES_HsmGetState(&Me);
 }
 
 /***************************************************************************
  private functions
  ***************************************************************************/
 
+/****************************************************************************
+ Guards
+   Check the frame in a EV_JETSON_MESSAGE_RECEIVED. Byte 0 is the message
+   type: 90 is an operations message (byte 1 says which). Velocity
+   commands (45) come in EV_JETSON_VELOCITY_RECEIVED instead.
+****************************************************************************/
+static bool IsHello(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+  return (pReceived[0] == 90) && (pReceived[1] == 0b11111111);
+}
+
+static bool IsConfirm(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+  return (pReceived[0] == 90) && (pReceived[1] == 0b10101010);
+}
+
+static bool IsShutdown(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+  return (pReceived[0] == 90) && (pReceived[1] == 0b11110000);
+}
+
+static bool IsDiagRequest(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+  return (pReceived[0] == 90) && (pReceived[1] == DIAG_REQUEST);
+}
+
+/****************************************************************************
+ Function
+    StartLink
+
+ Description
+    ES_INIT, the first reply the Jetson clocks out is a 0
+****************************************************************************/
+static void StartLink(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  CurrentMessage = 0; // Start with message 0
+
+  // Preload buffer with 0
+  SPI2BUF = 0;
+}
+
+/****************************************************************************
+ Function
+    EnterInactive / EnterPending / EnterActive / ExitActive
+
+ Description
+    The LEDs show the link state. Pending and Active each run their own
+    timeout on JETSON_TIMER, and the robot never keeps moving once it has
+    left RobotActive, however it left.
+****************************************************************************/
+static void EnterInactive(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  YELLOW_LATCH = 1; // Turn yellow LED on
+  GREEN_LATCH = 0;  // Turn green LED off
+}
+
+static void EnterPending(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  // Start pending timeout timer
+  ES_Timer_InitTimer(JETSON_TIMER, PENDING_TIMEOUT);
+}
+
+static void EnterActive(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  YELLOW_LATCH = 0; // Turn yellow LED off
+  GREEN_LATCH = 1; // Turn green LED on
+  ES_Timer_InitTimer(JETSON_TIMER, JETSON_TIMEOUT); // Start timeout timer
+}
+
+static void ExitActive(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  SetDesiredRPM(0, 0); // Stop all movement of the robot
+  CurrentMessage = 0;
+}
+
+/****************************************************************************
+ Function
+    SendHelloReply
+
+ Description
+    The Jetson said hello, answer with our robot ID
+****************************************************************************/
+static void SendHelloReply(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  // Send message received message to Jetson
+  MessageToSend[0] = 0;
+  MessageToSend[1] = 0b11111111;
+  MessageToSend[2] = 0; 
+  MessageToSend[3] = ROBOT_ID; // Send Robot ID
+  for (uint8_t ii = 4; ii < 16; ii++) {
+      MessageToSend[ii] = 0; // Fill rest of buffer with 0's
+  }
+}
+
+/****************************************************************************
+ Function
+    ClearReply
+
+ Description
+    A frame we were not waiting for, reply with 0's
+****************************************************************************/
+static void ClearReply(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  for (uint8_t ii = 0; ii < 16; ii++) {
+      MessageToSend[ii] = 0;
+  }
+}
+
+/****************************************************************************
+ Function
+    SetStartPose
+
+ Description
+    The confirmation carries the starting x, y and theta as big endian
+    floats in bytes 2-13, dead reckoning starts from there
+****************************************************************************/
+static void SetStartPose(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+  float x_pos = GetFloat(&pReceived[2]);
+  float y_pos = GetFloat(&pReceived[6]);
+  float theta_pos = GetFloat(&pReceived[10]);
+
+  DB_printf("x: %d\n", (uint32_t)(x_pos*100));
+  DB_printf("y: %d\n", (uint32_t)(y_pos*100));
+  DB_printf("th: %d\n", (uint32_t)(theta_pos*100));
+
+  // Use provided position to set the initial dead reckoning positions
+  SetPosition(x_pos, y_pos, theta_pos);
+}
+
+/****************************************************************************
+ Function
+    ReportTimeout
+
+ Description
+    No confirmation, or no message at all, from the Jetson in time
+****************************************************************************/
+static void ReportTimeout(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  DB_printf("Jetson timed out\r\n");
+}
+
+/****************************************************************************
+ Function
+    Shutdown
+
+ Description
+    The Jetson ended the session, ExitActive has already stopped the motors
+****************************************************************************/
+static void Shutdown(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  ES_Timer_StopTimer(JETSON_TIMER); // Stop timer
+  ResetPosition();
+  DB_printf("Received End Message\r\n");
+}
+
+/****************************************************************************
+ Function
+    SendDiagnostics
+
+ Description
+    Diagnostics request, byte 2 is the page (service number or
+    DIAG_SUMMARY_PAGE). The reply goes out in place of the next data message.
+****************************************************************************/
+static void SendDiagnostics(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+
+  ES_Timer_InitTimer(JETSON_TIMER, JETSON_TIMEOUT); // Restart timeout timer
+  WriteDiagnosticsToSPI(MessageToSend, pReceived[2]);
+}
+
+/****************************************************************************
+ Function
+    TakeVelocity
+
+ Description
+    Velocity message: bytes 1-4 and 5-8 are the desired linear and angular
+    velocity. Each one is answered with the next of the four data messages.
+****************************************************************************/
+static void TakeVelocity(ES_Event_t ThisEvent)
+{
+  uint8_t *pReceived = ES_PoolGetPtr(ThisEvent.EventParam);
+
+  ES_Timer_InitTimer(JETSON_TIMER, JETSON_TIMEOUT); // Restart timeout timer
+  switch (CurrentMessage)
+  {
+      case 0:
+      {
+          // Write the cliff sensor/button data
+          WriteCliffToSPI(MessageToSend);
+          CurrentMessage = 1;
+      }
+      break;
+
+      case 1:
+      {
+          // Write the IMU data
+          WriteImuToSPI(MessageToSend);
+          CurrentMessage = 2;
+      }
+      break;
+
+      case 2:
+      {
+          // Write the position as determined by dead reckoning
+          WritePositionToSPI(MessageToSend);
+          CurrentMessage = 3;
+      }
+      break;
+
+      case 3:
+      {
+          // Write the velocity as determined by dead reckoning
+          WriteDeadReckoningVelocityToSPI(MessageToSend);
+          CurrentMessage = 0;
+      }
+      break;
+  }
+
+  SetDesiredSpeed(GetFloat(&pReceived[1]), GetFloat(&pReceived[5]));
+}
+
+/****************************************************************************
+ Function
+    TraceTransition
+
+ Description
+    The machine's trace hook, prints every change of state. Internal
+    transitions (every velocity message) are not printed.
+****************************************************************************/
+static void TraceTransition(uint8_t From, uint8_t To, ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+
+  if (From != To) {
+    DB_printf("Jetson: %s -> %s\r\n", StateNames[From], StateNames[To]);
+  }
+}
+
+/****************************************************************************
+ Function
+    GetFloat
+
+ Description
+    Reads a big endian float out of a received frame
+****************************************************************************/
+static float GetFloat(const uint8_t *pSource)
+{
+  // the bits go in as an integer and come out as a float, without the
+  // aliasing a pointer cast would be
+  union {
+    float f;
+    uint32_t i;
+  } Value;
+
+  Value.i = ((uint32_t)pSource[0] << 24) |
+            ((uint32_t)pSource[1] << 16) |
+            ((uint32_t)pSource[2] << 8) |
+            pSource[3];
+  return Value.f;
+}
+
+/****************************************************************************
+ Function
+    WriteDiagnosticsToSPI
+
+ Description
+    Fills the message with one page of the framework profiling data
+    (ES_PROFILING). All multi-byte values are big endian like the rest of
+    the messages, times are core timer counts (10ns).
+ *  Service page (Page = service number):
+ *   - byte 0: 11, byte 1: page
+ *   - bytes 2-5: dispatch count
+ *   - bytes 6-9: average run time
+ *   - bytes 10-13: max run time
+ *   - byte 14: queue high water mark, byte 15: failed posts (saturates at 255)
+ *  Summary page (Page = 0xFF):
+ *   - byte 0: 11, byte 1: 0xFF
+ *   - bytes 2-3: CPU load in tenths of a percent, 0xFFFF if not known
+ *   - byte 4: number of services
+ *   - bytes 5-8: dispatches, all services
+ *   - bytes 9-12: failed posts, all services
+ *   - bytes 13-14: coalesced posts, all services (saturates at 65535)
+ *  An unknown service gets a page of zeros after the 2 header bytes.
+****************************************************************************/
+static void WriteDiagnosticsToSPI(uint8_t *Message2Send, uint8_t Page)
+{
+  ES_ServiceStats_t Stats;
+  uint32_t TotalDispatches = 0;
+  uint32_t TotalFailed = 0;
+  uint32_t TotalCoalesced = 0;
+  uint16_t Idle;
+  uint16_t Load;
+  uint8_t i;
+
+  Message2Send[0] = DIAG_MESSAGE;
+  Message2Send[1] = Page;
+  for (i = 2; i < 16; i++) {
+    Message2Send[i] = 0;
+  }
+
+  if (Page == DIAG_SUMMARY_PAGE) {
+    for (i = 0; ES_GetServiceStats(i, &Stats); i++) {
+      TotalDispatches += Stats.Dispatches;
+      TotalFailed += Stats.FailedPosts;
+      TotalCoalesced += Stats.Coalesced;
+    }
+    if (TotalCoalesced > 0xFFFF) {
+      TotalCoalesced = 0xFFFF;
+    }
+    Idle = ES_GetIdlePermille();
+    Load = (Idle == ES_IDLE_UNKNOWN) ? 0xFFFF : 1000 - Idle;
+    Message2Send[2] = Load >> 8;
+    Message2Send[3] = Load & 0xFF;
+    Message2Send[4] = i;
+    PutUint32(&Message2Send[5], TotalDispatches);
+    PutUint32(&Message2Send[9], TotalFailed);
+    Message2Send[13] = TotalCoalesced >> 8;
+    Message2Send[14] = TotalCoalesced & 0xFF;
+  } else if (ES_GetServiceStats(Page, &Stats)) {
+    PutUint32(&Message2Send[2], Stats.Dispatches);
+    PutUint32(&Message2Send[6], Stats.AvgCounts);
+    PutUint32(&Message2Send[10], Stats.MaxCounts);
+    Message2Send[14] = Stats.QueueHighWater;
+    Message2Send[15] = (Stats.FailedPosts > 255) ? 255 : Stats.FailedPosts;
+  }
+}
+
+/****************************************************************************
+ Function
+    PutUint32
+
+ Description
+    Writes Value into 4 bytes, most significant first
+****************************************************************************/
+static void PutUint32(uint8_t *pDest, uint32_t Value)
+{
+  for (uint8_t j = 0; j < 4; j++) {
+    pDest[j] = (Value >> (24 - 8*j)) & 0xFF;
+  }
+}
+
 /****************************************************************************
  Function
     SPI2TX
@@ -492,13 +712,15 @@ void __ISR(_SPI2_RX_VECTOR, IPL7SRS) SPI2RXHandler(void)
     
     // Static for speed
     static ES_Event_t ReceiveEvent = {EV_JETSON_MESSAGE_RECEIVED, 0};
-    static uint8_t buffer_num = 0;
+    static uint16_t RxBlock = ES_POOL_NO_BLOCK;
+    static uint8_t *pRx;
+    static uint8_t Discard[16]; // where a frame goes when the pool is empty
     static uint8_t MessageIndex = 0;
     static uint8_t TempData;
     
     if (InMessage) {
         while (!SPI2STATbits.SPIRBE && MessageIndex <= 15) {
-            ReceiveBuffer[buffer_num][MessageIndex] = SPI2BUF;
+            pRx[MessageIndex] = SPI2BUF;
             MessageIndex += 1;
         }
     } else {
@@ -511,6 +733,15 @@ void __ISR(_SPI2_RX_VECTOR, IPL7SRS) SPI2RXHandler(void)
             for (uint8_t ii = 0; ii < 16; ii++) {
                 SPI2BUF = MessageToSend[ii];
             }
+            
+            // Every frame gets its own block, so the next one can't 
+            // overwrite it before RunJetsonSM has read it
+            RxBlock = ES_PoolAlloc();
+            if (RxBlock == ES_POOL_NO_BLOCK) {
+                pRx = Discard; // counted in the pool's AllocFailures
+            } else {
+                pRx = ES_PoolGetPtr(RxBlock);
+            }
             InMessage = true; // Now we are accepting message bytes
         }
     }
@@ -521,24 +752,27 @@ void __ISR(_SPI2_RX_VECTOR, IPL7SRS) SPI2RXHandler(void)
         MessageIndex = 0; // Reset Message index once full
         InMessage = false; // No longer accepting message bytes
         
-        // Tell which buffer we just stored the data in
-        ReceiveEvent.EventParam = buffer_num;
-        if (buffer_num) {
-            buffer_num = 0;
-        } else {
-            buffer_num = 1;
+        if (RxBlock != ES_POOL_NO_BLOCK) {
+            // Tell state machine the data is ready, the framework takes its
+            // own reference to the block so we drop ours
+            if (pRx[0] == VELOCITY_MESSAGE) {
+                ReceiveEvent.EventType = EV_JETSON_VELOCITY_RECEIVED;
+            } else {
+                ReceiveEvent.EventType = EV_JETSON_MESSAGE_RECEIVED;
+            }
+            ReceiveEvent.EventParam = RxBlock;
+            PostJetsonSM(ReceiveEvent);
+            ES_PoolRelease(RxBlock);
+            RxBlock = ES_POOL_NO_BLOCK;
         }
-
-        // Tell state machine the data is ready
-        PostJetsonSM(ReceiveEvent);
     }
     
     // For debugging:
 //    DB_printf("Received 16 Messages!\r\n");
     // Read the data from the buffer
 //    for (uint8_t i=0; i < 16; i++) {
-//        ReceiveBuffer[buffer_num][i] = SPI2BUF;
-//        DB_printf("%d, ", ReceiveBuffer[buffer_num][i]);
+//        pRx[i] = SPI2BUF;
+//        DB_printf("%d, ", pRx[i]);
 //    }
 //    DB_printf("\r\n");    
 }
@@ -0,0 +1,403 @@
+/****************************************************************************
+ Module
+   MotorControl.c
+
+ Description
+   The PID law T1Handler runs for each wheel, from the encoder pulse length
+   and the desired RPM to the drive, in float and in fixed point.
+
+ Notes
+   The float law is the one T1Handler used to run inline. The fixed point
+   law gives the same duty cycles with integer math only: the speed is an
+   integer divide, and the gains are held as integer thousandths rather
+   than a binary fraction. The error, its sum and its difference are whole
+   tenths of an RPM (SPEED_SCALE), so with gains that are exact in
+   thousandths every product is exact and the clamp and anti-windup
+   decisions land exactly where the float law's do. 0.8 and 0.05 have no
+   exact Q16 form, and there the integrator could drift from the float law
+   at the clamp limits.
+   The speed is in tenths of an RPM, rounded. In whole RPM one step of the
+   reading was a step of Kp in the duty, which at a crawl of a few RPM
+   kept the loop hunting between readings. Both laws add half the pulse
+   length before the divide, the float constant's fraction can then not
+   carry it past a whole step.
+   The gains are the ones the robot was tuned with (Kp 5, Ki 0.8, Kd 3).
+   They rise fast, but at a crawl the encoder edges are tens of ms apart
+   and on motor_bench the loop oscillates around the late readings.
+   MOTOR_PID_CRAWL_GAINS in ES_Configure.h picks a set retuned there for
+   the finer speed (Kp 1.5, Ki 0.05, Kd 0), which keeps the ripple under 1%
+   down to 4 RPM and rises in 20-30 ms. The plant's motor figures are
+   nominal, so that set stays off until it is checked on the robot.
+   The duty is not truncated to whole percent: both laws clamp it in
+   ten-thousandths of a percent, round it to thousandths, and hand it to
+   MotorPWM.c as a Q15 drive, which sets it in full timer resolution. The
+   float law rounds before its clamp too, so the two decide on the same
+   integer.
+   MOTOR_PID_FIXED in ES_Configure.h picks the law T1Handler runs, see
+   MotorControl.h. make -f Makefile.host pid_check runs both over the same
+   traces.
+
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <math.h>
+#include "MotorControl.h"
+#include "MotorPWM.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// percent of duty per RPM of error, Ki summed every T1 period
+#if MOTOR_PID_CRAWL_GAINS
+#define Kp 1.5f // Proportional constant for PID law
+#define Ki 0.05f // Integral constant for PID law
+#define Kd 0 // Derivative constant for PID law
+#else
+#define Kp 5 // Proportional constant for PID law
+#define Ki 0.8f // Integral constant for PID law
+#define Kd 3 // Derivative constant for PID law
+#endif
+
+// the same gains in thousandths for the fixed point law
+#define GAIN_SCALE 1000
+#define KP_FIXED ((int32_t)(Kp * GAIN_SCALE + 0.5f))
+#define KI_FIXED ((int32_t)(Ki * GAIN_SCALE + 0.5f))
+#define KD_FIXED ((int32_t)(Kd * GAIN_SCALE + 0.5f))
+
+#define MAX_DUTY 100 // percent
+// the gain products are in thousandths of a percent per SPEED_SCALE
+#define MAX_DUTY_SUM ((int64_t)MAX_DUTY * GAIN_SCALE * SPEED_SCALE)
+// above this the speed reading is taken to be in error
+#define MAX_PLAUSIBLE_RPM 500
+
+/*---------------------------- Module Functions ---------------------------*/
+static int16_t DriveFor(int64_t DutySum);
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     MotorPIDFloat_Reset
+
+ Parameters
+     MotorPIDFloat_t *pPID: the wheel's controller
+
+ Returns
+     None
+
+ Description
+     Clears the error history, T1Handler calls it when the wheels stop
+****************************************************************************/
+void MotorPIDFloat_Reset(MotorPIDFloat_t *pPID)
+{
+    pPID->ErrorSum = 0;
+    pPID->PrevError = 0;
+}
+
+/****************************************************************************
+ Function
+     MotorPIDFloat_Step
+
+ Parameters
+     MotorPIDFloat_t *pPID: the wheel's controller
+     uint16_t DesiredRPM: the speed wanted
+     uint32_t PulseLength: the filtered time between encoder pulses
+
+ Returns
+     int16_t the wheel's drive, 0 to MOTOR_PWM_FULL (Q15), T1Handler gives
+         it the wheel's direction
+
+ Description
+     One step of the PID law, with anti-windup. Leaves the measured speed
+     and the error, in tenths of an RPM, in *pPID for the RL logging
+****************************************************************************/
+int16_t MotorPIDFloat_Step(MotorPIDFloat_t *pPID, uint16_t DesiredRPM,
+    uint32_t PulseLength)
+{
+    float ErrorDiff;
+    int64_t Duty;
+
+    // Calculate Current RPM based on Pulse Length from encoder, to the
+    // nearest tenth. The integer factor gives the same speed, with no double
+    pPID->Speed = (SPEED_CONVERSION_COUNTS * SPEED_SCALE + PulseLength / 2) /
+        PulseLength;
+
+    // Calculate error from desired RPM
+    pPID->Error = (float)((int32_t)DesiredRPM * SPEED_SCALE) -
+        (float)pPID->Speed;
+    if (pPID->Speed > MAX_PLAUSIBLE_RPM * SPEED_SCALE) {
+        // The RPM Readings are likely in error, use previous error instead
+        pPID->Error = pPID->PrevError;
+    }
+
+    // Integral and derivative of error
+    pPID->ErrorSum += pPID->Error;
+    ErrorDiff = pPID->Error - pPID->PrevError;
+    pPID->PrevError = pPID->Error;
+
+    // Calculate according to PID Law, in thousandths of a percent per
+    // SPEED_SCALE
+    Duty = llroundf((Kp*pPID->Error + Ki*pPID->ErrorSum + Kd*ErrorDiff) *
+        GAIN_SCALE);
+
+    // Anti-Windup
+    if (Duty > MAX_DUTY_SUM) {
+        Duty = MAX_DUTY_SUM;
+        pPID->ErrorSum -= pPID->Error;
+    } else if (Duty < 0) {
+        Duty = 0;
+        pPID->ErrorSum -= pPID->Error;
+    }
+    return DriveFor(Duty);
+}
+
+/****************************************************************************
+ Function
+     MotorPIDFixed_Reset
+
+ Parameters
+     MotorPIDFixed_t *pPID: the wheel's controller
+
+ Returns
+     None
+
+ Description
+     Clears the error history, T1Handler calls it when the wheels stop
+****************************************************************************/
+void MotorPIDFixed_Reset(MotorPIDFixed_t *pPID)
+{
+    pPID->ErrorSum = 0;
+    pPID->PrevError = 0;
+}
+
+/****************************************************************************
+ Function
+     MotorPIDFixed_Step
+
+ Parameters
+     MotorPIDFixed_t *pPID: the wheel's controller
+     uint16_t DesiredRPM: the speed wanted
+     uint32_t PulseLength: the filtered time between encoder pulses
+
+ Returns
+     int16_t the wheel's drive, 0 to MOTOR_PWM_FULL (Q15), T1Handler gives
+         it the wheel's direction
+
+ Description
+     MotorPIDFloat_Step in integer math. The sum of the gain products is
+     the float law's, taken in 64 bits (a madd on
+     the MIPS32 core) so no error sum can overflow it
+****************************************************************************/
+int16_t MotorPIDFixed_Step(MotorPIDFixed_t *pPID, uint16_t DesiredRPM,
+    uint32_t PulseLength)
+{
+    int32_t ErrorDiff;
+    int64_t Duty;
+
+    pPID->Speed = (SPEED_CONVERSION_COUNTS * SPEED_SCALE + PulseLength / 2) /
+        PulseLength;
+
+    pPID->Error = (int32_t)DesiredRPM * SPEED_SCALE - (int32_t)pPID->Speed;
+    if (pPID->Speed > MAX_PLAUSIBLE_RPM * SPEED_SCALE) {
+        pPID->Error = pPID->PrevError;
+    }
+
+    pPID->ErrorSum += pPID->Error;
+    ErrorDiff = pPID->Error - pPID->PrevError;
+    pPID->PrevError = pPID->Error;
+
+    Duty = (int64_t)KP_FIXED * pPID->Error + (int64_t)KI_FIXED * pPID->ErrorSum +
+        (int64_t)KD_FIXED * ErrorDiff;
+
+    if (Duty > MAX_DUTY_SUM) {
+        Duty = MAX_DUTY_SUM;
+        pPID->ErrorSum -= pPID->Error;
+    } else if (Duty < 0) {
+        Duty = 0;
+        pPID->ErrorSum -= pPID->Error;
+    }
+    return DriveFor(Duty);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// a clamped gain sum, 0 to MAX_DUTY_SUM, as a Q15 drive. Rounded to
+// thousandths of a percent first, that product fits 32 bits unsigned
+static int16_t DriveFor(int64_t DutySum)
+{
+    uint32_t Duty = ((uint32_t)DutySum + SPEED_SCALE / 2) / SPEED_SCALE;
+
+    return (int16_t)((Duty * MOTOR_PWM_FULL + MAX_DUTY * GAIN_SCALE / 2) /
+        (MAX_DUTY * GAIN_SCALE));
+}
+
+#ifdef TEST_PID
+/* PID law harness (make -f Makefile.host pid_check).
+   Runs the float and the fixed point law side by side over encoder traces
+   and fails on the first step where the drive, the measured speed or the
+   error differ. First the speed alone over every pulse length up to 2^20.
+   Each trace line is "desired RPM, pulse length"; with a file argument
+   that trace is run, otherwise built in ones are: steps up and down
+   through the clamp limits, a stop, a stall (pulse length pinned at its
+   max by the no speed timer), implausible readings, and a slow noisy
+   cruise. Then both laws are timed over the same inputs. */
+#include <stdio.h>
+#include <stdlib.h>
+#include "ES_Port.h"
+
+#define TIMING_PASSES 20u
+#define MAX_TRACE     20000u
+#define STALLED       4294967295u
+
+typedef struct
+{
+    uint16_t DesiredRPM;
+    uint32_t PulseLength;
+} TraceStep_t;
+
+static TraceStep_t Trace[MAX_TRACE];
+static uint32_t TraceLength;
+static volatile int32_t Sink; // keeps the optimizer honest
+
+static void AddStep(uint16_t DesiredRPM, uint32_t PulseLength)
+{
+    if (TraceLength < MAX_TRACE) {
+        Trace[TraceLength].DesiredRPM = DesiredRPM;
+        Trace[TraceLength].PulseLength = PulseLength;
+        TraceLength++;
+    }
+}
+
+// pulse length that reads as RPM, 0 is a stalled wheel
+static uint32_t PulseFor(uint32_t RPM)
+{
+    return (RPM == 0) ? STALLED : SPEED_CONVERSION_COUNTS / RPM;
+}
+
+// a crude first order wheel, so the traces move through the clamp limits
+// the way a real run does, with the occasional jittered pulse length
+static void BuildTraces(void)
+{
+    static const uint16_t Targets[] = { 30, 120, 45, 200, 0, 90, 60 };
+    uint32_t RPM = 0;
+    uint32_t i, j;
+
+    srand(1);
+    for (i = 0; i < sizeof(Targets) / sizeof(Targets[0]); i++) {
+        for (j = 0; j < 1500; j++) {
+            RPM += ((int32_t)Targets[i] - (int32_t)RPM) / 16;
+            uint32_t Pulse = PulseFor(RPM);
+            if ((Pulse != STALLED) && ((rand() % 8) == 0)) {
+                Pulse += (uint32_t)(rand() % 201) - 100; // edge jitter
+            }
+            AddStep(Targets[i] ? Targets[i] : 60, Pulse);
+        }
+    }
+    // a stalled wheel, then readings above MAX_PLAUSIBLE_RPM
+    for (j = 0; j < 1000; j++) {
+        AddStep(150, STALLED);
+    }
+    for (j = 0; j < 500; j++) {
+        AddStep(100, (j & 1) ? PulseFor(900) : PulseFor(80));
+    }
+    // creeping along at a few RPM with noisy readings
+    for (j = 0; j < 4000; j++) {
+        AddStep(5, PulseFor(3 + (rand() % 5)));
+    }
+}
+
+static bool ReadTrace(const char *pName)
+{
+    FILE *pFile = fopen(pName, "r");
+    unsigned Desired;
+    unsigned long Pulse;
+
+    if (pFile == NULL) {
+        printf("pid: can not open %s\r\n", pName);
+        return false;
+    }
+    while (fscanf(pFile, " %u , %lu", &Desired, &Pulse) == 2) {
+        AddStep((uint16_t)Desired, (uint32_t)Pulse);
+    }
+    fclose(pFile);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    MotorPIDFloat_t FloatPID;
+    MotorPIDFixed_t FixedPID;
+    int16_t FloatDuty, FixedDuty;
+    uint32_t Start, FloatTime, FixedTime;
+    uint32_t i, Pass, Pulse;
+
+    if (argc > 1) {
+        if (!ReadTrace(argv[1])) {
+            return 1;
+        }
+    } else {
+        BuildTraces();
+    }
+
+    // the rounded speed over every pulse length from where it is 65535 RPM
+    // up to 2^20
+    for (Pulse = SPEED_CONVERSION_COUNTS / 65535 + 1; Pulse <= (1u << 20);
+            Pulse++) {
+        MotorPIDFloat_Step(&FloatPID, 0, Pulse);
+        MotorPIDFixed_Step(&FixedPID, 0, Pulse);
+        if (FloatPID.Speed != FixedPID.Speed) {
+            printf("pid: pulse length %u reads %u/%u tenths of an RPM\r\n",
+                Pulse, FloatPID.Speed, FixedPID.Speed);
+            return 1;
+        }
+    }
+
+    MotorPIDFloat_Reset(&FloatPID);
+    MotorPIDFixed_Reset(&FixedPID);
+    for (i = 0; i < TraceLength; i++) {
+        FloatDuty = MotorPIDFloat_Step(&FloatPID, Trace[i].DesiredRPM,
+            Trace[i].PulseLength);
+        FixedDuty = MotorPIDFixed_Step(&FixedPID, Trace[i].DesiredRPM,
+            Trace[i].PulseLength);
+        if ((FloatDuty != FixedDuty) ||
+                (FloatPID.Speed != FixedPID.Speed) ||
+                (FloatPID.Error != (float)FixedPID.Error) ||
+                (FloatPID.ErrorSum != (float)FixedPID.ErrorSum)) {
+            printf("pid: step %u differs, drive %d/%d, sum %d/%d\r\n", i,
+                FloatDuty, FixedDuty, (int)FloatPID.ErrorSum,
+                (int)FixedPID.ErrorSum);
+            return 1;
+        }
+    }
+    printf("pid: float and fixed point agree on all %u steps\r\n",
+        TraceLength);
+
+    MotorPIDFloat_Reset(&FloatPID);
+    Start = ES_GetBenchCount();
+    for (Pass = 0; Pass < TIMING_PASSES; Pass++) {
+        for (i = 0; i < TraceLength; i++) {
+            Sink += MotorPIDFloat_Step(&FloatPID, Trace[i].DesiredRPM,
+                Trace[i].PulseLength);
+        }
+    }
+    FloatTime = ES_GetBenchCount() - Start;
+
+    MotorPIDFixed_Reset(&FixedPID);
+    Start = ES_GetBenchCount();
+    for (Pass = 0; Pass < TIMING_PASSES; Pass++) {
+        for (i = 0; i < TraceLength; i++) {
+            Sink += MotorPIDFixed_Step(&FixedPID, Trace[i].DesiredRPM,
+                Trace[i].PulseLength);
+        }
+    }
+    FixedTime = ES_GetBenchCount() - Start;
+
+    printf("per wheel step, float: %.2f %s, fixed point: %.2f %s\r\n",
+        (double)FloatTime / (TIMING_PASSES * TraceLength),
+        ES_BENCH_COUNT_UNITS,
+        (double)FixedTime / (TIMING_PASSES * TraceLength),
+        ES_BENCH_COUNT_UNITS);
+    return 0;
+}
+#endif
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
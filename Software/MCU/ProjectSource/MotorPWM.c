@@ -0,0 +1,282 @@
+/****************************************************************************
+ Module
+   MotorPWM.c
+
+ Description
+   The motor drive: OC1 (right) and OC2 (left) in PWM mode on Timer4, and
+   the direction pins RF8 (right) and RJ3 (left). T1Handler gives it a
+   drive per wheel as a signed Q15 fraction, and it sets the duty in full
+   timer resolution at a frequency chosen at run time.
+
+ Notes
+   Timer4 runs at 1:1 from PBCLK3, so the duty has 50 MHz / frequency steps,
+   5000 at 10 kHz where it had 100 at 1:16. MOTOR_PWM_HZ in ES_Configure.h
+   is the frequency at start.
+   The driver board drives a wheel going backward in the low part of the
+   period, so a backward drive is written as the complement of its duty.
+   The output compares load OCxRS at the start of each period by
+   themselves, but the direction pin is a port write. So when a wheel
+   reverses, its complemented duty goes to OCxRS at once and the pin is set
+   by Timer4's interrupt at the next period start, the two switch together
+   to within the interrupt latency. The interrupt is only enabled while
+   there is a change to make, not every period. A change made while one is
+   pending leaves the flag alone: a period start may already have raised
+   it for the first change, which is still waiting on its pin.
+   A new frequency is also made at a period start: just past the match
+   TMR4 is a few counts, under any PR4 the driver sets, so PR4 changes
+   without a long period. The duty the output compares loaded at that
+   period start is still in counts of the old period, the next one is
+   rescaled.
+
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "MotorPWM.h"
+#include <sys/attribs.h>
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PWM_TIMER_HZ 50000000u // Timer4 at 1:1 from PBCLK3
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t PeriodFor(uint32_t Hz);
+static uint16_t CountsFor(int16_t Drive, uint16_t Period);
+static void TakeNextPeriodStart(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+// the drives T1Handler set, kept to rescale them to a new period
+static int16_t Drives[2];
+// the direction pins as they are to be from the next period start
+static bool Backward[2];
+// PR4 from the next period start, 0 for no change
+static volatile uint16_t NextPeriod;
+// Timer4's interrupt is enabled for a change not yet made, T4IE as this
+// driver last set it
+static volatile bool ChangePending;
+static uint32_t Frequency;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     MotorPWM_Init
+
+ Parameters
+     uint32_t Hz: the PWM frequency, MOTOR_PWM_MIN_HZ to MOTOR_PWM_MAX_HZ
+
+ Returns
+     None
+
+ Description
+     Sets up the pins, Timer4 and both output compares and starts the PWM
+     with both wheels at 0 drive, forward. Leaves Timer4's interrupt
+     disabled, MotorSM turns on multi-vector mode and the interrupts
+****************************************************************************/
+void MotorPWM_Init(uint32_t Hz)
+{
+    if (Hz < MOTOR_PWM_MIN_HZ) {
+        Hz = MOTOR_PWM_MIN_HZ;
+    } else if (Hz > MOTOR_PWM_MAX_HZ) {
+        Hz = MOTOR_PWM_MAX_HZ;
+    }
+    Frequency = Hz;
+    NextPeriod = 0;
+    ChangePending = false;
+
+    // Set Motor Driving/Direction pins to outputs
+    TRISFCLR = _TRISF_TRISF2_MASK | _TRISF_TRISF8_MASK;
+    TRISDCLR = _TRISD_TRISD5_MASK;
+    TRISJCLR = _TRISJ_TRISJ3_MASK;
+
+    RPF2R = 0b1100; // Set RF2 -> OC1
+    RPD5R = 0b1011; // Set RD5 -> OC2
+
+    LATFbits.LATF8 = 0; // Start direction pins low
+    LATJbits.LATJ3 = 0; // Start direction pins low
+    Backward[MotorPWMLeft] = false;
+    Backward[MotorPWMRight] = false;
+    Drives[MotorPWMLeft] = 0;
+    Drives[MotorPWMRight] = 0;
+
+    // Timer 4 (for Output Compare)
+    T4CON = 0; // Reset the timer 4 register settings
+    T4CONbits.TCKPS = 0b000; // 1:1 prescale value, 50 MHz
+    T4CONbits.T32 = 0; // Use separate 16 bit timers
+    T4CONbits.TCS = 0; // Use internal peripheral clock (PBCLK3, 50 MHz)
+    PR4 = PeriodFor(Hz);
+    TMR4 = 0; // Set TMR4 to 0
+
+    // Setup Output compare
+    OC1CON = 0; // Reset OC1CON register settings
+    OC2CON = 0; // Reset OC2CON register settings
+    OC1CONbits.OC32 = 0; // Use 16-bit timer source
+    OC2CONbits.OC32 = 0; // Use 16-bit timer source
+    CFGCONbits.OCACLK = 1; // OC1-OC3 take Timer4/5 in place of Timer2/3
+    OC1CONbits.OCTSEL = 0; // Use timerx (timer4)
+    OC2CONbits.OCTSEL = 0; // Use timerx (timer4)
+    OC1CONbits.OCM = 0b110; // PWM with fault pin disabled
+    OC2CONbits.OCM = 0b110; // PWM with fault pin disabled
+
+    // Set the OC register to 0 to initialize
+    OC1R = 0;
+    OC1RS = 0;
+    OC2R = 0;
+    OC2RS = 0;
+
+    // the period start interrupt, enabled when there is a change to make
+    IPC4bits.T4IP = 7; // T4
+    IPC4bits.T4IS = 2; // T4 Sub-priority
+    IFS0CLR = _IFS0_T4IF_MASK;
+    IEC0CLR = _IEC0_T4IE_MASK;
+
+    OC1CONbits.ON = 1; // Turn OC1 on
+    OC2CONbits.ON = 1; // Turn OC2 on
+    T4CONbits.ON = 1; // Turn timer 4 on
+}
+
+/****************************************************************************
+ Function
+     MotorPWM_SetFrequency
+
+ Parameters
+     uint32_t Hz: the new PWM frequency
+
+ Returns
+     bool, false if Hz is outside MOTOR_PWM_MIN_HZ to MOTOR_PWM_MAX_HZ
+
+ Description
+     Changes the PWM frequency from the next period start, keeping both
+     drives. Can be called from any level: below Timer4's, a period start
+     with a change pending from T1Handler is taken as it comes
+****************************************************************************/
+bool MotorPWM_SetFrequency(uint32_t Hz)
+{
+    if ((Hz < MOTOR_PWM_MIN_HZ) || (Hz > MOTOR_PWM_MAX_HZ)) {
+        return false;
+    }
+    Frequency = Hz;
+    NextPeriod = PeriodFor(Hz);
+    TakeNextPeriodStart();
+    return true;
+}
+
+/****************************************************************************
+ Function
+     MotorPWM_GetFrequency
+
+ Parameters
+     None
+
+ Returns
+     uint32_t the PWM frequency last set, Hz
+
+ Description
+     The frequency asked for, the period is the nearest whole number of
+     timer counts to it
+****************************************************************************/
+uint32_t MotorPWM_GetFrequency(void)
+{
+    return Frequency;
+}
+
+/****************************************************************************
+ Function
+     MotorPWM_SetDrive
+
+ Parameters
+     MotorPWMWheel_t Which: the wheel
+     int16_t Drive: -MOTOR_PWM_FULL (full backward) to MOTOR_PWM_FULL (full
+         forward), Q15
+
+ Returns
+     None
+
+ Description
+     Sets the wheel's duty from the next period start, and its direction pin
+     at that period start if it changes. Called from T1Handler, anything
+     else has to hold it off
+****************************************************************************/
+void MotorPWM_SetDrive(MotorPWMWheel_t Which, int16_t Drive)
+{
+    uint16_t Counts = CountsFor(Drive, (uint16_t)PR4);
+
+    Drives[Which] = Drive;
+    if (Which == MotorPWMLeft) {
+        OC2RS = Counts;
+    } else {
+        OC1RS = Counts;
+    }
+    if ((Drive < 0) != Backward[Which]) {
+        Backward[Which] = (Drive < 0);
+        TakeNextPeriodStart();
+    }
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// PR4 for a frequency, to the nearest count
+static uint16_t PeriodFor(uint32_t Hz)
+{
+    return (uint16_t)((PWM_TIMER_HZ + Hz / 2) / Hz - 1);
+}
+
+// OCxRS for a drive, rounded. MOTOR_PWM_FULL is a whole period, and so
+// always on
+static uint16_t CountsFor(int16_t Drive, uint16_t Period)
+{
+    uint32_t Magnitude = (Drive < 0) ? -(int32_t)Drive : Drive;
+    uint32_t Counts;
+
+    if (Magnitude > MOTOR_PWM_FULL) {
+        Magnitude = MOTOR_PWM_FULL;
+    }
+    Counts = (Magnitude * ((uint32_t)Period + 1) + (1u << 14)) >> 15;
+    if (Drive < 0) {
+        // backward is driven in the low part of the period
+        Counts = (uint32_t)Period + 1 - Counts;
+    }
+    return (uint16_t)Counts;
+}
+
+// takes Timer4's interrupt at the next period start. With no change
+// pending the flag is up from every period before, and left up the handler
+// would run at once, mid period. With one pending it stays, it may be the
+// period start that change is waiting for
+static void TakeNextPeriodStart(void)
+{
+    if (!ChangePending) {
+        ChangePending = true;
+        IFS0CLR = _IFS0_T4IF_MASK;
+        IEC0SET = _IEC0_T4IE_MASK;
+    }
+}
+
+////////////////////// Interrupt Service Routines //////////////////////
+
+/****************************************************************************
+ Function
+    T4Handler
+
+ Description
+   Runs at the start of a PWM period when there is a change to make: sets
+   the direction pins to go with the duty the output compares just loaded,
+   and a new period
+****************************************************************************/
+void __ISR(_TIMER_4_VECTOR, IPL7SRS) T4Handler(void)
+{
+    IFS0CLR = _IFS0_T4IF_MASK; // Clear the interrupt
+    IEC0CLR = _IEC0_T4IE_MASK; // Until there is another change
+    ChangePending = false;
+
+    LATJbits.LATJ3 = Backward[MotorPWMLeft];
+    LATFbits.LATF8 = Backward[MotorPWMRight];
+
+    if (NextPeriod != 0) {
+        PR4 = NextPeriod;
+        NextPeriod = 0;
+        OC2RS = CountsFor(Drives[MotorPWMLeft], (uint16_t)PR4);
+        OC1RS = CountsFor(Drives[MotorPWMRight], (uint16_t)PR4);
+    }
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -23,42 +23,49 @@
 #include "dbprintf.h"
 #include <sys/attribs.h>
 #include <math.h>
-#include "matt_circular_buffer.h"
+#include "ES_Ring.h"
+#include "ES_Snapshot.h"
+#include "MotorControl.h"
+#include "WheelSpeed.h"
+#include "MotorPWM.h"
+#include "RLCapture.h"
 #include "IMU_SM.h"
+#include "FastMath.h"
 
 /*----------------------------- Module Defines ----------------------------*/
-#define IC_PERIOD 65535 // Input capture period
-#define OC_PERIOD 312   // Output compare period (10 kHz)
-#define NO_SPEED_PERIOD 65535 // Period to indicate motor not spinning
+#define IC_PERIOD 0xFFFFFFFF // Input capture period, the full 32 bits
 #define DEAD_RECKONING_PERIOD 3906// 1953 // 3906 // 7812 // Chosen so that we update at 50 Hz rate
-#define Kp 5 // Proportional constant for PID law
-#define Ki 0.8 // Integral constant for PID law
-#define Kd 3 // Derivative constant for PID law
 
 #if (MOTOR_TYPE==1)
-#define ENCODER_RESOLUTION 374 // Number of pulses per revolution
 #define CONTROL_PERIOD 1000 // 1000 // Control update period --- 6250 Hz
 #elif (MOTOR_TYPE==2)
-//#define ENCODER_RESOLUTION 1440 // Number of pulses per revolution
-#define ENCODER_RESOLUTION 360
 #define CONTROL_PERIOD 10000 // 1000 // Control update period --- 6250 Hz
 #endif
 
 #define GEAR_RATIO 34 // Gear reduction ratio
-#define SPEED_CONVERSION_FACTOR (1.6e7*60)/ENCODER_RESOLUTION
-#define WHEEL_RADIUS 0.04 // Radius of wheels (m))
-#define DEAD_RECKONING_TIME 0.00999936 //0.00499968 //0.00999936 //0.01999872 // Time between dead reckoning updates in seconds (depends on DEAD_RECKONING_PERIOD)
-#define DEAD_RECKONING_RATIO 2*3.14159 / ENCODER_RESOLUTION / DEAD_RECKONING_TIME * WHEEL_RADIUS // This number times change in encoder clicks is linear velocity in m/second
+#define DEAD_RECKONING_TIME 0.02000384f // Time between dead reckoning updates in seconds, (DEAD_RECKONING_PERIOD + 1) * 256 / 50 MHz
+#define DEAD_RECKONING_RATIO ((float)(WHEEL_SPEED_METERS_PER_EDGE / (double)DEAD_RECKONING_TIME)) // This number times change in encoder clicks is mean linear velocity in m/second
+
+// The geometry and constants in float, the handlers do no double math
+#define WHEEL_RADIUS_F ((float)WHEEL_RADIUS)
+#define INV_WHEEL_BASE ((float)(1 / WHEEL_BASE))
+#define PI_F ((float)M_PI)
+#define DEG_TO_RAD 0.0174533f
 
 #define V_MAX 1 // max 1 m/sec
 #define w_MAX 2 // max 2 rad/sec
 
-#define BUFF_SIZE 65
+#define BUFF_SIZE 65   // the last 13 control steps of state history
+#define STEP_SIZE 5    // values stored per control step
+#define RL_DRAIN_TIME 10 // ms, the terminal sends about 115 bytes in it
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
 */
+#ifdef RL_MOTOR_LOGGING
 static void Store_RL_Data(void);
+#endif
+static void PublishOdometry(uint32_t Time);
 
 /*---------------------------- Module Variables ---------------------------*/
 // everybody needs a state variable, you may need others as well.
@@ -66,24 +73,25 @@ static void Store_RL_Data(void);
 static MotorState_t CurrentState;
 
 // Everything we need for measuring motor speed
-static volatile MotorTimer_t MyTimer;
-static volatile uint32_t LeftPulseLength = 4294967295; 
-static volatile uint32_t RightPulseLength = 4294967295; 
-static volatile uint32_t LeftPrevTime = 0; 
-static volatile uint32_t RightPrevTime = 0; 
-
-// Used for dead reckoning to determine current position
-static volatile int32_t LeftRotations = 0;
-static volatile int32_t RightRotations = 0;
+// written by the encoder edge handlers, see WheelSpeed.c
+static WheelSpeed_t LeftSpeed;
+static WheelSpeed_t RightSpeed;
+
+// Used for dead reckoning to determine current position. T7Handler's own,
+// anything else holds it off or reads OdometrySnapshot
 static volatile int32_t LeftPrevRotations = 0;
 static volatile int32_t RightPrevRotations = 0;
-static volatile float x = 0; // x position of the robot
-static volatile float y = 0; // y position of the robot
-static volatile float theta = 0; // angular position of the robot
+static float x = 0; // x position of the robot
+static float y = 0; // y position of the robot
+static float theta = 0; // angular position of the robot
 
 // History variables to keep track of current V and w
-static volatile float V_current = 0.;
-static volatile float w_current = 0.;
+static float V_current = 0.;
+static float w_current = 0.;
+
+// the dead reckoning state as of the last update, for any level to read
+// whole while T7Handler goes on with the next one
+ES_SNAPSHOT_DEFINE(OdometrySnapshot, Odometry_t);
 
 static uint16_t DesiredLeftRPM;
 static uint16_t DesiredRightRPM;
@@ -94,16 +102,23 @@ static Direction_t RightDirection = Forward;
 static float V_desired = 0.;
 static float w_desired = 0.;
 
-static uint16_t RL_Data_Index = 0;
-static int16_t RL_Data[1000][32];
-static uint16_t RL_Data_Printing_Index = 0;
-
-static uint16_t circ_buff_size = BUFF_SIZE;
-static int16_t circ_buff_array[BUFF_SIZE];
-static circular_buffer_t cb;  // Buffer for keeping State data
+// State data, T1Handler keeps the newest BUFF_SIZE values
+ES_RING_DEFINE(StateRing, int16_t, 128);
 
-static int16_t recording_array[200];
-static circular_buffer_t cb_record;  // Buffer for keeping track of when to move data into RL_Data
+#ifdef RL_MOTOR_LOGGING
+// the control steps after a new set point that are recorded for RL, see
+// RLCapture_Schedule
+static const RLCaptureRun_t StepResponseRuns[] = {
+    {9, 100, 1},     // every step, first 0.16 s
+    {125, 600, 25},  // 0.2 s to 1 s
+    {625, 625, 1},   // 1 s to 1.5 s
+    {688, 688, 1},
+    {750, 750, 1},
+    {812, 812, 1},
+    {875, 875, 1},
+    {937, 937, 1}
+};
+#endif
 
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
@@ -127,20 +142,14 @@ bool InitMotorSM(uint8_t Priority)
 {
   ES_Event_t ThisEvent;
   
-  // Initialize the circular buffer
-  circular_buffer_init(&cb, circ_buff_array, circ_buff_size);
-  circular_buffer_init(&cb_record, recording_array, 200);
-  
-  // Set Motor Driving/Direction pins to outputs
-  TRISFCLR = _TRISF_TRISF2_MASK | _TRISF_TRISF8_MASK;
-  TRISDCLR = _TRISD_TRISD5_MASK;
-  TRISJCLR = _TRISJ_TRISJ3_MASK;
-  
-  RPF2R = 0b1100; // Set RF2 -> OC1
-  RPD5R = 0b1011; // Set RD5 -> OC2
+  // Initialize the ring buffers
+  ES_RingInitStatic(StateRing);
+#ifdef RL_MOTOR_LOGGING
+  RLCapture_Init();
+#endif
   
-  LATFbits.LATF8 = 0; // Start direction pins low
-  LATJbits.LATJ3 = 0; // Start direction pins low
+  // The motor drive pins, Timer 4 and Output Compare, see MotorPWM.c
+  MotorPWM_Init(MOTOR_PWM_HZ);
   
   // Set encoder pins and fault pins to digital inputs
   ANSELCCLR = _ANSELC_ANSC1_MASK | _ANSELC_ANSC4_MASK;
@@ -152,6 +161,22 @@ bool InitMotorSM(uint8_t Priority)
   
   IC1R = 0b0011; // Set IC1 -> RD0
   IC3R = 0b1010; // Set IC3 -> RC1
+  IC4R = 0b1010; // Set IC4 -> RC4
+  // RH8 (right channel B) is not a remappable pin, no input capture can
+  // see it, so its edges come in through change notice on port H instead
+  CNCONH = _CNCONH_ON_MASK | _CNCONH_EDGEDETECT_MASK;
+  CNENHSET = _CNENH_CNIEH8_MASK; // Rising edges
+  CNNEHSET = _CNNEH_CNNEH8_MASK; // Falling edges
+  CNFHCLR = _CNFH_CNFH8_MASK;
+  
+  // The decoders start from the levels the encoders are sitting at, the
+  // right encoder counts down going forward
+  WheelSpeed_Init(&LeftSpeed, 1,
+          (PORTCbits.RC1 ? WHEEL_SPEED_CHANNEL_A : 0) |
+          (PORTCbits.RC4 ? WHEEL_SPEED_CHANNEL_B : 0), WHEEL_SPEED_WINDOW);
+  WheelSpeed_Init(&RightSpeed, -1,
+          (PORTDbits.RD0 ? WHEEL_SPEED_CHANNEL_A : 0) |
+          (PORTHbits.RH8 ? WHEEL_SPEED_CHANNEL_B : 0), WHEEL_SPEED_WINDOW);
   
   // Set motor current pins to be analog inputs
   ANSELJSET = _ANSELJ_ANSJ9_MASK;
@@ -171,73 +196,38 @@ bool InitMotorSM(uint8_t Priority)
   PR1 = CONTROL_PERIOD; // The amount of time we should do a control update (1000=6250 Hz, 500=12500 Hz)
   TMR1 = 0; // Set TMR1 to 0
   
-  // Timer 2 (for Output Compare)
+  // Timer 2/3 (For Input Capture), one free running 32 bit timer, so every
+  // capture is the full time stamp and nothing counts rollovers. It wraps
+  // after 687 s, WheelSpeed.c works in differences modulo 2^32
   T2CON = 0; // Reset the timer 2 register settings
-  T2CONbits.TCKPS = 0b100; // 1:16 prescale value, 3.125 MHz
-  T2CONbits.T32 = 0; // Use separate 16 bit timers
+  T3CON = 0; // Reset the timer 3 register settings
+  T2CONbits.TCKPS = 0b011; // 1:8 prescale value, 6.25 MHz
+  T2CONbits.T32 = 1; // Timer 2 and 3 as one 32 bit timer, run from T2CON
   T2CONbits.TCS = 0; // Use internal peripheral clock (PBCLK3, 50 MHz)
-  PR2 = OC_PERIOD; // Use output compare period (800 = 3906 Hz, 500=6250 Hz, 200=15625 Hz)
+  PR2 = IC_PERIOD; // Use input capture period, just use full time
   TMR2 = 0; // Set TMR2 to 0
   
-  // Timer 3 (For Input Capture)
-  T3CON = 0; // Reset the timer 2 register settings
-  T3CONbits.TCKPS = 0b011; // 1:8 prescale value, 6.25 MHz
-  T3CONbits.TCS = 0; // Use internal peripheral clock (PBCLK3, 50 MHz)
-  PR3 = IC_PERIOD; // Use input capture period, just use full time
-  TMR3 = 0; // Set TMR3 to 0
-  
-  // Timer 4 (For Left Motor No Speed)
-  T4CON = 0;
-  T4CONbits.TCKPS = 0b111; // 1:256 prescale value, 195.3125  kHz
-  T4CONbits.T32 = 0; // Use separate 16 bit timers
-  T4CONbits.TCS = 0; // Use internal peripheral clock (PBCLK3, 50 MHz)
-  PR4 = NO_SPEED_PERIOD; // Use no speed period
-  TMR4 = 0; // Set TMR4 to 0
-  
-  // Timer 5 (For Right Motor No Speed)
-  T5CON = 0;
-  T5CONbits.TCKPS = 0b111; // 1:256 prescale value, 195.3125  kHz
-  T5CONbits.TCS = 0; // Use internal peripheral clock (PBCLK3, 50 MHz)
-  PR5 = NO_SPEED_PERIOD; // Use no speed period, ~3 Hz @ 65535
-  TMR5 = 0; // Set TMR5 to 0
-  
   T7CON = 0;
   T7CONbits.TCKPS = 0b111; // 1:256 prescale value, 195.3125  kHz
   T7CONbits.TCS = 0; // Use internal peripheral clock (PBCLK3, 50 MHz)
   PR7 = DEAD_RECKONING_PERIOD;
   TMR7 = 0;
   
-  // Setup Output compare
-  OC1CON = 0; // Reset OC1CON register settings
-  OC2CON = 0; // Reset OC2CON register settings
-  OC1CONbits.OC32 = 0; // Use 16-bit timer source
-  OC2CONbits.OC32 = 0; // Use 16-bit timer source
-  OC1CONbits.OCTSEL = 0; // Use timerx (timer2)
-  OC2CONbits.OCTSEL = 0; // Use timerx (timer2)
-  OC1CONbits.OCM = 0b110; // PWM with fault pin disabled
-  OC2CONbits.OCM = 0b110; // PWM with fault pin disabled 
-  
-  // Set the OC register to 0 to initialize
-  OC1R = 0;
-  OC1RS = 0;
-  OC2R = 0;
-  OC2RS = 0;
-  
   // Setup Input capture
   IC1CON = 0; // Reset IC1CON register settings 
   IC3CON = 0; // Reset IC3CON register settings 
-  IC1CONbits.ICTMR = 0; // User timery (timer3)
-  IC3CONbits.ICTMR = 0; // User timery (timer3)
+  IC4CON = 0; // Reset IC4CON register settings 
+  IC1CONbits.C32 = 1; // Capture the 32 bit timer (timer2/3)
+  IC3CONbits.C32 = 1; // Capture the 32 bit timer (timer2/3)
+  IC4CONbits.C32 = 1; // Capture the 32 bit timer (timer2/3)
   IC1CONbits.ICI = 0b00; // Interrupt on every capture event
   IC3CONbits.ICI = 0b00; // Interrupt on every capture event
-    
-#if (MOTOR_TYPE==1)
-  IC1CONbits.ICM = 0b011; // Every rising edge mode
-  IC3CONbits.ICM = 0b011; // Every rising edge mode
-#elif (MOTOR_TYPE==2)
-  IC1CONbits.ICM = 0b100; // Every 4th rising edge mode
-  IC3CONbits.ICM = 0b100; // Every 4th rising edge mode
-#endif
+  IC4CONbits.ICI = 0b00; // Interrupt on every capture event
+  
+  // Every edge of both channels is decoded (4x), for both motor types
+  IC1CONbits.ICM = 0b001; // Every edge mode
+  IC3CONbits.ICM = 0b001; // Every edge mode
+  IC4CONbits.ICM = 0b001; // Every edge mode
   
   // Setup Interrupts
   INTCONbits.MVEC = 1; // Use multivector mode
@@ -249,38 +239,36 @@ bool InitMotorSM(uint8_t Priority)
   IPC1bits.IC1IS = 3; // IC1 Sub-priority
   IPC4bits.IC3IP = 7; // IC3
   IPC4bits.IC3IS = 3; // IC3 Sub-priority
+  IPC5bits.IC4IP = 7; // IC4
+  IPC5bits.IC4IS = 3; // IC4 Sub-priority
+  IPC31bits.CNHIP = 7; // Change notice port H
+  IPC31bits.CNHIS = 3; // Change notice port H Sub-priority
   IPC1bits.T1IP = 7; // T1
   IPC1bits.T1IS = 1; // T1 Sub-priority
-  IPC3bits.T3IP = 7; // T3
-  IPC3bits.T3IS = 2; // T3 Sub-priority
-  IPC4bits.T4IP = 6; // T4
-  IPC6bits.T5IP = 6; // T5
   IPC8bits.T7IP = 6; // T7
   
   // Clear interrupt flags
-  IFS0CLR = _IFS0_IC1IF_MASK | _IFS0_IC3IF_MASK | _IFS0_T1IF_MASK | 
-          _IFS0_T3IF_MASK | _IFS0_T4IF_MASK | _IFS0_T5IF_MASK; 
+  IFS0CLR = _IFS0_IC1IF_MASK | _IFS0_IC3IF_MASK | _IFS0_IC4IF_MASK |
+          _IFS0_T1IF_MASK;
   
   IFS1CLR = _IFS1_T7IF_MASK;
+  IFS3CLR = _IFS3_CNHIF_MASK;
   
   // Local enable interrupts
-  IEC0SET = _IEC0_IC1IE_MASK | _IEC0_IC3IE_MASK | _IEC0_T1IE_MASK | 
-          _IEC0_T3IE_MASK | _IEC0_T4IE_MASK | _IEC0_T5IE_MASK; 
+  IEC0SET = _IEC0_IC1IE_MASK | _IEC0_IC3IE_MASK | _IEC0_IC4IE_MASK |
+          _IEC0_T1IE_MASK;
   
   IEC1SET = _IEC1_T7IE_MASK;
+  IEC3SET = _IEC3_CNHIE_MASK;
   
   __builtin_enable_interrupts(); // Global enable interrupts
   
   // Turn Everything On
   IC1CONbits.ON = 1; // Turn input capture on
   IC3CONbits.ON = 1; // Turn input capture on
-  OC1CONbits.ON = 1; // Turn OC1 on
-  OC2CONbits.ON = 1; // Turn OC2 on
+  IC4CONbits.ON = 1; // Turn input capture on
   T1CONbits.ON = 0; // Timer 1 does not need to be on yet
-  T2CONbits.ON = 1; // Turn timer 2 on
-  T3CONbits.ON = 1; // Turn timer 3 on
-  T4CONbits.ON = 1; // Turn timer 4 on
-  T5CONbits.ON = 1; // Turn timer 5 on
+  T2CONbits.ON = 1; // Turn timer 2/3 on
   T7CONbits.ON = 1; // Turn timer 7 on
   
   MyPriority = Priority;
@@ -340,11 +328,8 @@ ES_Event_t RunMotorSM(ES_Event_t ThisEvent)
     {
       if (ThisEvent.EventType == ES_INIT) 
       {
-        LeftRotations = 0;
-        RightRotations = 0;
-        
-        LeftPrevRotations = 0;
-        RightPrevRotations = 0;
+        LeftPrevRotations = LeftSpeed.Count;
+        RightPrevRotations = RightSpeed.Count;
           
         // now put the machine into the actual initial state
         CurrentState = MotorWait;
@@ -368,8 +353,8 @@ ES_Event_t RunMotorSM(ES_Event_t ThisEvent)
         case ES_TIMEOUT:
         {
             if (ThisEvent.EventParam == MOTOR_TIMER) {
-//            uint16_t left_rpm = SPEED_CONVERSION_FACTOR / LeftPulseLength;
-//            uint16_t right_rpm = SPEED_CONVERSION_FACTOR / RightPulseLength;
+//            uint16_t left_rpm = SPEED_CONVERSION_FACTOR / WheelSpeed_GetPulseLength(&LeftSpeed, TMR2);
+//            uint16_t right_rpm = SPEED_CONVERSION_FACTOR / WheelSpeed_GetPulseLength(&RightSpeed, TMR2);
 //            DB_printf("\r\n \r\n \r\n \r\n");
 //            DB_printf("RPM: %d, %d (%d, %d) \r\n", left_rpm, right_rpm, DesiredLeftRPM, DesiredRightRPM);
 //            DB_printf("Vel: %d (desired = %d)\r\n", (uint16_t)(V_current*100), (uint16_t)(V_desired*100));
@@ -377,48 +362,43 @@ ES_Event_t RunMotorSM(ES_Event_t ThisEvent)
 //            DB_printf("x: %d\r\n", (uint16_t)(x*100));
 //            DB_printf("y: %d\r\n", (uint16_t)(y*100));
 //            DB_printf("theta: %d\r\n", (uint16_t)(theta*100));
-//            DB_printf("LR: %d\r\n", LeftRotations);
-//            DB_printf("RR: %d\r\n", RightRotations);
+//            DB_printf("LR: %d\r\n", LeftSpeed.Count);
+//            DB_printf("RR: %d\r\n", RightSpeed.Count);
             
                 ES_Timer_InitTimer(MOTOR_TIMER, 2000);
-            } else if (ThisEvent.EventParam == RL_TIMER) {
-                // Print 2-1000 entries of RL DATA...
-//                DB_printf("%d.......\r\n", RL_Data_Printing_Index+1);
-                for (uint8_t i=0; i<31; i++) {
-                    DB_printf("%d,", RL_Data[RL_Data_Printing_Index][i]);
-                    while (!U1STAbits.TRMT) {
-                        // Block while writing...
-                    }
-                }
-                DB_printf("%d\r\n", RL_Data[RL_Data_Printing_Index][31]);
-
-                RL_Data_Printing_Index += 1;
-                
-                if (RL_Data_Printing_Index != RL_Data_Index) {
-                    ES_Timer_InitTimer(RL_TIMER, 15);
+            }
+#ifdef RL_MOTOR_LOGGING
+            else if (ThisEvent.EventParam == RL_TIMER) {
+                // Send the RL records T1Handler has captured, as many as the
+                // terminal has room for, until the capture is off and they
+                // are all out
+                if (RLCapture_MoveToTerminal() || RLCapture_IsOn()) {
+                    ES_Timer_InitTimer(RL_TIMER, RL_DRAIN_TIME);
                 } else {
-                    RL_Data_Index = 0;
-                    
                     ES_Event_t NewEvent = {EV_LED_OFF, 4};
                     PostLEDService(NewEvent);
                 }
             }
+#endif
         }
         break;
         
+#ifdef RL_MOTOR_LOGGING
         case EV_PRINT_RL_DATA:
         {
-            // Print first entry of RL Data
-//            DB_printf("1.......\r\n");
-            for (uint8_t i=0; i<31; i++) {
-                DB_printf("%d,", RL_Data[0][i]);
+            // Turns the RL capture on or off, LED 4 is on while it runs and
+            // until the last record is out, see RLCapture.c
+            if (RLCapture_IsOn()) {
+                RLCapture_Stop();
+            } else {
+                ES_Event_t NewEvent = {EV_LED_ON, 4};
+                PostLEDService(NewEvent);
+                RLCapture_Start();
+                ES_Timer_InitTimer(RL_TIMER, RL_DRAIN_TIME);
             }
-            DB_printf("%d\r\n", RL_Data[0][31]);
-            
-            RL_Data_Printing_Index = 1;
-            ES_Timer_InitTimer(RL_TIMER, 10);
         }
         break;
+#endif
         
         default:
           ;
@@ -462,13 +442,44 @@ MotorState_t QueryMotorSM(void)
      None
 
  Description
-     Sets the desired RPM for the two motors. Assumes the direction pins are 
+     Sets the desired RPM for the two motors. Assumes the wheel directions are
      already correctly set to have wheels moving in correct direction
+ Notes
+     JetsonSM and the terminal keys both drive the motors, with
+     ES_PREEMPTIVE from different levels, so the set speed functions update
+     under a ceiling of JETSON_LEVEL
 ****************************************************************************/
 void SetDesiredRPM(uint16_t LeftRPM, uint16_t RightRPM)
 {    
+  ES_Ceiling_t Saved = ES_EnterCeiling(JETSON_LEVEL);
+
   DesiredLeftRPM = LeftRPM;
   DesiredRightRPM = RightRPM;
+  ES_ExitCeiling(Saved);
+}
+
+/****************************************************************************
+ Function
+     QueryDesiredRPM
+
+ Parameters
+     uint16_t *pLeftRPM: where to put the left wheel's set point
+     uint16_t *pRightRPM: where to put the right wheel's set point
+
+ Returns
+     None
+
+ Description
+     Reads back the set points T1Handler is controlling to, the speeds
+     without the direction pins
+****************************************************************************/
+void QueryDesiredRPM(uint16_t *pLeftRPM, uint16_t *pRightRPM)
+{
+  ES_Ceiling_t Saved = ES_EnterCeiling(JETSON_LEVEL);
+
+  *pLeftRPM = DesiredLeftRPM;
+  *pRightRPM = DesiredRightRPM;
+  ES_ExitCeiling(Saved);
 }
 
 /****************************************************************************
@@ -487,21 +498,16 @@ void SetDesiredRPM(uint16_t LeftRPM, uint16_t RightRPM)
 ****************************************************************************/
 void SetDesiredSpeed(float V, float w)
 {
+  ES_Ceiling_t Saved = ES_EnterCeiling(JETSON_LEVEL);
+
 #ifdef RL_MOTOR_LOGGING
     if (V != V_desired && (V != 0 || w != 0)) {
-      circular_buffer_reset(&cb_record);
-      for (uint8_t i=9; i<=100; i++) { // First 0.16 sec
-          circular_buffer_put(&cb_record, i);
-      }
-      for (uint16_t i=125; i<625; i+=25) {
-          circular_buffer_put(&cb_record, i);
-      }
-      circular_buffer_put(&cb_record, 625); // 1 s
-      circular_buffer_put(&cb_record, 688); // 1.1 s
-      circular_buffer_put(&cb_record, 750); // 1.2 s
-      circular_buffer_put(&cb_record, 812); // 1.3 s
-      circular_buffer_put(&cb_record, 875); // 1.4 s
-      circular_buffer_put(&cb_record, 937); // 1.5 s
+      // T1Handler reads the schedule, hold it off while it is replaced
+      uint32_t T1Enabled = IEC0 & _IEC0_T1IE_MASK;
+
+      IEC0CLR = _IEC0_T1IE_MASK;
+      RLCapture_Schedule(StepResponseRuns, ARRAY_SIZE(StepResponseRuns));
+      IEC0SET = T1Enabled;
     }
 #endif
     
@@ -511,6 +517,7 @@ void SetDesiredSpeed(float V, float w)
     // We turn off control for stopped to prevent jittering
     if (V==0 && w == 0) {
         SetDesiredRPM(0,0); // This will cause T1 to be turned off in the ISR
+        ES_ExitCeiling(Saved);
         return;
     } else {
         T1CONSET = _T1CON_ON_MASK;
@@ -531,41 +538,63 @@ void SetDesiredSpeed(float V, float w)
     
     // Calculate the angular velocity of the left/right wheel to achieve 
     // desired linear/angular velocity of the robot
-    float v_r = V / WHEEL_RADIUS;
-    float w_r = WHEEL_BASE * w / 2 / WHEEL_RADIUS;
+    float v_r = V / WHEEL_RADIUS_F;
+    float w_r = (float)WHEEL_BASE * w / 2 / WHEEL_RADIUS_F;
     float left_w = v_r - w_r; // (rad/sec)
     float right_w = v_r + w_r; // (rad/sec)
     
-    // Convert to revolutions per minute
-    left_w = left_w * 60 / 2 / 3.14159; // (rev/min)
-    right_w = right_w * 60 / 2 / 3.14159; // (rev/min)
+    // Convert to revolutions per minute. These go to the speed loop as
+    // they are, in its RPM, which is 2.56 wheel RPM (SPEED_LOOP_TIMER_HZ in
+    // MotorControl.h), so the wheels turn at 1/2.56 of this. Left as it
+    // was, the Jetson's commands and the gains are tuned to it
+    left_w = left_w * 60 / 2 / 3.14159f; // (rev/min)
+    right_w = right_w * 60 / 2 / 3.14159f; // (rev/min)
     
-    // Set the direction pins to the motor driver to get correct forward or 
-    // backward motion
+    // The direction of each wheel, T1Handler gives it to the PWM driver,
+    // which switches the direction pin at a PWM period start
     if (left_w  >= 0) {
-        LATJbits.LATJ3 = 0; // Set direction pin forward
         LeftDirection = Forward;
     } else {
-        LATJbits.LATJ3 = 1; // Set direction pin to backward
         LeftDirection = Backward;
         left_w = -left_w;
     }
     
     if (right_w >= 0) {
-        LATFbits.LATF8 = 0; // Set direction pin forward
         RightDirection = Forward;
     } else {
-        LATFbits.LATF8 = 1; // Set direction pin to backward
         RightDirection = Backward;
         right_w = - right_w;
     }
     
     // Last set the desired RPM variables
     SetDesiredRPM(left_w, right_w);
+    ES_ExitCeiling(Saved);
 }
 
 void MultiplyDesiredSpeed(float Factor) {
+    // the read of the old speed has to go with the write of the new one
+    ES_Ceiling_t Saved = ES_EnterCeiling(JETSON_LEVEL);
+
     SetDesiredSpeed(Factor*V_desired, Factor*w_desired);    
+    ES_ExitCeiling(Saved);
+}
+
+/****************************************************************************
+ Function
+     QueryOdometry
+
+ Parameters
+     Odometry_t *pOdometry: where to copy the dead reckoning state
+
+ Returns
+     uint32_t the number of updates so far, it changes when there is a new one
+
+ Description
+     Copies the position and velocity, all from the same update, without
+     holding off T7Handler. Can be called from any level
+****************************************************************************/
+uint32_t QueryOdometry(Odometry_t *pOdometry) {
+    return ES_SnapshotRead(&OdometrySnapshot, pOdometry);
 }
 
 /****************************************************************************
@@ -582,6 +611,10 @@ void MultiplyDesiredSpeed(float Factor) {
      Writes the current position data to the specified SPI buffer
 ****************************************************************************/
 void WritePositionToSPI(uint8_t *Message2Send) {
+  Odometry_t Odometry;
+  
+  // x, y and theta from the same update
+  QueryOdometry(&Odometry);
   
   Message2Send[0] = 8; // 8 indicates we are position data (byte 1)
     
@@ -589,19 +622,19 @@ void WritePositionToSPI(uint8_t *Message2Send) {
   // 8 bits.
   
   // Now write the x data (bytes 2-5)
-  uint32_t x_as_int = *((uint32_t*)&x);
+  uint32_t x_as_int = *((uint32_t*)&Odometry.x);
   for (uint8_t j=0; j<4; j++) { // iterate through the 4, 8-bit chunks of the float
     Message2Send[j+1] = (x_as_int >> (24-8*j)) & 0xFF;
   }
   
   // Now write the y data (bytes 6-9)
-  uint32_t y_as_int = *((uint32_t*)&y);
+  uint32_t y_as_int = *((uint32_t*)&Odometry.y);
   for (uint8_t j=0; j<4; j++) { // iterate through the 4, 8-bit chunks of the float
     Message2Send[j+5] = (y_as_int >> (24-8*j)) & 0xFF;
   }
   
   // Now write the theta data (bytes 10-13)
-  uint32_t theta_as_int = *((uint32_t*)&theta);
+  uint32_t theta_as_int = *((uint32_t*)&Odometry.theta);
   for (uint8_t j=0; j<4; j++) { // iterate through the 4, 8-bit chunks of the float
     Message2Send[j+9] = (theta_as_int >> (24-8*j)) & 0xFF;
   }
@@ -612,19 +645,23 @@ void WritePositionToSPI(uint8_t *Message2Send) {
 }
 
 void WriteDeadReckoningVelocityToSPI(uint8_t *Message2Send) {
+    Odometry_t Odometry;
+    
+    // V and w from the same update
+    QueryOdometry(&Odometry);
     
     Message2Send[0] = 7; // 7 indcates the message type (byte 1)
     
     // the V/w data are floats. The floats can be sent as 4 chunks of 8 bits
     
     // Write V (bytes 2-5)
-    uint32_t V_as_int = *((uint32_t*)&V_current);
+    uint32_t V_as_int = *((uint32_t*)&Odometry.V);
     for (uint8_t j=0; j<4; j++) { // iterate through the 4, 8-bit chunks of the float
         Message2Send[j+1] = (V_as_int >> (24-8*j)) & 0xFF;
     }
     
     // Write w (bytes 6-9)
-    uint32_t w_as_int = *((uint32_t*)&w_current);
+    uint32_t w_as_int = *((uint32_t*)&Odometry.w);
     for (uint8_t j=0; j<4; j++) { // iterate through the 4, 8-bit chunks of the float
         Message2Send[j+5] = (w_as_int >> (24-8*j)) & 0xFF;
     }
@@ -635,19 +672,23 @@ void WriteDeadReckoningVelocityToSPI(uint8_t *Message2Send) {
 }
 
 void ResetPosition(void) {
-    x = 0;
-    y = 0;
-    theta = 0;
+    SetPosition(0, 0, 0);
 }
 
 void SetPosition(float x_set, float y_set, float theta_set) {
+    // T7Handler integrates from the pose, hold it off while it is replaced
+    uint32_t T7Enabled = IEC1 & _IEC1_T7IE_MASK;
+    
+    IEC1CLR = _IEC1_T7IE_MASK;
     x = x_set;
     y = y_set;
     theta = theta_set;
+    PublishOdometry(TMR2);
+    IEC1SET = T7Enabled;
 }
 
 void PrintBufferSize(void) {
-    DB_printf("Buffer Size: %d\r\n", circular_buffer_size(&cb));
+    DB_printf("Buffer Size: %d\r\n", ES_RingCount(&StateRing));
 }
 
 /***************************************************************************
@@ -661,42 +702,37 @@ void PrintBufferSize(void) {
     IC1Handler
 
  Description
-   Counts time between encoder pulses for measuring right motor pulse lengths
+   Decodes the edges of right encoder channel A
 ****************************************************************************/
 void __ISR(_INPUT_CAPTURE_1_VECTOR, IPL7SRS) IC1Handler(void)
 {
-    static uint8_t ChannelB = 0; // static for speed
-    
-    ChannelB = PORTHbits.RH8;
-    
-    MyTimer.TimeStruct.TimerBits = (uint16_t)IC1BUF; // grab the captured time 
     IFS0CLR = _IFS0_IC1IF_MASK; // Clear the interrupt
-    if (IFS0bits.T3IF && MyTimer.TimeStruct.TimerBits < 0x8000) {            
-        MyTimer.TimeStruct.RolloverBits += 1; // increment the rollover counter
-        IFS0CLR = _IFS0_T3IF_MASK; // clear the rollover interrupt   
-    }                                                     
-    
-    // Calculate the time length between encoder pulses
-    uint32_t CurrentPulseLength = MyTimer.FullTime - RightPrevTime; 
-    RightPulseLength = (uint32_t)(0.8*CurrentPulseLength + 0.2*RightPulseLength);
-    RightPrevTime = MyTimer.FullTime; // update our last time variable 
-    
-    // Update number of rotations for dead reckoning
-    if (ChannelB) {
-        RightRotations -= 1;
-    } else {
-        RightRotations += 1;
-    }
-    
-    // restart Timer5 (timer to indicate if right motor is stopped)
-    T5CONCLR = _T5CON_ON_MASK;     
-    TMR5 = 0;     
-    T5CONSET = _T5CON_ON_MASK;     
+    do {
+        WheelSpeed_Edge(&RightSpeed, WHEEL_SPEED_CHANNEL_A, IC1BUF);
+    } while (IC1CONbits.ICBNE);
 }
 
 void __ISR(_INPUT_CAPTURE_2_VECTOR, IPL7SRS) IC2Handler(void)
 {
-    // Probably don't need this here, we should just use this input to see if wheel moving forwards or backwards
+    // Not used, right channel B is on RH8 which IC2 can not be mapped to,
+    // see CNHHandler
+}
+
+/****************************************************************************
+ Function
+    CNHHandler
+
+ Description
+   Decodes the edges of right encoder channel B. There is no capture on
+   RH8, the edge time is timer2/3 as the handler runs.
+****************************************************************************/
+void __ISR(_CHANGE_NOTICE_H_VECTOR, IPL7SRS) CNHHandler(void)
+{
+    uint32_t Time = TMR2;
+    
+    CNFHCLR = _CNFH_CNFH8_MASK; // Clear the pin's edge flag first
+    IFS3CLR = _IFS3_CNHIF_MASK; // Clear the interrupt
+    WheelSpeed_Edge(&RightSpeed, WHEEL_SPEED_CHANNEL_B, Time);
 }
 
 /****************************************************************************
@@ -704,42 +740,29 @@ void __ISR(_INPUT_CAPTURE_2_VECTOR, IPL7SRS) IC2Handler(void)
     IC3Handler
 
  Description
-   Counts time between encoder pulses for measuring left motor pulse lengths
+   Decodes the edges of left encoder channel A
 ****************************************************************************/
 void __ISR(_INPUT_CAPTURE_3_VECTOR, IPL7SRS) IC3Handler(void)
 {
-    static uint8_t ChannelB = 0; // static for speed
-    
-    ChannelB = PORTCbits.RC4;
-    
-    MyTimer.TimeStruct.TimerBits = (uint16_t)IC3BUF; // grab the captured time 
     IFS0CLR = _IFS0_IC3IF_MASK; // Clear the interrupt
-    if (IFS0bits.T3IF && MyTimer.TimeStruct.TimerBits < 0x8000) {            
-        MyTimer.TimeStruct.RolloverBits += 1; // increment the rollover counter
-        IFS0CLR = _IFS0_T3IF_MASK; // clear the rollover interrupt   
-    }                                                     
-    
-    // Calculate the time length between encoder pulses
-    uint32_t CurrentPulseLength = MyTimer.FullTime - LeftPrevTime;    
-    LeftPulseLength = (uint32_t)(0.8*CurrentPulseLength + 0.2*LeftPulseLength);         
-    LeftPrevTime = MyTimer.FullTime; // update our last time variable 
-    
-    // Update number of rotations for dead reckoning
-    if (ChannelB) {
-        LeftRotations += 1;
-    } else {
-        LeftRotations -= 1;
-    }   
-    
-    // restart Timer4 (timer to indicate if left motor is stopped)
-    T4CONCLR = _T4CON_ON_MASK;     
-    TMR4 = 0;     
-    T4CONSET = _T4CON_ON_MASK; 
+    do {
+        WheelSpeed_Edge(&LeftSpeed, WHEEL_SPEED_CHANNEL_A, IC3BUF);
+    } while (IC3CONbits.ICBNE);
 }
 
+/****************************************************************************
+ Function
+    IC4Handler
+
+ Description
+   Decodes the edges of left encoder channel B
+****************************************************************************/
 void __ISR(_INPUT_CAPTURE_4_VECTOR, IPL7SRS) IC4Handler(void)
 {
-    // Probably don't need this here, we should just use this input to see if wheel moving forwards or backwards
+    IFS0CLR = _IFS0_IC4IF_MASK; // Clear the interrupt
+    do {
+        WheelSpeed_Edge(&LeftSpeed, WHEEL_SPEED_CHANNEL_B, IC4BUF);
+    } while (IC4CONbits.ICBNE);
 }
 
 /****************************************************************************
@@ -751,28 +774,20 @@ void __ISR(_INPUT_CAPTURE_4_VECTOR, IPL7SRS) IC4Handler(void)
 ****************************************************************************/
 void __ISR(_TIMER_1_VECTOR, IPL7SRS) T1Handler(void)
 {  
-    // Initializes the PI Variables
-    static float LeftErrorSum = 0.0;
-    static float RightErrorSum = 0.0;
-    static float LeftError;
-    static float RightError;
-    static float LeftPrevError = 0.0;
-    static float RightPrevError = 0.0;
-    static float LeftErrorDiff;
-    static float RightErrorDiff;
+    // Initializes the PID Variables
+    static MotorPID_t LeftPID;
+    static MotorPID_t RightPID;
     static int16_t LeftDutyCycle; // Only static here for speed
     static int16_t RightDutyCycle; // Only static here for speed
-    static int16_t PrevLeftDutyCycle; // Only static here for speed
-    static int16_t PrevRightDutyCycle; // Only static here for speed
+    static uint32_t Now; // Only static here for speed
+#ifdef RL_MOTOR_LOGGING
+    static int16_t LeftPercent; // Only static here for speed
+    static int16_t PrevLeftPercent; // Only static here for speed
     static int16_t LeftDelta=0; // Only static here for speed
-    static int16_t RightDelta=0; // Only static here for speed
     static int16_t LeftReward; // Only static here for speed
-    static int16_t peek_data; // Only static here for speed
-    static uint8_t peek_count; // Only static here for speed
-    
-    // Initialize variables used throughout the ISR (Static for speed)
-    static uint16_t ActualLeftRPM = 0;
-    static uint16_t ActualRightRPM = 0;
+    static int16_t LeftRPM; // Only static here for speed
+    static int16_t Step[STEP_SIZE]; // Only static here for speed
+#endif
     
     IFS0CLR = _IFS0_T1IF_MASK; // Clear the timer interrupt
     
@@ -782,184 +797,80 @@ void __ISR(_TIMER_1_VECTOR, IPL7SRS) T1Handler(void)
         T1CONCLR = _T1CON_ON_MASK; // stop the timer 
         TMR1 = 0;
                 
-        // Manually set drive pins to stopped
-        LATJbits.LATJ3 = 0; // Set direction pin forward
+        // Manually set the drives to stopped, forward
         LeftDirection = Forward;
-        LATFbits.LATF8 = 0; // Set direction pin forward
         RightDirection = Forward;
-        
-        OC1RS = 0;
-        OC2RS = 0;
+        MotorPWM_SetDrive(MotorPWMLeft, 0);
+        MotorPWM_SetDrive(MotorPWMRight, 0);
         
         // Reset stored values
-        LeftErrorSum = 0;
-        RightErrorSum = 0;
-        LeftPrevError = 0;
-        RightPrevError = 0;
+        MotorPID_Reset(&LeftPID);
+        MotorPID_Reset(&RightPID);
         
         return;
     }
     
-    // Calculate Current RPM based on Pulse Lengths from encoders
-    ActualLeftRPM = SPEED_CONVERSION_FACTOR / LeftPulseLength;
-    ActualRightRPM = SPEED_CONVERSION_FACTOR / RightPulseLength;
+    // Run the PID law for each wheel, see MotorControl.c
+    Now = TMR2;
+    LeftDutyCycle = MotorPID_Step(&LeftPID, DesiredLeftRPM,
+        WheelSpeed_GetPulseLength(&LeftSpeed, Now));
+    RightDutyCycle = MotorPID_Step(&RightPID, DesiredRightRPM,
+        WheelSpeed_GetPulseLength(&RightSpeed, Now));
     
-    // Calculate error from desired RPM
-    LeftError = DesiredLeftRPM - ActualLeftRPM;
-    RightError = DesiredRightRPM - ActualRightRPM;
+    // Lastly, set the drive of the motors, see MotorPWM.c
+    MotorPWM_SetDrive(MotorPWMLeft,
+        (LeftDirection == Backward) ? -LeftDutyCycle : LeftDutyCycle);
+    MotorPWM_SetDrive(MotorPWMRight,
+        (RightDirection == Backward) ? -RightDutyCycle : RightDutyCycle);
     
-    if (abs(ActualLeftRPM) > 500) {
-        // The RPM Readings are likely in error, use previous error instead
-        LeftError = LeftPrevError;
-    }
-    
-    if (abs(ActualRightRPM) > 500) {
-        // The RPM Readings are likely in error, use previous error instead
-        RightError = RightPrevError;
+#ifdef RL_MOTOR_LOGGING
+    // The RL data keeps the duty in percent of the PWM period, the way the
+    // PID law gave it before MotorPWM.c
+    LeftPercent = (int16_t)(((int32_t)LeftDutyCycle * 100 + MOTOR_PWM_FULL / 2) /
+        MOTOR_PWM_FULL);
+    if (LeftDirection == Backward) {
+        LeftPercent = 100 - LeftPercent;
     }
     
-#ifdef RL_MOTOR_LOGGING
 //    LeftReward = -3*LeftError*LeftError - LeftDelta*LeftDelta;
-    LeftReward = -LeftError*LeftError;
+    // the RL data keeps whole RPM, the PID law works in tenths
+    LeftRPM = (int16_t)((LeftPID.Speed + SPEED_SCALE / 2) / SPEED_SCALE);
+    LeftReward = (int16_t)(-(LeftPID.Error * LeftPID.Error) /
+        (SPEED_SCALE * SPEED_SCALE));
             
-    circular_buffer_put(&cb, (int16_t)(LeftReward));
+    Step[0] = (int16_t)(LeftReward);
     if (LeftDirection == Backward) {
-        circular_buffer_put(&cb, -ActualLeftRPM);
-        circular_buffer_put(&cb, -DesiredLeftRPM);
+        Step[1] = -LeftRPM;
+        Step[2] = -DesiredLeftRPM;
     } else {
-        circular_buffer_put(&cb, ActualLeftRPM);
-        circular_buffer_put(&cb, DesiredLeftRPM);
+        Step[1] = LeftRPM;
+        Step[2] = DesiredLeftRPM;
     }
-    circular_buffer_put(&cb, PrevLeftDutyCycle);
+    Step[3] = PrevLeftPercent;
 #endif
     
-//    DB_printf("%d, %d", (int16_t)LeftError, (int16_t)LeftErrorSum);
-    
-    // Integral of error
-    LeftErrorSum += LeftError;
-    RightErrorSum += RightError;
-    
-    // Derivative of Error
-    LeftErrorDiff = LeftError - LeftPrevError;
-    RightErrorDiff = RightError - RightPrevError;
-    
-    // Update for next time
-    LeftPrevError = LeftError;
-    RightPrevError = RightError;
-    
-    // Calculate according to PI Law
-    LeftDutyCycle = Kp*LeftError + Ki*LeftErrorSum + Kd*LeftErrorDiff; 
-    RightDutyCycle = Kp*RightError + Ki*RightErrorSum + Kd*RightErrorDiff;
-    
-    // Anti-Windup
-    if (LeftDutyCycle > 100) {
-        LeftDutyCycle = 100;
-        LeftErrorSum -= LeftError;
-    } else if (LeftDutyCycle < 0) {
-        LeftDutyCycle = 0;
-        LeftErrorSum -= LeftError;
-    }
-    
-    if (RightDutyCycle > 100) {
-        RightDutyCycle = 100;
-        RightErrorSum -= RightError;
-    } else if (RightDutyCycle < 0) {
-        RightDutyCycle = 0;
-        RightErrorSum -= RightError;
-    }
-        
-    // Lastly, Set the duty cycle of the motors by updating Output Compare
-    if (LeftDirection == Backward) {
-        LeftDutyCycle = 100 - LeftDutyCycle;
-    }
-    OC2RS = (OC_PERIOD + 1)/100 * LeftDutyCycle;
+#ifdef RL_MOTOR_LOGGING
+    LeftDelta = LeftPercent - PrevLeftPercent;
+    Step[4] = LeftDelta;
     
-    if (RightDirection == Backward) {
-        RightDutyCycle = 100 - RightDutyCycle;
+    // Drop the oldest step if the history is full, then add this one
+    if (ES_RingCount(&StateRing) > (BUFF_SIZE - STEP_SIZE)) {
+        ES_RingSkip(&StateRing, ES_RingCount(&StateRing) - (BUFF_SIZE - STEP_SIZE));
     }
-    OC1RS = (OC_PERIOD + 1)/100 * RightDutyCycle;
-    
-#ifdef RL_MOTOR_LOGGING
-    LeftDelta = LeftDutyCycle - PrevLeftDutyCycle;
-    circular_buffer_put(&cb, LeftDelta);
+    ES_RingPutN(&StateRing, Step, STEP_SIZE);
+    PrevLeftPercent = LeftPercent;
 #endif
     
-    PrevLeftDutyCycle = LeftDutyCycle;
-    PrevRightDutyCycle = RightDutyCycle;
-    
 #ifdef RL_MOTOR_LOGGING
-    peek_count = circular_buffer_peek(&cb_record, &peek_data, 1);
-    if (peek_count && (peek_data==0)) {
-        
-        // Remove the entry since it is now 0
-        circular_buffer_get(&cb_record, &peek_data);
-        
-        // Save the RL Data
-        if (RL_Data_Index < 1000) {
-            Store_RL_Data();
-        }
-        
-        if (RL_Data_Index == 1000) {
-            ES_Event_t NewEvent = {EV_LED_ON, 4};
-            PostLEDService(NewEvent);
-            RL_Data_Index = 1001;
-        }
+    // Save the RL Data if the schedule has this step, and the capture is on
+    if (RLCapture_IsDue()) {
+        Store_RL_Data();
     }
-    
-    // Decrement the record counts
-    circular_buffer_decrement_all(&cb_record);
 #endif
     
 //    LATHbits.LATH4 = 0;
 }
 
-/****************************************************************************
- Function
-    T3Handler
-
- Description
-   Increments the rollover bit of the timer since maxed out the timer
-****************************************************************************/
-void __ISR(_TIMER_3_VECTOR, IPL7SRS) T3Handler(void)
-{
-    __builtin_disable_interrupts(); // Disable interrupts globally
-    
-    if (IFS0bits.T3IF) {
-        MyTimer.TimeStruct.RolloverBits += 1; // Increment rollover counter
-        IFS0CLR = _IFS0_T3IF_MASK;
-    }
-    
-    __builtin_enable_interrupts(); // Enable interrupts globally
-}
-
-/****************************************************************************
- Function
-    T4Handler
-
- Description
-   If we reach here this means the left motor is not moving
-****************************************************************************/
-void __ISR(_TIMER_4_VECTOR, IPL6SRS) T4Handler(void)
-{
-    IFS0CLR = _IFS0_T4IF_MASK; // clear the interrupt flag     
-    T4CONCLR = _T4CON_ON_MASK; // stop the timer 
-    LeftPulseLength = 4294967295; // set LeftPulseLength to max    
-}
-
-/****************************************************************************
- Function
-    T5Handler
-
- Description
-   If we reach here this means the right motor is not moving
-****************************************************************************/
-void __ISR(_TIMER_5_VECTOR, IPL6SRS) T5Handler(void)
-{
-    IFS0CLR = _IFS0_T5IF_MASK; // clear the interrupt flag     
-    T5CONCLR = _T5CON_ON_MASK; // stop the timer 
-    RightPulseLength = 4294967295; // set RightPulseLength to max    
-}
-
 // Using an exact method to solve the differential equations
 void __ISR(_TIMER_7_VECTOR, IPL6SRS) T7Handler(void)
 {
@@ -969,9 +880,12 @@ void __ISR(_TIMER_7_VECTOR, IPL6SRS) T7Handler(void)
     static float omega; // Robot angular velocity (rad/second)
     static float prev_theta;
     static float effective_V;
+    float sin_prev, cos_prev; // of prev_theta
+    float sin_theta, cos_theta;
     
     static int32_t CurLeftRotations;
     static int32_t CurRightRotations;
+    uint32_t Now;
         
     static float roll;
     static float pitch;
@@ -980,15 +894,31 @@ void __ISR(_TIMER_7_VECTOR, IPL6SRS) T7Handler(void)
     
     // Get the current roll/pitch of the mobile robot
     GetAngles(&roll, &pitch);
-    if (abs(pitch) < 2.5) {
+    if (pitch < 2.5f && pitch > -2.5f) {
         pitch = 0;
     }
     
-    // First thing we do is grab current number of rotations so this doesn't change mid function
-    CurLeftRotations = LeftRotations;
-    CurRightRotations = RightRotations;
+    // First thing we do is grab the counts and the speeds, with the edge
+    // handlers held off so they all come from the same moment. This also
+    // ends the measurement of a wheel that has stopped, before timer2/3
+    // wraps around to its last edge
+    __builtin_disable_interrupts();
+    Now = TMR2;
+    WheelSpeed_Expire(&LeftSpeed, Now);
+    WheelSpeed_Expire(&RightSpeed, Now);
+    CurLeftRotations = LeftSpeed.Count;
+    CurRightRotations = RightSpeed.Count;
+    V_l = WheelSpeed_GetMetersPerSecond(&LeftSpeed, Now);
+    V_r = WheelSpeed_GetMetersPerSecond(&RightSpeed, Now);
+    __builtin_enable_interrupts();
+    
+    // The current linear/angular velocity of the robot, from the same
+    // estimate the speed loop uses
+    V_current = (V_l + V_r) / 2; // used to store current velocity
+    w_current = (V_r - V_l) * INV_WHEEL_BASE; // used to store current angular velocity
     
-    // Next we calculate the linear velocity of each wheel
+    // The position is integrated from the exact edge counts, the mean
+    // velocity of each wheel over the period
     V_l = (CurLeftRotations - LeftPrevRotations) * DEAD_RECKONING_RATIO; 
     V_r = (CurRightRotations - RightPrevRotations) * DEAD_RECKONING_RATIO;
     
@@ -996,90 +926,113 @@ void __ISR(_TIMER_7_VECTOR, IPL6SRS) T7Handler(void)
     LeftPrevRotations = CurLeftRotations;
     RightPrevRotations = CurRightRotations;
     
-    // Calculate the instantaneous linear/angular velocity of robot
+    // Calculate the mean linear/angular velocity of robot
     V = (V_l + V_r) / 2; 
-    omega = (V_r - V_l) / WHEEL_BASE;
-    
-    V_current = V; // used to store current velocity
-    w_current = omega; // used to store current angular velocity
+    omega = (V_r - V_l) * INV_WHEEL_BASE;
     
     // Calculate the update in theta and ensure theta stays within [-pi, pi]
     prev_theta = theta;
     theta = theta + omega * DEAD_RECKONING_TIME;
-    while (theta > M_PI) {
-        theta -= 2*M_PI;
+    while (theta > PI_F) {
+        theta -= 2*PI_F;
     }
-    while (theta < -M_PI) {
-        theta += 2*M_PI;
+    while (theta < -PI_F) {
+        theta += 2*PI_F;
     }
     
-    pitch *= 0.0174533; // Convert pitch to radians
-    effective_V = V * cosf(pitch); // Get effective velocity for pitch
+    pitch *= DEG_TO_RAD; // Convert pitch to radians
+    effective_V = V * FastMath_Cos(pitch); // Get effective velocity for pitch
+    FastMath_SinCos(prev_theta, &sin_prev, &cos_prev);
     
-    if (omega < 0.01 && omega > -0.01) {
+    if (omega < 0.01f && omega > -0.01f) {
         // No account for pitch
 //        x = x + V * cosf(prev_theta) * DEAD_RECKONING_TIME;
 //        y = y + V * sinf(prev_theta) * DEAD_RECKONING_TIME;
         
         // Account for pitch
-        x = x + effective_V * cosf(prev_theta) * DEAD_RECKONING_TIME;
-        y = y + effective_V * sinf(prev_theta) * DEAD_RECKONING_TIME;
+        x = x + effective_V * cos_prev * DEAD_RECKONING_TIME;
+        y = y + effective_V * sin_prev * DEAD_RECKONING_TIME;
     } else {
         // No account for pitch
 //        x = x + V/omega * (sinf(theta) - sinf(prev_theta));
 //        y = y - V/omega * (cosf(theta) - cosf(prev_theta));
         
         // Account for pitch
-        x = x + effective_V/omega * (sinf(theta) - sinf(prev_theta));
-        y = y - effective_V/omega * (cosf(theta) - cosf(prev_theta));
+        FastMath_SinCos(theta, &sin_theta, &cos_theta);
+        x = x + effective_V/omega * (sin_theta - sin_prev);
+        y = y - effective_V/omega * (cos_theta - cos_prev);
     }
+    
+    // Hand the update to the readers in one go
+    PublishOdometry(Now);
 }
 
-static void Store_RL_Data(void) {
+// the dead reckoning state to OdometrySnapshot, from T7Handler or with it
+// held off
+static void PublishOdometry(uint32_t Time) {
+    Odometry_t Odometry;
     
-    // Now store the set of data in RL_Data
+    Odometry.x = x;
+    Odometry.y = y;
+    Odometry.theta = theta;
+    Odometry.V = V_current;
+    Odometry.w = w_current;
+    Odometry.Time = Time;
+    ES_SnapshotPublish(&OdometrySnapshot, &Odometry);
+}
+
+#ifdef RL_MOTOR_LOGGING
+// the recording for the step 10 steps back goes in a record of the RL
+// capture, nothing if the capture is off or its ring is full
+static void Store_RL_Data(void) {
     int16_t peek_rl_data[BUFF_SIZE];
-    uint16_t peek_count = circular_buffer_peek(&cb, peek_rl_data, BUFF_SIZE);
+    int16_t *pRecord = RLCapture_Claim();
+    
+    if (pRecord == NULL) {
+        return;
+    }
+    ES_RingPeekN(&StateRing, peek_rl_data, BUFF_SIZE);
     
     // States (2 prior, current, and 1 after)
-    RL_Data[RL_Data_Index][0] = peek_rl_data[1];
-    RL_Data[RL_Data_Index][1] = peek_rl_data[2];
-    RL_Data[RL_Data_Index][2] = peek_rl_data[3];
-    RL_Data[RL_Data_Index][3] = peek_rl_data[6];
-    RL_Data[RL_Data_Index][4] = peek_rl_data[7];
-    RL_Data[RL_Data_Index][5] = peek_rl_data[8];
-    RL_Data[RL_Data_Index][6] = peek_rl_data[11];
-    RL_Data[RL_Data_Index][7] = peek_rl_data[12];
-    RL_Data[RL_Data_Index][8] = peek_rl_data[13];
-    RL_Data[RL_Data_Index][9] = peek_rl_data[16];
-    RL_Data[RL_Data_Index][10] = peek_rl_data[17];
-    RL_Data[RL_Data_Index][11] = peek_rl_data[18];
+    pRecord[0] = peek_rl_data[1];
+    pRecord[1] = peek_rl_data[2];
+    pRecord[2] = peek_rl_data[3];
+    pRecord[3] = peek_rl_data[6];
+    pRecord[4] = peek_rl_data[7];
+    pRecord[5] = peek_rl_data[8];
+    pRecord[6] = peek_rl_data[11];
+    pRecord[7] = peek_rl_data[12];
+    pRecord[8] = peek_rl_data[13];
+    pRecord[9] = peek_rl_data[16];
+    pRecord[10] = peek_rl_data[17];
+    pRecord[11] = peek_rl_data[18];
 
     // 3 States ending at t+10
-    RL_Data[RL_Data_Index][12] = peek_rl_data[51];
-    RL_Data[RL_Data_Index][13] = peek_rl_data[52];
-    RL_Data[RL_Data_Index][14] = peek_rl_data[53];
-    RL_Data[RL_Data_Index][15] = peek_rl_data[56];
-    RL_Data[RL_Data_Index][16] = peek_rl_data[57];
-    RL_Data[RL_Data_Index][17] = peek_rl_data[58];
-    RL_Data[RL_Data_Index][18] = peek_rl_data[61];
-    RL_Data[RL_Data_Index][19] = peek_rl_data[62];
-    RL_Data[RL_Data_Index][20] = peek_rl_data[63];
+    pRecord[12] = peek_rl_data[51];
+    pRecord[13] = peek_rl_data[52];
+    pRecord[14] = peek_rl_data[53];
+    pRecord[15] = peek_rl_data[56];
+    pRecord[16] = peek_rl_data[57];
+    pRecord[17] = peek_rl_data[58];
+    pRecord[18] = peek_rl_data[61];
+    pRecord[19] = peek_rl_data[62];
+    pRecord[20] = peek_rl_data[63];
 
     // Action taken
-    RL_Data[RL_Data_Index][21] =  peek_rl_data[14];
+    pRecord[21] = peek_rl_data[14];
 
     // Rewards Received 
-    RL_Data[RL_Data_Index][22] = peek_rl_data[15];
-    RL_Data[RL_Data_Index][23] = peek_rl_data[20];
-    RL_Data[RL_Data_Index][24] = peek_rl_data[25];
-    RL_Data[RL_Data_Index][25] = peek_rl_data[30];
-    RL_Data[RL_Data_Index][26] = peek_rl_data[35];
-    RL_Data[RL_Data_Index][27] = peek_rl_data[40];
-    RL_Data[RL_Data_Index][28] = peek_rl_data[45];
-    RL_Data[RL_Data_Index][29] = peek_rl_data[50];
-    RL_Data[RL_Data_Index][30] = peek_rl_data[55];
-    RL_Data[RL_Data_Index][31] = peek_rl_data[60];
-
-    RL_Data_Index += 1;
-}
\ No newline at end of file
+    pRecord[22] = peek_rl_data[15];
+    pRecord[23] = peek_rl_data[20];
+    pRecord[24] = peek_rl_data[25];
+    pRecord[25] = peek_rl_data[30];
+    pRecord[26] = peek_rl_data[35];
+    pRecord[27] = peek_rl_data[40];
+    pRecord[28] = peek_rl_data[45];
+    pRecord[29] = peek_rl_data[50];
+    pRecord[30] = peek_rl_data[55];
+    pRecord[31] = peek_rl_data[60];
+
+    RLCapture_Commit();
+}
+#endif
@@ -0,0 +1,669 @@
+/****************************************************************************
+ Module
+   RLCapture.c
+
+ Description
+   Streaming capture of the RL motor data. T1Handler writes each recording
+   straight into a record of a ring, and MotorSM's RL_TIMER sends the
+   records out over the terminal as it has room, one framed line each, for
+   as long as the capture is on. HostTools/rl_capture.py turns a terminal
+   capture back into CSV. Which control steps are recorded comes from a
+   schedule, a table of runs of steps that MotorSM makes on a new set point.
+
+ Notes
+   Compiled in with RL_MOTOR_LOGGING in ES_Configure.h. The ring is an
+   ES_Ring with T1Handler the only producer and MotorSM the only consumer.
+   A record is claimed in place (ES_RingWriteSpan), so the ISR fills it
+   without a copy, and committed once it is whole. When the ring is full
+   the new record is lost rather than an old one, and the ISR never waits.
+   A schedule is kept as the control step numbers of its recordings, in
+   order, in a second ring. T1Handler counts the steps and compares the
+   count with the earliest of them, taking the next one out of the ring
+   when it is reached, so a step costs the same however long the schedule.
+   Lines, with other terminal output between them but never inside one:
+     #R  ssss vvvv x 32 cccc   record number, the values as 16 bit two's
+                               complement, CRC-16/CCITT (0x1021, from
+                               0xFFFF) of the bytes the hex before it spells
+     #RL nnnnnnnn              records lost so far, sent before the next
+                               #R after a loss. The gaps in ssss say where
+
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "RLCapture.h"
+
+#ifdef RL_MOTOR_LOGGING
+#include "ES_Ring.h"
+#include "terminal.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#if (RL_CAPTURE_DEPTH & (RL_CAPTURE_DEPTH - 1)) != 0
+#error "RL_CAPTURE_DEPTH must be a power of 2"
+#endif
+
+// "#R " + Seq + the values, each with a space, + CRC + "\r\n"
+#define LINE_LENGTH (3 + 4 + (RL_CAPTURE_VALUES * 5) + 5 + 2)
+// "#RL " + count + "\r\n", sent with the line that follows the loss
+#define LOST_LENGTH (4 + 8 + 2)
+// left free in the terminal buffer for everybody else, and for a #RL line
+#define DRAIN_MARGIN 64
+
+#define CRC_POLY 0x1021
+#define CRC_INIT 0xFFFF
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t CrcWord(uint16_t Crc, uint16_t Word);
+static bool WriteRecordLine(const RLCaptureRecord_t *pRecord,
+    uint32_t LostNow);
+static uint8_t PutHex(char *pLine, uint32_t Value, uint8_t Digits);
+static uint8_t PutString(char *pLine, const char *pString);
+
+/*---------------------------- Module Variables ---------------------------*/
+ES_RING_DEFINE(CaptureRing, RLCaptureRecord_t, RL_CAPTURE_DEPTH);
+
+// the control steps still to be recorded, earliest first, the earliest one
+// out of the ring, and the number of the step T1Handler is at. Written by
+// RLCapture_Schedule with T1Handler held off, read by RLCapture_IsDue
+ES_RING_DEFINE(TriggerRing, uint32_t, RL_CAPTURE_TRIGGERS);
+static uint32_t NextTrigger;
+static bool TriggerPending;
+static uint32_t ControlStep;
+
+static volatile bool CaptureOn;
+static RLCaptureRecord_t *pClaimed; // T1Handler's record being filled
+static uint32_t Written;            // records ever claimed or lost
+static volatile uint32_t Lost;      // records the full ring turned away
+static uint32_t ReportedLost;       // Lost as of the last #RL line
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     RLCapture_Init
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Empties the ring and leaves the capture off
+****************************************************************************/
+void RLCapture_Init(void)
+{
+    CaptureOn = false;
+    ES_RingInitStatic(CaptureRing);
+    ES_RingInitStatic(TriggerRing);
+    TriggerPending = false;
+    ControlStep = 0;
+    pClaimed = NULL;
+    Written = 0;
+    Lost = 0;
+    ReportedLost = 0;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_Start
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Has RLCapture_Claim hand out records from now on
+****************************************************************************/
+void RLCapture_Start(void)
+{
+    CaptureOn = true;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_Stop
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     No more records are taken, the ones in the ring still go out
+****************************************************************************/
+void RLCapture_Stop(void)
+{
+    CaptureOn = false;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_IsOn
+
+ Parameters
+     None
+
+ Returns
+     bool, true between RLCapture_Start and RLCapture_Stop
+****************************************************************************/
+bool RLCapture_IsOn(void)
+{
+    return CaptureOn;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_Claim
+
+ Parameters
+     None
+
+ Returns
+     int16_t * the RL_CAPTURE_VALUES values of the next record to fill, NULL
+         if the capture is off or the ring is full
+
+ Description
+     The producer side, from T1Handler only. A record it gets has to be
+     handed on with RLCapture_Commit before the next claim. A full ring
+     counts the record as lost
+****************************************************************************/
+int16_t *RLCapture_Claim(void)
+{
+    uint32_t Length;
+
+    if (!CaptureOn) {
+        return NULL;
+    }
+    pClaimed = ES_RingWriteSpan(&CaptureRing, &Length);
+    if (Length == 0) {
+        pClaimed = NULL;
+        Written++;
+        Lost++;
+        return NULL;
+    }
+    pClaimed->Seq = (uint16_t)Written++;
+    return pClaimed->Values;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_Commit
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Puts the record from the last RLCapture_Claim in the ring, for
+     RLCapture_MoveToTerminal to send
+****************************************************************************/
+void RLCapture_Commit(void)
+{
+    if (pClaimed != NULL) {
+        ES_RingCommit(&CaptureRing, 1);
+        pClaimed = NULL;
+    }
+}
+
+/****************************************************************************
+ Function
+     RLCapture_MoveToTerminal
+
+ Parameters
+     None
+
+ Returns
+     bool, true while records are still waiting
+
+ Description
+     The consumer side. Sends as many records as fit in the terminal
+     buffer, MotorSM calls it from its RL_TIMER timeout
+****************************************************************************/
+bool RLCapture_MoveToTerminal(void)
+{
+    RLCaptureRecord_t *pRecord;
+    uint32_t Length;
+    uint32_t LostNow;
+
+    while (((pRecord = ES_RingPeekSpan(&CaptureRing, 0, &Length)) != NULL) &&
+            (Terminal_GetTxSpace() >= (LINE_LENGTH + DRAIN_MARGIN))) {
+        LostNow = Lost;
+        if (!WriteRecordLine(pRecord, LostNow)) {
+            break; // a higher level took the room, try again next time
+        }
+        ReportedLost = LostNow;
+        ES_RingSkip(&CaptureRing, 1);
+    }
+    return ES_RingCount(&CaptureRing) != 0;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_Schedule
+
+ Parameters
+     const RLCaptureRun_t *pRuns: the runs of recordings, each one starting
+         after the one before it ends
+     uint8_t NumRuns: how many
+
+ Returns
+     bool, false if the runs are out of order or hold more than
+         RL_CAPTURE_TRIGGERS recordings, and nothing is scheduled
+
+ Description
+     Replaces the schedule with the given one, counted from the next control
+     step (step 0). T1Handler has to be held off, it reads the schedule
+****************************************************************************/
+bool RLCapture_Schedule(const RLCaptureRun_t *pRuns, uint8_t NumRuns)
+{
+    uint32_t Step;
+    uint32_t Previous = 0;
+    uint8_t i;
+
+    TriggerPending = false;
+    ES_RingReset(&TriggerRing);
+    for (i = 0; i < NumRuns; i++) {
+        if ((pRuns[i].Every == 0) || (pRuns[i].Last < pRuns[i].First) ||
+                ((i > 0) && (pRuns[i].First <= Previous))) {
+            ES_RingReset(&TriggerRing);
+            return false;
+        }
+        for (Step = pRuns[i].First; Step <= pRuns[i].Last;
+                Step += pRuns[i].Every) {
+            uint32_t Trigger = ControlStep + Step;
+
+            if (!ES_RingPut(&TriggerRing, &Trigger)) {
+                ES_RingReset(&TriggerRing);
+                return false;
+            }
+            Previous = Step;
+        }
+    }
+    TriggerPending = ES_RingGet(&TriggerRing, &NextTrigger);
+    return true;
+}
+
+/****************************************************************************
+ Function
+     RLCapture_IsDue
+
+ Parameters
+     None
+
+ Returns
+     bool, true if this control step is one the schedule records
+
+ Description
+     Called from T1Handler once every control step, which it counts. Only
+     the earliest step of the schedule is looked at
+****************************************************************************/
+bool RLCapture_IsDue(void)
+{
+    bool Due = false;
+
+    // the difference copes with the count wrapping, after 79 days
+    if (TriggerPending && ((int32_t)(ControlStep - NextTrigger) >= 0)) {
+        TriggerPending = ES_RingGet(&TriggerRing, &NextTrigger);
+        Due = true;
+    }
+    ControlStep++;
+    return Due;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// CRC-16/CCITT of the two bytes of Word, high byte first as the hex reads
+static uint16_t CrcWord(uint16_t Crc, uint16_t Word)
+{
+    uint8_t Bit;
+
+    Crc ^= Word;
+    for (Bit = 0; Bit < 16; Bit++) {
+        Crc = (Crc & 0x8000) ? (uint16_t)((Crc << 1) ^ CRC_POLY) :
+            (uint16_t)(Crc << 1);
+    }
+    return Crc;
+}
+
+// builds the line for the record, after a #RL line if LostNow has not been
+// reported, and sends it in one write. False, and nothing sent, if it did
+// not fit
+static bool WriteRecordLine(const RLCaptureRecord_t *pRecord,
+    uint32_t LostNow)
+{
+    char Line[LOST_LENGTH + LINE_LENGTH];
+    uint16_t Length = 0;
+    uint16_t Crc = CrcWord(CRC_INIT, pRecord->Seq);
+    uint8_t i;
+
+    if (LostNow != ReportedLost) {
+        Length += PutString(&Line[Length], "#RL ");
+        Length += PutHex(&Line[Length], LostNow, 8);
+        Length += PutString(&Line[Length], "\r\n");
+    }
+    Length += PutString(&Line[Length], "#R ");
+    Length += PutHex(&Line[Length], pRecord->Seq, 4);
+    for (i = 0; i < RL_CAPTURE_VALUES; i++) {
+        Length += PutString(&Line[Length], " ");
+        Length += PutHex(&Line[Length], (uint16_t)pRecord->Values[i], 4);
+        Crc = CrcWord(Crc, (uint16_t)pRecord->Values[i]);
+    }
+    Length += PutString(&Line[Length], " ");
+    Length += PutHex(&Line[Length], Crc, 4);
+    Length += PutString(&Line[Length], "\r\n");
+    return Terminal_Write((const uint8_t *)Line, Length, TERMINAL_TX_DROP) != 0;
+}
+
+static uint8_t PutHex(char *pLine, uint32_t Value, uint8_t Digits)
+{
+    static const char HexDigits[] = "0123456789abcdef";
+    uint8_t i;
+
+    for (i = 0; i < Digits; i++) {
+        pLine[i] = HexDigits[(Value >> (4 * (Digits - 1 - i))) & 0xF];
+    }
+    return Digits;
+}
+
+static uint8_t PutString(char *pLine, const char *pString)
+{
+    uint8_t Length = 0;
+
+    while (pString[Length] != '\0') {
+        pLine[Length] = pString[Length];
+        Length++;
+    }
+    return Length;
+}
+
+#ifdef TEST_RL_CAPTURE
+/* RL capture harness (make -f Makefile.host rl_check).
+   "script" streams records the way T1Handler and MotorSM do: a few drained
+   one at a time, then a burst of three ring's worth with no draining, so
+   the ring turns the last two thirds away, and a few more after
+   RLCapture_Stop that must not be taken. A line of other output and a
+   frame with a bad CRC go in between. "csv" prints the rows
+   rl_capture.py has to give back for it, the frame with the bad CRC and
+   the lost records left out. "schedule" steps schedules through
+   RLCapture_IsDue next to the count down of every pending recording that
+   it replaced, and fails on the first step where the two differ. "bench"
+   times a claim, fill and commit against a drained line, and a control
+   step of each way of scheduling, on stderr. */
+#include <stdio.h>
+#include <string.h>
+#include "dbprintf.h"
+#include "ES_General.h"
+
+#define FIRST_RECORDS 10
+#define BURST_RECORDS (3 * RL_CAPTURE_DEPTH)
+#define BENCH_RECORDS 100000u
+#define BENCH_STEPS 100u // the first 0.16 s, every step recorded
+#define BENCH_RUNS 1000u
+
+// log spaced, a burst then periodic, and MotorSM's step response
+static const RLCaptureRun_t LogRuns[] = {
+    {1, 1, 1}, {2, 2, 1}, {4, 4, 1}, {8, 8, 1}, {16, 16, 1}, {32, 32, 1},
+    {64, 64, 1}, {128, 128, 1}, {256, 256, 1}, {512, 512, 1}
+};
+static const RLCaptureRun_t BurstRuns[] = {
+    {0, 31, 1}, {40, 990, 10}
+};
+static const RLCaptureRun_t StepRuns[] = {
+    {9, 100, 1}, {125, 600, 25}, {625, 625, 1}, {688, 688, 1},
+    {750, 750, 1}, {812, 812, 1}, {875, 875, 1}, {937, 937, 1}
+};
+// out of order, and too long
+static const RLCaptureRun_t BadRuns[] = {
+    {10, 20, 1}, {20, 30, 1}
+};
+static const RLCaptureRun_t LongRuns[] = {
+    {0, RL_CAPTURE_TRIGGERS, 1}
+};
+
+// the way T1Handler used to do it, a count down per pending recording
+static int16_t Countdowns[RL_CAPTURE_TRIGGERS];
+static uint16_t NumCountdowns;
+
+static void ScheduleCountdowns(const RLCaptureRun_t *pRuns, uint8_t NumRuns)
+{
+    uint32_t Step;
+    uint8_t i;
+
+    NumCountdowns = 0;
+    for (i = 0; i < NumRuns; i++) {
+        for (Step = pRuns[i].First; Step <= pRuns[i].Last;
+                Step += pRuns[i].Every) {
+            Countdowns[NumCountdowns++] = (int16_t)Step;
+        }
+    }
+}
+
+static bool CountdownIsDue(void)
+{
+    bool Due = false;
+    uint16_t i;
+
+    if ((NumCountdowns > 0) && (Countdowns[0] == 0)) {
+        NumCountdowns--;
+        memmove(&Countdowns[0], &Countdowns[1],
+            NumCountdowns * sizeof(Countdowns[0]));
+        Due = true;
+    }
+    for (i = 0; i < NumCountdowns; i++) {
+        Countdowns[i]--;
+    }
+    return Due;
+}
+
+// steps both for Steps control steps, false on the first difference
+static bool CompareSchedules(const char *pName, uint32_t Steps)
+{
+    uint32_t Step;
+    uint32_t Recordings = 0;
+
+    for (Step = 0; Step < Steps; Step++) {
+        bool Due = RLCapture_IsDue();
+
+        if (Due != CountdownIsDue()) {
+            fprintf(stderr, "rl: %s schedule, step %u: %s\n", pName,
+                (unsigned)Step, Due ? "recorded, not due" : "due, not recorded");
+            return false;
+        }
+        Recordings += Due;
+    }
+    fprintf(stderr, "%s schedule: %u recordings match\n", pName,
+        (unsigned)Recordings);
+    return true;
+}
+
+static bool RunSchedules(void)
+{
+    RLCapture_Init();
+    // a while in, so the steps are not counted from 0
+    CompareSchedules("none", 12345);
+    if (!RLCapture_Schedule(LogRuns, ARRAY_SIZE(LogRuns))) {
+        fprintf(stderr, "rl: log schedule refused\n");
+        return false;
+    }
+    ScheduleCountdowns(LogRuns, ARRAY_SIZE(LogRuns));
+    if (!CompareSchedules("log", 600)) {
+        return false;
+    }
+    // a full one, replaced before the last recording
+    if (!RLCapture_Schedule(BurstRuns, ARRAY_SIZE(BurstRuns))) {
+        fprintf(stderr, "rl: burst schedule refused\n");
+        return false;
+    }
+    ScheduleCountdowns(BurstRuns, ARRAY_SIZE(BurstRuns));
+    if (!CompareSchedules("burst", 900)) {
+        return false;
+    }
+    if (!RLCapture_Schedule(StepRuns, ARRAY_SIZE(StepRuns))) {
+        fprintf(stderr, "rl: step response schedule refused\n");
+        return false;
+    }
+    ScheduleCountdowns(StepRuns, ARRAY_SIZE(StepRuns));
+    if (!CompareSchedules("step response", 1000)) {
+        return false;
+    }
+    if (RLCapture_Schedule(BadRuns, ARRAY_SIZE(BadRuns)) ||
+            RLCapture_Schedule(LongRuns, ARRAY_SIZE(LongRuns))) {
+        fprintf(stderr, "rl: bad schedule taken\n");
+        return false;
+    }
+    NumCountdowns = 0;
+    return CompareSchedules("refused", 1000);
+}
+
+// the values of record Seq, both signs and the ends of the range
+static int16_t ValueOf(uint32_t Seq, uint8_t i)
+{
+    if (i == 0) {
+        return (Seq & 1) ? -32768 : 32767;
+    }
+    return (int16_t)((Seq * 31 + i * 1009) % 65536 - 32768);
+}
+
+static bool WriteRecord(uint32_t Seq)
+{
+    int16_t *pValues = RLCapture_Claim();
+    uint8_t i;
+
+    if (pValues == NULL) {
+        return false;
+    }
+    for (i = 0; i < RL_CAPTURE_VALUES; i++) {
+        pValues[i] = ValueOf(Seq, i);
+    }
+    RLCapture_Commit();
+    return true;
+}
+
+static void RunScript(void)
+{
+    char Line[LINE_LENGTH];
+    uint16_t Length;
+    uint32_t Seq = 0;
+    uint32_t i;
+
+    RLCapture_Init();
+    RLCapture_Start();
+    for (i = 0; i < FIRST_RECORDS; i++) {
+        WriteRecord(Seq++);
+        while (RLCapture_MoveToTerminal()) {
+        }
+    }
+    DB_printf("other output between the lines\r\n");
+    // right length, wrong CRC
+    Length = PutString(Line, "#R 7fff");
+    for (i = 0; i < RL_CAPTURE_VALUES; i++) {
+        Length += PutString(&Line[Length], " 0000");
+    }
+    Length += PutString(&Line[Length], " 0000\r\n");
+    Terminal_Write((const uint8_t *)Line, Length, TERMINAL_TX_DROP);
+    for (i = 0; i < BURST_RECORDS; i++) {
+        WriteRecord(Seq++);
+    }
+    RLCapture_Stop();
+    for (i = 0; i < FIRST_RECORDS; i++) {
+        if (WriteRecord(Seq)) {
+            printf("rl: record taken while the capture is off\r\n");
+        }
+    }
+    while (RLCapture_MoveToTerminal()) {
+    }
+}
+
+static void PrintExpected(void)
+{
+    uint32_t Seq;
+    uint8_t i;
+
+    // fprintf, printf is DB_printf and ends its lines with \r\n
+    for (Seq = 0; Seq < FIRST_RECORDS + RL_CAPTURE_DEPTH; Seq++) {
+        fprintf(stdout, "%u", (unsigned)Seq);
+        for (i = 0; i < RL_CAPTURE_VALUES; i++) {
+            fprintf(stdout, ",%d", ValueOf(Seq, i));
+        }
+        fprintf(stdout, "\n");
+    }
+}
+
+static void RunBench(void)
+{
+    uint64_t Start, WriteNanos, DrainNanos;
+    uint32_t i;
+    FILE *pSaved = stdout;
+
+    RLCapture_Init();
+    RLCapture_Start();
+    WriteNanos = 0;
+    DrainNanos = 0;
+    stdout = fopen("/dev/null", "w");
+    for (i = 0; i < BENCH_RECORDS; i += RL_CAPTURE_DEPTH) {
+        uint32_t j;
+
+        Start = _HW_Host_GetNanos();
+        for (j = 0; j < RL_CAPTURE_DEPTH; j++) {
+            WriteRecord(i + j);
+        }
+        WriteNanos += _HW_Host_GetNanos() - Start;
+        Start = _HW_Host_GetNanos();
+        while (RLCapture_MoveToTerminal()) {
+        }
+        DrainNanos += _HW_Host_GetNanos() - Start;
+    }
+    fclose(stdout);
+    stdout = pSaved;
+    fprintf(stderr, "per record, write %u ns, drain %u ns\n",
+        (unsigned)(WriteNanos / BENCH_RECORDS),
+        (unsigned)(DrainNanos / BENCH_RECORDS));
+
+    // the step response schedule from its start, again and again
+    WriteNanos = 0;
+    DrainNanos = 0;
+    for (i = 0; i < BENCH_RUNS; i++) {
+        uint32_t j;
+
+        RLCapture_Schedule(StepRuns, ARRAY_SIZE(StepRuns));
+        Start = _HW_Host_GetNanos();
+        for (j = 0; j < BENCH_STEPS; j++) {
+            RLCapture_IsDue();
+        }
+        WriteNanos += _HW_Host_GetNanos() - Start;
+        ScheduleCountdowns(StepRuns, ARRAY_SIZE(StepRuns));
+        Start = _HW_Host_GetNanos();
+        for (j = 0; j < BENCH_STEPS; j++) {
+            CountdownIsDue();
+        }
+        DrainNanos += _HW_Host_GetNanos() - Start;
+    }
+    fprintf(stderr, "per control step, schedule %u ns, count down %u ns\n",
+        (unsigned)(WriteNanos / (BENCH_RUNS * BENCH_STEPS)),
+        (unsigned)(DrainNanos / (BENCH_RUNS * BENCH_STEPS)));
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pMode = (argc > 1) ? argv[1] : "script";
+
+    if (strcmp(pMode, "bench") == 0) {
+        RunBench();
+    } else if (strcmp(pMode, "schedule") == 0) {
+        return RunSchedules() ? 0 : 1;
+    } else if (strcmp(pMode, "csv") == 0) {
+        PrintExpected();
+    } else {
+        RunScript();
+    }
+    fflush(stdout);
+    return 0;
+}
+#endif /* TEST_RL_CAPTURE */
+#endif /* RL_MOTOR_LOGGING */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
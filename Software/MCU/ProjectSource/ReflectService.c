@@ -25,6 +25,7 @@
 #include "ReflectService.h"
 #include "ADC_HAL.h"
 #include "dbprintf.h"
+#include "ES_Log.h"
 #include <sys/attribs.h>
 
 /*----------------------------- Module Defines ----------------------------*/
@@ -209,7 +210,7 @@ void __ISR(_ADC_VECTOR, IPL4SRS) ADCHandler(void) {
         ReflectiveResults[1] = ADCDATA37; // fetch the result
         ReflectiveResults[2] = ADCDATA4; // fetch the result
     } else {
-        DB_printf("Some other ADC interrupt is active!\r\n");
+        ES_LOG("Some other ADC interrupt is active!\r\n");
     }
 }
 /*------------------------------- Footnotes -------------------------------*/
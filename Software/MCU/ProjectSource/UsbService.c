@@ -22,12 +22,13 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "ES_DeferRecall.h"
+#include "ES_Pool.h"
+#include "ES_Trace.h"
 #include "ES_Port.h"
 #include "terminal.h"
 #include "dbprintf.h"
 #include "MotorSM.h"
 #include "EEPROMSM.h"
-#include "matt_circular_buffer.h"
 #include "IMU_SM.h"
 /*----------------------------- Module Defines ----------------------------*/
 // these times assume a 10.000mS/tick timing
@@ -44,6 +45,7 @@
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static void PrintServiceStats(void);
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
@@ -52,10 +54,6 @@ static uint8_t MyPriority;
 static ES_Event_t DeferralQueue[3 + 1];
 
 static uint32_t address = 0;
-
-static int16_t circ_buff_array[5];
-static circular_buffer_t cb;  // Buffer for keeping State data
-static int16_t data = 1;
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
@@ -73,9 +71,6 @@ static int16_t data = 1;
 ****************************************************************************/
 bool InitUsbService(uint8_t Priority)
 {
-    
-  circular_buffer_init(&cb, circ_buff_array, 5);
-    
   ES_Event_t ThisEvent;
 
   MyPriority = Priority;
@@ -283,17 +278,6 @@ ES_Event_t RunUsbService(ES_Event_t ThisEvent)
           MultiplyDesiredSpeed(-1);
       }
       
-//      if ('8' == ThisEvent.EventParam) {
-//          int16_t peek_data[5];
-//          uint16_t num = circular_buffer_peek(&cb, peek_data, 5);
-//          uint8_t a = 5;
-//      }
-//      
-//      if ('9' == ThisEvent.EventParam) {
-//          circular_buffer_put(&cb, data);
-//          data += 1;
-//      }
-      
       if ('c' == ThisEvent.EventParam) {
           SetDesiredSpeed(0, 1);
       }
@@ -307,6 +291,21 @@ ES_Event_t RunUsbService(ES_Event_t ThisEvent)
           PostMotorSM(NewEvent);
       }
       
+      if ('t' == ThisEvent.EventParam) {
+          PrintServiceStats();
+      }
+      
+      if ('T' == ThisEvent.EventParam) {
+          ES_ResetServiceStats();
+          ES_PoolResetStats();
+          DB_printf("Service stats reset\r\n");
+      }
+      
+      if ('r' == ThisEvent.EventParam) {
+          // the dump goes out from ES_Run's idle loop, see ES_Trace.c
+          ES_TraceStartDump();
+      }
+      
       if ('y' == ThisEvent.EventParam)
       {
           float roll;
@@ -339,6 +338,50 @@ ES_Event_t RunUsbService(ES_Event_t ThisEvent)
  private functions
  ***************************************************************************/
 
+/****************************************************************************
+ Function
+    PrintServiceStats
+
+ Description
+    Prints the ES_PROFILING numbers for every service, the CPU load and the
+    payload pool use. Run times, and Wait/MaxWait from a post to an empty
+    queue to the run function call, are in core timer counts (10ns), Queue
+    and Pool are high water/size. Merged counts the coalesced posts. The
+    terminal line is the output dropped for lack of transmit buffer room.
+****************************************************************************/
+static void PrintServiceStats(void)
+{
+  ES_ServiceStats_t Stats;
+  ES_PoolStats_t PoolStats;
+  uint16_t IdlePermille = ES_GetIdlePermille();
+  uint8_t i;
+
+  DB_printf("Serv\tCount\tMin\tAvg\tMax\tWait\tMaxWait\tQueue\tFailed"
+      "\tMerged\r\n");
+  for (i = 0; ES_GetServiceStats(i, &Stats); i++)
+  {
+    DB_printf("%s\t%u\t%u\t%u\t%u\t%u\t%u\t%u/%u\t%u\t%u\r\n",
+        ES_GetServiceName(i), Stats.Dispatches, Stats.MinCounts,
+        Stats.AvgCounts, Stats.MaxCounts, Stats.AvgLatency, Stats.MaxLatency,
+        Stats.QueueHighWater, Stats.QueueSize, Stats.FailedPosts,
+        Stats.Coalesced);
+  }
+  if (IdlePermille == ES_IDLE_UNKNOWN)
+  {
+    DB_printf("CPU load: unknown\r\n");
+  }
+  else
+  {
+    DB_printf("CPU load: %u.%u%%\r\n", (1000 - IdlePermille) / 10,
+        (1000 - IdlePermille) % 10);
+  }
+  ES_PoolGetStats(&PoolStats);
+  DB_printf("Pool: %u in use, %u/%u x %u bytes, %u alloc failures\r\n",
+      PoolStats.InUse, PoolStats.HighWater, PoolStats.NumBlocks,
+      PoolStats.BlockSize, PoolStats.AllocFailures);
+  DB_printf("Terminal: %u bytes dropped\r\n", Terminal_GetTxDropped());
+}
+
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
 
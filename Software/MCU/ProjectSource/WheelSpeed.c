@@ -0,0 +1,694 @@
+/****************************************************************************
+ Module
+   WheelSpeed.c
+
+ Description
+   The speed of each wheel from its quadrature encoder, as the one source
+   for the speed loop (a pulse length, which the PID laws turn into RPM)
+   and for the dead reckoning (m/s). MotorSM's edge handlers pass in every
+   edge of both channels with its timer2/3 time.
+
+ Notes
+   Decoding: only the channel with the edge changes level, so the order of
+   the edges gives the direction. Up (01 -> 11 -> 10 -> 00) is an A edge
+   with A != B or a B edge with A == B.
+   Estimate (M/T method): at each edge the speed is M edges over the T
+   ticks from the M-th edge back to this one, both exact. M is the fewest
+   whole lines (4 edges, so the encoder's uneven quarter line spacing
+   cancels) whose T reaches the window. At speed many edges fall in the
+   window and M is large, which averages out edge jitter; at a crawl one
+   line already takes longer than the window and M is 4. The window is the
+   smoothing: longer is quieter and later.
+   Between edges a reader bounds the estimate by the time since the last
+   one, a wheel that has had no edge for well over its edge spacing is
+   turning slower than it was. A slowing wheel is seen at once, not at its
+   next edge.
+   A reversal, or WHEEL_SPEED_STOP_TICKS without an edge, starts the
+   measurement over, until the next edge there is no estimate and the wheel
+   reads as stopped. The time stamps are 32 bits and wrap after 687 s, so a
+   wheel at rest has to be expired (WheelSpeed_Expire) more often than that
+   or its last edge would come round again as a recent one.
+   make -f Makefile.host speed_check runs the estimator against synthetic
+   encoder traces.
+
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "WheelSpeed.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define EDGES_PER_LINE 4
+#define HISTORY_MASK (WHEEL_SPEED_HISTORY - 1)
+
+// the quarters of a line are not evenly spaced, so the time since the last
+// edge bounds the estimate only once it is 5/4 of the mean spacing. From
+// there the estimate is 5/4 of an edge over that time, which meets the
+// measured speed where it takes over
+#define STALE_SPACINGS_NUM 5
+#define STALE_SPACINGS_DEN 4
+
+// m/s for a speed of one edge per timer tick
+#define METERS_PER_SECOND_PER_EDGE_TICK \
+    ((float)(WHEEL_SPEED_METERS_PER_EDGE * WHEEL_SPEED_TIMER_HZ))
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint8_t EstimateAt(const WheelSpeed_t *pSpeed, uint32_t Now,
+    uint32_t *pSpan);
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     WheelSpeed_Init
+
+ Parameters
+     WheelSpeed_t *pSpeed: the wheel's estimator
+     int8_t Sign: +1 if the encoder counts up going forward, -1 if down
+     uint8_t State: the levels of the channels now, WHEEL_SPEED_CHANNEL_A
+         and WHEEL_SPEED_CHANNEL_B
+     uint32_t Window: the shortest time to measure a speed over, timer ticks,
+         WHEEL_SPEED_WINDOW unless there is reason to smooth differently
+
+ Returns
+     None
+
+ Description
+     Starts the wheel at rest, with a count of 0
+****************************************************************************/
+void WheelSpeed_Init(WheelSpeed_t *pSpeed, int8_t Sign, uint8_t State,
+    uint32_t Window)
+{
+    pSpeed->State = State;
+    pSpeed->Sign = Sign;
+    pSpeed->LastStep = 0;
+    pSpeed->Held = 0;
+    pSpeed->Newest = 0;
+    pSpeed->SpanEdges = 0;
+    pSpeed->Span = 0;
+    pSpeed->Window = Window;
+    pSpeed->Count = 0;
+}
+
+/****************************************************************************
+ Function
+     WheelSpeed_Edge
+
+ Parameters
+     WheelSpeed_t *pSpeed: the wheel's estimator
+     uint8_t Channel: WHEEL_SPEED_CHANNEL_A or WHEEL_SPEED_CHANNEL_B
+     uint32_t Time: when the edge was, timer ticks
+
+ Returns
+     None
+
+ Description
+     Decodes one edge, counts it and updates the speed estimate. Called by
+     the channel's edge handler, in the order the edges came
+****************************************************************************/
+void WheelSpeed_Edge(WheelSpeed_t *pSpeed, uint8_t Channel, uint32_t Time)
+{
+    uint8_t Differ = ((pSpeed->State >> 1) ^ pSpeed->State) & 1;
+    int8_t Step = ((Channel == WHEEL_SPEED_CHANNEL_A) == Differ) ?
+        pSpeed->Sign : -pSpeed->Sign;
+    uint8_t Intervals;
+    uint8_t M;
+
+    pSpeed->State ^= Channel;
+    pSpeed->Count += Step;
+
+    // a reversal or a stop starts a new measurement
+    if ((Step != pSpeed->LastStep) || ((pSpeed->Held > 0) &&
+        (Time - pSpeed->EdgeTimes[pSpeed->Newest] >= WHEEL_SPEED_STOP_TICKS))) {
+        pSpeed->LastStep = Step;
+        pSpeed->Held = 0;
+        pSpeed->SpanEdges = 0;
+    }
+
+    pSpeed->Newest = (pSpeed->Newest + 1) & HISTORY_MASK;
+    pSpeed->EdgeTimes[pSpeed->Newest] = Time;
+    if (pSpeed->Held < WHEEL_SPEED_HISTORY) {
+        pSpeed->Held++;
+    }
+    Intervals = pSpeed->Held - 1;
+    if (Intervals == 0) {
+        return;
+    }
+
+    // the fewest whole lines that reach the window, or what there is
+    if (Intervals < EDGES_PER_LINE) {
+        M = Intervals;
+    } else {
+        M = EDGES_PER_LINE;
+        while ((M + EDGES_PER_LINE <= Intervals) &&
+            ((Time - pSpeed->EdgeTimes[(pSpeed->Newest - M) & HISTORY_MASK]) <
+            pSpeed->Window)) {
+            M += EDGES_PER_LINE;
+        }
+    }
+    pSpeed->Span = Time - pSpeed->EdgeTimes[(pSpeed->Newest - M) & HISTORY_MASK];
+    pSpeed->SpanEdges = M;
+}
+
+/****************************************************************************
+ Function
+     WheelSpeed_Expire
+
+ Parameters
+     WheelSpeed_t *pSpeed: the wheel's estimator
+     uint32_t Now: the time now, timer ticks
+
+ Returns
+     None
+
+ Description
+     Ends the measurement of a wheel that has had no edge for
+     WHEEL_SPEED_STOP_TICKS, the next edge starts a new one. Readers see the
+     wheel as stopped from then on anyway, this keeps it so past the wrap of
+     the time stamps. Called at least once a wrap, with the edge handlers
+     held off.
+****************************************************************************/
+void WheelSpeed_Expire(WheelSpeed_t *pSpeed, uint32_t Now)
+{
+    if ((pSpeed->Held > 0) &&
+        (Now - pSpeed->EdgeTimes[pSpeed->Newest] >= WHEEL_SPEED_STOP_TICKS)) {
+        pSpeed->Held = 0;
+        pSpeed->SpanEdges = 0;
+    }
+}
+
+/****************************************************************************
+ Function
+     WheelSpeed_GetPulseLength
+
+ Parameters
+     const WheelSpeed_t *pSpeed: the wheel's estimator
+     uint32_t Now: the time now, timer ticks
+
+ Returns
+     uint32_t ticks per 1/ENCODER_RESOLUTION of a turn, WHEEL_SPEED_STOPPED
+         for a wheel at rest. Either direction.
+
+ Description
+     The speed for the speed loop, in the form the PID laws take it
+****************************************************************************/
+uint32_t WheelSpeed_GetPulseLength(const WheelSpeed_t *pSpeed, uint32_t Now)
+{
+    uint32_t Span;
+    uint8_t Edges = EstimateAt(pSpeed, Now, &Span);
+
+    if (Edges == 0) {
+        return WHEEL_SPEED_STOPPED;
+    }
+    return Span * EDGES_PER_PULSE / Edges;
+}
+
+/****************************************************************************
+ Function
+     WheelSpeed_GetMetersPerSecond
+
+ Parameters
+     const WheelSpeed_t *pSpeed: the wheel's estimator
+     uint32_t Now: the time now, timer ticks
+
+ Returns
+     float the speed of the wheel's rim, m/s, negative going backward
+
+ Description
+     The same estimate as WheelSpeed_GetPulseLength, for the dead reckoning
+****************************************************************************/
+float WheelSpeed_GetMetersPerSecond(const WheelSpeed_t *pSpeed, uint32_t Now)
+{
+    uint32_t Span;
+    uint8_t Edges = EstimateAt(pSpeed, Now, &Span);
+
+    if (Edges == 0) {
+        return 0;
+    }
+    return pSpeed->LastStep * METERS_PER_SECOND_PER_EDGE_TICK * Edges / Span;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// the estimate as it stands at Now, returns its edges (0 for none) and
+// puts the ticks they took in *pSpan
+static uint8_t EstimateAt(const WheelSpeed_t *pSpeed, uint32_t Now,
+    uint32_t *pSpan)
+{
+    uint32_t SinceEdge;
+
+    if (pSpeed->SpanEdges == 0) {
+        return 0;
+    }
+    SinceEdge = Now - pSpeed->EdgeTimes[pSpeed->Newest];
+    // stopped, which also keeps the products below from overflowing
+    if (SinceEdge >= WHEEL_SPEED_STOP_TICKS) {
+        return 0;
+    }
+    if (((int32_t)SinceEdge > 0) && (STALE_SPACINGS_DEN * SinceEdge *
+        pSpeed->SpanEdges > STALE_SPACINGS_NUM * pSpeed->Span)) {
+        *pSpan = STALE_SPACINGS_DEN * SinceEdge;
+        return STALE_SPACINGS_NUM;
+    }
+    // two edges in the same tick
+    *pSpan = (pSpeed->Span > 0) ? pSpeed->Span : 1;
+    return pSpeed->SpanEdges;
+}
+
+#ifdef TEST_WHEEL_SPEED
+/* Estimator harness (make -f Makefile.host speed_check).
+   Generates encoder edge traces from speed profiles, with the flaws of a
+   real encoder: lines not quite evenly spaced around the disk, channel A
+   not quite 50% duty, B not quite a quarter line behind it, and up to
+   10 us of interrupt latency on the B edges that come in through change
+   notice (A edges are hardware captures). Every edge goes to:
+     legacy   the estimate this replaced, every 4th rising edge of A
+              (every one for MOTOR_TYPE 1) through the 0.8/0.2 filter, and
+              stopped by the 0.34 s no speed timers it had
+     M/T      this module, with windows of one line (0), the default and
+              4 times the default
+   Each is read every control period and compared with the true speed:
+   RMS error over the steady part of the cruise profiles, and how long
+   after a change ends it takes to get within 5% (0.5 RPM near 0) and
+   stay there. The time stamps wrap through 0 half a second into each
+   trace. Fails if the default window is not within 1% at cruise, 5% at a
+   crawl, if it settles later than legacy, if its count of edges is off, if
+   its pulse length and m/s disagree, or if a stopped wheel reads as moving
+   once the time stamps come round again. Then the cost of
+   WheelSpeed_Edge and a read. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ES_Port.h"
+
+#define SAMPLE_TICKS    10000u  // read at the control rate, 625 Hz
+#define STEP_SECONDS    5e-6    // trace generator time step
+#define NO_SPEED_TICKS  (65536u * 256u / 8u) // legacy Timer4/5 period
+#define LINES_PER_REV   (ENCODER_EDGES_PER_REV / 4)
+#define LEGACY_RISING   (LINES_PER_REV / ENCODER_RESOLUTION)
+#define A_DUTY_ERROR    0.03    // line fraction
+#define B_PHASE_ERROR   0.04
+#define LINE_ERROR      0.02    // line fraction, each line's own, at most
+#define B_LATENCY       64u     // ticks, at most (about 10 us)
+#define TIMING_PASSES   20u
+#define TICK_BASE       (0u - 3125000u) // the time stamps wrap 0.5 s in
+#define MAX_EDGES       40000u
+#define NUM_ESTIMATORS  4
+#define MT_DEFAULT      2       // the M/T estimator with the default window
+
+typedef struct
+{
+    const char *pName;
+    double Duration;  // s
+    double From, To;  // wheel RPM
+    double At;        // s, when the change starts
+    double Accel;     // RPM/s
+    bool Cruise;      // RMS error is the figure, not settling time
+} Profile_t;
+
+typedef struct
+{
+    uint32_t PulseLength;
+    uint32_t PrevTime;
+    uint32_t LastCapture;
+    uint32_t Rising;
+    int8_t Dir;
+} Legacy_t;
+
+typedef struct
+{
+    double SquareSum;
+    uint32_t Samples;
+    double LastOut; // s, the last read out of tolerance after the change
+} Result_t;
+
+static const Profile_t Profiles[] =
+{
+#if (MOTOR_TYPE==1)
+    { "cruise 300",     1.5, 300, 300, 0, 0, true },
+#else
+    { "cruise 100",     1.5, 100, 100, 0, 0, true },
+#endif
+    { "cruise 30",      1.5, 30, 30, 0, 0, true },
+    { "crawl 2",        3.0, 2, 2, 0, 0, true },
+    { "step 5-60",      1.0, 5, 60, 0.5, 2000, false },
+    { "stop 60-0",      1.5, 60, 0, 0.5, 2000, false },
+    { "reverse 30",     1.5, 30, -30, 0.5, 2000, false },
+};
+#define NUM_PROFILES (sizeof(Profiles) / sizeof(Profiles[0]))
+
+static const char *EstimatorNames[NUM_ESTIMATORS] =
+{
+    "legacy", "M/T 1 line", "M/T default", "M/T 4x window"
+};
+static const uint32_t Windows[NUM_ESTIMATORS] =
+{
+    0, 0, WHEEL_SPEED_WINDOW, 4 * WHEEL_SPEED_WINDOW
+};
+
+static Legacy_t Legacy;
+static WheelSpeed_t Speeds[NUM_ESTIMATORS];
+static Result_t Results[NUM_ESTIMATORS];
+static uint8_t TrueState;
+static int32_t TrueCount;
+static bool Failed;
+
+static double LineErrors[LINES_PER_REV];
+static uint32_t EdgeTicks[MAX_EDGES];
+static uint8_t EdgeChannels[MAX_EDGES];
+static uint32_t NumEdges;
+static volatile uint32_t Sink; // keeps the optimizer honest
+
+static double SpeedAt(const Profile_t *pProfile, double T)
+{
+    double Change = pProfile->To - pProfile->From;
+    double Ramp = (pProfile->Accel > 0) ? fabs(Change) / pProfile->Accel : 0;
+
+    if (T <= pProfile->At) {
+        return pProfile->From;
+    }
+    if (T >= pProfile->At + Ramp) {
+        return pProfile->To;
+    }
+    return pProfile->From + Change * (T - pProfile->At) / Ramp;
+}
+
+// where edge q is, in lines. Quarter q % 4: 0 A rises, 1 B falls, 2 A
+// falls, 3 B rises (going up)
+static double EdgePosition(int32_t q)
+{
+    static const double Offsets[4] = {
+        0, 0.25 + B_PHASE_ERROR, 0.5 + A_DUTY_ERROR, 0.75 + B_PHASE_ERROR
+    };
+    int32_t Line = (q >= 0) ? q / 4 : -((-q + 3) / 4);
+    int32_t Slot = ((Line % LINES_PER_REV) + LINES_PER_REV) % LINES_PER_REV;
+
+    return Line + Offsets[q - Line * 4] + LineErrors[Slot];
+}
+
+static double WheelRPM(uint32_t PulseLength)
+{
+    if (PulseLength == WHEEL_SPEED_STOPPED) {
+        return 0;
+    }
+    return 60.0 * WHEEL_SPEED_TIMER_HZ / ((double)PulseLength *
+        ENCODER_RESOLUTION);
+}
+
+static void LegacyEdge(uint8_t Channel, uint32_t Tick)
+{
+    uint32_t Current;
+
+    // the capture is on A rising, B is read from its pin then
+    if ((Channel != WHEEL_SPEED_CHANNEL_A) ||
+        !(TrueState & WHEEL_SPEED_CHANNEL_A)) {
+        return;
+    }
+    if ((++Legacy.Rising % LEGACY_RISING) != 0) {
+        return;
+    }
+    Current = Tick - Legacy.PrevTime;
+    Legacy.PulseLength = (uint32_t)(0.8*Current + 0.2*Legacy.PulseLength);
+    Legacy.PrevTime = Tick;
+    Legacy.LastCapture = Tick;
+    Legacy.Dir = (TrueState & WHEEL_SPEED_CHANNEL_B) ? 1 : -1;
+}
+
+static double LegacyRPM(uint32_t Now)
+{
+    if (Now - Legacy.LastCapture >= NO_SPEED_TICKS) {
+        Legacy.PulseLength = WHEEL_SPEED_STOPPED; // its no speed timer
+    }
+    return Legacy.Dir * WheelRPM(Legacy.PulseLength);
+}
+
+static void Edge(uint8_t Channel, uint32_t Tick)
+{
+    uint8_t i;
+
+    TrueState ^= Channel;
+    LegacyEdge(Channel, Tick);
+    for (i = 1; i < NUM_ESTIMATORS; i++) {
+        WheelSpeed_Edge(&Speeds[i], Channel, Tick);
+    }
+    if (NumEdges < MAX_EDGES) {
+        EdgeTicks[NumEdges] = Tick;
+        EdgeChannels[NumEdges] = Channel;
+        NumEdges++;
+    }
+}
+
+static void Sample(const Profile_t *pProfile, double T, uint32_t Now)
+{
+    double True = SpeedAt(pProfile, T);
+    double Ramp = (pProfile->Accel > 0) ?
+        fabs(pProfile->To - pProfile->From) / pProfile->Accel : 0;
+    double Tolerance = fmax(0.05 * fabs(True), 0.5);
+    uint8_t i;
+
+    for (i = 0; i < NUM_ESTIMATORS; i++) {
+        double Estimate;
+
+        if (i == 0) {
+            Estimate = LegacyRPM(Now);
+        } else {
+            uint32_t Pulse = WheelSpeed_GetPulseLength(&Speeds[i], Now);
+            float MPS = WheelSpeed_GetMetersPerSecond(&Speeds[i], Now);
+
+            Estimate = MPS / (2 * M_PI * WHEEL_RADIUS) * 60;
+            // one estimate, two units
+            if (fabs(fabs(Estimate) - WheelRPM(Pulse)) >
+                1e-3 * fabs(Estimate) + 1e-3) {
+                printf("speed: %s pulse length %u and %.4f m/s disagree\r\n",
+                    EstimatorNames[i], (unsigned)Pulse, MPS);
+                Failed = true;
+            }
+        }
+        if (pProfile->Cruise) {
+            if (T >= 0.5) {
+                Results[i].SquareSum += (Estimate - True) * (Estimate - True);
+                Results[i].Samples++;
+            }
+        } else if ((T >= pProfile->At + Ramp) &&
+            (fabs(Estimate - True) > Tolerance)) {
+            Results[i].LastOut = T;
+        }
+    }
+}
+
+// runs one profile through every estimator from rest, edges and reads in
+// time order
+static void RunProfile(const Profile_t *pProfile)
+{
+    double Lines = 0.1;
+    double Speed = pProfile->From;
+    double T = 0;
+    uint32_t NextSample = SAMPLE_TICKS;
+    int32_t Up = 1; // the next edge going up, EdgePosition(Up) > Lines
+    uint8_t i;
+
+    TrueState = WHEEL_SPEED_CHANNEL_A | WHEEL_SPEED_CHANNEL_B;
+    TrueCount = 0;
+    NumEdges = 0;
+    memset(&Legacy, 0, sizeof(Legacy));
+    Legacy.PulseLength = WHEEL_SPEED_STOPPED;
+    Legacy.PrevTime = TICK_BASE;
+    Legacy.LastCapture = TICK_BASE;
+    for (i = 1; i < NUM_ESTIMATORS; i++) {
+        WheelSpeed_Init(&Speeds[i], 1, TrueState, Windows[i]);
+    }
+    memset(Results, 0, sizeof(Results));
+    srand(7);
+
+    while (T < pProfile->Duration) {
+        double Next = SpeedAt(pProfile, T + STEP_SECONDS);
+        double Travel = (Speed + Next) / 2 / 60 * LINES_PER_REV * STEP_SECONDS;
+        double End = Lines + Travel;
+        uint32_t EndTick = (uint32_t)((T + STEP_SECONDS) * WHEEL_SPEED_TIMER_HZ);
+
+        for (;;) {
+            int32_t q;
+            double Position, Fraction;
+            uint32_t Tick;
+            uint8_t Channel;
+
+            if ((Travel > 0) && (EdgePosition(Up) <= End)) {
+                q = Up++;
+                TrueCount++;
+            } else if ((Travel < 0) && (EdgePosition(Up - 1) > End)) {
+                q = --Up;
+                TrueCount--;
+            } else {
+                break;
+            }
+            Position = EdgePosition(q);
+            Fraction = (Position - Lines) / Travel;
+            Tick = (uint32_t)((T + Fraction * STEP_SECONDS) *
+                WHEEL_SPEED_TIMER_HZ);
+            Channel = (((q % 4) + 4) % 2) ? WHEEL_SPEED_CHANNEL_B :
+                WHEEL_SPEED_CHANNEL_A;
+            if (Channel == WHEEL_SPEED_CHANNEL_B) {
+                Tick += (uint32_t)(rand() % B_LATENCY);
+            }
+            while ((int32_t)(Tick - NextSample) >= 0) {
+                Sample(pProfile, NextSample / (double)WHEEL_SPEED_TIMER_HZ,
+                    TICK_BASE + NextSample);
+                NextSample += SAMPLE_TICKS;
+            }
+            Edge(Channel, TICK_BASE + Tick);
+        }
+        while ((int32_t)(EndTick - NextSample) >= 0) {
+            Sample(pProfile, NextSample / (double)WHEEL_SPEED_TIMER_HZ,
+                TICK_BASE + NextSample);
+            NextSample += SAMPLE_TICKS;
+        }
+        Lines = End;
+        Speed = Next;
+        T += STEP_SECONDS;
+    }
+
+    for (i = 1; i < NUM_ESTIMATORS; i++) {
+        if (Speeds[i].Count != TrueCount) {
+            printf("speed: %s counted %d edges, not %d\r\n", EstimatorNames[i],
+                (int)Speeds[i].Count, (int)TrueCount);
+            Failed = true;
+        }
+    }
+}
+
+// a wheel at rest past the wrap of the time stamps reads as stopped once
+// expired, and not as the speed it had at its last edge
+static void CheckWrap(void)
+{
+    WheelSpeed_t Speed;
+    uint32_t Time = 0;
+    uint8_t i;
+
+    // forward from 11 is B, A, B, A
+    WheelSpeed_Init(&Speed, 1, WHEEL_SPEED_CHANNEL_A | WHEEL_SPEED_CHANNEL_B,
+        WHEEL_SPEED_WINDOW);
+    for (i = 0; i < 8; i++) {
+        Time += 1000;
+        WheelSpeed_Edge(&Speed, (i & 1) ? WHEEL_SPEED_CHANNEL_A :
+            WHEEL_SPEED_CHANNEL_B, Time);
+    }
+    if (WheelSpeed_GetPulseLength(&Speed, Time) != 1000 * EDGES_PER_PULSE) {
+        printf("speed: %u ticks per pulse, not %u\r\n",
+            (unsigned)WheelSpeed_GetPulseLength(&Speed, Time),
+            1000u * EDGES_PER_PULSE);
+        Failed = true;
+    }
+    WheelSpeed_Expire(&Speed, Time + WHEEL_SPEED_STOP_TICKS);
+    if (WheelSpeed_GetPulseLength(&Speed, Time + 100) != WHEEL_SPEED_STOPPED) {
+        printf("speed: an expired wheel reads as moving after the wrap\r\n");
+        Failed = true;
+    }
+}
+
+static void TimeEstimator(void)
+{
+    WheelSpeed_t Speed;
+    uint32_t Start, EdgeTime, ReadTime;
+    uint32_t i, Pass;
+
+    // the edges of the first profile, the fastest
+    RunProfile(&Profiles[0]);
+
+    EdgeTime = 0;
+    for (Pass = 0; Pass < TIMING_PASSES; Pass++) {
+        WheelSpeed_Init(&Speed, 1, WHEEL_SPEED_CHANNEL_A |
+            WHEEL_SPEED_CHANNEL_B, WHEEL_SPEED_WINDOW);
+        Start = ES_GetBenchCount();
+        for (i = 0; i < NumEdges; i++) {
+            WheelSpeed_Edge(&Speed, EdgeChannels[i], EdgeTicks[i]);
+        }
+        EdgeTime += ES_GetBenchCount() - Start;
+        Sink += Speed.Count;
+    }
+
+    Start = ES_GetBenchCount();
+    for (Pass = 0; Pass < TIMING_PASSES; Pass++) {
+        for (i = 0; i < NumEdges; i++) {
+            Sink += WheelSpeed_GetPulseLength(&Speed, EdgeTicks[i]);
+        }
+    }
+    ReadTime = ES_GetBenchCount() - Start;
+
+    printf("WheelSpeed_Edge: %.1f %s, WheelSpeed_GetPulseLength: %.1f %s\r\n",
+        (double)EdgeTime / (TIMING_PASSES * NumEdges), ES_BENCH_COUNT_UNITS,
+        (double)ReadTime / (TIMING_PASSES * NumEdges), ES_BENCH_COUNT_UNITS);
+}
+
+int main(void)
+{
+    double Figures[NUM_ESTIMATORS][NUM_PROFILES];
+    uint32_t p;
+    uint8_t i;
+
+    srand(3);
+    for (p = 0; p < LINES_PER_REV; p++) {
+        LineErrors[p] = LINE_ERROR * (2.0 * rand() / RAND_MAX - 1);
+    }
+
+    printf("%-14s", "estimator");
+    for (p = 0; p < NUM_PROFILES; p++) {
+        printf(" %11s", Profiles[p].pName);
+    }
+    printf("\r\n%-14s", "");
+    for (p = 0; p < NUM_PROFILES; p++) {
+        printf(" %11s", Profiles[p].Cruise ? "rms %" : "settle ms");
+    }
+    printf("\r\n");
+
+    for (p = 0; p < NUM_PROFILES; p++) {
+        const Profile_t *pProfile = &Profiles[p];
+        double Ramp = (pProfile->Accel > 0) ?
+            fabs(pProfile->To - pProfile->From) / pProfile->Accel : 0;
+
+        RunProfile(pProfile);
+        for (i = 0; i < NUM_ESTIMATORS; i++) {
+            if (pProfile->Cruise) {
+                Figures[i][p] = 100 * sqrt(Results[i].SquareSum /
+                    Results[i].Samples) / fabs(pProfile->To);
+            } else if (Results[i].LastOut > 0) {
+                // settled at the read after the last one out
+                Figures[i][p] = (Results[i].LastOut - pProfile->At - Ramp) *
+                    1000 + SAMPLE_TICKS * 1000.0 / WHEEL_SPEED_TIMER_HZ;
+            } else {
+                Figures[i][p] = 0;
+            }
+        }
+        if (pProfile->Cruise && (Figures[MT_DEFAULT][p] >
+            ((fabs(pProfile->To) >= 20) ? 1.0 : 5.0))) {
+            printf("speed: %s is %.2f%% off at the default window\r\n",
+                pProfile->pName, Figures[MT_DEFAULT][p]);
+            Failed = true;
+        }
+        if (!pProfile->Cruise && (Figures[MT_DEFAULT][p] > Figures[0][p])) {
+            printf("speed: %s settles later than legacy\r\n", pProfile->pName);
+            Failed = true;
+        }
+    }
+
+    for (i = 0; i < NUM_ESTIMATORS; i++) {
+        printf("%-14s", EstimatorNames[i]);
+        for (p = 0; p < NUM_PROFILES; p++) {
+            printf(" %11.2f", Figures[i][p]);
+        }
+        printf("\r\n");
+    }
+
+    CheckWrap();
+    TimeEstimator();
+
+    if (Failed) {
+        printf("speed: FAILED\r\n");
+        return 1;
+    }
+    printf("speed: estimator checks passed\r\n");
+    return 0;
+}
+#endif /* TEST_WHEEL_SPEED */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=FrameworkSource/ES_CheckEvents.c FrameworkSource/ES_DeferRecall.c FrameworkSource/ES_Framework.c FrameworkSource/ES_LookupTables.c FrameworkSource/ES_Port.c FrameworkSource/ES_PostList.c FrameworkSource/ES_Queue.c FrameworkSource/ES_Timers.c FrameworkSource/terminal.c FrameworkSource/circular_buffer_no_modulo_threadsafe.c FrameworkSource/dbprintf.c ProjectSource/EventCheckers.c ProjectSource/main.c ProjectSource/IMU_SM.c ProjectSource/UsbService.c ProjectSource/MotorSM.c ProjectSource/JetsonSM.c ProjectSource/Button1DebouncerSM.c ProjectSource/Button2DebouncerSM.c ProjectSource/Button3DebouncerSM.c ProjectSource/LEDService.c ProjectSource/EEPROMSM.c ProjectSource/ReflectService.c ProjectSource/ADC_HAL.c ProjectSource/matt_circular_buffer.c
+SOURCEFILES_QUOTED_IF_SPACED=FrameworkSource/ES_CheckEvents.c FrameworkSource/ES_DeferRecall.c FrameworkSource/ES_Framework.c FrameworkSource/ES_Hsm.c FrameworkSource/ES_Log.c FrameworkSource/ES_LookupTables.c FrameworkSource/ES_Pool.c FrameworkSource/ES_Port.c FrameworkSource/ES_PostList.c FrameworkSource/ES_Queue.c FrameworkSource/ES_Ring.c FrameworkSource/ES_Snapshot.c FrameworkSource/ES_Timers.c FrameworkSource/ES_Trace.c FrameworkSource/terminal.c FrameworkSource/dbprintf.c ProjectSource/EventCheckers.c ProjectSource/main.c ProjectSource/IMU_SM.c ProjectSource/UsbService.c ProjectSource/MotorSM.c ProjectSource/MotorControl.c ProjectSource/MotorPWM.c ProjectSource/RLCapture.c ProjectSource/WheelSpeed.c ProjectSource/FastMath.c ProjectSource/JetsonSM.c ProjectSource/Button1DebouncerSM.c ProjectSource/Button2DebouncerSM.c ProjectSource/Button3DebouncerSM.c ProjectSource/LEDService.c ProjectSource/EEPROMSM.c ProjectSource/ReflectService.c ProjectSource/ADC_HAL.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o ${OBJECTDIR}/FrameworkSource/ES_DeferRecall.o ${OBJECTDIR}/FrameworkSource/ES_Framework.o ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o ${OBJECTDIR}/FrameworkSource/ES_Port.o ${OBJECTDIR}/FrameworkSource/ES_PostList.o ${OBJECTDIR}/FrameworkSource/ES_Queue.o ${OBJECTDIR}/FrameworkSource/ES_Timers.o ${OBJECTDIR}/FrameworkSource/terminal.o ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o ${OBJECTDIR}/FrameworkSource/dbprintf.o ${OBJECTDIR}/ProjectSource/EventCheckers.o ${OBJECTDIR}/ProjectSource/main.o ${OBJECTDIR}/ProjectSource/IMU_SM.o ${OBJECTDIR}/ProjectSource/UsbService.o ${OBJECTDIR}/ProjectSource/MotorSM.o ${OBJECTDIR}/ProjectSource/JetsonSM.o ${OBJECTDIR}/ProjectSource/Button1DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button2DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button3DebouncerSM.o ${OBJECTDIR}/ProjectSource/LEDService.o ${OBJECTDIR}/ProjectSource/EEPROMSM.o ${OBJECTDIR}/ProjectSource/ReflectService.o ${OBJECTDIR}/ProjectSource/ADC_HAL.o ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o.d ${OBJECTDIR}/FrameworkSource/ES_DeferRecall.o.d ${OBJECTDIR}/FrameworkSource/ES_Framework.o.d ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o.d ${OBJECTDIR}/FrameworkSource/ES_Port.o.d ${OBJECTDIR}/FrameworkSource/ES_PostList.o.d ${OBJECTDIR}/FrameworkSource/ES_Queue.o.d ${OBJECTDIR}/FrameworkSource/ES_Timers.o.d ${OBJECTDIR}/FrameworkSource/terminal.o.d ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o.d ${OBJECTDIR}/FrameworkSource/dbprintf.o.d ${OBJECTDIR}/ProjectSource/EventCheckers.o.d ${OBJECTDIR}/ProjectSource/main.o.d ${OBJECTDIR}/ProjectSource/IMU_SM.o.d ${OBJECTDIR}/ProjectSource/UsbService.o.d ${OBJECTDIR}/ProjectSource/MotorSM.o.d ${OBJECTDIR}/ProjectSource/JetsonSM.o.d ${OBJECTDIR}/ProjectSource/Button1DebouncerSM.o.d ${OBJECTDIR}/ProjectSource/Button2DebouncerSM.o.d ${OBJECTDIR}/ProjectSource/Button3DebouncerSM.o.d ${OBJECTDIR}/ProjectSource/LEDService.o.d ${OBJECTDIR}/ProjectSource/EEPROMSM.o.d ${OBJECTDIR}/ProjectSource/ReflectService.o.d ${OBJECTDIR}/ProjectSource/ADC_HAL.o.d ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o ${OBJECTDIR}/FrameworkSource/ES_DeferRecall.o ${OBJECTDIR}/FrameworkSource/ES_Framework.o ${OBJECTDIR}/FrameworkSource/ES_Hsm.o ${OBJECTDIR}/FrameworkSource/ES_Log.o ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o ${OBJECTDIR}/FrameworkSource/ES_Pool.o ${OBJECTDIR}/FrameworkSource/ES_Port.o ${OBJECTDIR}/FrameworkSource/ES_PostList.o ${OBJECTDIR}/FrameworkSource/ES_Queue.o ${OBJECTDIR}/FrameworkSource/ES_Ring.o ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o ${OBJECTDIR}/FrameworkSource/ES_Timers.o ${OBJECTDIR}/FrameworkSource/ES_Trace.o ${OBJECTDIR}/FrameworkSource/terminal.o ${OBJECTDIR}/FrameworkSource/dbprintf.o ${OBJECTDIR}/ProjectSource/EventCheckers.o ${OBJECTDIR}/ProjectSource/main.o ${OBJECTDIR}/ProjectSource/IMU_SM.o ${OBJECTDIR}/ProjectSource/UsbService.o ${OBJECTDIR}/ProjectSource/MotorSM.o ${OBJECTDIR}/ProjectSource/MotorControl.o ${OBJECTDIR}/ProjectSource/MotorPWM.o ${OBJECTDIR}/ProjectSource/RLCapture.o ${OBJECTDIR}/ProjectSource/WheelSpeed.o ${OBJECTDIR}/ProjectSource/FastMath.o ${OBJECTDIR}/ProjectSource/JetsonSM.o ${OBJECTDIR}/ProjectSource/Button1DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button2DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button3DebouncerSM.o ${OBJECTDIR}/ProjectSource/LEDService.o ${OBJECTDIR}/ProjectSource/EEPROMSM.o ${OBJECTDIR}/ProjectSource/ReflectService.o ${OBJECTDIR}/ProjectSource/ADC_HAL.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o.d ${OBJECTDIR}/FrameworkSource/ES_DeferRecall.o.d ${OBJECTDIR}/FrameworkSource/ES_Framework.o.d ${OBJECTDIR}/FrameworkSource/ES_Hsm.o.d ${OBJECTDIR}/FrameworkSource/ES_Log.o.d ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o.d ${OBJECTDIR}/FrameworkSource/ES_Pool.o.d ${OBJECTDIR}/FrameworkSource/ES_Port.o.d ${OBJECTDIR}/FrameworkSource/ES_PostList.o.d ${OBJECTDIR}/FrameworkSource/ES_Queue.o.d ${OBJECTDIR}/FrameworkSource/ES_Ring.o.d ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o.d ${OBJECTDIR}/FrameworkSource/ES_Timers.o.d ${OBJECTDIR}/FrameworkSource/ES_Trace.o.d ${OBJECTDIR}/FrameworkSource/terminal.o.d ${OBJECTDIR}/FrameworkSource/dbprintf.o.d ${OBJECTDIR}/ProjectSource/EventCheckers.o.d ${OBJECTDIR}/ProjectSource/main.o.d ${OBJECTDIR}/ProjectSource/IMU_SM.o.d ${OBJECTDIR}/ProjectSource/UsbService.o.d ${OBJECTDIR}/ProjectSource/MotorSM.o.d ${OBJECTDIR}/ProjectSource/MotorControl.o.d ${OBJECTDIR}/ProjectSource/MotorPWM.o.d ${OBJECTDIR}/ProjectSource/RLCapture.o.d ${OBJECTDIR}/ProjectSource/WheelSpeed.o.d ${OBJECTDIR}/ProjectSource/FastMath.o.d ${OBJECTDIR}/ProjectSource/JetsonSM.o.d ${OBJECTDIR}/ProjectSource/Button1DebouncerSM.o.d ${OBJECTDIR}/ProjectSource/Button2DebouncerSM.o.d ${OBJECTDIR}/ProjectSource/Button3DebouncerSM.o.d ${OBJECTDIR}/ProjectSource/LEDService.o.d ${OBJECTDIR}/ProjectSource/EEPROMSM.o.d ${OBJECTDIR}/ProjectSource/ReflectService.o.d ${OBJECTDIR}/ProjectSource/ADC_HAL.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o ${OBJECTDIR}/FrameworkSource/ES_DeferRecall.o ${OBJECTDIR}/FrameworkSource/ES_Framework.o ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o ${OBJECTDIR}/FrameworkSource/ES_Port.o ${OBJECTDIR}/FrameworkSource/ES_PostList.o ${OBJECTDIR}/FrameworkSource/ES_Queue.o ${OBJECTDIR}/FrameworkSource/ES_Timers.o ${OBJECTDIR}/FrameworkSource/terminal.o ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o ${OBJECTDIR}/FrameworkSource/dbprintf.o ${OBJECTDIR}/ProjectSource/EventCheckers.o ${OBJECTDIR}/ProjectSource/main.o ${OBJECTDIR}/ProjectSource/IMU_SM.o ${OBJECTDIR}/ProjectSource/UsbService.o ${OBJECTDIR}/ProjectSource/MotorSM.o ${OBJECTDIR}/ProjectSource/JetsonSM.o ${OBJECTDIR}/ProjectSource/Button1DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button2DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button3DebouncerSM.o ${OBJECTDIR}/ProjectSource/LEDService.o ${OBJECTDIR}/ProjectSource/EEPROMSM.o ${OBJECTDIR}/ProjectSource/ReflectService.o ${OBJECTDIR}/ProjectSource/ADC_HAL.o ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o
+OBJECTFILES=${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o ${OBJECTDIR}/FrameworkSource/ES_DeferRecall.o ${OBJECTDIR}/FrameworkSource/ES_Framework.o ${OBJECTDIR}/FrameworkSource/ES_Hsm.o ${OBJECTDIR}/FrameworkSource/ES_Log.o ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o ${OBJECTDIR}/FrameworkSource/ES_Pool.o ${OBJECTDIR}/FrameworkSource/ES_Port.o ${OBJECTDIR}/FrameworkSource/ES_PostList.o ${OBJECTDIR}/FrameworkSource/ES_Queue.o ${OBJECTDIR}/FrameworkSource/ES_Ring.o ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o ${OBJECTDIR}/FrameworkSource/ES_Timers.o ${OBJECTDIR}/FrameworkSource/ES_Trace.o ${OBJECTDIR}/FrameworkSource/terminal.o ${OBJECTDIR}/FrameworkSource/dbprintf.o ${OBJECTDIR}/ProjectSource/EventCheckers.o ${OBJECTDIR}/ProjectSource/main.o ${OBJECTDIR}/ProjectSource/IMU_SM.o ${OBJECTDIR}/ProjectSource/UsbService.o ${OBJECTDIR}/ProjectSource/MotorSM.o ${OBJECTDIR}/ProjectSource/MotorControl.o ${OBJECTDIR}/ProjectSource/MotorPWM.o ${OBJECTDIR}/ProjectSource/RLCapture.o ${OBJECTDIR}/ProjectSource/WheelSpeed.o ${OBJECTDIR}/ProjectSource/FastMath.o ${OBJECTDIR}/ProjectSource/JetsonSM.o ${OBJECTDIR}/ProjectSource/Button1DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button2DebouncerSM.o ${OBJECTDIR}/ProjectSource/Button3DebouncerSM.o ${OBJECTDIR}/ProjectSource/LEDService.o ${OBJECTDIR}/ProjectSource/EEPROMSM.o ${OBJECTDIR}/ProjectSource/ReflectService.o ${OBJECTDIR}/ProjectSource/ADC_HAL.o
 
 # Source Files
-SOURCEFILES=FrameworkSource/ES_CheckEvents.c FrameworkSource/ES_DeferRecall.c FrameworkSource/ES_Framework.c FrameworkSource/ES_LookupTables.c FrameworkSource/ES_Port.c FrameworkSource/ES_PostList.c FrameworkSource/ES_Queue.c FrameworkSource/ES_Timers.c FrameworkSource/terminal.c FrameworkSource/circular_buffer_no_modulo_threadsafe.c FrameworkSource/dbprintf.c ProjectSource/EventCheckers.c ProjectSource/main.c ProjectSource/IMU_SM.c ProjectSource/UsbService.c ProjectSource/MotorSM.c ProjectSource/JetsonSM.c ProjectSource/Button1DebouncerSM.c ProjectSource/Button2DebouncerSM.c ProjectSource/Button3DebouncerSM.c ProjectSource/LEDService.c ProjectSource/EEPROMSM.c ProjectSource/ReflectService.c ProjectSource/ADC_HAL.c ProjectSource/matt_circular_buffer.c
+SOURCEFILES=FrameworkSource/ES_CheckEvents.c FrameworkSource/ES_DeferRecall.c FrameworkSource/ES_Framework.c FrameworkSource/ES_Hsm.c FrameworkSource/ES_Log.c FrameworkSource/ES_LookupTables.c FrameworkSource/ES_Pool.c FrameworkSource/ES_Port.c FrameworkSource/ES_PostList.c FrameworkSource/ES_Queue.c FrameworkSource/ES_Ring.c FrameworkSource/ES_Snapshot.c FrameworkSource/ES_Timers.c FrameworkSource/ES_Trace.c FrameworkSource/terminal.c FrameworkSource/dbprintf.c ProjectSource/EventCheckers.c ProjectSource/main.c ProjectSource/IMU_SM.c ProjectSource/UsbService.c ProjectSource/MotorSM.c ProjectSource/MotorControl.c ProjectSource/MotorPWM.c ProjectSource/RLCapture.c ProjectSource/WheelSpeed.c ProjectSource/FastMath.c ProjectSource/JetsonSM.c ProjectSource/Button1DebouncerSM.c ProjectSource/Button2DebouncerSM.c ProjectSource/Button3DebouncerSM.c ProjectSource/LEDService.c ProjectSource/EEPROMSM.c ProjectSource/ReflectService.c ProjectSource/ADC_HAL.c
 
 
 
@@ -119,12 +119,30 @@ ${OBJECTDIR}/FrameworkSource/ES_Framework.o: FrameworkSource/ES_Framework.c  .ge
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Framework.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Framework.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Framework.o FrameworkSource/ES_Framework.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Hsm.o: FrameworkSource/ES_Hsm.c  .generated_files/flags/default/3d6d1feda87bd43a495b296c875dca0b9a70d4d1 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Hsm.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Hsm.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Hsm.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Hsm.o FrameworkSource/ES_Hsm.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/FrameworkSource/ES_Log.o: FrameworkSource/ES_Log.c  .generated_files/flags/default/3d6d1feda87bd43a495b296c875dca0b9a70d4d1 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Log.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Log.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Log.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Log.o FrameworkSource/ES_Log.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o: FrameworkSource/ES_LookupTables.c  .generated_files/flags/default/9e5ca5999f050bf2d308115eced29b13740d143b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o.d 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_LookupTables.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o FrameworkSource/ES_LookupTables.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Pool.o: FrameworkSource/ES_Pool.c  .generated_files/flags/default/9e5ca5999f050bf2d308115eced29b13740d143b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Pool.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Pool.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Pool.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Pool.o FrameworkSource/ES_Pool.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/ES_Port.o: FrameworkSource/ES_Port.c  .generated_files/flags/default/cbc60e0304b3ae9ac9afafa4daff0696e34b7f13 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Port.o.d 
@@ -143,24 +161,36 @@ ${OBJECTDIR}/FrameworkSource/ES_Queue.o: FrameworkSource/ES_Queue.c  .generated_
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Queue.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Queue.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Queue.o FrameworkSource/ES_Queue.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Ring.o: FrameworkSource/ES_Ring.c  .generated_files/flags/default/dc335c55a9f4a8cd0edf82736aa645b27ca27f79 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Ring.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Ring.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Ring.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Ring.o FrameworkSource/ES_Ring.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/FrameworkSource/ES_Snapshot.o: FrameworkSource/ES_Snapshot.c  .generated_files/flags/default/dc335c55a9f4a8cd0edf82736aa645b27ca27f79 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Snapshot.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o FrameworkSource/ES_Snapshot.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/ES_Timers.o: FrameworkSource/ES_Timers.c  .generated_files/flags/default/6d0d2a3026b7da4977c74c2107d3bd3cf5c19d52 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Timers.o.d 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Timers.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Timers.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Timers.o FrameworkSource/ES_Timers.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Trace.o: FrameworkSource/ES_Trace.c  .generated_files/flags/default/6d0d2a3026b7da4977c74c2107d3bd3cf5c19d52 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Trace.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Trace.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Trace.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Trace.o FrameworkSource/ES_Trace.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/terminal.o: FrameworkSource/terminal.c  .generated_files/flags/default/12110c3331245594e656edd9c6b5582f2f895d2b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/terminal.o.d 
 	@${RM} ${OBJECTDIR}/FrameworkSource/terminal.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/terminal.o.d" -o ${OBJECTDIR}/FrameworkSource/terminal.o FrameworkSource/terminal.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
-${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o: FrameworkSource/circular_buffer_no_modulo_threadsafe.c  .generated_files/flags/default/dc335c55a9f4a8cd0edf82736aa645b27ca27f79 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
-	@${RM} ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o.d 
-	@${RM} ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o.d" -o ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o FrameworkSource/circular_buffer_no_modulo_threadsafe.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
-	
 ${OBJECTDIR}/FrameworkSource/dbprintf.o: FrameworkSource/dbprintf.c  .generated_files/flags/default/4848ef23d2020f9b54678f4711fbbcc6cbccd883 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/dbprintf.o.d 
@@ -197,6 +227,36 @@ ${OBJECTDIR}/ProjectSource/MotorSM.o: ProjectSource/MotorSM.c  .generated_files/
 	@${RM} ${OBJECTDIR}/ProjectSource/MotorSM.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/MotorSM.o.d" -o ${OBJECTDIR}/ProjectSource/MotorSM.o ProjectSource/MotorSM.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/ProjectSource/MotorControl.o: ProjectSource/MotorControl.c  .generated_files/flags/default/1420a4dac495b25a4a49a6b7062e5e3fe6520fbc .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorControl.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorControl.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/MotorControl.o.d" -o ${OBJECTDIR}/ProjectSource/MotorControl.o ProjectSource/MotorControl.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/MotorPWM.o: ProjectSource/MotorPWM.c  .generated_files/flags/default/1420a4dac495b25a4a49a6b7062e5e3fe6520fbc .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorPWM.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorPWM.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/MotorPWM.o.d" -o ${OBJECTDIR}/ProjectSource/MotorPWM.o ProjectSource/MotorPWM.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/RLCapture.o: ProjectSource/RLCapture.c  .generated_files/flags/default/1420a4dac495b25a4a49a6b7062e5e3fe6520fbc .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/RLCapture.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/RLCapture.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/RLCapture.o.d" -o ${OBJECTDIR}/ProjectSource/RLCapture.o ProjectSource/RLCapture.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/WheelSpeed.o: ProjectSource/WheelSpeed.c  .generated_files/flags/default/1420a4dac495b25a4a49a6b7062e5e3fe6520fbc .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/WheelSpeed.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/WheelSpeed.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/WheelSpeed.o.d" -o ${OBJECTDIR}/ProjectSource/WheelSpeed.o ProjectSource/WheelSpeed.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/FastMath.o: ProjectSource/FastMath.c  .generated_files/flags/default/1420a4dac495b25a4a49a6b7062e5e3fe6520fbc .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/FastMath.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/FastMath.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/FastMath.o.d" -o ${OBJECTDIR}/ProjectSource/FastMath.o ProjectSource/FastMath.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/ProjectSource/JetsonSM.o: ProjectSource/JetsonSM.c  .generated_files/flags/default/e0b10a4107d9070545f10ef5dcbe5c452ed25c76 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
 	@${RM} ${OBJECTDIR}/ProjectSource/JetsonSM.o.d 
@@ -245,12 +305,6 @@ ${OBJECTDIR}/ProjectSource/ADC_HAL.o: ProjectSource/ADC_HAL.c  .generated_files/
 	@${RM} ${OBJECTDIR}/ProjectSource/ADC_HAL.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/ADC_HAL.o.d" -o ${OBJECTDIR}/ProjectSource/ADC_HAL.o ProjectSource/ADC_HAL.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
-${OBJECTDIR}/ProjectSource/matt_circular_buffer.o: ProjectSource/matt_circular_buffer.c  .generated_files/flags/default/c05d2431f38258c377a872d532352bfafae283af .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
-	@${RM} ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o.d 
-	@${RM} ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/matt_circular_buffer.o.d" -o ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o ProjectSource/matt_circular_buffer.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
-	
 else
 ${OBJECTDIR}/FrameworkSource/ES_CheckEvents.o: FrameworkSource/ES_CheckEvents.c  .generated_files/flags/default/d88b6eb392944e40c8af5fea34e3bb821616d5ac .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
@@ -270,12 +324,30 @@ ${OBJECTDIR}/FrameworkSource/ES_Framework.o: FrameworkSource/ES_Framework.c  .ge
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Framework.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Framework.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Framework.o FrameworkSource/ES_Framework.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Hsm.o: FrameworkSource/ES_Hsm.c  .generated_files/flags/default/8ff350e6a378152365b310f2dba6544e3f53843 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Hsm.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Hsm.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Hsm.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Hsm.o FrameworkSource/ES_Hsm.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/FrameworkSource/ES_Log.o: FrameworkSource/ES_Log.c  .generated_files/flags/default/8ff350e6a378152365b310f2dba6544e3f53843 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Log.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Log.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Log.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Log.o FrameworkSource/ES_Log.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o: FrameworkSource/ES_LookupTables.c  .generated_files/flags/default/cc5ddb8dc0ece807230bec8c3b4f3cc383ccb30b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o.d 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_LookupTables.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_LookupTables.o FrameworkSource/ES_LookupTables.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Pool.o: FrameworkSource/ES_Pool.c  .generated_files/flags/default/cc5ddb8dc0ece807230bec8c3b4f3cc383ccb30b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Pool.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Pool.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Pool.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Pool.o FrameworkSource/ES_Pool.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/ES_Port.o: FrameworkSource/ES_Port.c  .generated_files/flags/default/50cb9bd6c7e5c802ed64b58116a5dab8c52c85ce .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Port.o.d 
@@ -294,24 +366,36 @@ ${OBJECTDIR}/FrameworkSource/ES_Queue.o: FrameworkSource/ES_Queue.c  .generated_
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Queue.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Queue.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Queue.o FrameworkSource/ES_Queue.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Ring.o: FrameworkSource/ES_Ring.c  .generated_files/flags/default/5b0180eac9d80528ca3bf3d48a793f7d268d85ee .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Ring.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Ring.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Ring.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Ring.o FrameworkSource/ES_Ring.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/FrameworkSource/ES_Snapshot.o: FrameworkSource/ES_Snapshot.c  .generated_files/flags/default/5b0180eac9d80528ca3bf3d48a793f7d268d85ee .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Snapshot.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Snapshot.o FrameworkSource/ES_Snapshot.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/ES_Timers.o: FrameworkSource/ES_Timers.c  .generated_files/flags/default/f84ca0aa4531ac1fd320c2dd17b535e72a044291 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Timers.o.d 
 	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Timers.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Timers.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Timers.o FrameworkSource/ES_Timers.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/FrameworkSource/ES_Trace.o: FrameworkSource/ES_Trace.c  .generated_files/flags/default/f84ca0aa4531ac1fd320c2dd17b535e72a044291 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Trace.o.d 
+	@${RM} ${OBJECTDIR}/FrameworkSource/ES_Trace.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/ES_Trace.o.d" -o ${OBJECTDIR}/FrameworkSource/ES_Trace.o FrameworkSource/ES_Trace.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/FrameworkSource/terminal.o: FrameworkSource/terminal.c  .generated_files/flags/default/6b293599e0b25535e10b8a5db43e88794b86f103 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/terminal.o.d 
 	@${RM} ${OBJECTDIR}/FrameworkSource/terminal.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/terminal.o.d" -o ${OBJECTDIR}/FrameworkSource/terminal.o FrameworkSource/terminal.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
-${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o: FrameworkSource/circular_buffer_no_modulo_threadsafe.c  .generated_files/flags/default/5b0180eac9d80528ca3bf3d48a793f7d268d85ee .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
-	@${RM} ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o.d 
-	@${RM} ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o.d" -o ${OBJECTDIR}/FrameworkSource/circular_buffer_no_modulo_threadsafe.o FrameworkSource/circular_buffer_no_modulo_threadsafe.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
-	
 ${OBJECTDIR}/FrameworkSource/dbprintf.o: FrameworkSource/dbprintf.c  .generated_files/flags/default/acf1ed831b3e54eb0c60c4d22e212b3bf5da24de .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/FrameworkSource" 
 	@${RM} ${OBJECTDIR}/FrameworkSource/dbprintf.o.d 
@@ -348,6 +432,36 @@ ${OBJECTDIR}/ProjectSource/MotorSM.o: ProjectSource/MotorSM.c  .generated_files/
 	@${RM} ${OBJECTDIR}/ProjectSource/MotorSM.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/MotorSM.o.d" -o ${OBJECTDIR}/ProjectSource/MotorSM.o ProjectSource/MotorSM.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/ProjectSource/MotorControl.o: ProjectSource/MotorControl.c  .generated_files/flags/default/30f4169dded207dd220babe6c107d7431b872c13 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorControl.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorControl.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/MotorControl.o.d" -o ${OBJECTDIR}/ProjectSource/MotorControl.o ProjectSource/MotorControl.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/MotorPWM.o: ProjectSource/MotorPWM.c  .generated_files/flags/default/30f4169dded207dd220babe6c107d7431b872c13 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorPWM.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/MotorPWM.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/MotorPWM.o.d" -o ${OBJECTDIR}/ProjectSource/MotorPWM.o ProjectSource/MotorPWM.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/RLCapture.o: ProjectSource/RLCapture.c  .generated_files/flags/default/30f4169dded207dd220babe6c107d7431b872c13 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/RLCapture.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/RLCapture.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/RLCapture.o.d" -o ${OBJECTDIR}/ProjectSource/RLCapture.o ProjectSource/RLCapture.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/WheelSpeed.o: ProjectSource/WheelSpeed.c  .generated_files/flags/default/30f4169dded207dd220babe6c107d7431b872c13 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/WheelSpeed.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/WheelSpeed.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/WheelSpeed.o.d" -o ${OBJECTDIR}/ProjectSource/WheelSpeed.o ProjectSource/WheelSpeed.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/ProjectSource/FastMath.o: ProjectSource/FastMath.c  .generated_files/flags/default/30f4169dded207dd220babe6c107d7431b872c13 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
+	@${RM} ${OBJECTDIR}/ProjectSource/FastMath.o.d 
+	@${RM} ${OBJECTDIR}/ProjectSource/FastMath.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/FastMath.o.d" -o ${OBJECTDIR}/ProjectSource/FastMath.o ProjectSource/FastMath.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 ${OBJECTDIR}/ProjectSource/JetsonSM.o: ProjectSource/JetsonSM.c  .generated_files/flags/default/8e86af26c237e812771a20b10e10bf99b4a86c7e .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
 	@${RM} ${OBJECTDIR}/ProjectSource/JetsonSM.o.d 
@@ -396,12 +510,6 @@ ${OBJECTDIR}/ProjectSource/ADC_HAL.o: ProjectSource/ADC_HAL.c  .generated_files/
 	@${RM} ${OBJECTDIR}/ProjectSource/ADC_HAL.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/ADC_HAL.o.d" -o ${OBJECTDIR}/ProjectSource/ADC_HAL.o ProjectSource/ADC_HAL.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
-${OBJECTDIR}/ProjectSource/matt_circular_buffer.o: ProjectSource/matt_circular_buffer.c  .generated_files/flags/default/9b3fa81a801fbf4da120e544a479555bcfc676c2 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
-	@${MKDIR} "${OBJECTDIR}/ProjectSource" 
-	@${RM} ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o.d 
-	@${RM} ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o 
-	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -I"FrameworkHeaders" -I"ProjectHeaders" -fno-common -MP -MMD -MF "${OBJECTDIR}/ProjectSource/matt_circular_buffer.o.d" -o ${OBJECTDIR}/ProjectSource/matt_circular_buffer.o ProjectSource/matt_circular_buffer.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
-	
 endif
 
 # ------------------------------------------------------------------------------------